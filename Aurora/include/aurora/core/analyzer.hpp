@@ -1,9 +1,16 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "aurora/core/renderer.hpp"
+#include "aurora/core/stft.hpp"
 
 namespace aurora::core {
 
@@ -18,9 +25,13 @@ struct SpectralRatios {
   double ultra = 0.0;
 };
 
+// ITU-R BS.1770-4 / EBU R128 figures: K-weighted, gated integrated loudness, EBU Tech 3342 loudness range and 4x
+// oversampled true peak. `short_term_lufs` is the mean of the 3 s short-term series.
 struct LoudnessMetrics {
   double integrated_lufs = 0.0;
   double short_term_lufs = 0.0;
+  double momentary_max_lufs = 0.0;
+  double short_term_max_lufs = 0.0;
   double true_peak_dbtp = 0.0;
   double rms_db = 0.0;
   double crest_factor_db = 0.0;
@@ -65,6 +76,7 @@ struct SpectrogramArtifact {
   bool enabled = false;
   std::string path;
   std::vector<std::string> paths;
+  std::string tiles_manifest;  // tile pyramid manifest, when tiles were requested
   std::string error;
   std::string mode = "mixdown";
   int sr = 0;
@@ -81,6 +93,7 @@ struct SpectrogramArtifact {
   int height_px = 512;
   double gamma = 1.0;
   int smoothing_bins = 0;
+  int smoothing_columns = 0;
 };
 
 struct IntentEvaluation {
@@ -110,6 +123,55 @@ struct CompositeSpectrogramReport {
   std::string error;
 };
 
+// Per-hop feature time series kept when AnalysisOptions::keep_feature_series is set. `columns[c][f]` holds feature
+// `column_names[c]` for STFT frame f, which starts at sample f * hop.
+struct FeatureSeries {
+  int hop = 0;
+  int fft_size = 0;
+  std::vector<std::string> column_names;
+  std::vector<std::vector<float>> columns;
+  // Short-term loudness keeps its own 3 s window / 1 s hop.
+  int loudness_window = 0;
+  int loudness_hop = 0;
+  std::vector<float> short_term_lufs;
+};
+
+// Location of an exported FeatureSeries; the series data itself is not repeated in analysis.json.
+struct FeatureExportArtifact {
+  bool present = false;
+  std::string format = "npy";
+  std::string path;
+  std::string loudness_path;
+  int frames = 0;
+  int hop = 0;
+  int fft_size = 0;
+  std::vector<std::string> columns;
+  int loudness_frames = 0;
+  int loudness_window = 0;
+  int loudness_hop = 0;
+  std::string error;
+};
+
+// Metrics of one time window of a target, taken from the same pass as the whole-file figures.
+struct TimelineWindow {
+  std::string section;  // section name of a section-aligned window; empty for fixed windows
+  double start_seconds = 0.0;
+  double end_seconds = 0.0;
+  double integrated_lufs = 0.0;  // gated BS.1770 loudness of the window alone
+  double short_term_max_lufs = 0.0;
+  SpectralRatios ratios;
+  double centroid_hz = 0.0;
+  double correlation = 0.0;  // stereo targets only
+  double transients_per_minute = 0.0;  // onsets above the whole-file threshold
+};
+
+struct AnalysisTimeline {
+  bool present = false;
+  double window_seconds = 0.0;
+  std::vector<TimelineWindow> windows;
+  std::vector<TimelineWindow> sections;
+};
+
 struct FileAnalysis {
   std::string name;
   double duration_seconds = 0.0;
@@ -125,6 +187,47 @@ struct FileAnalysis {
   double sub_contribution_ratio = 0.0;
   std::string frequency_dominance_profile;
   SpectrogramArtifact spectrogram;
+  FeatureSeries series;
+  FeatureExportArtifact features;
+  AnalysisTimeline timeline;
+  // Mono magnitude frames kept for the spectrogram when AnalysisOptions::spectrogram_widths is set; empty otherwise.
+  MagnitudeFrames spectrum;
+};
+
+struct MaskingPeak {
+  double start_seconds = 0.0;  // start of the window
+  std::string band;
+  double value = 0.0;
+};
+
+// Interference of two targets per band, measured on their mono folds. `overlap` is the share of their combined bin
+// energy that both occupy (2 * sum(min) / sum(a + b), 0..1); `cancellation_db` is the level of their sum relative
+// to the sum of their levels (negative where they cancel, positive where they reinforce).
+struct MaskingPair {
+  std::string a;
+  std::string b;
+  bool with_mix = false;  // `b` is the mix rather than another stem
+  SpectralRatios overlap;
+  SpectralRatios cancellation_db;
+  // Strongest overlap and deepest cancellation over windows and bands, ignoring cells 30 dB below the pair's loudest.
+  MaskingPeak peak_overlap;
+  MaskingPeak peak_cancellation;
+  // Per-window values; exported as arrays rather than written to analysis.json.
+  std::vector<SpectralRatios> window_overlap;
+  std::vector<SpectralRatios> window_cancellation_db;
+};
+
+struct MaskingReport {
+  bool present = false;
+  double window_seconds = 0.0;
+  int fft_size = 0;
+  int hop = 0;
+  size_t windows = 0;
+  SpectralRatios mix_summing_db;  // mix level relative to the summed stem levels, per band
+  std::vector<MaskingPair> pairs;
+  std::string overlap_path;
+  std::string cancellation_path;
+  std::string error;
 };
 
 struct AnalysisReport {
@@ -137,19 +240,74 @@ struct AnalysisReport {
   std::vector<FileAnalysis> stems;
   CompositeSpectrogramReport composite_spectrogram;
   IntentEvaluation intent_evaluation;
+  MaskingReport masking;
 };
 
 struct AnalysisOptions {
   int fft_size = 2048;
   int fft_hop = 1024;
   double silence_threshold_db = -50.0;
+  // Cap on the TaskScheduler threads analysis jobs spread over; 0 uses the whole global budget.
   int max_parallel_jobs = 0;
   std::string intent;
+  bool keep_feature_series = false;
+  // Spectrogram STFT to share with the analysis. When widths are given, the window and nfft equal fft_size and
+  // fft_hop is a multiple of spectrogram_hop, the analysis STFT runs at spectrogram_hop (metrics use every
+  // fft_hop / spectrogram_hop-th frame) and keeps the frames spectrograms of those widths read in
+  // FileAnalysis::spectrum.
+  int spectrogram_window = 2048;
+  int spectrogram_hop = 512;
+  int spectrogram_nfft = 2048;
+  std::vector<int> spectrogram_widths;
+  // Timeline of fixed windows this many seconds long (0 disables it), plus one window per section. AnalyzeRender
+  // fills the sections from the render metadata.
+  double timeline_window_seconds = 0.0;
+  std::vector<RenderSection> timeline_sections;
+  // Pairwise stem masking over windows this many seconds long; 0 disables it. Needs at least one stem.
+  double masking_window_seconds = 0.0;
+  // When set, every analyzed segment adds its STFT frames here, so callers can watch analysis advance.
+  std::atomic<uint64_t>* frames_processed = nullptr;
+};
+
+// Interleaved audio pulled in bounded blocks instead of held in memory. `read` fills `out` with frames
+// [first_frame, first_frame + frame_count) and may be called concurrently from several analysis workers.
+struct StreamedAudio {
+  std::string name;
+  int channels = 0;
+  size_t frame_count = 0;
+  std::function<bool(size_t first_frame, size_t frame_count, float* out, std::string* error)> read;
 };
 
 FileAnalysis AnalyzeStem(const AudioStem& stem, int sample_rate, const AnalysisOptions& options);
 AnalysisReport AnalyzeRender(const RenderResult& render, const AnalysisOptions& options);
 AnalysisReport AnalyzeFiles(const std::vector<AudioStem>& stems, const AudioStem& mix, int sample_rate,
                             const std::string& mode, const AnalysisOptions& options);
+// Same analysis as AnalyzeFiles over streamed sources; memory stays bounded by the worker count, not file length.
+bool AnalyzeStreamedFiles(const std::vector<StreamedAudio>& stems, const StreamedAudio& mix, int sample_rate,
+                          const std::string& mode, const AnalysisOptions& options, AnalysisReport* report,
+                          std::string* error);
+
+// Render analysis that runs alongside the render: each stem is analyzed on the TaskScheduler as soon as the renderer
+// hands it over through RenderOptions::stem_callback, so Finish() is left with the master and the cross-stem
+// metrics. The report equals AnalyzeRender's for the same render.
+class RenderAnalysisSession {
+ public:
+  RenderAnalysisSession(const RenderMetadata& metadata, size_t stem_count, const AnalysisOptions& options);
+  ~RenderAnalysisSession();
+  RenderAnalysisSession(const RenderAnalysisSession&) = delete;
+  RenderAnalysisSession& operator=(const RenderAnalysisSession&) = delete;
+
+  // Starts analyzing stem `index` (patch stems, then bus stems). The stem must outlive the session. Thread-safe.
+  void AddStem(size_t index, const AudioStem& stem);
+  // Analyzes the master, collects the stem analyses (analyzing any stem never added) and builds the report.
+  AnalysisReport Finish(const RenderResult& render);
+
+ private:
+  int sample_rate_ = 0;
+  AnalysisOptions options_;
+  std::vector<FileAnalysis> stems_;
+  std::vector<std::future<void>> pending_;
+  std::mutex mutex_;
+};
 
 }  // namespace aurora::core
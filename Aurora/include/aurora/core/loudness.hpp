@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace aurora::core {
+
+// ITU-R BS.1770-4 K-weighting of one channel: the high-shelf pre-filter followed by the RLB high-pass, with
+// coefficients derived for any sample rate (they reduce to the published 48 kHz values).
+class KWeightingFilter {
+ public:
+  explicit KWeightingFilter(int sample_rate);
+
+  // Filters `count` samples spaced `stride` apart in `in` into contiguous `out`.
+  void Process(const float* in, size_t count, size_t stride, float* out);
+
+ private:
+  double shelf_b_[3] = {};
+  double shelf_a_[3] = {};
+  double highpass_b_[3] = {};
+  double highpass_a_[3] = {};
+  double shelf_z_[2] = {};
+  double highpass_z_[2] = {};
+};
+
+// Inter-sample peak of one channel after BS.1770-4 Annex 2: polyphase oversampling (4x below 96 kHz, 2x below
+// 192 kHz) through a 12-tap-per-phase windowed-sinc interpolator, combined with the sample peak. Each phase is a
+// contiguous multiply-add over a chunk of input, which the compiler vectorizes.
+class TruePeakDetector {
+ public:
+  explicit TruePeakDetector(int sample_rate);
+
+  // Feeds `count` samples spaced `stride` apart. Peaks are only recorded when `measure` is set, so a detector can be
+  // primed with the audio before a segment.
+  void Process(const float* in, size_t count, size_t stride, bool measure);
+  double peak() const { return peak_; }  // linear
+
+ private:
+  size_t factor_ = 1;
+  size_t taps_ = 1;
+  std::vector<float> phases_;   // factor_ x taps_, reversed so phase p at output i reads input i .. i + taps_ - 1
+  std::vector<float> history_;  // previous taps_ - 1 inputs followed by the current chunk
+  std::vector<float> phase_out_;
+  double peak_ = 0.0;
+};
+
+// Length of the 100 ms blocks that every loudness window is assembled from.
+size_t LoudnessBlockFrames(int sample_rate);
+
+struct LoudnessSummary {
+  bool gated = false;  // false when the signal is shorter than one 400 ms gating block
+  double integrated_lufs = 0.0;
+  double lra = 0.0;
+  double momentary_max_lufs = 0.0;
+  double short_term_max_lufs = 0.0;
+  // Short-term loudness of 3 s windows starting every 1 s.
+  std::vector<double> short_term_lufs;
+};
+
+// Loudness of a signal from `block_energy[i]`, the channel-summed squared K-weighted samples of 100 ms block i.
+// Momentary (400 ms) and short-term (3 s) windows slide over the blocks as running sums, so the cost is one add and
+// one subtract per block at any window length. Integrated loudness applies the BS.1770-4 two-stage gate (-70 LUFS
+// absolute, -10 LU relative) to 400 ms blocks at 75% overlap; LRA applies the EBU Tech 3342 gate (-70 LUFS, -20 LU)
+// to short-term values every 100 ms and spans their 10th to 95th percentile.
+LoudnessSummary SummarizeLoudness(const std::vector<double>& block_energy, size_t block_frames);
+
+struct LoudnessReading {
+  bool measured = false;
+  double integrated_lufs = 0.0;
+  double lra = 0.0;
+  double momentary_max_lufs = 0.0;
+  double short_term_max_lufs = 0.0;
+  double true_peak_dbtp = 0.0;
+};
+
+// Streaming BS.1770 meter for interleaved audio fed in order. Memory grows by one double per 100 ms block.
+class LoudnessMeter {
+ public:
+  LoudnessMeter(int sample_rate, int channels);
+
+  void Add(const float* interleaved, size_t frames);
+  LoudnessReading Finish() const;
+
+ private:
+  int channels_ = 1;
+  size_t block_frames_ = 1;
+  size_t block_filled_ = 0;
+  double block_sum_ = 0.0;
+  std::vector<KWeightingFilter> weighting_;
+  std::vector<TruePeakDetector> true_peak_;
+  std::vector<float> weighted_;
+  std::vector<double> blocks_;
+};
+
+}  // namespace aurora::core
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "aurora/core/analyzer.hpp"
+
+namespace aurora::core {
+
+// Pairwise masking between every pair of `stems` and between each stem and `mix`, per band and per window of
+// AnalysisOptions::masking_window_seconds. All targets are transformed in lockstep with the analysis STFT size and
+// hop; each frame's spectra then go through a pairwise kernel tiled over stem rows and grouped by band, so the rows
+// a tile compares stay in cache while every pair in it is scored. Windows are independent jobs, so the report does
+// not depend on AnalysisOptions::max_parallel_jobs. Fails only when a source cannot be read.
+bool AnalyzeMasking(const std::vector<StreamedAudio>& stems, const StreamedAudio& mix, int sample_rate,
+                    const AnalysisOptions& options, MaskingReport* report, std::string* error);
+
+}  // namespace aurora::core
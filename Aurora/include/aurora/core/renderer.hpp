@@ -1,26 +1,86 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <string>
 #include <vector>
 
+#include "aurora/core/loudness.hpp"
+#include "aurora/core/stem_stats.hpp"
 #include "aurora/lang/ast.hpp"
 
 namespace aurora::core {
 
+struct AudioStem;
+class RenderCache;
+struct RenderPlan;
+struct RenderProgress;
+
+// One end of a range render: a timeline position (s, ms, min, h or beats) or a named section, which bounds the range
+// at its start when used as RenderOptions::range_from and at its end as range_to.
+struct RenderTimeRef {
+  aurora::lang::UnitNumber time;
+  std::string section;
+};
+
+// Fast, lower-fidelity rendering for iteration (RenderOptions::draft).
+struct DraftOptions {
+  bool enabled = false;
+  // Internal render rate, capped at the output rate; stems and the master are upsampled back to the output rate.
+  int sample_rate = 24000;
+  // Renders every patch and bus in mono; outputs keep their channel layout with equal channels.
+  bool mono = false;
+};
+
 struct RenderOptions {
   uint64_t seed = 0;
   int sample_rate_override = 0;
-  std::function<void(double)> progress_callback;
+  // Automation CC points are only emitted when the 7-bit value differs from the last emitted one by more than this.
+  int midi_cc_tolerance = 0;
+  // Measures BS.1770 loudness and true peak of the master during the final limiter pass.
+  bool meter_master_loudness = false;
+  // Renders only [range_from, range_to) of the timeline (defaults: its start and end). Only plays sounding in the
+  // range, release tails included, are rendered; buses fed by patches warm up over a pre-roll as long as their delay
+  // and reverb tails (at most 30 s). All outputs start at range_from. Renderer::ResolveRange validates the bounds.
+  std::optional<RenderTimeRef> range_from;
+  std::optional<RenderTimeRef> range_to;
+  // Draft renders run at DraftOptions::sample_rate with modulation routes updated once per block and a two-comb bus
+  // reverb. Timeline, event placement, stem lengths and MIDI are those of a final render.
+  DraftOptions draft;
+  // Stems of earlier renders to reuse; patches and buses whose inputs are unchanged are copied instead of rendered.
+  RenderCache* cache = nullptr;
+  // Renders only these patches and buses and the patches sending to a selected bus (both empty: everything). Stems
+  // keep the length, start and channel layout of the whole render; RenderResult holds only the rendered stems and
+  // their MIDI tracks, and the master mixes only them. Names are checked by Renderer::ResolveSelection.
+  std::set<std::string> only_patches;
+  std::set<std::string> only_buses;
+  // Receives a RenderProgress snapshot when the render starts, at most every few hundred milliseconds while it runs,
+  // and when it ends. Called from whichever thread advances the counters, never from two threads at once.
+  std::function<void(const RenderProgress&)> progress_callback;
+  // Receives the cost model once the score is expanded, before any patch renders.
+  std::function<void(const RenderPlan&)> plan_callback;
+  // Receives each stem as soon as its samples are final: a patch stem when its patch has rendered, a bus stem when
+  // its bus has processed. `index` counts RenderResult::patch_stems and then bus_stems (only the rendered ones when
+  // only_patches / only_buses select some); the stem is the object later
+  // returned there, and its samples no longer change. Called from TaskScheduler threads, possibly concurrently.
+  std::function<void(size_t index, const AudioStem& stem)> stem_callback;
 };
 
 struct AudioStem {
   std::string name;
   int channels = 1;
   std::vector<float> samples;
+  AudioStemStats stats;
 };
 
+// Rescans `stem` when its stats were not gathered while it was produced.
+AudioStemStats ComputeAudioStemStats(const AudioStem& stem);
+
 struct MidiNote {
   int channel = 0;
   int note = 60;
@@ -42,25 +102,130 @@ struct MidiTrackData {
   std::vector<MidiCCPoint> ccs;
 };
 
+// Placement of one score section on the rendered timeline, in samples.
+struct RenderSection {
+  std::string name;
+  uint64_t start_sample = 0;
+  uint64_t end_sample = 0;
+};
+
 struct RenderMetadata {
   int sample_rate = 48000;
   int block_size = 256;
+  // Timeline sample the outputs start at; non-zero only for a range render, whose sections are shifted to match.
+  uint64_t start_sample = 0;
   uint64_t total_samples = 0;
   double duration_seconds = 0.0;
+  // Internal rate of a draft render (RenderOptions::draft) and whether it rendered in mono; rate 0 for a final render.
+  int draft_sample_rate = 0;
+  bool draft_mono = false;
+  std::vector<RenderSection> sections;
+};
+
+// Predicted single-thread cost of rendering one patch or processing one bus.
+struct RenderCostEstimate {
+  std::string name;
+  // Patches: samples rendered per voice, summed over every play and pitch. Buses: frames processed.
+  uint64_t samples = 0;
+  // Relative cost of one sample through the enabled stages; one unit is one oscillator of a mono voice.
+  double units_per_sample = 0.0;
+  double seconds = 0.0;
+};
+
+// Cost model of one render. Patch and bus costs come from their enabled stages times the samples they process,
+// converted to seconds by a microbenchmark of the real voice and bus code that runs once per process. Tasks are
+// dispatched longest first, so a heavy patch declared last no longer starts late and becomes the straggler.
+struct RenderPlan {
+  RenderMetadata metadata;
+  std::vector<RenderCostEstimate> patches;  // patches with plays, longest first
+  std::vector<RenderCostEstimate> buses;    // longest first
+  size_t threads = 1;
+  double work_seconds = 0.0;  // all estimates summed
+  // Patch stage then bus stage, each list-scheduled longest first on `threads`.
+  double predicted_seconds = 0.0;
+};
+
+// Live state of one patch in a RenderProgress.
+struct RenderPatchProgress {
+  std::string name;
+  uint64_t samples_rendered = 0;   // voice-samples rendered so far
+  uint64_t samples_predicted = 0;  // RenderCostEstimate::samples
+  bool done = false;
+};
+
+// Telemetry snapshot of a running render. Voices publish their rendered samples every few thousand samples, so the
+// counters move while a long patch renders instead of only when it finishes.
+struct RenderProgress {
+  // Predicted work done: each patch counts its estimated seconds in proportion to its rendered samples (capped until
+  // it finishes), each bus its estimated seconds once processed.
+  double percent = 0.0;
+  double elapsed_seconds = 0.0;
+  // Timeline seconds finished per wall-clock second, from `percent` of the render duration.
+  double realtime_factor = 0.0;
+  // Elapsed time scaled by the predicted work left; 0 until some work has finished.
+  double remaining_seconds = 0.0;
+  size_t voices_in_flight = 0;
+  uint64_t samples_rendered = 0;
+  uint64_t samples_predicted = 0;
+  size_t buses_done = 0;
+  size_t buses_total = 0;
+  std::vector<RenderPatchProgress> patches;  // RenderPlan::patches order
 };
 
 struct RenderResult {
   std::vector<AudioStem> patch_stems;
   std::vector<AudioStem> bus_stems;
   AudioStem master;
+  LoudnessReading master_loudness;  // measured only with RenderOptions::meter_master_loudness
   std::vector<MidiTrackData> midi_tracks;
   RenderMetadata metadata;
   std::vector<std::string> warnings;
+  // Patch stems then bus stems: true where RenderOptions::cache supplied the stem instead of a render.
+  std::vector<bool> stems_reused;
+};
+
+// Patch and bus stems kept between renders of an edited score (RenderOptions::cache). Each stem is stored under a
+// fingerprint of everything it depends on: the patch or bus definition, the plays and automation reaching the patch,
+// the patches feeding the bus, the render's rate, window and draft settings, and the seed for patches whose voices use
+// it. A render copies every stem whose fingerprint is unchanged and renders the rest, so only edited patches, the buses
+// they feed and the master are recomputed, and renders of one score under many seeds share every seed-independent
+// stem. The result is the same as without the cache. Safe to use from the renderer's worker threads.
+class RenderCache {
+ public:
+  // Copies the channels and samples stored under `key` into *stem when they were stored with `fingerprint`.
+  bool Lookup(const std::string& key, uint64_t fingerprint, AudioStem* stem);
+  void Store(const std::string& key, uint64_t fingerprint, const AudioStem& stem);
+  // Drops every stem no Lookup or Store has touched since the previous sweep; Renderer::Render sweeps after each
+  // render, so stems of removed or renamed patches do not linger.
+  void Sweep();
+  size_t size() const;
+
+ private:
+  struct Entry {
+    uint64_t fingerprint = 0;
+    int channels = 1;
+    std::vector<float> samples;
+  };
+
+  mutable std::mutex mutex_;
+  std::map<std::string, Entry> entries_;
+  std::set<std::string> touched_;
 };
 
 class Renderer {
  public:
   RenderResult Render(const aurora::lang::AuroraFile& file, const RenderOptions& options) const;
+  // Expands the score and predicts the render's cost on the global TaskScheduler without rendering any audio.
+  RenderPlan Plan(const aurora::lang::AuroraFile& file, const RenderOptions& options) const;
+  // Resolves RenderOptions::range_from / range_to to timeline samples [*start_sample, *end_sample). Fails on an unknown
+  // section or unit, or a range that is empty or starts past the end of the timeline; Render() then renders the whole
+  // timeline and records the problem as a warning.
+  bool ResolveRange(const aurora::lang::AuroraFile& file, const RenderOptions& options, uint64_t* start_sample,
+                    uint64_t* end_sample, std::string* error) const;
+  // Lists what RenderOptions::only_patches / only_buses render, in declaration order: the selected patches and buses
+  // and every patch sending to a selected bus. Fails on a name the score does not define.
+  bool ResolveSelection(const aurora::lang::AuroraFile& file, const RenderOptions& options,
+                        std::vector<std::string>* patches, std::vector<std::string>* buses, std::string* error) const;
 };
 
 }  // namespace aurora::core
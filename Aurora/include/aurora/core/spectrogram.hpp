@@ -1,9 +1,13 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
+#include "aurora/core/stft.hpp"
+
 namespace aurora::core {
 
 struct SpectrogramConfig {
@@ -20,11 +24,64 @@ struct SpectrogramConfig {
   int width_px = 1600;
   int height_px = 512;
   double gamma = 1.0;
+  // Box-filter radii over normalized values: `smoothing_bins` along frequency (image rows), `smoothing_columns` along
+  // time (image columns). Either costs the same at any radius.
   int smoothing_bins = 0;
+  int smoothing_columns = 0;
+  // Cap on the TaskScheduler threads rasterizing image columns; a runtime setting, not part of the reported artifact.
+  int render_threads = 1;
 };
 
+// Renders the normalized spectrogram straight to 8-bit colormap LUT indices (row-major, top row = max_hz). The RGB
+// expansion through the colormap is only produced when `rgb` is non-null.
+bool RenderSpectrogramIndexed(const std::vector<float>& mono, int sample_rate, const SpectrogramConfig& config,
+                              std::vector<uint8_t>* indices, std::vector<uint8_t>* rgb, std::string* error);
+// Rasterizes precomputed magnitude frames (e.g. kept by the analyzer) instead of running the STFT again. `frames`
+// must match the config's window/hop/nfft and hold every frame MarkSpectrogramFrames flags for `config.width_px`.
+bool RenderSpectrogramIndexedFromFrames(const MagnitudeFrames& frames, int sample_rate, const SpectrogramConfig& config,
+                                        std::vector<uint8_t>* indices, std::vector<uint8_t>* rgb, std::string* error);
 bool RenderSpectrogramRgb(const std::vector<float>& mono, int sample_rate, const SpectrogramConfig& config,
                           std::vector<uint8_t>* rgb, std::string* error);
 bool BuildColormapLutRgb(const std::string& name, std::vector<uint8_t>* palette_rgb, std::string* error);
 
+// Zoomable tile pyramid of one signal, deep-zoom style: level 0 fits in a single tile and every finer level doubles the
+// time resolution, down to one column per STFT frame. Tiles are `tile_width_px` columns of `config.height_px` rows;
+// the last tile of a level may be narrower.
+struct SpectrogramTileConfig {
+  int tile_width_px = 256;
+  // How a coarser column combines the two finer ones, on linear magnitudes: "max" keeps short events visible,
+  // "mean" matches what a wider STFT hop would average.
+  std::string pooling = "max";
+};
+
+struct SpectrogramTile {
+  int level = 0;
+  size_t index = 0;  // tile position along time within the level
+  int width = 0;
+  int height = 0;
+  std::vector<uint8_t> indices;  // colormap LUT indices, row-major, top row = max_hz
+};
+
+struct SpectrogramPyramidLevel {
+  size_t columns = 0;
+  size_t tiles = 0;
+  size_t frames_per_column = 1;
+};
+
+struct SpectrogramPyramid {
+  size_t frame_count = 0;
+  int tile_width_px = 0;
+  int tile_height_px = 0;
+  std::vector<SpectrogramPyramidLevel> levels;  // coarsest first
+};
+
+using SpectrogramTileSink = std::function<bool(const SpectrogramTile& tile, std::string* error)>;
+
+// Builds the pyramid in one pass over the STFT frames of `read`. Only the tile being filled at each level is kept;
+// coarser levels pool finer columns instead of transforming again, so memory is bounded by levels x tile size for
+// any signal length. Tiles reach `sink` as soon as they are complete. Smoothing settings are not applied to tiles.
+bool RenderSpectrogramPyramid(const MonoSampleReader& read, size_t sample_count, int sample_rate,
+                              const SpectrogramConfig& config, const SpectrogramTileConfig& tiles,
+                              const SpectrogramTileSink& sink, SpectrogramPyramid* pyramid, std::string* error);
+
 }  // namespace aurora::core
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace aurora::core {
+
+// Samples at or below this magnitude count as silence for the audible-range bookkeeping (-120 dBFS).
+inline constexpr double kStemSilenceFloor = 1e-6;
+
+// Whole-stem statistics gathered while the final samples are produced, so render.json and the analyzer do not have
+// to rescan the buffer. `valid` stays false for stems whose samples were filled without an accumulator.
+struct AudioStemStats {
+  bool valid = false;
+  uint64_t frame_count = 0;
+  uint64_t sample_count = 0;
+  double peak = 0.0;
+  double sum_squares = 0.0;
+  double sum = 0.0;
+  // Peak and energy of the mono fold used by analysis (stereo frames averaged in float, as MixToMono does).
+  double mono_peak = 0.0;
+  double mono_sum_squares = 0.0;
+  // [first_audible_frame, end_audible_frame) spans every frame with a sample above kStemSilenceFloor; empty if silent.
+  uint64_t first_audible_frame = 0;
+  uint64_t end_audible_frame = 0;
+  uint64_t nan_count = 0;
+
+  double rms() const { return sample_count == 0 ? 0.0 : std::sqrt(sum_squares / static_cast<double>(sample_count)); }
+  double mono_rms() const { return frame_count == 0 ? 0.0 : std::sqrt(mono_sum_squares / static_cast<double>(frame_count)); }
+  double dc_offset() const { return sample_count == 0 ? 0.0 : sum / static_cast<double>(sample_count); }
+};
+
+// Frame-at-a-time accumulator for AudioStemStats. Sums run in sample order so results match a sequential rescan.
+class AudioStemStatsAccumulator {
+ public:
+  void AddMono(float sample) {
+    AddSample(sample);
+    stats_.mono_sum_squares = stats_.sum_squares;
+    stats_.mono_peak = stats_.peak;
+    EndFrame(std::fabs(static_cast<double>(sample)) > kStemSilenceFloor);
+  }
+
+  void AddStereo(float left, float right) {
+    AddSample(left);
+    AddSample(right);
+    const double mono = static_cast<double>(0.5F * (left + right));
+    stats_.mono_peak = std::max(stats_.mono_peak, std::fabs(mono));
+    stats_.mono_sum_squares += mono * mono;
+    EndFrame(std::fabs(static_cast<double>(left)) > kStemSilenceFloor ||
+             std::fabs(static_cast<double>(right)) > kStemSilenceFloor);
+  }
+
+  AudioStemStats Finish() const {
+    AudioStemStats out = stats_;
+    out.valid = true;
+    return out;
+  }
+
+ private:
+  void AddSample(float sample) {
+    const double v = static_cast<double>(sample);
+    if (std::isnan(v)) {
+      ++stats_.nan_count;
+    }
+    stats_.peak = std::max(stats_.peak, std::fabs(v));
+    stats_.sum_squares += v * v;
+    stats_.sum += v;
+    ++stats_.sample_count;
+  }
+
+  void EndFrame(bool audible) {
+    if (audible) {
+      if (stats_.end_audible_frame == 0) {
+        stats_.first_audible_frame = stats_.frame_count;
+      }
+      stats_.end_audible_frame = stats_.frame_count + 1U;
+    }
+    ++stats_.frame_count;
+  }
+
+  AudioStemStats stats_;
+};
+
+}  // namespace aurora::core
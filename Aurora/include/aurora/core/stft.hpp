@@ -0,0 +1,61 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace aurora::core {
+
+// In-place radix-2 FFT; the size must be a power of two.
+void FftInPlace(std::vector<std::complex<double>>* values);
+// Symmetric Hann window of `size` taps.
+std::vector<double> BuildHann(int size);
+
+// Number of frames in a Hann-windowed STFT of `sample_count` samples. A signal shorter than one window still yields
+// one zero-padded frame.
+size_t StftFrameCount(size_t sample_count, int window, int hop);
+
+// Magnitude frames of one STFT, shared between the analyzer and the spectrogram rasterizer. Only frames that a
+// consumer asked for are stored: `slots[f]` is the row of frame `f` in `magnitudes`, or -1 when it was skipped.
+struct MagnitudeFrames {
+  int window = 0;
+  int hop = 0;
+  int nfft = 0;
+  int bins = 0;  // nfft / 2 + 1
+  size_t frame_count = 0;
+  std::vector<int32_t> slots;
+  std::vector<float> magnitudes;
+
+  bool Matches(int other_window, int other_hop, int other_nfft) const {
+    return frame_count > 0 && window == other_window && hop == other_hop && nfft == other_nfft;
+  }
+  bool Has(size_t frame) const { return frame < slots.size() && slots[frame] >= 0; }
+  const float* Frame(size_t frame) const {
+    return magnitudes.data() + static_cast<size_t>(slots[frame]) * static_cast<size_t>(bins);
+  }
+};
+
+// Flags in `wanted` (sized to `frame_count`) the frames a spectrogram `width_px` columns wide interpolates between.
+// Calling it for several widths marks the union, so one set of frames can feed several profiles.
+void MarkSpectrogramFrames(size_t frame_count, int width_px, std::vector<uint8_t>* wanted);
+
+// Fills `out` with samples [first, first + count) of a mono signal; `count` never runs past the signal end.
+using MonoSampleReader = std::function<bool(size_t first, size_t count, float* out, std::string* error)>;
+
+// Computes the wanted magnitude frames of `mono`; non-finite samples are treated as silence.
+bool ComputeMagnitudeFrames(const std::vector<float>& mono, int window, int hop, int nfft,
+                            const std::vector<uint8_t>& wanted, MagnitudeFrames* out, std::string* error);
+// Same, pulling one window per wanted frame from `read`, so a long signal never has to be resident.
+bool ComputeMagnitudeFrames(const MonoSampleReader& read, size_t sample_count, int window, int hop, int nfft,
+                            const std::vector<uint8_t>& wanted, MagnitudeFrames* out, std::string* error);
+
+// Receives frame `frame`'s `nfft / 2 + 1` magnitudes; the buffer is reused for the next frame.
+using MagnitudeFrameVisitor = std::function<bool(size_t frame, const float* magnitudes, std::string* error)>;
+// Streams every frame of the STFT in order without storing any, reading each sample from `read` once.
+bool ForEachMagnitudeFrame(const MonoSampleReader& read, size_t sample_count, int window, int hop, int nfft,
+                           const MagnitudeFrameVisitor& visit, std::string* error);
+
+}  // namespace aurora::core
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace aurora::core {
+
+// Threads this process may keep busy when no budget is given: the CPUs in its affinity mask, capped by a cgroup CPU
+// quota (v2 `cpu.max`, or v1 `cpu.cfs_quota_us` / `cpu.cfs_period_us`) rounded up to whole CPUs.
+int DefaultThreadCount();
+
+// Process-wide work-stealing scheduler shared by the renderer, analyzer, spectrogram rasterizer and output writers.
+// A budget of N threads starts N - 1 workers; a thread blocked in Wait() or ParallelFor() does work itself, so at most
+// N threads run tasks at once however deeply the subsystems nest. Each worker owns a deque: tasks it submits go to
+// the back and are popped from there, idle workers steal from the front of the others, and tasks submitted from
+// outside the pool go to a shared queue.
+class TaskScheduler {
+ public:
+  // The scheduler every subsystem uses; created on first use with DefaultThreadCount() threads.
+  static TaskScheduler& Global();
+  // Rebuilds the global scheduler with a budget of `threads` (<= 0 selects DefaultThreadCount()). Call it before any
+  // work is submitted, e.g. while parsing the command line.
+  static void Configure(int threads);
+
+  explicit TaskScheduler(size_t threads);
+  ~TaskScheduler();
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+  // Threads that may run tasks at once, counting the caller that waits for them.
+  size_t concurrency() const;
+
+  // Queues `task`; its result (or exception) arrives through the returned future. Collect it with Wait().
+  template <typename F>
+  auto Submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+    using Result = std::invoke_result_t<std::decay_t<F>>;
+    auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+    std::future<Result> future = packaged->get_future();
+    Push([packaged]() { (*packaged)(); });
+    return future;
+  }
+
+  // Returns the value of `future`, running queued tasks on this thread until it is ready.
+  template <typename T>
+  T Wait(std::future<T>& future) {
+    while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      if (!RunOne()) {
+        future.wait_for(kIdlePoll);
+      }
+    }
+    return future.get();
+  }
+
+  // Runs body(i) for every i in [0, count) on up to `max_parallelism` threads (0: concurrency()), the caller
+  // included, each claiming the next index in turn. Returns once every index has finished and rethrows the first
+  // exception a body threw. Only indices already claimed by running threads are waited for, so a body may itself
+  // call ParallelFor.
+  void ParallelFor(size_t count, size_t max_parallelism, const std::function<void(size_t)>& body);
+
+ private:
+  struct State;
+
+  static constexpr std::chrono::microseconds kIdlePoll{200};
+
+  void Push(std::function<void()> task);
+  bool RunOne();
+
+  std::unique_ptr<State> state_;
+};
+
+}  // namespace aurora::core
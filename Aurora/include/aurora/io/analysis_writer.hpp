@@ -4,9 +4,15 @@
 #include <string>
 
 #include "aurora/core/analyzer.hpp"
+#include "aurora/core/spectrogram.hpp"
 
 namespace aurora::io {
 
 bool WriteAnalysisJson(const std::filesystem::path& path, const aurora::core::AnalysisReport& report, std::string* error);
+// Describes a spectrogram tile pyramid whose tiles sit next to the manifest as "<level>/<index>.png".
+bool WriteSpectrogramTileManifest(const std::filesystem::path& path, const std::string& target, int sample_rate,
+                                  const aurora::core::SpectrogramConfig& config,
+                                  const aurora::core::SpectrogramTileConfig& tiles,
+                                  const aurora::core::SpectrogramPyramid& pyramid, std::string* error);
 
 }  // namespace aurora::io
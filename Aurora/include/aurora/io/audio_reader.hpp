@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <filesystem>
+#include <memory>
 #include <string>
 
 #include "aurora/core/renderer.hpp"
@@ -9,4 +11,28 @@ namespace aurora::io {
 
 bool ReadAudioFile(const std::filesystem::path& path, aurora::core::AudioStem* stem, int* sample_rate, std::string* error);
 
+// Pull-based counterpart of ReadAudioFile: Open parses the header only and ReadFrames decodes the requested block, so
+// memory does not grow with file length. FLAC/MP3/AIFF inputs are decoded once through ffmpeg into a temporary WAV
+// that is removed with the reader. ReadFrames may be called from several threads.
+class AudioStreamReader {
+ public:
+  AudioStreamReader();
+  ~AudioStreamReader();
+  AudioStreamReader(const AudioStreamReader&) = delete;
+  AudioStreamReader& operator=(const AudioStreamReader&) = delete;
+
+  bool Open(const std::filesystem::path& path, std::string* error);
+  // Decodes interleaved frames [first_frame, first_frame + frame_count) into `out`.
+  bool ReadFrames(size_t first_frame, size_t frame_count, float* out, std::string* error);
+
+  const std::string& name() const;
+  int sample_rate() const;
+  int channels() const;
+  size_t frame_count() const;
+
+ private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
 }  // namespace aurora::io
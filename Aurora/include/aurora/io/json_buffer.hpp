@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace aurora::io {
+
+// Append-only JSON text builder used by the metadata writers. Text accumulates in one string that is written to disk
+// in a single call; doubles are formatted like an ostream with precision 9 so output matches the previous writers.
+class JsonBuffer {
+ public:
+  JsonBuffer& Raw(std::string_view text);
+  JsonBuffer& Indent(int spaces);
+  // Appends `text` quoted and escaped.
+  JsonBuffer& String(std::string_view text);
+  JsonBuffer& Number(double value);
+  JsonBuffer& Int(int64_t value);
+  JsonBuffer& UInt(uint64_t value);
+  JsonBuffer& Bool(bool value);
+
+  const std::string& str() const { return text_; }
+
+ private:
+  std::string text_;
+};
+
+}  // namespace aurora::io
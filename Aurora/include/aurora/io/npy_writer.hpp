@@ -0,0 +1,14 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace aurora::io {
+
+// Writes equally sized float32 columns as a NumPy .npy (format 1.0) array of shape (rows, columns) with
+// `fortran_order: True`, so every column is one contiguous run that can be memory-mapped directly.
+bool WriteNpyFloat32Columns(const std::filesystem::path& path, const std::vector<std::vector<float>>& columns,
+                            std::string* error);
+
+}  // namespace aurora::io
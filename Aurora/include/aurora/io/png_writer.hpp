@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -12,4 +13,29 @@ bool WritePngRgb8(const std::filesystem::path& path, int width, int height, cons
 bool WritePngIndexed8(const std::filesystem::path& path, int width, int height, const std::vector<uint8_t>& indices,
                       const std::vector<uint8_t>& palette_rgb, int compression_level, std::string* error);
 
+// Incremental PNG encoder: scanlines are deflated and flushed to disk as IDAT chunks while they arrive, so callers
+// never hold the full image. Rows are RGB8 (width * 3 bytes) unless a 256-color palette is given at Open, in which
+// case rows are 8-bit palette indices (width bytes). The file is written to "<path>.tmp" and renamed on Finish.
+class PngStreamWriter {
+ public:
+  PngStreamWriter();
+  ~PngStreamWriter();
+  PngStreamWriter(const PngStreamWriter&) = delete;
+  PngStreamWriter& operator=(const PngStreamWriter&) = delete;
+
+  bool Open(const std::filesystem::path& path, int width, int height, const std::vector<uint8_t>* palette_rgb,
+            int compression_level, std::string* error);
+  bool WriteRow(const uint8_t* row, std::string* error);
+  bool Finish(std::string* error);
+
+  int width() const;
+  int height() const;
+  int rows_written() const;
+  bool indexed() const;
+
+ private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
 }  // namespace aurora::io
@@ -5,28 +5,40 @@
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <future>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <cctype>
 #include <cmath>
+#include <condition_variable>
 #include <limits>
 #include <optional>
 #include <set>
 #include <sstream>
+#include <streambuf>
 #include <string>
 #include <thread>
-#include <unordered_map>
 #include <vector>
 
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
 #include "aurora/core/analyzer.hpp"
 #include "aurora/core/renderer.hpp"
 #include "aurora/core/spectrogram.hpp"
+#include "aurora/core/task_scheduler.hpp"
 #include "aurora/core/timebase.hpp"
 #include "aurora/io/analysis_writer.hpp"
 #include "aurora/io/audio_reader.hpp"
+#include "aurora/io/json_buffer.hpp"
 #include "aurora/io/json_writer.hpp"
 #include "aurora/io/midi_writer.hpp"
+#include "aurora/io/npy_writer.hpp"
 #include "aurora/io/png_writer.hpp"
 #include "aurora/io/wav_writer.hpp"
 #include "aurora/lang/parser.hpp"
@@ -34,10 +46,30 @@
 
 namespace {
 
+// Window lengths of `--timeline` and `--masking` without an explicit window option.
+constexpr double kDefaultTimelineSeconds = 10.0;
+constexpr double kDefaultMaskingSeconds = 10.0;
+
 struct RenderCliOptions {
   uint64_t seed = 0;
+  // Batch render: one render per seed of --seeds, of the first score and of every further score named.
+  std::vector<uint64_t> seeds;
+  std::vector<std::filesystem::path> extra_files;
   int sample_rate = 0;
+  int midi_cc_tolerance = 0;
+  int threads = 0;
   std::optional<std::filesystem::path> out_root;
+  bool loudness = false;
+  bool dry_run = false;
+  bool progress_json = false;
+  std::optional<aurora::core::RenderTimeRef> range_from;
+  std::optional<aurora::core::RenderTimeRef> range_to;
+  bool draft = false;
+  bool draft_mono = false;
+  // --only: the patches and buses to render; the master is written only with --partial-master.
+  std::set<std::string> only_patches;
+  std::set<std::string> only_buses;
+  bool partial_master = false;
   bool analyze = false;
   std::optional<std::filesystem::path> analysis_out;
   int analyze_threads = 0;
@@ -53,6 +85,13 @@ struct RenderCliOptions {
   std::optional<std::string> spectrogram_config_json;
   std::string spectrogram_composite = "stacked_headers";
   std::optional<std::filesystem::path> spectrogram_composite_out;
+  bool spectrogram_tiles = false;
+  int spectrogram_tile_width_px = 256;
+  std::string spectrogram_tile_pooling = "max";
+  bool features = false;
+  std::optional<std::filesystem::path> features_out;
+  double timeline_seconds = 0.0;
+  double masking_seconds = 0.0;
 };
 
 struct AnalyzeCliOptions {
@@ -60,6 +99,7 @@ struct AnalyzeCliOptions {
   bool stems_mode = false;
   std::optional<std::filesystem::path> mix_file;
   std::optional<std::filesystem::path> out_path;
+  int threads = 0;
   int analyze_threads = 0;
   std::string intent;
   bool spectrogram = true;
@@ -73,31 +113,133 @@ struct AnalyzeCliOptions {
   std::optional<std::string> spectrogram_config_json;
   std::string spectrogram_composite = "stacked_headers";
   std::optional<std::filesystem::path> spectrogram_composite_out;
+  bool spectrogram_tiles = false;
+  int spectrogram_tile_width_px = 256;
+  std::string spectrogram_tile_pooling = "max";
+  bool features = false;
+  std::optional<std::filesystem::path> features_out;
+  double timeline_seconds = 0.0;
+  double masking_seconds = 0.0;
+  bool streaming = false;
+};
+
+// Where a render or analyze command writes: the summary on `out`; log steps, diagnostics and progress on `err`. The
+// CLI passes std::cout / std::cerr; `aurora serve` passes streams that send to the job's client.
+struct CommandStreams {
+  std::ostream& out;
+  std::ostream& err;
 };
 
+// `--from` / `--to` value: a number with an optional unit (s, ms, min, h or beats; a bare number is seconds), else a
+// section name. `section:<name>` forces a section, for names that read as times.
+aurora::core::RenderTimeRef ParseRenderTimeRef(const std::string& value) {
+  aurora::core::RenderTimeRef ref;
+  constexpr const char* kSectionPrefix = "section:";
+  if (value.rfind(kSectionPrefix, 0) == 0) {
+    ref.section = value.substr(std::char_traits<char>::length(kSectionPrefix));
+    return ref;
+  }
+  size_t consumed = 0;
+  double number = 0.0;
+  try {
+    number = std::stod(value, &consumed);
+  } catch (const std::exception&) {
+    consumed = 0;
+  }
+  const std::string unit = value.substr(consumed);
+  if (consumed > 0 && std::isfinite(number) &&
+      (unit.empty() || unit == "s" || unit == "ms" || unit == "min" || unit == "h" || unit == "beats")) {
+    ref.time.value = number;
+    ref.time.unit = unit.empty() ? "s" : unit;
+  } else {
+    ref.section = value;
+  }
+  return ref;
+}
+
 void PrintUsage() {
   std::cerr << "Usage:\n";
-  std::cerr << "  aurora render <file.au> [--seed N] [--sr 44100|48000|96000] [--out <dir>] [--analyze]";
+  std::cerr << "  aurora render <file.au> [<more.au> ...] [--seed N] [--seeds <list>] [--sr 44100|48000|96000]";
+  std::cerr << " [--out <dir>] [--midi-cc-tolerance N]";
+  std::cerr << " [--threads N] [--dry-run] [--progress-json] [--from <time|section>] [--to <time|section>]";
+  std::cerr << " [--draft] [--draft-mono] [--only patch:<name>,bus:<name>] [--partial-master] [--loudness] [--analyze]";
   std::cerr << " [--analysis-out <path>] [--analyze-threads N] [--intent sleep|ritual|dub]";
+  std::cerr << " [--features] [--features-out <dir>] [--timeline] [--timeline-window <seconds>]";
+  std::cerr << " [--masking] [--masking-window <seconds>]";
   std::cerr << " [--nospectrogram] [--spectrogram-separate] [--spectrogram-profile preview|analysis|publication]";
   std::cerr << " [--spectrogram-width <int>] [--spectrogram-row-height <int>] [--spectrogram-header-height <int>]";
   std::cerr << " [--spectrogram-indexed <true|false>]";
   std::cerr << " [--spectrogram-out <dir>] [--spectrogram-config <json>]";
-  std::cerr << " [--spectrogram-composite none|stacked_headers] [--spectrogram-composite-out <dir>]\n";
-  std::cerr << "  aurora analyze <input.wav|input.flac|input.mp3|input.aiff> [--out <analysis.json>] [--analyze-threads N]";
-  std::cerr << " [--intent sleep|ritual|dub] [--nospectrogram] [--spectrogram-separate]";
+  std::cerr << " [--spectrogram-composite none|stacked_headers] [--spectrogram-composite-out <dir>]";
+  std::cerr << " [--spectrogram-tiles] [--spectrogram-tile-width <int>] [--spectrogram-tile-pooling max|mean]\n";
+  std::cerr << "  aurora analyze <input.wav|input.flac|input.mp3|input.aiff> [--out <analysis.json>] [--threads N]";
+  std::cerr << " [--analyze-threads N] [--streaming]";
+  std::cerr << " [--intent sleep|ritual|dub] [--features] [--features-out <dir>] [--timeline] [--timeline-window <seconds>]";
+  std::cerr << " [--nospectrogram] [--spectrogram-separate]";
   std::cerr << " [--spectrogram-profile preview|analysis|publication]";
   std::cerr << " [--spectrogram-width <int>] [--spectrogram-row-height <int>] [--spectrogram-header-height <int>]";
   std::cerr << " [--spectrogram-indexed <true|false>]";
   std::cerr << " [--spectrogram-out <dir>] [--spectrogram-config <json>]";
-  std::cerr << " [--spectrogram-composite none|stacked_headers] [--spectrogram-composite-out <dir>]\n";
+  std::cerr << " [--spectrogram-composite none|stacked_headers] [--spectrogram-composite-out <dir>]";
+  std::cerr << " [--spectrogram-tiles] [--spectrogram-tile-width <int>] [--spectrogram-tile-pooling max|mean]\n";
+  std::cerr << "  aurora watch <file.au> [--seed N] [--sr 44100|48000|96000] [--out <dir>] [--midi-cc-tolerance N]";
+  std::cerr << " [--threads N] [--from <time|section>] [--to <time|section>] [--draft] [--draft-mono] [--loudness]\n";
+  std::cerr << "  aurora serve --socket <path> [--threads N] [--jobs N] [--memory-mb N]\n";
   std::cerr << "  aurora analyze --stems <stem1.wav> <stem2.wav> ... [--mix <mix.wav>] [--out <analysis.json>]";
-  std::cerr << " [--analyze-threads N] [--intent sleep|ritual|dub]";
+  std::cerr << " [--threads N] [--analyze-threads N] [--streaming] [--intent sleep|ritual|dub] [--features]";
+  std::cerr << " [--features-out <dir>]";
+  std::cerr << " [--timeline] [--timeline-window <seconds>] [--masking] [--masking-window <seconds>]";
   std::cerr << " [--nospectrogram] [--spectrogram-separate] [--spectrogram-profile preview|analysis|publication]";
   std::cerr << " [--spectrogram-width <int>] [--spectrogram-row-height <int>] [--spectrogram-header-height <int>]";
   std::cerr << " [--spectrogram-indexed <true|false>]";
   std::cerr << " [--spectrogram-out <dir>] [--spectrogram-config <json>]";
-  std::cerr << " [--spectrogram-composite none|stacked_headers] [--spectrogram-composite-out <dir>]\n";
+  std::cerr << " [--spectrogram-composite none|stacked_headers] [--spectrogram-composite-out <dir>]";
+  std::cerr << " [--spectrogram-tiles] [--spectrogram-tile-width <int>] [--spectrogram-tile-pooling max|mean]\n";
+}
+
+// Parses a --seeds list: comma-separated seeds and inclusive ranges, e.g. "1..50" or "3,7,10..12".
+bool ParseSeedList(const std::string& text, std::vector<uint64_t>* seeds, std::string* error) {
+  constexpr uint64_t kMaxSeeds = 100000;
+  std::stringstream items(text);
+  std::string item;
+  // std::stoull would take a sign or leading spaces (and wrap "-1"), so each seed must be all digits.
+  const auto parse_seed = [](const std::string& digits, uint64_t* seed) {
+    if (digits.empty() || digits.find_first_not_of("0123456789") != std::string::npos) {
+      return false;
+    }
+    try {
+      *seed = static_cast<uint64_t>(std::stoull(digits));
+    } catch (const std::exception&) {
+      return false;
+    }
+    return true;
+  };
+  while (std::getline(items, item, ',')) {
+    const size_t dots = item.find("..");
+    uint64_t first = 0;
+    uint64_t last = 0;
+    if (!parse_seed(item.substr(0, dots), &first) ||
+        !parse_seed(dots == std::string::npos ? item : item.substr(dots + 2U), &last)) {
+      *error = "Invalid --seeds value: " + text;
+      return false;
+    }
+    if (last < first || last - first >= kMaxSeeds - seeds->size()) {
+      *error = "Invalid --seeds range: " + item + " (ranges run upwards, at most " + std::to_string(kMaxSeeds) +
+               " seeds)";
+      return false;
+    }
+    for (uint64_t seed = first;; ++seed) {
+      seeds->push_back(seed);
+      if (seed == last) {
+        break;
+      }
+    }
+  }
+  if (seeds->empty()) {
+    *error = "Invalid --seeds value: " + text;
+    return false;
+  }
+  return true;
 }
 
 bool ParseRenderArgs(int argc, char** argv, std::filesystem::path* file, RenderCliOptions* options, std::string* error) {
@@ -122,6 +264,16 @@ bool ParseRenderArgs(int argc, char** argv, std::filesystem::path* file, RenderC
       }
       continue;
     }
+    if (arg == "--seeds") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --seeds";
+        return false;
+      }
+      if (!ParseSeedList(argv[++i], &options->seeds, error)) {
+        return false;
+      }
+      continue;
+    }
     if (arg == "--sr") {
       if (i + 1 >= argc) {
         *error = "Expected value after --sr";
@@ -148,6 +300,72 @@ bool ParseRenderArgs(int argc, char** argv, std::filesystem::path* file, RenderC
       options->out_root = std::filesystem::path(argv[++i]);
       continue;
     }
+    if (arg == "--midi-cc-tolerance") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --midi-cc-tolerance";
+        return false;
+      }
+      const std::string value = argv[++i];
+      try {
+        options->midi_cc_tolerance = std::stoi(value);
+      } catch (const std::exception&) {
+        *error = "Invalid --midi-cc-tolerance value: " + value;
+        return false;
+      }
+      if (options->midi_cc_tolerance < 0 || options->midi_cc_tolerance > 127) {
+        *error = "--midi-cc-tolerance must be in [0, 127].";
+        return false;
+      }
+      continue;
+    }
+    if (arg == "--loudness") {
+      options->loudness = true;
+      continue;
+    }
+    if (arg == "--dry-run") {
+      options->dry_run = true;
+      continue;
+    }
+    if (arg == "--progress-json") {
+      options->progress_json = true;
+      continue;
+    }
+    if (arg == "--from" || arg == "--to") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after " + arg;
+        return false;
+      }
+      (arg == "--from" ? options->range_from : options->range_to) = ParseRenderTimeRef(argv[++i]);
+      continue;
+    }
+    if (arg == "--draft" || arg == "--draft-mono") {
+      options->draft = true;
+      options->draft_mono = options->draft_mono || arg == "--draft-mono";
+      continue;
+    }
+    if (arg == "--only") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --only";
+        return false;
+      }
+      std::stringstream items(argv[++i]);
+      std::string item;
+      while (std::getline(items, item, ',')) {
+        if (item.rfind("patch:", 0) == 0 && item.size() > 6U) {
+          options->only_patches.insert(item.substr(6U));
+        } else if (item.rfind("bus:", 0) == 0 && item.size() > 4U) {
+          options->only_buses.insert(item.substr(4U));
+        } else {
+          *error = "Invalid --only item: '" + item + "' (expected patch:<name> or bus:<name>)";
+          return false;
+        }
+      }
+      continue;
+    }
+    if (arg == "--partial-master") {
+      options->partial_master = true;
+      continue;
+    }
     if (arg == "--analyze") {
       options->analyze = true;
       continue;
@@ -170,6 +388,24 @@ bool ParseRenderArgs(int argc, char** argv, std::filesystem::path* file, RenderC
       options->analyze = true;
       continue;
     }
+    if (arg == "--threads") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --threads";
+        return false;
+      }
+      const std::string value = argv[++i];
+      try {
+        options->threads = std::stoi(value);
+      } catch (const std::exception&) {
+        *error = "Invalid --threads value: " + value;
+        return false;
+      }
+      if (options->threads < 1) {
+        *error = "--threads must be >= 1.";
+        return false;
+      }
+      continue;
+    }
     if (arg == "--analyze-threads") {
       if (i + 1 >= argc) {
         *error = "Expected value after --analyze-threads";
@@ -189,6 +425,69 @@ bool ParseRenderArgs(int argc, char** argv, std::filesystem::path* file, RenderC
       options->analyze = true;
       continue;
     }
+    if (arg == "--features") {
+      options->features = true;
+      options->analyze = true;
+      continue;
+    }
+    if (arg == "--features-out") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --features-out";
+        return false;
+      }
+      options->features_out = std::filesystem::path(argv[++i]);
+      options->features = true;
+      options->analyze = true;
+      continue;
+    }
+    if (arg == "--masking") {
+      options->masking_seconds = kDefaultMaskingSeconds;
+      options->analyze = true;
+      continue;
+    }
+    if (arg == "--masking-window") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --masking-window";
+        return false;
+      }
+      const std::string value = argv[++i];
+      try {
+        options->masking_seconds = std::stod(value);
+      } catch (const std::exception&) {
+        *error = "Invalid --masking-window value: " + value;
+        return false;
+      }
+      if (!(options->masking_seconds >= 1.0)) {
+        *error = "--masking-window must be >= 1 second.";
+        return false;
+      }
+      options->analyze = true;
+      continue;
+    }
+    if (arg == "--timeline") {
+      options->timeline_seconds = kDefaultTimelineSeconds;
+      options->analyze = true;
+      continue;
+    }
+    if (arg == "--timeline-window") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --timeline-window";
+        return false;
+      }
+      const std::string value = argv[++i];
+      try {
+        options->timeline_seconds = std::stod(value);
+      } catch (const std::exception&) {
+        *error = "Invalid --timeline-window value: " + value;
+        return false;
+      }
+      if (!(options->timeline_seconds >= 1.0)) {
+        *error = "--timeline-window must be >= 1 second.";
+        return false;
+      }
+      options->analyze = true;
+      continue;
+    }
     if (arg == "--nospectrogram") {
       options->spectrogram = false;
       options->analyze = true;
@@ -290,6 +589,46 @@ bool ParseRenderArgs(int argc, char** argv, std::filesystem::path* file, RenderC
       options->analyze = true;
       continue;
     }
+    if (arg == "--spectrogram-tiles") {
+      options->spectrogram_tiles = true;
+      options->analyze = true;
+      continue;
+    }
+    if (arg == "--spectrogram-tile-width") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --spectrogram-tile-width";
+        return false;
+      }
+      const std::string value = argv[++i];
+      try {
+        options->spectrogram_tile_width_px = std::stoi(value);
+      } catch (const std::exception&) {
+        *error = "Invalid value for --spectrogram-tile-width: " + value;
+        return false;
+      }
+      if (options->spectrogram_tile_width_px < 16) {
+        *error = "--spectrogram-tile-width must be >= 16.";
+        return false;
+      }
+      options->spectrogram_tiles = true;
+      options->analyze = true;
+      continue;
+    }
+    if (arg == "--spectrogram-tile-pooling") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --spectrogram-tile-pooling";
+        return false;
+      }
+      const std::string value = argv[++i];
+      if (value != "max" && value != "mean") {
+        *error = "Invalid --spectrogram-tile-pooling value: " + value;
+        return false;
+      }
+      options->spectrogram_tile_pooling = value;
+      options->spectrogram_tiles = true;
+      options->analyze = true;
+      continue;
+    }
     if (arg == "--spectrogram-composite-out") {
       if (i + 1 >= argc) {
         *error = "Expected value after --spectrogram-composite-out";
@@ -299,9 +638,24 @@ bool ParseRenderArgs(int argc, char** argv, std::filesystem::path* file, RenderC
       options->analyze = true;
       continue;
     }
+    if (arg.rfind('-', 0) != 0) {
+      options->extra_files.emplace_back(arg);
+      continue;
+    }
     *error = "Unknown argument: " + arg;
     return false;
   }
+  if (options->partial_master && options->only_patches.empty() && options->only_buses.empty()) {
+    *error = "--partial-master needs --only.";
+    return false;
+  }
+  if ((!options->seeds.empty() || !options->extra_files.empty()) &&
+      (options->analysis_out.has_value() || options->spectrogram_out.has_value() || options->features_out.has_value() ||
+       options->spectrogram_composite_out.has_value())) {
+    *error = "A batch render writes each variant's analysis under its own meta directory; --analysis-out, "
+             "--spectrogram-out, --features-out and --spectrogram-composite-out need a single render.";
+    return false;
+  }
   return true;
 }
 
@@ -340,6 +694,24 @@ bool ParseAnalyzeArgs(int argc, char** argv, AnalyzeCliOptions* options, std::st
       options->intent = argv[++i];
       continue;
     }
+    if (arg == "--threads") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --threads";
+        return false;
+      }
+      const std::string value = argv[++i];
+      try {
+        options->threads = std::stoi(value);
+      } catch (const std::exception&) {
+        *error = "Invalid --threads value: " + value;
+        return false;
+      }
+      if (options->threads < 1) {
+        *error = "--threads must be >= 1.";
+        return false;
+      }
+      continue;
+    }
     if (arg == "--analyze-threads") {
       if (i + 1 >= argc) {
         *error = "Expected value after --analyze-threads";
@@ -358,6 +730,67 @@ bool ParseAnalyzeArgs(int argc, char** argv, AnalyzeCliOptions* options, std::st
       }
       continue;
     }
+    if (arg == "--features") {
+      options->features = true;
+      continue;
+    }
+    if (arg == "--streaming") {
+      options->streaming = true;
+      continue;
+    }
+    if (arg == "--features-out") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --features-out";
+        return false;
+      }
+      options->features_out = std::filesystem::path(argv[++i]);
+      options->features = true;
+      continue;
+    }
+    if (arg == "--masking") {
+      options->masking_seconds = kDefaultMaskingSeconds;
+      continue;
+    }
+    if (arg == "--masking-window") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --masking-window";
+        return false;
+      }
+      const std::string value = argv[++i];
+      try {
+        options->masking_seconds = std::stod(value);
+      } catch (const std::exception&) {
+        *error = "Invalid --masking-window value: " + value;
+        return false;
+      }
+      if (!(options->masking_seconds >= 1.0)) {
+        *error = "--masking-window must be >= 1 second.";
+        return false;
+      }
+      continue;
+    }
+    if (arg == "--timeline") {
+      options->timeline_seconds = kDefaultTimelineSeconds;
+      continue;
+    }
+    if (arg == "--timeline-window") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --timeline-window";
+        return false;
+      }
+      const std::string value = argv[++i];
+      try {
+        options->timeline_seconds = std::stod(value);
+      } catch (const std::exception&) {
+        *error = "Invalid --timeline-window value: " + value;
+        return false;
+      }
+      if (!(options->timeline_seconds >= 1.0)) {
+        *error = "--timeline-window must be >= 1 second.";
+        return false;
+      }
+      continue;
+    }
     if (arg == "--nospectrogram") {
       options->spectrogram = false;
       continue;
@@ -451,6 +884,43 @@ bool ParseAnalyzeArgs(int argc, char** argv, AnalyzeCliOptions* options, std::st
       options->spectrogram_composite = value;
       continue;
     }
+    if (arg == "--spectrogram-tiles") {
+      options->spectrogram_tiles = true;
+      continue;
+    }
+    if (arg == "--spectrogram-tile-width") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --spectrogram-tile-width";
+        return false;
+      }
+      const std::string value = argv[++i];
+      try {
+        options->spectrogram_tile_width_px = std::stoi(value);
+      } catch (const std::exception&) {
+        *error = "Invalid value for --spectrogram-tile-width: " + value;
+        return false;
+      }
+      if (options->spectrogram_tile_width_px < 16) {
+        *error = "--spectrogram-tile-width must be >= 16.";
+        return false;
+      }
+      options->spectrogram_tiles = true;
+      continue;
+    }
+    if (arg == "--spectrogram-tile-pooling") {
+      if (i + 1 >= argc) {
+        *error = "Expected value after --spectrogram-tile-pooling";
+        return false;
+      }
+      const std::string value = argv[++i];
+      if (value != "max" && value != "mean") {
+        *error = "Invalid --spectrogram-tile-pooling value: " + value;
+        return false;
+      }
+      options->spectrogram_tile_pooling = value;
+      options->spectrogram_tiles = true;
+      continue;
+    }
     if (arg == "--spectrogram-composite-out") {
       if (i + 1 >= argc) {
         *error = "Expected value after --spectrogram-composite-out";
@@ -471,13 +941,14 @@ bool ParseAnalyzeArgs(int argc, char** argv, AnalyzeCliOptions* options, std::st
       *error = "analyze expects a single input file unless --stems is used.";
       return false;
     }
-    return true;
-  }
-
-  if (options->positional.empty() && !options->mix_file.has_value()) {
+  } else if (options->positional.empty() && !options->mix_file.has_value()) {
     *error = "--stems mode requires one or more audio file paths.";
     return false;
   }
+  if (options->masking_seconds > 0.0 && (!options->stems_mode || options->positional.empty())) {
+    *error = "--masking needs at least one stem; use --stems.";
+    return false;
+  }
   return true;
 }
 
@@ -540,8 +1011,48 @@ std::filesystem::path ResolveImportPath(const std::filesystem::path& importer_fi
   return joined.lexically_normal();
 }
 
+// Parse results of imports by path, reused while the file keeps its modification time and size. A resident `aurora
+// serve` or `aurora watch` process loads the same libraries for every job or edit and parses each one only once.
+struct ParsedImport {
+  std::filesystem::file_time_type time;
+  uintmax_t size = 0;
+  aurora::lang::ParseResult parse;
+};
+std::mutex g_parsed_imports_mutex;
+std::map<std::filesystem::path, ParsedImport> g_parsed_imports;
+
+// Fails only when the file cannot be read; a file that does not parse yields a ParseResult that is not ok.
+bool ParseImport(const std::filesystem::path& path, aurora::lang::ParseResult* parse, std::string* error) {
+  std::error_code time_ec;
+  std::error_code size_ec;
+  const auto time = std::filesystem::last_write_time(path, time_ec);
+  const uintmax_t size = std::filesystem::file_size(path, size_ec);
+  const bool stamped = !time_ec && !size_ec;
+  if (stamped) {
+    std::lock_guard<std::mutex> lock(g_parsed_imports_mutex);
+    const auto it = g_parsed_imports.find(path);
+    if (it != g_parsed_imports.end() && it->second.time == time && it->second.size == size) {
+      *parse = it->second.parse;
+      return true;
+    }
+  }
+  std::string source;
+  if (!ReadFile(path, &source, error)) {
+    return false;
+  }
+  *parse = aurora::lang::ParseAuroraSource(source);
+  if (stamped) {
+    std::lock_guard<std::mutex> lock(g_parsed_imports_mutex);
+    g_parsed_imports[path] = ParsedImport{time, size, *parse};
+  }
+  return true;
+}
+
+// Merges the patches of every import of `file`, recursively. `imported_files`, when given, receives the path of each
+// import reached, including one that fails to load.
 bool ResolveImportsRecursive(const std::filesystem::path& file_path, aurora::lang::AuroraFile* file,
-                            std::vector<std::string>* import_stack, std::string* error) {
+                            std::vector<std::string>* import_stack, std::string* error,
+                            std::vector<std::filesystem::path>* imported_files = nullptr) {
   if (file == nullptr || import_stack == nullptr) {
     if (error != nullptr) {
       *error = "Internal error: null import resolver state.";
@@ -590,16 +1101,17 @@ bool ResolveImportsRecursive(const std::filesystem::path& file_path, aurora::lan
       }
     }
 
-    std::string imported_source;
+    if (imported_files != nullptr) {
+      imported_files->push_back(import_path);
+    }
+    aurora::lang::ParseResult imported_parse;
     std::string read_error;
-    if (!ReadFile(import_path, &imported_source, &read_error)) {
+    if (!ParseImport(import_path, &imported_parse, &read_error)) {
       if (error != nullptr) {
         *error = "Failed to load import '" + import.source + "' from " + file_path.string() + ": " + read_error;
       }
       return false;
     }
-
-    aurora::lang::ParseResult imported_parse = aurora::lang::ParseAuroraSource(imported_source);
     if (!imported_parse.ok) {
       if (error != nullptr) {
         std::ostringstream msg;
@@ -614,7 +1126,7 @@ bool ResolveImportsRecursive(const std::filesystem::path& file_path, aurora::lan
     }
 
     import_stack->push_back(import_key);
-    if (!ResolveImportsRecursive(import_path, &imported_parse.file, import_stack, error)) {
+    if (!ResolveImportsRecursive(import_path, &imported_parse.file, import_stack, error, imported_files)) {
       import_stack->pop_back();
       return false;
     }
@@ -652,24 +1164,246 @@ bool ResolveImportsRecursive(const std::filesystem::path& file_path, aurora::lan
   return true;
 }
 
-std::filesystem::path ResolveOutputPath(const std::string& configured_path, const std::filesystem::path& au_parent,
-                                        const std::optional<std::filesystem::path>& cli_out) {
-  const std::filesystem::path path(configured_path);
-  if (path.is_absolute()) {
-    return path;
-  }
-  if (cli_out.has_value()) {
-    return cli_out.value() / path;
+// Reads, parses, resolves the imports of and validates `au_file`, reporting each stage through `log_step` and
+// writing diagnostics to `diagnostics`. Returns 0, or the render exit code of the failing stage: 3 unreadable, 4 parse
+// or import error, 5 validation error. `sources`, when given, receives the score and every import it reaches.
+int LoadScore(const std::filesystem::path& au_file, const std::function<void(const std::string&)>& log_step,
+              std::ostream& diagnostics, aurora::lang::AuroraFile* file, std::vector<std::filesystem::path>* sources) {
+  if (sources != nullptr) {
+    sources->assign(1U, au_file);
+  }
+  log_step("Reading source: " + au_file.string());
+  std::string source;
+  std::string read_error;
+  if (!ReadFile(au_file, &source, &read_error)) {
+    diagnostics << read_error << "\n";
+    return 3;
+  }
+
+  log_step("Parsing");
+  aurora::lang::ParseResult parse = aurora::lang::ParseAuroraSource(source);
+  if (!parse.ok) {
+    for (const auto& d : parse.diagnostics) {
+      diagnostics << au_file.string() << ":" << d.line << ":" << d.column << ": parse error: " << d.message << "\n";
+    }
+    return 4;
+  }
+
+  log_step("Resolving imports");
+  {
+    std::error_code ec;
+    const std::filesystem::path canonical_au_file = std::filesystem::weakly_canonical(au_file, ec);
+    const std::string root_key = (ec ? au_file.lexically_normal() : canonical_au_file).string();
+    std::vector<std::string> import_stack;
+    import_stack.push_back(root_key);
+    std::string import_error;
+    if (!ResolveImportsRecursive(au_file, &parse.file, &import_stack, &import_error, sources)) {
+      diagnostics << "import error: " << import_error << "\n";
+      return 4;
+    }
+  }
+
+  log_step("Validating");
+  const aurora::lang::ValidationResult validation = aurora::lang::Validate(parse.file);
+  for (const auto& warning : validation.warnings) {
+    diagnostics << "warning: " << warning << "\n";
+  }
+  if (!validation.ok) {
+    for (const auto& error : validation.errors) {
+      diagnostics << "validation error: " << error << "\n";
+    }
+    return 5;
+  }
+  *file = std::move(parse.file);
+  return 0;
+}
+
+std::filesystem::path ResolveOutputPath(const std::string& configured_path, const std::filesystem::path& au_parent,
+                                        const std::optional<std::filesystem::path>& cli_out) {
+  const std::filesystem::path path(configured_path);
+  if (path.is_absolute()) {
+    return path;
+  }
+  if (cli_out.has_value()) {
+    return cli_out.value() / path;
   }
   return au_parent / path;
 }
 
+struct RenderOutputDirs {
+  std::filesystem::path stems;
+  std::filesystem::path midi;
+  std::filesystem::path mix;
+  std::filesystem::path meta;
+};
+
+// Output directories of a render: `--out <dir>` subdirectories, else the score's `outputs` paths relative to it.
+RenderOutputDirs ResolveRenderOutputDirs(const aurora::lang::OutputsDefinition& outputs,
+                                         const std::filesystem::path& au_file,
+                                         const std::optional<std::filesystem::path>& out_root) {
+  const std::filesystem::path au_parent =
+      au_file.has_parent_path() ? std::filesystem::absolute(au_file).parent_path() : std::filesystem::current_path();
+  const auto resolve = [&](const char* subdir, const std::string& configured) {
+    return out_root.has_value() ? out_root.value() / subdir : ResolveOutputPath(configured, au_parent, std::nullopt);
+  };
+  return RenderOutputDirs{resolve("stems", outputs.stems_dir), resolve("midi", outputs.midi_dir),
+                          resolve("mix", outputs.mix_dir), resolve("meta", outputs.meta_dir)};
+}
+
+aurora::core::RenderOptions BuildRenderOptions(const RenderCliOptions& options) {
+  aurora::core::RenderOptions render_options;
+  render_options.seed = options.seed;
+  render_options.sample_rate_override = options.sample_rate;
+  render_options.midi_cc_tolerance = options.midi_cc_tolerance;
+  render_options.meter_master_loudness = options.loudness;
+  render_options.range_from = options.range_from;
+  render_options.range_to = options.range_to;
+  render_options.draft.enabled = options.draft;
+  render_options.draft.mono = options.draft_mono;
+  render_options.only_patches = options.only_patches;
+  render_options.only_buses = options.only_buses;
+  return render_options;
+}
+
 std::string FormatElapsed(const std::chrono::steady_clock::time_point& start) {
   const auto now = std::chrono::steady_clock::now();
   const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
   return std::to_string(ms) + "ms";
 }
 
+std::string FormatSeconds(double seconds) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(3) << seconds << " s";
+  return out.str();
+}
+
+std::string FormatThreadCount(size_t threads) {
+  return std::to_string(threads) + (threads == 1U ? " thread" : " threads");
+}
+
+std::string DescribePredictedRender(const aurora::core::RenderPlan& plan) {
+  std::string line = "Predicted render: " + FormatSeconds(plan.predicted_seconds) + " on " +
+                     FormatThreadCount(plan.threads) + " (" + FormatSeconds(plan.work_seconds) + " of work";
+  if (!plan.patches.empty()) {
+    line += "; longest patch '" + plan.patches.front().name + "' " + FormatSeconds(plan.patches.front().seconds);
+  }
+  return line + ")";
+}
+
+// `--dry-run` report: one line per patch and bus in dispatch order, then the prediction.
+void PrintRenderPlan(const aurora::core::RenderPlan& plan, std::ostream& out) {
+  out << "Render plan: " << FormatSeconds(plan.metadata.duration_seconds) << " of audio at " << plan.metadata.sample_rate
+      << " Hz, " << FormatThreadCount(plan.threads) << "\n";
+  const auto print = [&out](const char* kind, const char* unit, const aurora::core::RenderCostEstimate& estimate) {
+    out << "  " << kind << " " << estimate.name << ": " << estimate.samples << " " << unit << " x " << std::fixed
+        << std::setprecision(2) << estimate.units_per_sample << " units = " << FormatSeconds(estimate.seconds) << "\n";
+  };
+  for (const auto& estimate : plan.patches) {
+    print("patch", "voice-samples", estimate);
+  }
+  for (const auto& estimate : plan.buses) {
+    print("bus", "frames", estimate);
+  }
+  out << DescribePredictedRender(plan) << "\n";
+}
+
+// `--progress-json`: one JSON object per line on stderr for job orchestrators. Lines follow every renderer progress
+// callback; once the render returns, a heartbeat line every half second carries the write and analysis counters until
+// Finish() prints the "done" line. Each line repeats the last render snapshot, so a reader only needs the newest one.
+class ProgressJsonEmitter {
+ public:
+  ProgressJsonEmitter(std::chrono::steady_clock::time_point start, std::ostream& out) : start_(start), out_(out) {}
+  ~ProgressJsonEmitter() { StopHeartbeat(); }
+  ProgressJsonEmitter(const ProgressJsonEmitter&) = delete;
+  ProgressJsonEmitter& operator=(const ProgressJsonEmitter&) = delete;
+
+  std::atomic<uint64_t> bytes_written{0U};
+  std::atomic<uint64_t> analysis_frames{0U};
+
+  void OnRender(const aurora::core::RenderProgress& progress) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_ = progress;
+    EmitLocked("render");
+  }
+
+  void StartHeartbeat() {
+    heartbeat_ = std::thread([this]() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (!stop_) {
+        EmitLocked("finalize");
+        stop_cv_.wait_for(lock, std::chrono::milliseconds(500), [this]() { return stop_; });
+      }
+    });
+  }
+
+  void Finish() {
+    StopHeartbeat();
+    std::lock_guard<std::mutex> lock(mutex_);
+    EmitLocked("done");
+  }
+
+ private:
+  void StopHeartbeat() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    stop_cv_.notify_all();
+    if (heartbeat_.joinable()) {
+      heartbeat_.join();
+    }
+  }
+
+  void EmitLocked(const char* phase) {
+    const double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    aurora::io::JsonBuffer out;
+    out.Raw("{\"event\":\"progress\",\"phase\":").String(phase);
+    out.Raw(",\"elapsed_s\":").Number(elapsed);
+    out.Raw(",\"render_percent\":").Number(last_.percent);
+    out.Raw(",\"render_elapsed_s\":").Number(last_.elapsed_seconds);
+    out.Raw(",\"realtime_factor\":").Number(last_.realtime_factor);
+    out.Raw(",\"render_remaining_s\":").Number(last_.remaining_seconds);
+    out.Raw(",\"voices_in_flight\":").UInt(last_.voices_in_flight);
+    out.Raw(",\"samples_rendered\":").UInt(last_.samples_rendered);
+    out.Raw(",\"samples_predicted\":").UInt(last_.samples_predicted);
+    out.Raw(",\"buses_done\":").UInt(last_.buses_done);
+    out.Raw(",\"buses_total\":").UInt(last_.buses_total);
+    out.Raw(",\"bytes_written\":").UInt(bytes_written.load());
+    out.Raw(",\"analysis_frames\":").UInt(analysis_frames.load());
+    out.Raw(",\"patches\":[");
+    for (size_t i = 0; i < last_.patches.size(); ++i) {
+      const aurora::core::RenderPatchProgress& patch = last_.patches[i];
+      out.Raw(i == 0 ? "{\"name\":" : ",{\"name\":").String(patch.name);
+      out.Raw(",\"samples_rendered\":").UInt(patch.samples_rendered);
+      out.Raw(",\"samples_predicted\":").UInt(patch.samples_predicted);
+      out.Raw(",\"done\":").Bool(patch.done).Raw("}");
+    }
+    out.Raw("]}\n");
+    out_ << out.str() << std::flush;
+  }
+
+  const std::chrono::steady_clock::time_point start_;
+  std::ostream& out_;
+  std::mutex mutex_;
+  std::condition_variable stop_cv_;
+  bool stop_ = false;
+  std::thread heartbeat_;
+  aurora::core::RenderProgress last_;
+};
+
+// Adds the size of a file just written to `bytes` (when set); a file that cannot be stat'ed counts as empty.
+void CountWrittenBytes(const std::filesystem::path& path, std::atomic<uint64_t>* bytes) {
+  if (bytes == nullptr) {
+    return;
+  }
+  std::error_code ec;
+  const uintmax_t size = std::filesystem::file_size(path, ec);
+  if (!ec) {
+    bytes->fetch_add(static_cast<uint64_t>(size));
+  }
+}
+
 struct SpectrogramConfigOverrides {
   std::optional<int> window;
   std::optional<int> hop;
@@ -685,11 +1419,13 @@ struct SpectrogramConfigOverrides {
   std::optional<int> height_px;
   std::optional<double> gamma;
   std::optional<int> smoothing_bins;
+  std::optional<int> smoothing_columns;
 };
 
 struct CompositeRowSource {
   bool available = false;
-  std::vector<uint8_t> rgb;
+  bool indexed = false;
+  std::vector<uint8_t> pixels;
   int width = 0;
   int height = 0;
   std::string kind;
@@ -1010,6 +1746,10 @@ bool ParseSpectrogramConfigJson(const std::string& json, SpectrogramConfigOverri
       if (!parse_int(&overrides->smoothing_bins)) {
         return false;
       }
+    } else if (key == "smoothing_columns") {
+      if (!parse_int(&overrides->smoothing_columns)) {
+        return false;
+      }
     } else {
       if (error != nullptr) {
         *error = "Unknown key in --spectrogram-config: " + key;
@@ -1111,6 +1851,7 @@ bool BuildSpectrogramProfileConfig(int sample_rate, const std::optional<std::str
   apply(overrides.height_px, &resolved.config.height_px);
   apply(overrides.gamma, &resolved.config.gamma);
   apply(overrides.smoothing_bins, &resolved.config.smoothing_bins);
+  apply(overrides.smoothing_columns, &resolved.config.smoothing_columns);
   apply(width_override, &resolved.config.width_px);
   apply(row_height_override, &resolved.config.height_px);
   apply(header_height_override, &resolved.header_height_px);
@@ -1180,6 +1921,12 @@ bool BuildSpectrogramProfileConfig(int sample_rate, const std::optional<std::str
     }
     return false;
   }
+  if (resolved.config.smoothing_columns < 0) {
+    if (error != nullptr) {
+      *error = "spectrogram smoothing_columns must be >= 0.";
+    }
+    return false;
+  }
   if (resolved.header_height_px < 8) {
     if (error != nullptr) {
       *error = "spectrogram header height must be >= 8.";
@@ -1242,6 +1989,85 @@ std::string RelativeToAnalysisRoot(const std::filesystem::path& absolute_path, c
   return rel.generic_string();
 }
 
+void ExportTargetFeatures(aurora::core::FileAnalysis* analysis, const std::string& target_name,
+                          const std::filesystem::path& features_dir, const std::filesystem::path& analysis_root) {
+  aurora::core::FeatureExportArtifact& artifact = analysis->features;
+  aurora::core::FeatureSeries& series = analysis->series;
+  artifact.present = true;
+  const std::string safe_name = SanitizeTargetName(target_name);
+  const std::filesystem::path features_path = features_dir / (safe_name + ".features.npy");
+  const std::filesystem::path loudness_path = features_dir / (safe_name + ".loudness.npy");
+  std::string error;
+  if (!aurora::io::WriteNpyFloat32Columns(features_path, series.columns, &error) ||
+      !aurora::io::WriteNpyFloat32Columns(loudness_path, {series.short_term_lufs}, &error)) {
+    artifact.error = error;
+    return;
+  }
+  artifact.path = RelativeToAnalysisRoot(features_path, analysis_root);
+  artifact.loudness_path = RelativeToAnalysisRoot(loudness_path, analysis_root);
+  artifact.frames = series.columns.empty() ? 0 : static_cast<int>(series.columns.front().size());
+  artifact.hop = series.hop;
+  artifact.fft_size = series.fft_size;
+  artifact.columns = series.column_names;
+  artifact.loudness_frames = static_cast<int>(series.short_term_lufs.size());
+  artifact.loudness_window = series.loudness_window;
+  artifact.loudness_hop = series.loudness_hop;
+  // The series now lives on disk; analysis.json only carries the reference.
+  series = aurora::core::FeatureSeries{};
+}
+
+void ExportFeatureSeries(aurora::core::AnalysisReport* report, const std::filesystem::path& features_dir,
+                         const std::filesystem::path& analysis_root) {
+  ExportTargetFeatures(&report->mix, "mix", features_dir, analysis_root);
+  for (auto& stem_analysis : report->stems) {
+    ExportTargetFeatures(&stem_analysis, stem_analysis.name, features_dir, analysis_root);
+  }
+}
+
+// Writes the per-window masking grids as (windows, pairs * 8) arrays: column pair * 8 + band follows one pair and
+// band over time, in the order of `masking.pairs` and the spectral-ratio bands.
+void ExportMaskingWindows(aurora::core::AnalysisReport* report, const std::filesystem::path& masking_dir,
+                          const std::filesystem::path& analysis_root) {
+  aurora::core::MaskingReport& masking = report->masking;
+  if (!masking.present) {
+    return;
+  }
+  const auto band_columns = [&masking](bool overlap) {
+    std::vector<std::vector<float>> columns;
+    columns.reserve(masking.pairs.size() * 8U);
+    for (const auto& pair : masking.pairs) {
+      const auto& windows = overlap ? pair.window_overlap : pair.window_cancellation_db;
+      const double aurora::core::SpectralRatios::*const bands[] = {
+          &aurora::core::SpectralRatios::sub,      &aurora::core::SpectralRatios::low,
+          &aurora::core::SpectralRatios::low_mid,  &aurora::core::SpectralRatios::mid,
+          &aurora::core::SpectralRatios::presence, &aurora::core::SpectralRatios::high,
+          &aurora::core::SpectralRatios::air,      &aurora::core::SpectralRatios::ultra};
+      for (const auto band : bands) {
+        std::vector<float>& column = columns.emplace_back();
+        column.reserve(windows.size());
+        for (const auto& window : windows) {
+          column.push_back(static_cast<float>(window.*band));
+        }
+      }
+    }
+    return columns;
+  };
+  const std::filesystem::path overlap_path = masking_dir / "overlap.npy";
+  const std::filesystem::path cancellation_path = masking_dir / "cancellation_db.npy";
+  std::string error;
+  if (!aurora::io::WriteNpyFloat32Columns(overlap_path, band_columns(true), &error) ||
+      !aurora::io::WriteNpyFloat32Columns(cancellation_path, band_columns(false), &error)) {
+    masking.error = error;
+    return;
+  }
+  masking.overlap_path = RelativeToAnalysisRoot(overlap_path, analysis_root);
+  masking.cancellation_path = RelativeToAnalysisRoot(cancellation_path, analysis_root);
+  for (auto& pair : masking.pairs) {
+    pair.window_overlap.clear();
+    pair.window_cancellation_db.clear();
+  }
+}
+
 aurora::core::SpectrogramArtifact BuildBaseArtifact(const aurora::core::SpectrogramConfig& config, int sample_rate) {
   aurora::core::SpectrogramArtifact out;
   out.present = true;
@@ -1261,6 +2087,7 @@ aurora::core::SpectrogramArtifact BuildBaseArtifact(const aurora::core::Spectrog
   out.height_px = config.height_px;
   out.gamma = config.gamma;
   out.smoothing_bins = config.smoothing_bins;
+  out.smoothing_columns = config.smoothing_columns;
   return out;
 }
 
@@ -1377,104 +2204,160 @@ std::string EllipsizeLabel(const std::string& label, int max_chars) {
   return label.substr(0, static_cast<size_t>(max_chars - 3)) + "...";
 }
 
-bool WriteCompositeSpectrogramPng(const std::filesystem::path& out_path, const std::vector<CompositeRowSource>& rows, int width_px,
-                                  int row_spectrogram_height, int header_height_px, bool indexed_palette,
-                                  const std::string& colormap, int png_compression_level, std::string* error) {
-  if (width_px < 2 || row_spectrogram_height < 2 || header_height_px < 8 || rows.empty()) {
+uint8_t NearestPaletteIndex(const std::vector<uint8_t>& palette, uint8_t r, uint8_t g, uint8_t b) {
+  int best = 0;
+  int best_d = std::numeric_limits<int>::max();
+  for (int i = 0; i < 256 && best_d > 0; ++i) {
+    const int dr = static_cast<int>(r) - static_cast<int>(palette[static_cast<size_t>(i) * 3U]);
+    const int dg = static_cast<int>(g) - static_cast<int>(palette[static_cast<size_t>(i) * 3U + 1U]);
+    const int db = static_cast<int>(b) - static_cast<int>(palette[static_cast<size_t>(i) * 3U + 2U]);
+    const int d = dr * dr + dg * dg + db * db;
+    if (d < best_d) {
+      best_d = d;
+      best = i;
+    }
+  }
+  return static_cast<uint8_t>(best);
+}
+
+// Row-streamed stacked composite: each target is appended (header strip + spectrogram rows) as soon as it is ready,
+// so only one scanline of the composite is ever materialized. Indexed composites consume LUT indices directly.
+struct CompositeSpectrogramStream {
+  aurora::io::PngStreamWriter png;
+  int width_px = 0;
+  int row_spectrogram_height = 0;
+  int header_height_px = 0;
+  int row_count = 0;
+  int rows_appended = 0;
+  bool indexed_palette = false;
+  std::vector<uint8_t> palette;
+  uint8_t header_bg_index = 0;
+  uint8_t header_text_index = 255;
+  std::vector<uint8_t> scanline;
+};
+
+bool BeginCompositeSpectrogram(CompositeSpectrogramStream* stream, const std::filesystem::path& out_path, int row_count,
+                               int width_px, int row_spectrogram_height, int header_height_px, bool indexed_palette,
+                               const std::string& colormap, int png_compression_level, std::string* error) {
+  if (stream == nullptr || width_px < 2 || row_spectrogram_height < 2 || header_height_px < 8 || row_count <= 0) {
     if (error != nullptr) {
       *error = "Invalid composite spectrogram dimensions.";
     }
     return false;
   }
-  const int row_height = header_height_px + row_spectrogram_height;
-  const int total_height = static_cast<int>(rows.size()) * row_height;
-  std::vector<uint8_t> composite(static_cast<size_t>(width_px * total_height * 3), 0U);
-  std::vector<uint8_t> palette;
-  std::unordered_map<uint32_t, uint8_t> color_to_index;
-  if (indexed_palette) {
-    std::string lut_error;
-    if (!aurora::core::BuildColormapLutRgb(colormap, &palette, &lut_error)) {
-      if (error != nullptr) {
-        *error = lut_error;
-      }
-      return false;
-    }
-    for (int i = 0; i < 256; ++i) {
-      const uint32_t key = (static_cast<uint32_t>(palette[static_cast<size_t>(i) * 3U]) << 16U) |
-                           (static_cast<uint32_t>(palette[static_cast<size_t>(i) * 3U + 1U]) << 8U) |
-                           static_cast<uint32_t>(palette[static_cast<size_t>(i) * 3U + 2U]);
-      color_to_index[key] = static_cast<uint8_t>(i);
+  stream->width_px = width_px;
+  stream->row_spectrogram_height = row_spectrogram_height;
+  stream->header_height_px = header_height_px;
+  stream->row_count = row_count;
+  stream->rows_appended = 0;
+  stream->indexed_palette = indexed_palette;
+  std::string lut_error;
+  if (!aurora::core::BuildColormapLutRgb(colormap, &stream->palette, &lut_error)) {
+    if (error != nullptr) {
+      *error = lut_error;
     }
+    return false;
   }
+  stream->header_bg_index = NearestPaletteIndex(stream->palette, 0, 0, 0);
+  stream->header_text_index = 255;
+  stream->scanline.assign(static_cast<size_t>(width_px) * (indexed_palette ? 1U : 3U), 0U);
+  const int total_height = row_count * (header_height_px + row_spectrogram_height);
+  return stream->png.Open(out_path, width_px, total_height, indexed_palette ? &stream->palette : nullptr,
+                          png_compression_level, error);
+}
 
-  for (size_t i = 0; i < rows.size(); ++i) {
-    const int y0 = static_cast<int>(i) * row_height;
-    uint8_t text_r = 255;
-    uint8_t text_g = 255;
-    uint8_t text_b = 255;
-    if (indexed_palette && palette.size() == 256U * 3U) {
-      text_r = palette[255U * 3U];
-      text_g = palette[255U * 3U + 1U];
-      text_b = palette[255U * 3U + 2U];
-    }
-    FillRectRgb(&composite, width_px, total_height, 0, y0, width_px, y0 + header_height_px, 0, 0, 0);
-    const std::string text = EllipsizeLabel(rows[i].name, std::max(0, (width_px - 20) / 6));
-    const int text_y = y0 + std::max(0, (header_height_px - 7) / 2);
-    DrawText5x7(&composite, width_px, total_height, 10, text_y, text, text_r, text_g, text_b);
-
-    const int sy0 = y0 + header_height_px;
-    if (!rows[i].available || rows[i].rgb.empty() || rows[i].width <= 0 || rows[i].height <= 0) {
-      std::cerr << "warning: composite row missing image for target '" << rows[i].name << "'\n";
-      continue;
-    }
+void CopyCompositePixel(CompositeSpectrogramStream* stream, const CompositeRowSource& row, size_t src, size_t dst) {
+  if (stream->indexed_palette) {
+    stream->scanline[dst] =
+        row.indexed ? row.pixels[src]
+                    : NearestPaletteIndex(stream->palette, row.pixels[src * 3U], row.pixels[src * 3U + 1U],
+                                          row.pixels[src * 3U + 2U]);
+    return;
+  }
+  const uint8_t* c = row.indexed ? &stream->palette[static_cast<size_t>(row.pixels[src]) * 3U] : &row.pixels[src * 3U];
+  stream->scanline[dst * 3U] = c[0];
+  stream->scanline[dst * 3U + 1U] = c[1];
+  stream->scanline[dst * 3U + 2U] = c[2];
+}
 
-    if (rows[i].width != width_px || rows[i].height != row_spectrogram_height) {
-      std::cerr << "warning: composite row dimension mismatch for target '" << rows[i].name << "', resizing.\n";
+bool AppendCompositeRow(CompositeSpectrogramStream* stream, const CompositeRowSource& row, std::ostream& diagnostics,
+                        std::string* error) {
+  if (stream == nullptr || stream->rows_appended >= stream->row_count) {
+    if (error != nullptr) {
+      *error = "Composite spectrogram received more rows than declared.";
     }
-    for (int y = 0; y < row_spectrogram_height; ++y) {
-      const int src_y = std::clamp((y * rows[i].height) / row_spectrogram_height, 0, rows[i].height - 1);
+    return false;
+  }
+  const int width_px = stream->width_px;
+  const std::string text = EllipsizeLabel(row.name, std::max(0, (width_px - 20) / 6));
+  const int text_y = std::max(0, (stream->header_height_px - 7) / 2);
+  std::vector<uint8_t> header_rgb;
+  if (stream->indexed_palette) {
+    // Draw the label as 0/1 coverage in a one-row RGB scratch line, then map coverage to palette indices.
+    header_rgb.assign(static_cast<size_t>(width_px) * 3U, 0U);
+  }
+  for (int y = 0; y < stream->header_height_px; ++y) {
+    if (stream->indexed_palette) {
+      std::fill(header_rgb.begin(), header_rgb.end(), 0U);
+      DrawText5x7(&header_rgb, width_px, 1, 10, text_y - y, text, 255, 255, 255);
       for (int x = 0; x < width_px; ++x) {
-        const int src_x = std::clamp((x * rows[i].width) / width_px, 0, rows[i].width - 1);
-        const size_t src = static_cast<size_t>((src_y * rows[i].width + src_x) * 3);
-        const size_t dst = static_cast<size_t>(((sy0 + y) * width_px + x) * 3);
-        composite[dst] = rows[i].rgb[src];
-        composite[dst + 1] = rows[i].rgb[src + 1];
-        composite[dst + 2] = rows[i].rgb[src + 2];
+        stream->scanline[static_cast<size_t>(x)] =
+            header_rgb[static_cast<size_t>(x) * 3U] != 0U ? stream->header_text_index : stream->header_bg_index;
       }
+    } else {
+      FillRectRgb(&stream->scanline, width_px, 1, 0, 0, width_px, 1, 0, 0, 0);
+      DrawText5x7(&stream->scanline, width_px, 1, 10, text_y - y, text, 255, 255, 255);
+    }
+    if (!stream->png.WriteRow(stream->scanline.data(), error)) {
+      return false;
     }
   }
 
-  if (indexed_palette) {
-    std::vector<uint8_t> indices(static_cast<size_t>(width_px * total_height), 0U);
-    for (int y = 0; y < total_height; ++y) {
-      for (int x = 0; x < width_px; ++x) {
-        const size_t p = static_cast<size_t>((y * width_px + x) * 3);
-        const uint32_t key = (static_cast<uint32_t>(composite[p]) << 16U) | (static_cast<uint32_t>(composite[p + 1U]) << 8U) |
-                             static_cast<uint32_t>(composite[p + 2U]);
-        const auto it = color_to_index.find(key);
-        if (it != color_to_index.end()) {
-          indices[static_cast<size_t>(y * width_px + x)] = it->second;
-        } else {
-          int best = 0;
-          int best_d = std::numeric_limits<int>::max();
-          for (int i = 0; i < 256; ++i) {
-            const int dr = static_cast<int>(composite[p]) - static_cast<int>(palette[static_cast<size_t>(i) * 3U]);
-            const int dg = static_cast<int>(composite[p + 1U]) - static_cast<int>(palette[static_cast<size_t>(i) * 3U + 1U]);
-            const int db = static_cast<int>(composite[p + 2U]) - static_cast<int>(palette[static_cast<size_t>(i) * 3U + 2U]);
-            const int d = dr * dr + dg * dg + db * db;
-            if (d < best_d) {
-              best_d = d;
-              best = i;
-            }
-          }
-          indices[static_cast<size_t>(y * width_px + x)] = static_cast<uint8_t>(best);
+  const size_t bytes_per_pixel = row.indexed ? 1U : 3U;
+  const bool have_image = row.available && row.width > 0 && row.height > 0 &&
+                          row.pixels.size() == static_cast<size_t>(row.width) * static_cast<size_t>(row.height) * bytes_per_pixel;
+  if (!have_image) {
+    diagnostics << "warning: composite row missing image for target '" << row.name << "'\n";
+  } else if (row.width != width_px || row.height != stream->row_spectrogram_height) {
+    diagnostics << "warning: composite row dimension mismatch for target '" << row.name << "', resizing.\n";
+  }
+  for (int y = 0; y < stream->row_spectrogram_height; ++y) {
+    if (!have_image) {
+      std::fill(stream->scanline.begin(), stream->scanline.end(), stream->indexed_palette ? stream->header_bg_index : 0U);
+    } else if (row.width == width_px) {
+      const int src_y = std::clamp((y * row.height) / stream->row_spectrogram_height, 0, row.height - 1);
+      const size_t src_row = static_cast<size_t>(src_y) * static_cast<size_t>(row.width);
+      if (row.indexed == stream->indexed_palette) {
+        std::copy_n(row.pixels.begin() + static_cast<std::ptrdiff_t>(src_row * bytes_per_pixel), stream->scanline.size(),
+                    stream->scanline.begin());
+      } else {
+        for (int x = 0; x < width_px; ++x) {
+          CopyCompositePixel(stream, row, src_row + static_cast<size_t>(x), static_cast<size_t>(x));
         }
       }
+    } else {
+      const int src_y = std::clamp((y * row.height) / stream->row_spectrogram_height, 0, row.height - 1);
+      for (int x = 0; x < width_px; ++x) {
+        const int src_x = std::clamp((x * row.width) / width_px, 0, row.width - 1);
+        CopyCompositePixel(stream, row, static_cast<size_t>(src_y * row.width + src_x), static_cast<size_t>(x));
+      }
+    }
+    if (!stream->png.WriteRow(stream->scanline.data(), error)) {
+      return false;
     }
-    return aurora::io::WritePngIndexed8(out_path, width_px, total_height, indices, palette, png_compression_level, error);
   }
+  ++stream->rows_appended;
+  return true;
+}
 
-  return aurora::io::WritePngRgb8(out_path, width_px, total_height, composite, png_compression_level, error);
+bool FinishCompositeSpectrogram(CompositeSpectrogramStream* stream, std::string* error) {
+  if (stream == nullptr || stream->rows_appended != stream->row_count) {
+    if (error != nullptr) {
+      *error = "Composite spectrogram is missing rows.";
+    }
+    return false;
+  }
+  return stream->png.Finish(error);
 }
 
 void MarkSpectrogramDisabled(aurora::core::FileAnalysis* item, const aurora::core::SpectrogramConfig& config, int sample_rate) {
@@ -1482,21 +2365,153 @@ void MarkSpectrogramDisabled(aurora::core::FileAnalysis* item, const aurora::cor
   item->spectrogram.enabled = false;
 }
 
-void PopulateSpectrograms(const std::vector<aurora::core::AudioStem>& stems, const aurora::core::AudioStem& mix, int sample_rate,
+// Audio behind one spectrogram target: resident samples, or a reader pulled one STFT window at a time.
+struct SpectrogramSource {
+  std::string name;
+  int channels = 0;
+  size_t frame_count = 0;
+  const aurora::core::AudioStem* stem = nullptr;
+  aurora::io::AudioStreamReader* reader = nullptr;
+};
+
+SpectrogramSource ResidentSpectrogramSource(const aurora::core::AudioStem& stem) {
+  SpectrogramSource source;
+  source.name = stem.name;
+  source.channels = stem.channels;
+  source.frame_count = stem.channels > 0 ? stem.samples.size() / static_cast<size_t>(stem.channels) : 0U;
+  source.stem = &stem;
+  return source;
+}
+
+// Mono samples of the mixdown (`channel` < 0) or one channel of `source`. Resident audio is mixed into `mono` up
+// front; streamed audio is read and mixed per request through `interleaved`.
+aurora::core::MonoSampleReader SourceMonoReader(const SpectrogramSource& source, int channel, std::vector<float>* mono,
+                                                std::vector<float>* interleaved) {
+  if (source.stem != nullptr) {
+    *mono = channel < 0 ? Mixdown(*source.stem) : ExtractChannel(*source.stem, channel);
+    return [mono](size_t first, size_t count, float* out, std::string*) {
+      std::copy_n(mono->begin() + static_cast<std::ptrdiff_t>(first), count, out);
+      return true;
+    };
+  }
+  const size_t channels = static_cast<size_t>(std::max(source.channels, 1));
+  return [&source, channel, channels, interleaved](size_t first, size_t count, float* out, std::string* read_error) {
+    interleaved->resize(count * channels);
+    if (!source.reader->ReadFrames(first, count, interleaved->data(), read_error)) {
+      return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      if (channels == 1U) {
+        out[i] = (*interleaved)[i];
+      } else if (channel < 0) {
+        out[i] = 0.5F * ((*interleaved)[i * 2U] + (*interleaved)[i * 2U + 1U]);
+      } else {
+        out[i] = (*interleaved)[i * 2U + static_cast<size_t>(channel)];
+      }
+    }
+    return true;
+  };
+}
+
+// STFT magnitudes of the mixdown (`channel` < 0) or one channel of `source`, limited to the frames the configured
+// image width reads.
+bool ComputeSourceFrames(const SpectrogramSource& source, int channel, const aurora::core::SpectrogramConfig& config,
+                         aurora::core::MagnitudeFrames* frames, std::string* error) {
+  std::vector<float> mono;
+  std::vector<float> interleaved;
+  const aurora::core::MonoSampleReader read = SourceMonoReader(source, channel, &mono, &interleaved);
+  std::vector<uint8_t> wanted;
+  aurora::core::MarkSpectrogramFrames(aurora::core::StftFrameCount(source.frame_count, config.window, config.hop),
+                                      config.width_px, &wanted);
+  return aurora::core::ComputeMagnitudeFrames(read, source.frame_count, config.window, config.hop, config.nfft, wanted,
+                                              frames, error);
+}
+
+// Streams the mixdown of `source` into a tile pyramid under `tiles_dir` ("<level>/<index>.png" plus manifest.json).
+// Tiles are always palette PNGs: they hold LUT indices, so the colors match the RGB images exactly.
+bool WriteSpectrogramTiles(const SpectrogramSource& source, const std::string& target_name, int sample_rate,
+                           const aurora::core::SpectrogramConfig& config,
+                           const aurora::core::SpectrogramTileConfig& tiles, const std::vector<uint8_t>& palette,
+                           int png_compression_level, const std::filesystem::path& tiles_dir, std::string* error) {
+  std::error_code ec;
+  // A previous run may have produced more levels; stale tiles must not outlive the new manifest.
+  std::filesystem::remove_all(tiles_dir, ec);
+  std::vector<float> mono;
+  std::vector<float> interleaved;
+  const aurora::core::MonoSampleReader read = SourceMonoReader(source, -1, &mono, &interleaved);
+  const aurora::core::SpectrogramTileSink sink = [&](const aurora::core::SpectrogramTile& tile, std::string* tile_error) {
+    const std::filesystem::path level_dir = tiles_dir / std::to_string(tile.level);
+    if (tile.index == 0U) {
+      std::filesystem::create_directories(level_dir, ec);
+    }
+    return aurora::io::WritePngIndexed8(level_dir / (std::to_string(tile.index) + ".png"), tile.width, tile.height,
+                                        tile.indices, palette, png_compression_level, tile_error);
+  };
+  aurora::core::SpectrogramPyramid pyramid;
+  if (!aurora::core::RenderSpectrogramPyramid(read, source.frame_count, sample_rate, config, tiles, sink, &pyramid,
+                                              error)) {
+    return false;
+  }
+  return aurora::io::WriteSpectrogramTileManifest(tiles_dir / "manifest.json", target_name, sample_rate, config, tiles,
+                                                  pyramid, error);
+}
+
+template <typename CliOptions>
+std::optional<aurora::core::SpectrogramTileConfig> SpectrogramTileOptions(const CliOptions& options) {
+  if (!options.spectrogram_tiles) {
+    return std::nullopt;
+  }
+  aurora::core::SpectrogramTileConfig tiles;
+  tiles.tile_width_px = options.spectrogram_tile_width_px;
+  tiles.pooling = options.spectrogram_tile_pooling;
+  return tiles;
+}
+
+// Lets the analyzer keep the magnitude frames the spectrogram pass reads, so each mixdown target is transformed once.
+void ShareSpectrogramStft(const aurora::core::SpectrogramConfig& config, aurora::core::AnalysisOptions* options) {
+  if (config.mode != "mixdown") {
+    return;
+  }
+  options->spectrogram_window = config.window;
+  options->spectrogram_hop = config.hop;
+  options->spectrogram_nfft = config.nfft;
+  options->spectrogram_widths = {config.width_px};
+}
+
+// `targets[0]` is the mix; the rest map to report->stems in order.
+void PopulateSpectrograms(const std::vector<SpectrogramSource>& targets, int sample_rate,
                          const aurora::core::SpectrogramConfig& config, const std::filesystem::path& spectrogram_dir,
                          const std::filesystem::path& analysis_root, int max_parallel_jobs, const std::string& composite_mode,
                          const std::optional<std::filesystem::path>& composite_out, bool write_individual,
                          int composite_header_height_px, const std::string& profile_name, bool indexed_palette,
                          int png_compression_level,
+                         const std::optional<aurora::core::SpectrogramTileConfig>& tiles,
                          aurora::core::AnalysisReport* report, const std::string& mode_label,
-                         const std::chrono::steady_clock::time_point& start_time) {
+                         const std::chrono::steady_clock::time_point& start_time, std::ostream& diagnostics) {
   auto log_step = [&](const std::string& msg) {
-    std::cerr << "[aurora +" << FormatElapsed(start_time) << "] " << msg << "\n";
+    diagnostics << "[aurora +" << FormatElapsed(start_time) << "] " << msg << "\n";
   };
   const bool composite_enabled = composite_mode == "stacked_headers";
-  auto render_target = [&](const aurora::core::AudioStem& stem, const std::string& target_name, const std::string& target_kind) {
+  const int default_jobs = static_cast<int>(aurora::core::TaskScheduler::Global().concurrency());
+  const int requested_jobs = std::max(1, max_parallel_jobs > 0 ? max_parallel_jobs : default_jobs);
+  aurora::core::SpectrogramConfig raster_config = config;
+  std::vector<uint8_t> palette;
+  if (indexed_palette) {
+    std::string lut_error;
+    if (!aurora::core::BuildColormapLutRgb(config.colormap, &palette, &lut_error)) {
+      palette.clear();
+      diagnostics << "warning: failed to build indexed palette, falling back to RGB PNG: " << lut_error << "\n";
+    }
+  }
+  std::vector<uint8_t> tile_palette = palette;
+  if (tiles.has_value() && tile_palette.empty()) {
+    std::string lut_error;
+    aurora::core::BuildColormapLutRgb(config.colormap, &tile_palette, &lut_error);
+  }
+  auto render_target = [&](const SpectrogramSource& source, const std::string& target_name, const std::string& target_kind,
+                           const aurora::core::MagnitudeFrames* shared_frames) {
     aurora::core::SpectrogramArtifact artifact = BuildBaseArtifact(config, sample_rate);
-    if (!write_individual) {
+    if (!write_individual && !tiles.has_value()) {
       artifact.present = false;
     }
     CompositeRowSource row;
@@ -1504,66 +2519,39 @@ void PopulateSpectrograms(const std::vector<aurora::core::AudioStem>& stems, con
     row.name = target_name == "mix" ? "Mix" : target_name;
     const std::string safe_name = SanitizeTargetName(target_name);
 
-    std::vector<uint8_t> palette;
-    std::unordered_map<uint32_t, uint8_t> color_to_index;
-    if (indexed_palette && write_individual) {
-      std::string lut_error;
-      if (aurora::core::BuildColormapLutRgb(config.colormap, &palette, &lut_error)) {
-        for (int i = 0; i < 256; ++i) {
-          const uint32_t key = (static_cast<uint32_t>(palette[static_cast<size_t>(i) * 3U]) << 16U) |
-                               (static_cast<uint32_t>(palette[static_cast<size_t>(i) * 3U + 1U]) << 8U) |
-                               static_cast<uint32_t>(palette[static_cast<size_t>(i) * 3U + 2U]);
-          color_to_index[key] = static_cast<uint8_t>(i);
+    // `channel` < 0 renders the mixdown; frames kept by the analyzer replace a second STFT when they match.
+    auto render_signal = [&](int channel, const aurora::core::MagnitudeFrames* frames, const std::filesystem::path& out_path,
+                             bool write_file, bool capture_row) -> bool {
+      std::vector<uint8_t> pixels;
+      std::string err;
+      const bool use_indices = indexed_palette && palette.size() == 256U * 3U;
+      aurora::core::MagnitudeFrames computed;
+      if (frames == nullptr || !frames->Matches(config.window, config.hop, config.nfft)) {
+        frames = &computed;
+        if (!ComputeSourceFrames(source, channel, config, &computed, &err)) {
+          artifact.enabled = false;
+          artifact.error = err;
+          return false;
         }
-      } else {
-        std::cerr << "warning: failed to build indexed palette, falling back to RGB PNG: " << lut_error << "\n";
       }
-    }
-
-    auto render_signal = [&](const std::vector<float>& mono, const std::filesystem::path& out_path, bool write_file, bool capture_row)
-        -> bool {
-      std::vector<uint8_t> rgb;
-      std::string err;
-      if (!aurora::core::RenderSpectrogramRgb(mono, sample_rate, config, &rgb, &err)) {
+      std::vector<uint8_t> indices;
+      const bool rendered =
+          use_indices
+              ? aurora::core::RenderSpectrogramIndexedFromFrames(*frames, sample_rate, raster_config, &pixels, nullptr, &err)
+              : aurora::core::RenderSpectrogramIndexedFromFrames(*frames, sample_rate, raster_config, &indices, &pixels,
+                                                                 &err);
+      if (!rendered) {
         artifact.enabled = false;
         artifact.error = err;
         return false;
       }
       if (write_file) {
-        if (indexed_palette && palette.size() == 256U * 3U && !color_to_index.empty()) {
-          std::vector<uint8_t> indices(static_cast<size_t>(config.width_px * config.height_px), 0U);
-          for (int y = 0; y < config.height_px; ++y) {
-            for (int x = 0; x < config.width_px; ++x) {
-              const size_t p = static_cast<size_t>((y * config.width_px + x) * 3);
-              const uint32_t key = (static_cast<uint32_t>(rgb[p]) << 16U) | (static_cast<uint32_t>(rgb[p + 1U]) << 8U) |
-                                   static_cast<uint32_t>(rgb[p + 2U]);
-              const auto it = color_to_index.find(key);
-              if (it != color_to_index.end()) {
-                indices[static_cast<size_t>(y * config.width_px + x)] = it->second;
-              } else {
-                int best = 0;
-                int best_d = std::numeric_limits<int>::max();
-                for (int i = 0; i < 256; ++i) {
-                  const int dr = static_cast<int>(rgb[p]) - static_cast<int>(palette[static_cast<size_t>(i) * 3U]);
-                  const int dg = static_cast<int>(rgb[p + 1U]) - static_cast<int>(palette[static_cast<size_t>(i) * 3U + 1U]);
-                  const int db = static_cast<int>(rgb[p + 2U]) - static_cast<int>(palette[static_cast<size_t>(i) * 3U + 2U]);
-                  const int d = dr * dr + dg * dg + db * db;
-                  if (d < best_d) {
-                    best_d = d;
-                    best = i;
-                  }
-                }
-                indices[static_cast<size_t>(y * config.width_px + x)] = static_cast<uint8_t>(best);
-              }
-            }
-          }
-          if (!aurora::io::WritePngIndexed8(out_path, config.width_px, config.height_px, indices, palette,
-                                            png_compression_level, &err)) {
-            artifact.enabled = false;
-            artifact.error = err;
-            return false;
-          }
-        } else if (!aurora::io::WritePngRgb8(out_path, config.width_px, config.height_px, rgb, png_compression_level, &err)) {
+        const bool written =
+            use_indices ? aurora::io::WritePngIndexed8(out_path, config.width_px, config.height_px, pixels, palette,
+                                                       png_compression_level, &err)
+                        : aurora::io::WritePngRgb8(out_path, config.width_px, config.height_px, pixels,
+                                                   png_compression_level, &err);
+        if (!written) {
           artifact.enabled = false;
           artifact.error = err;
           return false;
@@ -1571,23 +2559,41 @@ void PopulateSpectrograms(const std::vector<aurora::core::AudioStem>& stems, con
       }
       if (capture_row && composite_enabled) {
         row.available = true;
+        row.indexed = use_indices;
         row.width = config.width_px;
         row.height = config.height_px;
-        row.rgb = std::move(rgb);
+        row.pixels = std::move(pixels);
       }
       return true;
     };
 
-    if (config.mode == "channels" && stem.channels == 2) {
+    // The tile pyramid always follows the mixdown and streams its own STFT over every frame.
+    auto write_tiles = [&]() {
+      if (!tiles.has_value() || !artifact.error.empty()) {
+        return;
+      }
+      const std::filesystem::path tiles_dir = spectrogram_dir / (safe_name + ".tiles");
+      std::string err;
+      if (!WriteSpectrogramTiles(source, target_name, sample_rate, config, *tiles, tile_palette, png_compression_level,
+                                 tiles_dir, &err)) {
+        artifact.enabled = false;
+        artifact.error = err;
+        return;
+      }
+      artifact.enabled = true;
+      artifact.tiles_manifest = RelativeToAnalysisRoot(tiles_dir / "manifest.json", analysis_root);
+    };
+
+    if (config.mode == "channels" && source.channels == 2) {
       const std::filesystem::path left_path = spectrogram_dir / (safe_name + ".L.spectrogram.png");
       const std::filesystem::path right_path = spectrogram_dir / (safe_name + ".R.spectrogram.png");
       bool ok_left = false;
       bool ok_right = true;
       if (write_individual) {
-        ok_left = render_signal(ExtractChannel(stem, 0), left_path, true, true);
-        ok_right = ok_left ? render_signal(ExtractChannel(stem, 1), right_path, true, false) : false;
+        ok_left = render_signal(0, nullptr, left_path, true, true);
+        ok_right = ok_left ? render_signal(1, nullptr, right_path, true, false) : false;
       } else if (composite_enabled) {
-        ok_left = render_signal(ExtractChannel(stem, 0), left_path, false, true);
+        ok_left = render_signal(0, nullptr, left_path, false, true);
       }
       if (write_individual && ok_left && ok_right) {
         artifact.enabled = true;
@@ -1597,16 +2603,19 @@ void PopulateSpectrograms(const std::vector<aurora::core::AudioStem>& stems, con
             RelativeToAnalysisRoot(right_path, analysis_root),
         };
       }
+      write_tiles();
       return std::pair<aurora::core::SpectrogramArtifact, CompositeRowSource>{artifact, std::move(row)};
     }
 
     const std::filesystem::path out_path = spectrogram_dir / (safe_name + ".spectrogram.png");
-    const bool ok = render_signal(Mixdown(stem), out_path, write_individual, true);
+    const bool ok = (write_individual || composite_enabled) &&
+                    render_signal(-1, shared_frames, out_path, write_individual, true);
     if (ok && write_individual) {
       artifact.enabled = true;
       artifact.path = RelativeToAnalysisRoot(out_path, analysis_root);
       artifact.paths = {artifact.path};
     }
+    write_tiles();
     return std::pair<aurora::core::SpectrogramArtifact, CompositeRowSource>{artifact, std::move(row)};
   };
 
@@ -1614,179 +2623,267 @@ void PopulateSpectrograms(const std::vector<aurora::core::AudioStem>& stems, con
   if (report == nullptr) {
     return;
   }
-  const size_t total_targets = stems.size() + 1U;
-  std::vector<aurora::core::SpectrogramArtifact> stem_artifacts(stems.size());
-  std::vector<CompositeRowSource> composite_rows(total_targets);
+  if (targets.empty()) {
+    return;
+  }
+  const size_t total_targets = targets.size();
+  std::vector<aurora::core::SpectrogramArtifact> artifacts(total_targets);
+  std::vector<CompositeRowSource> pending_rows(total_targets);
+  std::vector<bool> target_done(total_targets, false);
 
   report->mix.spectrogram = BuildBaseArtifact(config, sample_rate);
-  const int default_jobs = std::max(1U, std::thread::hardware_concurrency());
-  const int requested_jobs = max_parallel_jobs > 0 ? max_parallel_jobs : default_jobs;
-  const int max_jobs = std::max(1, requested_jobs);
-
-  if (max_jobs == 1 || total_targets <= 1U) {
-    auto mix_out = render_target(mix, "mix", "mix");
-    report->mix.spectrogram = std::move(mix_out.first);
-    composite_rows[0] = std::move(mix_out.second);
-    for (size_t i = 0; i < stems.size(); ++i) {
-      auto stem_out = render_target(stems[i], stems[i].name, "stem");
-      stem_artifacts[i] = std::move(stem_out.first);
-      composite_rows[i + 1U] = std::move(stem_out.second);
+  report->composite_spectrogram.present = composite_enabled;
+
+  const std::filesystem::path composite_dir = composite_out.value_or(spectrogram_dir);
+  const std::filesystem::path composite_path = composite_dir / "composite.png";
+  CompositeSpectrogramStream composite;
+  bool composite_ok = false;
+  std::string composite_error;
+  if (composite_enabled) {
+    report->composite_spectrogram.mode = "stacked_headers";
+    report->composite_spectrogram.profile = profile_name;
+    report->composite_spectrogram.width_px = config.width_px;
+    report->composite_spectrogram.header_height_px = composite_header_height_px;
+    report->composite_spectrogram.row_height_px = config.height_px + report->composite_spectrogram.header_height_px;
+    report->composite_spectrogram.freq_scale = config.freq_scale;
+    report->composite_spectrogram.colormap = config.colormap;
+    report->composite_spectrogram.format = "png";
+    report->composite_spectrogram.indexed_palette = indexed_palette;
+    report->composite_spectrogram.targets.clear();
+    report->composite_spectrogram.targets.reserve(total_targets);
+    report->composite_spectrogram.targets.push_back({"mix", "Mix"});
+    for (size_t i = 1; i < targets.size(); ++i) {
+      report->composite_spectrogram.targets.push_back({"stem", targets[i].name == "mix" ? "Mix" : targets[i].name});
     }
-  } else {
-    std::vector<aurora::core::SpectrogramArtifact> artifacts(total_targets);
-    std::vector<CompositeRowSource> rows(total_targets);
-    std::atomic<size_t> next_target{0U};
-    const size_t worker_count = std::min(static_cast<size_t>(max_jobs), total_targets);
-    std::vector<std::thread> workers;
-    workers.reserve(worker_count);
-    for (size_t worker = 0; worker < worker_count; ++worker) {
-      workers.emplace_back([&]() {
-        while (true) {
-          const size_t target_index = next_target.fetch_add(1U);
-          if (target_index >= total_targets) {
+    composite_ok = BeginCompositeSpectrogram(&composite, composite_path, static_cast<int>(total_targets), config.width_px,
+                                             config.height_px, composite_header_height_px, indexed_palette,
+                                             config.colormap, png_compression_level, &composite_error);
+  }
+
+  const size_t worker_count = std::min(static_cast<size_t>(requested_jobs), total_targets);
+  // Each image may also spread its columns over the whole budget: the shared scheduler hands column blocks to threads
+  // that have no whole target left, e.g. when there is a single mix.
+  raster_config.render_threads = requested_jobs;
+
+  // Each index renders one target, so a thread that picks up this loop while waiting elsewhere finishes one image and
+  // can return; nothing in it blocks on other targets. Composite rows must reach the PNG stream in target order:
+  // finished rows wait in `pending_rows`, and whichever thread finds the next row ready appends every ready row in
+  // order. A thread that finds another one appending leaves its row to it instead of waiting.
+  std::mutex state_mutex;
+  std::mutex emit_mutex;
+  size_t next_emit = 0U;
+  const auto next_row_ready = [&]() {
+    std::lock_guard<std::mutex> lock(state_mutex);
+    return next_emit < total_targets && target_done[next_emit];
+  };
+
+  auto drain_completed = [&]() {
+    std::unique_lock<std::mutex> emit_lock(emit_mutex, std::try_to_lock);
+    while (emit_lock.owns_lock()) {
+      while (true) {
+        CompositeRowSource row;
+        {
+          std::lock_guard<std::mutex> lock(state_mutex);
+          if (next_emit >= total_targets || !target_done[next_emit]) {
             break;
           }
-          if (target_index == 0U) {
-            auto out = render_target(mix, "mix", "mix");
-            artifacts[target_index] = std::move(out.first);
-            rows[target_index] = std::move(out.second);
-          } else {
-            const size_t stem_index = target_index - 1U;
-            auto out = render_target(stems[stem_index], stems[stem_index].name, "stem");
-            artifacts[target_index] = std::move(out.first);
-            rows[target_index] = std::move(out.second);
-          }
+          row = std::move(pending_rows[next_emit]);
         }
-      });
+        if (composite_ok) {
+          composite_ok = AppendCompositeRow(&composite, row, diagnostics, &composite_error);
+        }
+        std::lock_guard<std::mutex> lock(state_mutex);
+        ++next_emit;
+      }
+      emit_lock.unlock();
+      // A row finished while this thread held the lock was left to it; take the lock again unless another thread has.
+      if (!next_row_ready()) {
+        return;
+      }
+      emit_lock.try_lock();
     }
-    for (auto& worker : workers) {
-      worker.join();
+  };
+
+  aurora::core::TaskScheduler::Global().ParallelFor(total_targets, worker_count, [&](size_t target_index) {
+    aurora::core::FileAnalysis* analysis = target_index == 0U ? &report->mix
+                                           : target_index - 1U < report->stems.size() ? &report->stems[target_index - 1U]
+                                                                                     : nullptr;
+    auto out = target_index == 0U
+                   ? render_target(targets[0], "mix", "mix", &analysis->spectrum)
+                   : render_target(targets[target_index], targets[target_index].name, "stem",
+                                   analysis != nullptr ? &analysis->spectrum : nullptr);
+    if (analysis != nullptr) {
+      analysis->spectrum = aurora::core::MagnitudeFrames{};
     }
-    report->mix.spectrogram = std::move(artifacts[0]);
-    composite_rows[0] = std::move(rows[0]);
-    for (size_t i = 0; i < stems.size(); ++i) {
-      stem_artifacts[i] = std::move(artifacts[i + 1U]);
-      composite_rows[i + 1U] = std::move(rows[i + 1U]);
+    {
+      std::lock_guard<std::mutex> lock(state_mutex);
+      artifacts[target_index] = std::move(out.first);
+      pending_rows[target_index] = std::move(out.second);
+      target_done[target_index] = true;
     }
-  }
+    drain_completed();
+  });
 
-  const size_t stem_count = std::min(stems.size(), report->stems.size());
+  report->mix.spectrogram = std::move(artifacts[0]);
+  const size_t stem_count = std::min(targets.size() - 1U, report->stems.size());
   for (size_t i = 0; i < stem_count; ++i) {
-    report->stems[i].spectrogram = std::move(stem_artifacts[i]);
+    report->stems[i].spectrogram = std::move(artifacts[i + 1U]);
   }
 
-  report->composite_spectrogram.present = composite_enabled;
   if (!composite_enabled) {
     return;
   }
-  report->composite_spectrogram.mode = "stacked_headers";
-  report->composite_spectrogram.profile = profile_name;
-  report->composite_spectrogram.width_px = config.width_px;
-  report->composite_spectrogram.header_height_px = composite_header_height_px;
-  report->composite_spectrogram.row_height_px = config.height_px + report->composite_spectrogram.header_height_px;
-  report->composite_spectrogram.freq_scale = config.freq_scale;
-  report->composite_spectrogram.colormap = config.colormap;
-  report->composite_spectrogram.format = "png";
-  report->composite_spectrogram.indexed_palette = indexed_palette;
-  report->composite_spectrogram.targets.clear();
-  report->composite_spectrogram.targets.reserve(composite_rows.size());
-  for (const auto& row : composite_rows) {
-    report->composite_spectrogram.targets.push_back({row.kind, row.name});
+  if (composite_ok) {
+    composite_ok = FinishCompositeSpectrogram(&composite, &composite_error);
   }
-
-  const std::filesystem::path composite_dir = composite_out.value_or(spectrogram_dir);
-  const std::filesystem::path composite_path = composite_dir / "composite.png";
-  std::string composite_error;
-  if (!WriteCompositeSpectrogramPng(composite_path, composite_rows, config.width_px, config.height_px,
-                                    composite_header_height_px, indexed_palette, config.colormap, png_compression_level,
-                                    &composite_error)) {
+  if (!composite_ok) {
     report->composite_spectrogram.enabled = false;
     report->composite_spectrogram.error = composite_error;
-    std::cerr << "warning: failed to write spectrogram composite: " << composite_error << "\n";
+    diagnostics << "warning: failed to write spectrogram composite: " << composite_error << "\n";
     return;
   }
   report->composite_spectrogram.enabled = true;
   report->composite_spectrogram.path = RelativeToAnalysisRoot(composite_path, analysis_root);
   report->composite_spectrogram.error.clear();
-  std::cerr << "[aurora +" << FormatElapsed(start_time) << "] Spectrogram composite written: " << composite_path.string()
-            << " (rows=" << composite_rows.size() << ", " << config.width_px << "x"
-            << (report->composite_spectrogram.row_height_px * static_cast<int>(composite_rows.size())) << ")\n";
+  diagnostics << "[aurora +" << FormatElapsed(start_time) << "] Spectrogram composite written: "
+              << composite_path.string() << " (rows=" << total_targets << ", " << config.width_px << "x"
+              << (report->composite_spectrogram.row_height_px * static_cast<int>(total_targets)) << ")\n";
 }
 
-int RunAnalyzeCommand(const AnalyzeCliOptions& options, const std::chrono::steady_clock::time_point& start_time) {
+int RunAnalyzeCommand(const AnalyzeCliOptions& options, const std::chrono::steady_clock::time_point& start_time,
+                      const CommandStreams& streams) {
   auto log_step = [&](const std::string& msg) {
-    std::cerr << "[aurora +" << FormatElapsed(start_time) << "] " << msg << "\n";
+    streams.err << "[aurora +" << FormatElapsed(start_time) << "] " << msg << "\n";
   };
 
   aurora::core::AnalysisOptions analysis_options;
   analysis_options.max_parallel_jobs = options.analyze_threads;
   analysis_options.intent = options.intent;
+  analysis_options.keep_feature_series = options.features;
+  analysis_options.timeline_window_seconds = options.timeline_seconds;
+  analysis_options.masking_window_seconds = options.masking_seconds;
 
-  aurora::core::AudioStem mix;
-  std::vector<aurora::core::AudioStem> stems;
-  int mix_sample_rate = 0;
-  std::string mode;
-
-  if (!options.stems_mode) {
-    std::string error;
-    log_step("Loading audio: " + options.positional.front().string());
-    if (!aurora::io::ReadAudioFile(options.positional.front(), &mix, &mix_sample_rate, &error)) {
-      std::cerr << "Analyze error: " << error << "\n";
-      return 3;
-    }
-    mode = "standalone_analysis";
-  } else {
-    std::filesystem::path mix_path;
-    std::vector<std::filesystem::path> stem_paths = options.positional;
-
+  std::filesystem::path mix_path = options.positional.front();
+  std::vector<std::filesystem::path> stem_paths;
+  std::string mode = "standalone_analysis";
+  if (options.stems_mode) {
+    stem_paths = options.positional;
     if (options.mix_file.has_value()) {
       mix_path = options.mix_file.value();
     } else {
       mix_path = stem_paths.back();
       stem_paths.pop_back();
     }
+    mode = "hybrid_stems";
+  }
 
-    std::string error;
-    log_step("Loading mix audio: " + mix_path.string());
-    if (!aurora::io::ReadAudioFile(mix_path, &mix, &mix_sample_rate, &error)) {
-      std::cerr << "Analyze error: " << error << "\n";
+  // Resident mode decodes every file up front; streaming mode only parses headers here and the analysis and
+  // spectrogram passes pull bounded blocks on demand.
+  aurora::core::AudioStem mix;
+  std::vector<aurora::core::AudioStem> stems;
+  aurora::io::AudioStreamReader mix_reader;
+  std::vector<std::unique_ptr<aurora::io::AudioStreamReader>> stem_readers;
+  int mix_sample_rate = 0;
+  std::string error;
+  const auto load = [&](const std::filesystem::path& path, const std::string& what, aurora::core::AudioStem* stem,
+                        aurora::io::AudioStreamReader* reader, int* sample_rate) {
+    log_step((options.streaming ? "Opening " : "Loading ") + what + ": " + path.string());
+    if (options.streaming) {
+      if (!reader->Open(path, &error)) {
+        return false;
+      }
+      *sample_rate = reader->sample_rate();
+      return true;
+    }
+    return aurora::io::ReadAudioFile(path, stem, sample_rate, &error);
+  };
+  if (!load(mix_path, options.stems_mode ? "mix audio" : "audio", &mix, &mix_reader, &mix_sample_rate)) {
+    streams.err << "Analyze error: " << error << "\n";
+    return 3;
+  }
+  for (const auto& stem_path : stem_paths) {
+    aurora::core::AudioStem stem;
+    auto reader = std::make_unique<aurora::io::AudioStreamReader>();
+    int stem_sr = 0;
+    if (!load(stem_path, "stem audio", &stem, reader.get(), &stem_sr)) {
+      streams.err << "Analyze error: " << error << "\n";
       return 3;
     }
-
-    for (const auto& stem_path : stem_paths) {
-      aurora::core::AudioStem stem;
-      int stem_sr = 0;
-      log_step("Loading stem audio: " + stem_path.string());
-      if (!aurora::io::ReadAudioFile(stem_path, &stem, &stem_sr, &error)) {
-        std::cerr << "Analyze error: " << error << "\n";
-        return 3;
-      }
-      if (stem_sr != mix_sample_rate) {
-        std::cerr << "Analyze error: sample-rate mismatch between stem '" << stem_path.string() << "' (" << stem_sr
-                  << ") and mix (" << mix_sample_rate << ").\n";
-        return 3;
-      }
+    if (stem_sr != mix_sample_rate) {
+      streams.err << "Analyze error: sample-rate mismatch between stem '" << stem_path.string() << "' (" << stem_sr
+                << ") and mix (" << mix_sample_rate << ").\n";
+      return 3;
+    }
+    if (options.streaming) {
+      stem_readers.push_back(std::move(reader));
+    } else {
       stems.push_back(std::move(stem));
     }
-    mode = "hybrid_stems";
   }
 
-  log_step("Running analysis");
-  aurora::core::AnalysisReport report =
-      aurora::core::AnalyzeFiles(stems, mix, mix_sample_rate, mode, analysis_options);
+  std::vector<SpectrogramSource> spectrogram_targets;
+  std::vector<aurora::core::StreamedAudio> streamed_stems;
+  aurora::core::StreamedAudio streamed_mix;
+  if (options.streaming) {
+    const auto streamed = [](aurora::io::AudioStreamReader* reader) {
+      aurora::core::StreamedAudio audio;
+      audio.name = reader->name();
+      audio.channels = reader->channels();
+      audio.frame_count = reader->frame_count();
+      audio.read = [reader](size_t first, size_t count, float* out, std::string* read_error) {
+        return reader->ReadFrames(first, count, out, read_error);
+      };
+      return audio;
+    };
+    const auto streamed_source = [](aurora::io::AudioStreamReader* reader) {
+      SpectrogramSource source;
+      source.name = reader->name();
+      source.channels = reader->channels();
+      source.frame_count = reader->frame_count();
+      source.reader = reader;
+      return source;
+    };
+    streamed_mix = streamed(&mix_reader);
+    spectrogram_targets.push_back(streamed_source(&mix_reader));
+    for (const auto& reader : stem_readers) {
+      streamed_stems.push_back(streamed(reader.get()));
+      spectrogram_targets.push_back(streamed_source(reader.get()));
+    }
+  } else {
+    spectrogram_targets.push_back(ResidentSpectrogramSource(mix));
+    for (const auto& stem : stems) {
+      spectrogram_targets.push_back(ResidentSpectrogramSource(stem));
+    }
+  }
 
-  const std::filesystem::path out_path = options.out_path.value_or(std::filesystem::current_path() / "analysis.json");
-  const std::filesystem::path analysis_root = out_path.parent_path();
   ResolvedSpectrogramProfile spectrogram_profile;
   std::string spectrogram_error;
   if (!BuildSpectrogramProfileConfig(mix_sample_rate, options.spectrogram_config_json, options.spectrogram_profile,
                                      options.spectrogram_width_px, options.spectrogram_row_height_px,
                                      options.spectrogram_header_height_px, options.spectrogram_indexed_palette,
                                      &spectrogram_profile, &spectrogram_error)) {
-    std::cerr << "Analyze error: " << spectrogram_error << "\n";
+    streams.err << "Analyze error: " << spectrogram_error << "\n";
     return 2;
   }
   const aurora::core::SpectrogramConfig& spectrogram_config = spectrogram_profile.config;
+  if (options.spectrogram && (options.spectrogram_separate || options.spectrogram_composite == "stacked_headers")) {
+    ShareSpectrogramStft(spectrogram_config, &analysis_options);
+  }
+
+  log_step(options.streaming ? "Running streaming analysis" : "Running analysis");
+  aurora::core::AnalysisReport report;
+  if (options.streaming) {
+    if (!aurora::core::AnalyzeStreamedFiles(streamed_stems, streamed_mix, mix_sample_rate, mode, analysis_options,
+                                            &report, &error)) {
+      streams.err << "Analyze error: " << error << "\n";
+      return 3;
+    }
+  } else {
+    report = aurora::core::AnalyzeFiles(stems, mix, mix_sample_rate, mode, analysis_options);
+  }
+
+  const std::filesystem::path out_path = options.out_path.value_or(std::filesystem::current_path() / "analysis.json");
+  const std::filesystem::path analysis_root = out_path.parent_path();
   if (!options.spectrogram) {
     MarkSpectrogramDisabled(&report.mix, spectrogram_config, mix_sample_rate);
     for (auto& stem_analysis : report.stems) {
@@ -1801,7 +2898,7 @@ int RunAnalyzeCommand(const AnalyzeCliOptions& options, const std::chrono::stead
   } else {
     const bool composite_enabled = options.spectrogram_composite == "stacked_headers";
     const bool write_individual = options.spectrogram_separate;
-    if (!composite_enabled && !write_individual) {
+    if (!composite_enabled && !write_individual && !options.spectrogram_tiles) {
       report.mix.spectrogram.present = false;
       for (auto& stem_analysis : report.stems) {
         stem_analysis.spectrogram.present = false;
@@ -1809,233 +2906,244 @@ int RunAnalyzeCommand(const AnalyzeCliOptions& options, const std::chrono::stead
     } else {
     const std::filesystem::path spectrogram_out =
         options.spectrogram_out.value_or(analysis_root);
-    PopulateSpectrograms(stems, mix, mix_sample_rate, spectrogram_config, spectrogram_out, analysis_root,
+    PopulateSpectrograms(spectrogram_targets, mix_sample_rate, spectrogram_config, spectrogram_out, analysis_root,
                          options.analyze_threads, options.spectrogram_composite, options.spectrogram_composite_out,
                          write_individual, spectrogram_profile.header_height_px, spectrogram_profile.profile,
-                         spectrogram_profile.indexed_palette, spectrogram_profile.png_compression_level, &report, "analyze",
-                         start_time);
+                         spectrogram_profile.indexed_palette, spectrogram_profile.png_compression_level,
+                         SpectrogramTileOptions(options), &report, "analyze", start_time, streams.err);
     }
   }
 
+  if (options.features) {
+    log_step("Writing feature series");
+    ExportFeatureSeries(&report, options.features_out.value_or(analysis_root / "features"), analysis_root);
+  }
+  if (report.masking.present) {
+    log_step("Writing masking windows");
+    ExportMaskingWindows(&report, analysis_root / "masking", analysis_root);
+  }
+
   std::string write_error;
   if (!aurora::io::WriteAnalysisJson(out_path, report, &write_error)) {
-    std::cerr << "Analyze error: " << write_error << "\n";
+    streams.err << "Analyze error: " << write_error << "\n";
     return 6;
   }
 
   log_step("Done");
-  std::cout << "Analysis complete\n";
-  std::cout << "  mode: " << report.mode << "\n";
-  std::cout << "  sample_rate: " << report.sample_rate << "\n";
-  std::cout << "  mix_lufs: " << report.mix.loudness.integrated_lufs << "\n";
-  std::cout << "  output: " << out_path.string() << "\n";
+  streams.out << "Analysis complete\n";
+  streams.out << "  mode: " << report.mode << "\n";
+  streams.out << "  sample_rate: " << report.sample_rate << "\n";
+  streams.out << "  mix_lufs: " << report.mix.loudness.integrated_lufs << "\n";
+  streams.out << "  output: " << out_path.string() << "\n";
   return 0;
 }
 
 }  // namespace
 
-int main(int argc, char** argv) {
-  const auto start_time = std::chrono::steady_clock::now();
+// Renders a loaded score, writes stems, master, MIDI and render.json to `output_dirs`, and runs the requested analysis.
+// With a cache, stems it holds for this score are reused and the render's stems are stored for the next one.
+// Progress lines, the `--progress-json` objects or the percentage log, go to `streams.err` from renderer threads.
+int RenderLoadedScore(const aurora::lang::AuroraFile& score, const RenderOutputDirs& output_dirs,
+                      const RenderCliOptions& options, aurora::core::RenderCache* cache,
+                      const std::chrono::steady_clock::time_point& start_time, const CommandStreams& streams) {
   auto log_step = [&](const std::string& msg) {
-    std::cerr << "[aurora +" << FormatElapsed(start_time) << "] " << msg << "\n";
+    streams.err << "[aurora +" << FormatElapsed(start_time) << "] " << msg << "\n";
   };
 
-  if (argc < 2) {
-    PrintUsage();
-    return 2;
-  }
-
-  const std::string command = argv[1];
-  if (command == "analyze") {
-    AnalyzeCliOptions options;
-    std::string cli_error;
-    if (!ParseAnalyzeArgs(argc, argv, &options, &cli_error)) {
-      std::cerr << "Argument error: " << cli_error << "\n";
-      PrintUsage();
+  aurora::core::Renderer renderer;
+  aurora::core::RenderOptions render_options = BuildRenderOptions(options);
+  render_options.cache = cache;
+  if (options.range_from.has_value() || options.range_to.has_value()) {
+    uint64_t range_start = 0;
+    uint64_t range_end = 0;
+    std::string range_error;
+    if (!renderer.ResolveRange(score, render_options, &range_start, &range_end, &range_error)) {
+      streams.err << "Argument error: " << range_error << "\n";
       return 2;
     }
-    return RunAnalyzeCommand(options, start_time);
-  }
-
-  if (command != "render") {
-    std::cerr << "Unsupported command: " << command << "\n";
-    PrintUsage();
-    return 2;
+    const double sample_rate =
+        static_cast<double>(options.sample_rate > 0 ? options.sample_rate : score.globals.sr);
+    log_step("Range: " + FormatSeconds(static_cast<double>(range_start) / sample_rate) + " to " +
+             FormatSeconds(static_cast<double>(range_end) / sample_rate));
   }
-
-  std::filesystem::path au_file;
-  RenderCliOptions options;
-  std::string cli_error;
-  if (!ParseRenderArgs(argc, argv, &au_file, &options, &cli_error)) {
-    std::cerr << "Argument error: " << cli_error << "\n";
-    PrintUsage();
-    return 2;
-  }
-
-  log_step("Reading source: " + au_file.string());
-  std::string source;
-  std::string read_error;
-  if (!ReadFile(au_file, &source, &read_error)) {
-    std::cerr << read_error << "\n";
-    return 3;
-  }
-
-  log_step("Parsing");
-  aurora::lang::ParseResult parse = aurora::lang::ParseAuroraSource(source);
-  if (!parse.ok) {
-    for (const auto& d : parse.diagnostics) {
-      std::cerr << au_file.string() << ":" << d.line << ":" << d.column << ": parse error: " << d.message << "\n";
-    }
-    return 4;
-  }
-
-  log_step("Resolving imports");
-  {
-    std::error_code ec;
-    const std::filesystem::path canonical_au_file = std::filesystem::weakly_canonical(au_file, ec);
-    const std::string root_key = (ec ? au_file.lexically_normal() : canonical_au_file).string();
-    std::vector<std::string> import_stack;
-    import_stack.push_back(root_key);
-    std::string import_error;
-    if (!ResolveImportsRecursive(au_file, &parse.file, &import_stack, &import_error)) {
-      std::cerr << "import error: " << import_error << "\n";
-      return 4;
+  const bool selective = !options.only_patches.empty() || !options.only_buses.empty();
+  if (selective) {
+    std::vector<std::string> patches;
+    std::vector<std::string> buses;
+    std::string selection_error;
+    if (!renderer.ResolveSelection(score, render_options, &patches, &buses, &selection_error)) {
+      streams.err << "Argument error: " << selection_error << "\n";
+      return 2;
     }
+    const auto join = [](const std::vector<std::string>& names) {
+      std::string joined;
+      for (const std::string& name : names) {
+        joined += (joined.empty() ? "" : ", ") + name;
+      }
+      return joined.empty() ? std::string("none") : joined;
+    };
+    log_step("Selection: patches " + join(patches) + "; buses " + join(buses));
   }
-
-  log_step("Validating");
-  const aurora::lang::ValidationResult validation = aurora::lang::Validate(parse.file);
-  for (const auto& warning : validation.warnings) {
-    std::cerr << "warning: " << warning << "\n";
-  }
-  if (!validation.ok) {
-    for (const auto& err : validation.errors) {
-      std::cerr << "validation error: " << err << "\n";
-    }
-    return 5;
+  std::optional<ProgressJsonEmitter> progress_json;
+  if (options.progress_json) {
+    progress_json.emplace(start_time, streams.err);
   }
-
-  log_step("Rendering audio/MIDI");
-  aurora::core::Renderer renderer;
-  aurora::core::RenderOptions render_options;
-  render_options.seed = options.seed;
-  render_options.sample_rate_override = options.sample_rate;
   int last_render_pct = -5;
-  render_options.progress_callback = [&](double pct) {
-    int rounded = static_cast<int>(pct + 0.5);
+  render_options.progress_callback = [&](const aurora::core::RenderProgress& progress) {
+    if (progress_json.has_value()) {
+      progress_json->OnRender(progress);
+      return;
+    }
+    int rounded = static_cast<int>(progress.percent + 0.5);
     if (rounded < 0) {
       rounded = 0;
     } else if (rounded > 100) {
       rounded = 100;
     }
-    if (rounded >= last_render_pct + 5 || rounded == 100) {
+    if (rounded >= last_render_pct + 5 || (rounded == 100 && last_render_pct < 100)) {
       last_render_pct = rounded;
-      std::cerr << "[aurora +" << FormatElapsed(start_time) << "] Rendering " << rounded << "%\n";
+      streams.err << "[aurora +" << FormatElapsed(start_time) << "] Rendering " << rounded << "%\n";
     }
   };
-  aurora::core::RenderResult rendered = renderer.Render(parse.file, render_options);
+  if (options.dry_run) {
+    PrintRenderPlan(renderer.Plan(score, render_options), streams.out);
+    return 0;
+  }
+  const std::filesystem::path& stems_dir = output_dirs.stems;
+  const std::filesystem::path& midi_dir = output_dirs.midi;
+  const std::filesystem::path& mix_dir = output_dirs.mix;
+  const std::filesystem::path& meta_dir = output_dirs.meta;
 
-  const std::filesystem::path au_parent =
-      au_file.has_parent_path() ? std::filesystem::absolute(au_file).parent_path() : std::filesystem::current_path();
-  const std::filesystem::path stems_dir =
-      options.out_root.has_value() ? options.out_root.value() / "stems"
-                                   : ResolveOutputPath(parse.file.outputs.stems_dir, au_parent, std::nullopt);
-  const std::filesystem::path midi_dir =
-      options.out_root.has_value() ? options.out_root.value() / "midi"
-                                   : ResolveOutputPath(parse.file.outputs.midi_dir, au_parent, std::nullopt);
-  const std::filesystem::path mix_dir =
-      options.out_root.has_value() ? options.out_root.value() / "mix"
-                                   : ResolveOutputPath(parse.file.outputs.mix_dir, au_parent, std::nullopt);
-  const std::filesystem::path meta_dir =
-      options.out_root.has_value() ? options.out_root.value() / "meta"
-                                   : ResolveOutputPath(parse.file.outputs.meta_dir, au_parent, std::nullopt);
+  aurora::core::AnalysisOptions analysis_options;
+  analysis_options.max_parallel_jobs = options.analyze_threads;
+  analysis_options.intent = options.intent;
+  analysis_options.keep_feature_series = options.features;
+  analysis_options.timeline_window_seconds = options.timeline_seconds;
+  analysis_options.masking_window_seconds = options.masking_seconds;
+  if (progress_json.has_value()) {
+    analysis_options.frames_processed = &progress_json->analysis_frames;
+  }
+  std::atomic<uint64_t>* const written_counter = progress_json.has_value() ? &progress_json->bytes_written : nullptr;
+  ResolvedSpectrogramProfile spectrogram_profile;
+  std::string spectrogram_error;
+  std::unique_ptr<aurora::core::RenderAnalysisSession> analysis_session;
 
-  log_step("Writing outputs");
+  // Each stem is written and analyzed as soon as the renderer finishes it, while later patches and buses still render.
+  aurora::core::TaskScheduler& scheduler = aurora::core::TaskScheduler::Global();
   std::vector<std::future<std::optional<std::string>>> write_jobs;
-  write_jobs.reserve(rendered.patch_stems.size() + rendered.bus_stems.size() + 3U);
-
-  for (const auto& stem : rendered.patch_stems) {
+  std::mutex write_jobs_mutex;
+  int render_sample_rate = 0;
+  render_options.plan_callback = [&](const aurora::core::RenderPlan& plan) {
+    log_step(DescribePredictedRender(plan));
+    render_sample_rate = plan.metadata.sample_rate;
+    if (!options.analyze ||
+        !BuildSpectrogramProfileConfig(plan.metadata.sample_rate, options.spectrogram_config_json,
+                                       options.spectrogram_profile, options.spectrogram_width_px,
+                                       options.spectrogram_row_height_px, options.spectrogram_header_height_px,
+                                       options.spectrogram_indexed_palette, &spectrogram_profile, &spectrogram_error)) {
+      return;
+    }
+    if (options.spectrogram && (options.spectrogram_separate || options.spectrogram_composite == "stacked_headers")) {
+      ShareSpectrogramStft(spectrogram_profile.config, &analysis_options);
+    }
+    analysis_session = std::make_unique<aurora::core::RenderAnalysisSession>(
+        plan.metadata, score.patches.size() + score.buses.size(), analysis_options);
+  };
+  render_options.stem_callback = [&](size_t index, const aurora::core::AudioStem& stem) {
     const auto* stem_ptr = &stem;
     const auto path = stems_dir / (stem.name + ".wav");
-    write_jobs.push_back(std::async(std::launch::async, [path, stem_ptr, sr = rendered.metadata.sample_rate]() {
+    auto job = scheduler.Submit([path, stem_ptr, written_counter, sr = render_sample_rate]() {
       std::string error;
       if (!aurora::io::WriteWavFloat32(path, *stem_ptr, sr, &error)) {
         return std::optional<std::string>(error);
       }
+      CountWrittenBytes(path, written_counter);
       return std::optional<std::string>{};
-    }));
+    });
+    {
+      std::lock_guard<std::mutex> lock(write_jobs_mutex);
+      write_jobs.push_back(std::move(job));
+    }
+    if (analysis_session) {
+      analysis_session->AddStem(index, stem);
+    }
+  };
+  log_step(options.draft ? "Rendering audio/MIDI (draft)" : "Rendering audio/MIDI");
+  aurora::core::RenderResult rendered = renderer.Render(score, render_options);
+  if (progress_json.has_value()) {
+    progress_json->StartHeartbeat();
   }
-  for (const auto& stem : rendered.bus_stems) {
-    const auto* stem_ptr = &stem;
-    const auto path = stems_dir / (stem.name + ".wav");
-    write_jobs.push_back(std::async(std::launch::async, [path, stem_ptr, sr = rendered.metadata.sample_rate]() {
-      std::string error;
-      if (!aurora::io::WriteWavFloat32(path, *stem_ptr, sr, &error)) {
-        return std::optional<std::string>(error);
-      }
-      return std::optional<std::string>{};
-    }));
+  if (cache != nullptr) {
+    log_step("Reused " + std::to_string(std::count(rendered.stems_reused.begin(), rendered.stems_reused.end(), true)) +
+             " of " + std::to_string(rendered.stems_reused.size()) + " stems");
   }
-  {
-    const auto master_path = mix_dir / parse.file.outputs.master;
-    write_jobs.push_back(std::async(std::launch::async, [master_path, &rendered]() {
+
+  log_step("Writing outputs");
+  if (!selective || options.partial_master) {
+    const auto master_path = mix_dir / score.outputs.master;
+    write_jobs.push_back(scheduler.Submit([master_path, written_counter, &rendered]() {
       std::string error;
       if (!aurora::io::WriteWavFloat32(master_path, rendered.master, rendered.metadata.sample_rate, &error)) {
         return std::optional<std::string>(error);
       }
+      CountWrittenBytes(master_path, written_counter);
       return std::optional<std::string>{};
     }));
   }
   {
-    const aurora::core::TempoMap tempo_map = aurora::core::BuildTempoMap(parse.file.globals);
+    const aurora::core::TempoMap tempo_map = aurora::core::BuildTempoMap(score.globals);
     const auto midi_path = midi_dir / "arrangement.mid";
-    write_jobs.push_back(std::async(std::launch::async, [midi_path, &rendered, tempo_map]() {
+    write_jobs.push_back(scheduler.Submit([midi_path, written_counter, &rendered, tempo_map]() {
       std::string error;
       if (!aurora::io::WriteMidiFormat1(midi_path, rendered.midi_tracks, tempo_map, rendered.metadata.total_samples,
                                         rendered.metadata.sample_rate, &error)) {
         return std::optional<std::string>(error);
       }
+      CountWrittenBytes(midi_path, written_counter);
       return std::optional<std::string>{};
     }));
   }
   {
-    const auto meta_path = meta_dir / parse.file.outputs.render_json;
-    write_jobs.push_back(std::async(std::launch::async, [meta_path, &rendered]() {
+    const auto meta_path = meta_dir / score.outputs.render_json;
+    write_jobs.push_back(scheduler.Submit([meta_path, written_counter, &rendered]() {
       std::string error;
       if (!aurora::io::WriteRenderJson(meta_path, rendered, &error)) {
         return std::optional<std::string>(error);
       }
+      CountWrittenBytes(meta_path, written_counter);
       return std::optional<std::string>{};
     }));
   }
+  // The master is analyzed while the last files are still being written.
+  std::optional<aurora::core::AnalysisReport> analyzed_render;
+  if (analysis_session) {
+    log_step("Running integrated analysis");
+    analyzed_render = analysis_session->Finish(rendered);
+    analysis_session.reset();
+  }
+  // Every write is waited for before returning: the jobs read `rendered` and its stems.
+  std::optional<std::string> write_error;
   for (auto& job : write_jobs) {
-    const std::optional<std::string> maybe_error = job.get();
-    if (maybe_error.has_value()) {
-      std::cerr << "I/O error: " << *maybe_error << "\n";
-      return 6;
+    std::optional<std::string> maybe_error = scheduler.Wait(job);
+    if (maybe_error.has_value() && !write_error.has_value()) {
+      write_error = std::move(maybe_error);
     }
   }
+  if (write_error.has_value()) {
+    streams.err << "I/O error: " << *write_error << "\n";
+    return 6;
+  }
 
   std::optional<std::filesystem::path> analysis_path;
   if (options.analyze) {
-    log_step("Running integrated analysis");
-    aurora::core::AnalysisOptions analysis_options;
-    analysis_options.max_parallel_jobs = options.analyze_threads;
-    analysis_options.intent = options.intent;
-    aurora::core::AnalysisReport report = aurora::core::AnalyzeRender(rendered, analysis_options);
-    const std::filesystem::path out_path = options.analysis_out.value_or(meta_dir / "analysis.json");
-    const std::filesystem::path analysis_root = out_path.parent_path();
-    ResolvedSpectrogramProfile spectrogram_profile;
-    std::string spectrogram_error;
-    if (!BuildSpectrogramProfileConfig(rendered.metadata.sample_rate, options.spectrogram_config_json,
-                                       options.spectrogram_profile, options.spectrogram_width_px,
-                                       options.spectrogram_row_height_px, options.spectrogram_header_height_px,
-                                       options.spectrogram_indexed_palette,
-                                       &spectrogram_profile, &spectrogram_error)) {
-      std::cerr << "Argument error: " << spectrogram_error << "\n";
+    if (!spectrogram_error.empty()) {
+      streams.err << "Argument error: " << spectrogram_error << "\n";
       return 2;
     }
     const aurora::core::SpectrogramConfig& spectrogram_config = spectrogram_profile.config;
+    aurora::core::AnalysisReport report = std::move(*analyzed_render);
+    const std::filesystem::path out_path = options.analysis_out.value_or(meta_dir / "analysis.json");
+    const std::filesystem::path analysis_root = out_path.parent_path();
     if (!options.spectrogram) {
       MarkSpectrogramDisabled(&report.mix, spectrogram_config, rendered.metadata.sample_rate);
       for (auto& stem_analysis : report.stems) {
@@ -2050,43 +3158,1048 @@ int main(int argc, char** argv) {
     } else {
       const bool composite_enabled = options.spectrogram_composite == "stacked_headers";
       const bool write_individual = options.spectrogram_separate;
-      if (!composite_enabled && !write_individual) {
+      if (!composite_enabled && !write_individual && !options.spectrogram_tiles) {
         report.mix.spectrogram.present = false;
         for (auto& stem_analysis : report.stems) {
           stem_analysis.spectrogram.present = false;
         }
       } else {
-      std::vector<aurora::core::AudioStem> rendered_stems;
-      rendered_stems.reserve(rendered.patch_stems.size() + rendered.bus_stems.size());
-      rendered_stems.insert(rendered_stems.end(), rendered.patch_stems.begin(), rendered.patch_stems.end());
-      rendered_stems.insert(rendered_stems.end(), rendered.bus_stems.begin(), rendered.bus_stems.end());
+      std::vector<SpectrogramSource> spectrogram_targets;
+      spectrogram_targets.reserve(rendered.patch_stems.size() + rendered.bus_stems.size() + 1U);
+      spectrogram_targets.push_back(ResidentSpectrogramSource(rendered.master));
+      for (const auto& stem : rendered.patch_stems) {
+        spectrogram_targets.push_back(ResidentSpectrogramSource(stem));
+      }
+      for (const auto& stem : rendered.bus_stems) {
+        spectrogram_targets.push_back(ResidentSpectrogramSource(stem));
+      }
       const std::filesystem::path spectrogram_out =
           options.spectrogram_out.value_or(analysis_root);
-      PopulateSpectrograms(rendered_stems, rendered.master, rendered.metadata.sample_rate, spectrogram_config, spectrogram_out,
+      PopulateSpectrograms(spectrogram_targets, rendered.metadata.sample_rate, spectrogram_config, spectrogram_out,
                            analysis_root, options.analyze_threads, options.spectrogram_composite,
                            options.spectrogram_composite_out, write_individual, spectrogram_profile.header_height_px,
                            spectrogram_profile.profile, spectrogram_profile.indexed_palette,
-                           spectrogram_profile.png_compression_level, &report, "render", start_time);
+                           spectrogram_profile.png_compression_level, SpectrogramTileOptions(options), &report,
+                           "render", start_time, streams.err);
       }
     }
+    if (options.features) {
+      log_step("Writing feature series");
+      ExportFeatureSeries(&report, options.features_out.value_or(analysis_root / "features"), analysis_root);
+    }
+    if (report.masking.present) {
+      log_step("Writing masking windows");
+      ExportMaskingWindows(&report, analysis_root / "masking", analysis_root);
+    }
     std::string error;
     if (!aurora::io::WriteAnalysisJson(out_path, report, &error)) {
-      std::cerr << "I/O error: " << error << "\n";
+      streams.err << "I/O error: " << error << "\n";
       return 6;
     }
     analysis_path = out_path;
-    std::cout << "  mix_lufs: " << report.mix.loudness.integrated_lufs << "\n";
-    std::cout << "  transients_per_minute: " << report.mix.transient.transients_per_minute << "\n";
+    streams.out << "  mix_lufs: " << report.mix.loudness.integrated_lufs << "\n";
+    streams.out << "  transients_per_minute: " << report.mix.transient.transients_per_minute << "\n";
   }
 
   log_step("Done");
-  std::cout << "Render complete\n";
-  std::cout << "  sample_rate: " << rendered.metadata.sample_rate << "\n";
-  std::cout << "  total_samples: " << rendered.metadata.total_samples << "\n";
-  std::cout << "  stems: " << rendered.patch_stems.size() + rendered.bus_stems.size() << "\n";
-  std::cout << "  midi_tracks: " << rendered.midi_tracks.size() << "\n";
+  if (progress_json.has_value()) {
+    progress_json->Finish();
+  }
+  streams.out << "Render complete\n";
+  streams.out << "  sample_rate: " << rendered.metadata.sample_rate << "\n";
+  streams.out << "  total_samples: " << rendered.metadata.total_samples << "\n";
+  streams.out << "  stems: " << rendered.patch_stems.size() + rendered.bus_stems.size() << "\n";
+  streams.out << "  midi_tracks: " << rendered.midi_tracks.size() << "\n";
+  if (rendered.master_loudness.measured) {
+    streams.out << "  master_lufs: " << rendered.master_loudness.integrated_lufs << "\n";
+    streams.out << "  master_lra: " << rendered.master_loudness.lra << "\n";
+    streams.out << "  master_true_peak_dbtp: " << rendered.master_loudness.true_peak_dbtp << "\n";
+  }
   if (analysis_path.has_value()) {
-    std::cout << "  analysis: " << analysis_path->string() << "\n";
+    streams.out << "  analysis: " << analysis_path->string() << "\n";
+  }
+  return 0;
+}
+
+// A score parsed for rendering and the .au file it came from.
+struct LoadedScore {
+  std::filesystem::path au_file;
+  aurora::lang::AuroraFile score;
+};
+
+// Loads the score of a render and each further file of a batch, in command-line order. Returns 0, or the exit code of
+// the first file that fails to load (see LoadScore).
+int LoadRenderScores(const std::filesystem::path& au_file, const RenderCliOptions& options,
+                     const std::function<void(const std::string&)>& log_step, std::ostream& diagnostics,
+                     std::vector<LoadedScore>* scores) {
+  std::vector<std::filesystem::path> files{au_file};
+  files.insert(files.end(), options.extra_files.begin(), options.extra_files.end());
+  scores->clear();
+  scores->reserve(files.size());
+  for (const auto& file : files) {
+    LoadedScore loaded;
+    loaded.au_file = file;
+    if (const int load_status = LoadScore(file, log_step, diagnostics, &loaded.score, nullptr); load_status != 0) {
+      return load_status;
+    }
+    scores->push_back(std::move(loaded));
+  }
+  return 0;
+}
+
+// A batch render: every score is rendered once per seed (or with --seed when no --seeds is given). Each variant
+// writes a full set of outputs under `<file stem>/seed-<N>` (only the parts that vary): inside --out when given, else
+// inside each of the score's output directories. Variants of a score run one after another on the shared scheduler
+// and share one RenderCache, so stems that do not depend on the seed render only for the first variant.
+int RunRenderBatch(const std::vector<LoadedScore>& scores, const RenderCliOptions& options,
+                   const std::chrono::steady_clock::time_point& start_time, const CommandStreams& streams) {
+  auto log_step = [&](const std::string& msg) {
+    streams.err << "[aurora +" << FormatElapsed(start_time) << "] " << msg << "\n";
+  };
+  const std::vector<uint64_t> seeds = options.seeds.empty() ? std::vector<uint64_t>{options.seed} : options.seeds;
+  for (const auto& [file, score] : scores) {
+    aurora::core::RenderCache cache;
+    for (const uint64_t seed : seeds) {
+      std::filesystem::path variant;
+      if (scores.size() > 1U) {
+        variant /= file.stem();
+      }
+      if (!options.seeds.empty()) {
+        variant /= "seed-" + std::to_string(seed);
+      }
+      RenderOutputDirs dirs = ResolveRenderOutputDirs(
+          score.outputs, file,
+          options.out_root.has_value() ? std::optional<std::filesystem::path>(*options.out_root / variant)
+                                       : std::nullopt);
+      if (!options.out_root.has_value()) {
+        dirs = RenderOutputDirs{dirs.stems / variant, dirs.midi / variant, dirs.mix / variant, dirs.meta / variant};
+      }
+      RenderCliOptions variant_options = options;
+      variant_options.seed = seed;
+      log_step("Variant " + variant.generic_string());
+      if (const int status = RenderLoadedScore(score, dirs, variant_options, &cache, start_time, streams);
+          status != 0) {
+        return status;
+      }
+    }
   }
+  log_step("Batch done: " + std::to_string(scores.size() * seeds.size()) + " renders");
   return 0;
 }
+
+// Renders scores loaded by LoadRenderScores: a single render, or a batch with --seeds or several files.
+int RenderLoadedScores(const std::vector<LoadedScore>& scores, const RenderCliOptions& options,
+                       const std::chrono::steady_clock::time_point& start_time, const CommandStreams& streams) {
+  if (!options.seeds.empty() || scores.size() > 1U) {
+    return RunRenderBatch(scores, options, start_time, streams);
+  }
+  const LoadedScore& loaded = scores.front();
+  const RenderOutputDirs dirs = ResolveRenderOutputDirs(loaded.score.outputs, loaded.au_file, options.out_root);
+  return RenderLoadedScore(loaded.score, dirs, options, nullptr, start_time, streams);
+}
+
+int RunRenderCommand(const std::filesystem::path& au_file, const RenderCliOptions& options,
+                     const std::chrono::steady_clock::time_point& start_time, const CommandStreams& streams) {
+  auto log_step = [&](const std::string& msg) {
+    streams.err << "[aurora +" << FormatElapsed(start_time) << "] " << msg << "\n";
+  };
+  std::vector<LoadedScore> scores;
+  if (const int load_status = LoadRenderScores(au_file, options, log_step, streams.err, &scores); load_status != 0) {
+    return load_status;
+  }
+  return RenderLoadedScores(scores, options, start_time, streams);
+}
+
+// `aurora watch` polls the sources of the score this often.
+constexpr std::chrono::milliseconds kWatchPollInterval{200};
+
+// Modification time and size of each watched source that exists.
+using SourceStamps = std::map<std::filesystem::path, std::pair<std::filesystem::file_time_type, uintmax_t>>;
+
+SourceStamps StampSources(const std::vector<std::filesystem::path>& sources) {
+  SourceStamps stamps;
+  for (const auto& path : sources) {
+    std::error_code time_ec;
+    std::error_code size_ec;
+    const auto time = std::filesystem::last_write_time(path, time_ec);
+    const uintmax_t size = std::filesystem::file_size(path, size_ec);
+    if (!time_ec && !size_ec) {
+      stamps[path] = {time, size};
+    }
+  }
+  return stamps;
+}
+
+// Writes an output through `write` to a file beside `path` and moves it over `path` only when the bytes differ, so an
+// unchanged output keeps its file and modification time.
+bool ReplaceIfChanged(const std::filesystem::path& path,
+                      const std::function<bool(const std::filesystem::path&, std::string*)>& write, bool* changed,
+                      std::string* error) {
+  std::filesystem::path staged = path;
+  staged += ".tmp";
+  if (!write(staged, error)) {
+    return false;
+  }
+  std::string before;
+  std::string after;
+  *changed = !ReadFile(path, &before, nullptr) || !ReadFile(staged, &after, nullptr) || before != after;
+  std::error_code ec;
+  if (*changed) {
+    std::filesystem::rename(staged, path, ec);
+  } else {
+    std::filesystem::remove(staged, ec);
+  }
+  if (ec) {
+    *error = "Failed to replace " + path.string() + ": " + ec.message();
+    return false;
+  }
+  return true;
+}
+
+// `aurora watch`: keeps the stems of the last render in a RenderCache and re-renders whenever the score or one of its
+// imports changes. Only patches whose definition, plays or automation changed are rendered again, then the buses they
+// feed and the master; stem files whose stem was reused are not rewritten, and MIDI and render.json are only replaced
+// when their bytes change.
+class RenderWatcher {
+ public:
+  RenderWatcher(std::filesystem::path au_file, const RenderCliOptions& options,
+                std::chrono::steady_clock::time_point start_time)
+      : au_file_(std::move(au_file)), options_(options), start_time_(start_time) {
+    render_options_ = BuildRenderOptions(options_);
+    render_options_.cache = &cache_;
+  }
+
+  // Loads and renders the score once. A score that fails to load leaves the previous outputs in place.
+  void RunPass() {
+    const auto pass_start = std::chrono::steady_clock::now();
+    const auto log_step = [this](const std::string& message) { Log(message); };
+    aurora::lang::AuroraFile score;
+    const int load_status = LoadScore(au_file_, log_step, std::cerr, &score, &sources_);
+    stamps_ = StampSources(sources_);
+    if (load_status != 0) {
+      Log("Keeping the previous outputs until the score loads again");
+      return;
+    }
+    Log(options_.draft ? "Rendering audio/MIDI (draft)" : "Rendering audio/MIDI");
+    const aurora::core::RenderResult rendered = renderer_.Render(score, render_options_);
+    for (const auto& warning : rendered.warnings) {
+      std::cerr << "warning: " << warning << "\n";
+    }
+    std::string rerendered;
+    size_t rerendered_count = 0;
+    for (size_t i = 0; i < rendered.stems_reused.size(); ++i) {
+      if (!rendered.stems_reused[i]) {
+        rerendered += (rerendered_count++ == 0 ? "" : ", ") + StemAt(rendered, i).name;
+      }
+    }
+    Log("Rendered " + std::to_string(rerendered_count) + " of " + std::to_string(rendered.stems_reused.size()) +
+        " stems" + (rerendered.empty() ? "" : " (" + rerendered + ")") + " in " +
+        FormatSeconds(std::chrono::duration<double>(std::chrono::steady_clock::now() - pass_start).count()));
+
+    std::vector<std::filesystem::path> written;
+    std::string error;
+    if (!WriteOutputs(score, rendered, &written, &error)) {
+      std::cerr << "I/O error: " << error << "\n";
+      return;
+    }
+    std::string written_list;
+    for (const auto& path : written) {
+      written_list += (written_list.empty() ? "" : ", ") + path.filename().string();
+    }
+    Log(written.empty() ? "Outputs unchanged" : "Wrote " + written_list);
+    if (rendered.master_loudness.measured) {
+      std::cout << "  master_lufs: " << rendered.master_loudness.integrated_lufs << "\n";
+      std::cout << "  master_true_peak_dbtp: " << rendered.master_loudness.true_peak_dbtp << std::endl;
+    }
+  }
+
+  // Returns once a watched source has changed and then stayed unchanged for one poll interval, since editors may
+  // save a file in several writes.
+  void WaitForChange() {
+    SourceStamps current = stamps_;
+    while (current == stamps_) {
+      std::this_thread::sleep_for(kWatchPollInterval);
+      current = StampSources(sources_);
+    }
+    SourceStamps settled;
+    do {
+      settled = current;
+      std::this_thread::sleep_for(kWatchPollInterval);
+      current = StampSources(sources_);
+    } while (current != settled);
+    for (const auto& path : sources_) {
+      const auto before = stamps_.find(path);
+      const auto after = current.find(path);
+      if ((before == stamps_.end()) != (after == current.end()) ||
+          (before != stamps_.end() && before->second != after->second)) {
+        Log("Changed: " + path.string());
+      }
+    }
+  }
+
+ private:
+  static const aurora::core::AudioStem& StemAt(const aurora::core::RenderResult& rendered, size_t index) {
+    const size_t patch_count = rendered.patch_stems.size();
+    return index < patch_count ? rendered.patch_stems[index] : rendered.bus_stems[index - patch_count];
+  }
+
+  void Log(const std::string& message) const {
+    std::cerr << "[aurora +" << FormatElapsed(start_time_) << "] " << message << "\n";
+  }
+
+  bool WriteOutputs(const aurora::lang::AuroraFile& score, const aurora::core::RenderResult& rendered,
+                    std::vector<std::filesystem::path>* written, std::string* error) {
+    const RenderOutputDirs dirs = ResolveRenderOutputDirs(score.outputs, au_file_, options_.out_root);
+    aurora::core::TaskScheduler& scheduler = aurora::core::TaskScheduler::Global();
+    std::vector<std::future<std::optional<std::string>>> jobs;
+    const auto write_wav = [&](const std::filesystem::path& path, const aurora::core::AudioStem* stem) {
+      written->push_back(path);
+      jobs.push_back(scheduler.Submit([path, stem, sample_rate = rendered.metadata.sample_rate]() {
+        std::string write_error;
+        if (!aurora::io::WriteWavFloat32(path, *stem, sample_rate, &write_error)) {
+          return std::optional<std::string>(write_error);
+        }
+        return std::optional<std::string>{};
+      }));
+    };
+
+    // A stem file is current when the previous pass wrote the same patch or bus to it and the stem was reused.
+    std::map<std::filesystem::path, std::string> stem_files;
+    std::vector<std::string> mixed;
+    bool any_rendered = false;
+    for (size_t i = 0; i < rendered.stems_reused.size(); ++i) {
+      const size_t patch_count = rendered.patch_stems.size();
+      const std::string key =
+          i < patch_count ? "patch:" + score.patches[i].name : "bus:" + score.buses[i - patch_count].name;
+      const aurora::core::AudioStem& stem = StemAt(rendered, i);
+      const std::filesystem::path path = dirs.stems / (stem.name + ".wav");
+      const auto previous = stem_files_.find(path);
+      if (!rendered.stems_reused[i] || previous == stem_files_.end() || previous->second != key ||
+          !std::filesystem::exists(path)) {
+        write_wav(path, &stem);
+      }
+      any_rendered = any_rendered || !rendered.stems_reused[i];
+      stem_files[path] = key;
+      mixed.push_back(key);
+    }
+    const std::filesystem::path master_path = dirs.mix / score.outputs.master;
+    if (any_rendered || master_path != master_file_ || mixed != master_stems_ || !std::filesystem::exists(master_path)) {
+      write_wav(master_path, &rendered.master);
+    }
+
+    // MIDI and render.json are small, so they are compared byte for byte instead of tracked.
+    bool ok = true;
+    bool changed = false;
+    const std::filesystem::path midi_path = dirs.midi / "arrangement.mid";
+    const aurora::core::TempoMap tempo_map = aurora::core::BuildTempoMap(score.globals);
+    ok = ReplaceIfChanged(
+        midi_path,
+        [&](const std::filesystem::path& path, std::string* write_error) {
+          return aurora::io::WriteMidiFormat1(path, rendered.midi_tracks, tempo_map, rendered.metadata.total_samples,
+                                              rendered.metadata.sample_rate, write_error);
+        },
+        &changed, error);
+    if (ok && changed) {
+      written->push_back(midi_path);
+    }
+    const std::filesystem::path meta_path = dirs.meta / score.outputs.render_json;
+    ok = ok && ReplaceIfChanged(
+                   meta_path,
+                   [&](const std::filesystem::path& path, std::string* write_error) {
+                     return aurora::io::WriteRenderJson(path, rendered, write_error);
+                   },
+                   &changed, error);
+    if (ok && changed) {
+      written->push_back(meta_path);
+    }
+    for (auto& job : jobs) {
+      const std::optional<std::string> maybe_error = scheduler.Wait(job);
+      if (maybe_error.has_value() && ok) {
+        *error = *maybe_error;
+        ok = false;
+      }
+    }
+    if (!ok) {
+      // Nothing on disk can be trusted to match a stem any more; the next pass rewrites everything.
+      stem_files_.clear();
+      master_file_.clear();
+      return false;
+    }
+    stem_files_ = std::move(stem_files);
+    master_file_ = master_path;
+    master_stems_ = std::move(mixed);
+    return true;
+  }
+
+  const std::filesystem::path au_file_;
+  const RenderCliOptions options_;
+  const std::chrono::steady_clock::time_point start_time_;
+  aurora::core::Renderer renderer_;
+  aurora::core::RenderCache cache_;
+  aurora::core::RenderOptions render_options_;
+  std::vector<std::filesystem::path> sources_;
+  SourceStamps stamps_;
+  // What the last successful pass left on disk: the patch or bus in each stem file and the stems mixed into the
+  // master file, in mix order.
+  std::map<std::filesystem::path, std::string> stem_files_;
+  std::filesystem::path master_file_;
+  std::vector<std::string> master_stems_;
+};
+
+int RunWatchCommand(const std::filesystem::path& au_file, const RenderCliOptions& options,
+                    const std::chrono::steady_clock::time_point& start_time) {
+  RenderWatcher watcher(au_file, options, start_time);
+  std::cerr << "[aurora +" << FormatElapsed(start_time) << "] Watching " << au_file.string()
+            << " and its imports; press Ctrl-C to stop\n";
+  while (true) {
+    watcher.RunPass();
+    watcher.WaitForChange();
+  }
+}
+
+struct ServeCliOptions {
+  std::filesystem::path socket_path;
+  int threads = 0;
+  int jobs = 1;
+  uint64_t memory_mb = 0;  // 0: no memory budget
+};
+
+bool ParseServeArgs(int argc, char** argv, ServeCliOptions* options, std::string* error) {
+  for (int i = 2; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) {
+      *error = arg.rfind("--", 0) == 0 ? "Expected value after " + arg : "Unknown argument: " + arg;
+      return false;
+    }
+    const std::string value = argv[++i];
+    if (arg == "--socket") {
+      options->socket_path = value;
+      continue;
+    }
+    int number = 0;
+    try {
+      number = std::stoi(value);
+    } catch (const std::exception&) {
+      *error = "Invalid " + arg + " value: " + value;
+      return false;
+    }
+    if (arg == "--threads") {
+      options->threads = number;
+    } else if (arg == "--jobs" && number >= 1) {
+      options->jobs = number;
+    } else if (arg == "--memory-mb" && number >= 0) {
+      options->memory_mb = static_cast<uint64_t>(number);
+    } else {
+      *error = arg == "--jobs" || arg == "--memory-mb" ? "Invalid " + arg + " value: " + value
+                                                       : "Unknown argument: " + arg;
+      return false;
+    }
+  }
+  if (options->socket_path.empty()) {
+    *error = "serve needs --socket <path>.";
+    return false;
+  }
+  return true;
+}
+
+// One job request of `aurora serve`: a single JSON line such as
+// {"id":"a","priority":1,"command":"render","args":["song.au","--seed","7"]}.
+struct ServeRequest {
+  std::string id;
+  int priority = 0;  // higher runs first
+  std::string command;
+  std::vector<std::string> args;
+};
+
+bool ParseServeRequest(const std::string& json, ServeRequest* request, std::string* error) {
+  size_t pos = 0;
+  SkipWs(json, &pos);
+  if (pos >= json.size() || json[pos] != '{') {
+    *error = "Request must be a JSON object.";
+    return false;
+  }
+  ++pos;
+  bool first = true;
+  while (true) {
+    SkipWs(json, &pos);
+    if (pos < json.size() && json[pos] == '}') {
+      break;
+    }
+    if (!first) {
+      if (pos >= json.size() || json[pos] != ',') {
+        *error = "Expected ',' or '}' in request.";
+        return false;
+      }
+      ++pos;
+      SkipWs(json, &pos);
+    }
+    first = false;
+    std::string key;
+    if (!ParseJsonString(json, &pos, &key, error)) {
+      return false;
+    }
+    SkipWs(json, &pos);
+    if (pos >= json.size() || json[pos] != ':') {
+      *error = "Expected ':' after key '" + key + "' in request.";
+      return false;
+    }
+    ++pos;
+    SkipWs(json, &pos);
+    if (key == "id") {
+      if (!ParseJsonString(json, &pos, &request->id, error)) {
+        return false;
+      }
+    } else if (key == "command") {
+      if (!ParseJsonString(json, &pos, &request->command, error)) {
+        return false;
+      }
+    } else if (key == "priority") {
+      std::string token;
+      if (!ParseJsonNumberToken(json, &pos, &token, error) ||
+          !ParseIntegerToken(token, &request->priority, error, key)) {
+        return false;
+      }
+    } else if (key == "args") {
+      if (pos >= json.size() || json[pos] != '[') {
+        *error = "args must be an array of strings.";
+        return false;
+      }
+      ++pos;
+      SkipWs(json, &pos);
+      if (pos < json.size() && json[pos] == ']') {
+        ++pos;
+        continue;
+      }
+      while (true) {
+        std::string arg;
+        if (!ParseJsonString(json, &pos, &arg, error)) {
+          return false;
+        }
+        request->args.push_back(std::move(arg));
+        SkipWs(json, &pos);
+        if (pos >= json.size()) {
+          *error = "Unterminated args array in request.";
+          return false;
+        }
+        if (json[pos] == ']') {
+          ++pos;
+          break;
+        }
+        if (json[pos] != ',') {
+          *error = "Expected ',' or ']' in args.";
+          return false;
+        }
+        ++pos;
+        SkipWs(json, &pos);
+      }
+    } else {
+      *error = "Unknown request key: " + key;
+      return false;
+    }
+  }
+  if (request->command != "render" && request->command != "analyze") {
+    *error = "command must be \"render\" or \"analyze\".";
+    return false;
+  }
+  return true;
+}
+
+// Limits on a serve connection: the request line it may send, how long it may take to send it, and how many
+// connections may be open at once (queued and running jobs included).
+constexpr size_t kMaxServeRequestBytes = 64U * 1024U;
+constexpr int kServeRequestTimeoutSeconds = 10;
+constexpr size_t kMaxServeConnections = 256U;
+
+// Client end of one `aurora serve` connection. Events are written whole under a lock, so lines from the job thread and
+// renderer threads never interleave; once the client has gone, further events are dropped and the job still finishes.
+class ServeConnection {
+ public:
+  explicit ServeConnection(int fd) : fd_(fd) {}
+  ~ServeConnection() {
+#if !defined(_WIN32)
+    ::close(fd_);
+#endif
+  }
+  ServeConnection(const ServeConnection&) = delete;
+  ServeConnection& operator=(const ServeConnection&) = delete;
+
+  // Reads up to the first newline (or the end of the stream) into *line. A request longer than
+  // kMaxServeRequestBytes, or one that stalls for kServeRequestTimeoutSeconds, fails with *error set; anything sent
+  // after the newline is ignored.
+  bool ReadLine(std::string* line, std::string* error) {
+#if !defined(_WIN32)
+    timeval timeout{};
+    timeout.tv_sec = kServeRequestTimeoutSeconds;
+    ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    std::array<char, 4096> chunk{};
+    while (true) {
+      const ssize_t n = ::recv(fd_, chunk.data(), chunk.size(), 0);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        *error = "No request line within " + std::to_string(kServeRequestTimeoutSeconds) + " s.";
+        return false;
+      }
+      if (n <= 0) {
+        break;
+      }
+      const char* begin = chunk.data();
+      const char* end = std::find(begin, begin + n, '\n');
+      line->append(begin, end);
+      if (line->size() > kMaxServeRequestBytes) {
+        *error = "Request line longer than " + std::to_string(kMaxServeRequestBytes / 1024U) + " KB.";
+        return false;
+      }
+      if (end != begin + n) {
+        return true;
+      }
+    }
+#endif
+    return !line->empty();
+  }
+
+  void Send(const std::string& line) {
+    std::lock_guard<std::mutex> lock(mutex_);
+#if !defined(_WIN32)
+    size_t sent = 0;
+    while (open_ && sent < line.size()) {
+      const ssize_t n = ::send(fd_, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) {
+        open_ = false;
+      } else {
+        sent += static_cast<size_t>(n);
+      }
+    }
+#endif
+  }
+
+ private:
+  const int fd_;
+  std::mutex mutex_;
+  bool open_ = true;
+};
+
+// Turns a job's stdout and stderr text into events: each complete line is one `log` event, except stderr lines that
+// already are JSON objects (`--progress-json`), which are passed through.
+class JobOutput {
+ public:
+  JobOutput(ServeConnection* connection, std::string id) : connection_(connection), id_(std::move(id)) {}
+
+  void Write(size_t stream, const char* data, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string& pending = pending_[stream];
+    pending.append(data, size);
+    size_t start = 0;
+    for (size_t newline = pending.find('\n'); newline != std::string::npos; newline = pending.find('\n', start)) {
+      EmitLine(stream, pending.substr(start, newline - start));
+      start = newline + 1U;
+    }
+    pending.erase(0, start);
+  }
+
+  void Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t stream = 0; stream < pending_.size(); ++stream) {
+      if (!pending_[stream].empty()) {
+        EmitLine(stream, pending_[stream]);
+        pending_[stream].clear();
+      }
+    }
+  }
+
+ private:
+  void EmitLine(size_t stream, const std::string& line) {
+    if (stream == 1U && !line.empty() && line.front() == '{') {
+      connection_->Send(line + "\n");
+      return;
+    }
+    aurora::io::JsonBuffer out;
+    out.Raw("{\"event\":\"log\",\"id\":").String(id_);
+    out.Raw(",\"stream\":").String(stream == 0U ? "stdout" : "stderr");
+    out.Raw(",\"text\":").String(line).Raw("}\n");
+    connection_->Send(out.str());
+  }
+
+  ServeConnection* const connection_;
+  const std::string id_;
+  std::mutex mutex_;
+  std::array<std::string, 2> pending_;  // stdout, stderr
+};
+
+// One of a job's output streams (0: stdout, 1: stderr) as a stream buffer, so the job's CommandStreams can be ordinary
+// ostreams. JobOutput serializes the writes, which may come from any scheduler thread.
+class JobStreamBuf : public std::streambuf {
+ public:
+  JobStreamBuf(JobOutput* job, size_t stream) : job_(job), stream_(stream) {}
+
+ protected:
+  int overflow(int ch) override {
+    if (ch == traits_type::eof()) {
+      return traits_type::not_eof(ch);
+    }
+    const char c = static_cast<char>(ch);
+    job_->Write(stream_, &c, 1U);
+    return ch;
+  }
+  std::streamsize xsputn(const char* data, std::streamsize size) override {
+    job_->Write(stream_, data, static_cast<size_t>(size));
+    return size;
+  }
+
+ private:
+  JobOutput* const job_;
+  const size_t stream_;
+};
+
+// Admission of `aurora serve` jobs: the highest priority job waiting (the oldest among equals) starts once fewer than
+// `max_jobs` run and its estimated memory fits in what the running jobs leave of the budget. A job larger than the
+// whole budget still starts when nothing else runs, so it is never starved.
+class ServeJobQueue {
+ public:
+  ServeJobQueue(size_t max_jobs, uint64_t memory_budget) : max_jobs_(max_jobs), memory_budget_(memory_budget) {}
+
+  // Registers a job; returns its ticket and the number of jobs queued ahead of it.
+  uint64_t Enqueue(int priority, uint64_t memory, size_t* ahead) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Waiting job{priority, next_ticket_++, memory};
+    *ahead = static_cast<size_t>(std::count_if(waiting_.begin(), waiting_.end(),
+                                               [&](const Waiting& other) { return Before(other, job); }));
+    waiting_.push_back(job);
+    return job.ticket;
+  }
+
+  // Blocks until the job may run.
+  void Start(uint64_t ticket) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&]() {
+      const auto head = std::min_element(waiting_.begin(), waiting_.end(), Before);
+      return head->ticket == ticket && running_ < max_jobs_ &&
+             (running_ == 0U || memory_budget_ == 0U || memory_in_use_ + head->memory <= memory_budget_);
+    });
+    const auto it = std::find_if(waiting_.begin(), waiting_.end(),
+                                 [&](const Waiting& job) { return job.ticket == ticket; });
+    memory_in_use_ += it->memory;
+    waiting_.erase(it);
+    ++running_;
+    cv_.notify_all();
+  }
+
+  void Finish(uint64_t memory) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --running_;
+      memory_in_use_ -= memory;
+    }
+    cv_.notify_all();
+  }
+
+ private:
+  struct Waiting {
+    int priority = 0;
+    uint64_t ticket = 0;
+    uint64_t memory = 0;
+  };
+
+  static bool Before(const Waiting& a, const Waiting& b) {
+    return a.priority != b.priority ? a.priority > b.priority : a.ticket < b.ticket;
+  }
+
+  const size_t max_jobs_;
+  const uint64_t memory_budget_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<Waiting> waiting_;
+  uint64_t next_ticket_ = 0;
+  size_t running_ = 0;
+  uint64_t memory_in_use_ = 0;
+};
+
+// Rough peak memory of a render: every stem, the master and, with analysis, about as much again, all stereo float.
+uint64_t EstimateRenderMemory(const aurora::lang::AuroraFile& score, const RenderCliOptions& options) {
+  const aurora::core::RenderPlan plan = aurora::core::Renderer().Plan(score, BuildRenderOptions(options));
+  const uint64_t stems = static_cast<uint64_t>(score.patches.size() + score.buses.size() + 1U);
+  const uint64_t bytes = plan.metadata.total_samples * 2U * sizeof(float) * stems;
+  return options.analyze ? bytes * 2U : bytes;
+}
+
+// Rough peak memory of an analysis: the inputs decoded to float, WAV at twice its file size (16-bit sources) and
+// compressed formats at ten times; streaming analysis keeps little resident.
+uint64_t EstimateAnalyzeMemory(const AnalyzeCliOptions& options) {
+  if (options.streaming) {
+    return 0U;
+  }
+  std::vector<std::filesystem::path> inputs = options.positional;
+  if (options.mix_file.has_value()) {
+    inputs.push_back(*options.mix_file);
+  }
+  uint64_t bytes = 0;
+  for (const auto& path : inputs) {
+    std::error_code ec;
+    const uintmax_t size = std::filesystem::file_size(path, ec);
+    if (!ec) {
+      std::string extension = path.extension().string();
+      std::transform(extension.begin(), extension.end(), extension.begin(),
+                     [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+      bytes += static_cast<uint64_t>(size) * (extension == ".wav" ? 2U : 10U);
+    }
+  }
+  return bytes;
+}
+
+void SendServeEvent(ServeConnection* connection, const std::string& event, const std::string& id,
+                    const std::function<void(aurora::io::JsonBuffer*)>& fields = nullptr) {
+  aurora::io::JsonBuffer out;
+  out.Raw("{\"event\":").String(event).Raw(",\"id\":").String(id);
+  if (fields) {
+    fields(&out);
+  }
+  out.Raw("}\n");
+  connection->Send(out.str());
+}
+
+// Runs one connection of `aurora serve`: reads its request, parses the arguments and estimates memory on this thread,
+// waits for admission, then runs the command here on the shared scheduler. Everything the command prints comes back
+// as events, followed by `done` with its exit code.
+void ServeJob(int fd, ServeJobQueue* queue) {
+  ServeConnection connection(fd);
+  std::string line;
+  ServeRequest request;
+  std::string error;
+  if (!connection.ReadLine(&line, &error) || !ParseServeRequest(line, &request, &error)) {
+    SendServeEvent(&connection, "rejected", request.id, [&](aurora::io::JsonBuffer* out) {
+      out->Raw(",\"error\":").String(error.empty() ? "Empty request." : error);
+    });
+    return;
+  }
+  JobOutput output(&connection, request.id);
+  JobStreamBuf out_buf(&output, 0U);
+  JobStreamBuf err_buf(&output, 1U);
+  std::ostream job_out(&out_buf);
+  std::ostream job_err(&err_buf);
+  const CommandStreams streams{job_out, job_err};
+  const auto finish = [&](int exit_code, const std::chrono::steady_clock::time_point& start) {
+    output.Flush();
+    SendServeEvent(&connection, "done", request.id, [&](aurora::io::JsonBuffer* out) {
+      out->Raw(",\"exit_code\":").Int(exit_code);
+      out->Raw(",\"elapsed_s\":").Number(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    });
+  };
+
+  std::vector<std::string> arg_storage{"aurora", request.command};
+  arg_storage.insert(arg_storage.end(), request.args.begin(), request.args.end());
+  std::vector<char*> argv;
+  for (std::string& arg : arg_storage) {
+    argv.push_back(arg.data());
+  }
+  const int argc = static_cast<int>(argv.size());
+  const auto received = std::chrono::steady_clock::now();
+  std::filesystem::path au_file;
+  RenderCliOptions render_options;
+  std::vector<LoadedScore> scores;
+  AnalyzeCliOptions analyze_options;
+  uint64_t memory = 0;
+  if (request.command == "render") {
+    if (!ParseRenderArgs(argc, argv.data(), &au_file, &render_options, &error)) {
+      job_err << "Argument error: " << error << "\n";
+      finish(2, received);
+      return;
+    }
+    // Progress always comes back as events. The scores are loaded once, here: they size the job and are the ones
+    // rendered, even if a file changes while the job is queued. Batch renders run one after another, so the largest
+    // file sizes the batch.
+    render_options.progress_json = true;
+    const int load_status =
+        LoadRenderScores(au_file, render_options, [](const std::string&) {}, job_err, &scores);
+    if (load_status != 0) {
+      finish(load_status, received);
+      return;
+    }
+    for (const LoadedScore& loaded : scores) {
+      memory = std::max(memory, EstimateRenderMemory(loaded.score, render_options));
+    }
+  } else {
+    if (!ParseAnalyzeArgs(argc, argv.data(), &analyze_options, &error)) {
+      job_err << "Argument error: " << error << "\n";
+      finish(2, received);
+      return;
+    }
+    memory = EstimateAnalyzeMemory(analyze_options);
+  }
+
+  size_t ahead = 0;
+  const uint64_t ticket = queue->Enqueue(request.priority, memory, &ahead);
+  SendServeEvent(&connection, "queued", request.id, [&](aurora::io::JsonBuffer* out) {
+    out->Raw(",\"priority\":").Int(request.priority);
+    out->Raw(",\"ahead\":").UInt(ahead);
+    out->Raw(",\"estimated_memory_bytes\":").UInt(memory);
+  });
+  queue->Start(ticket);
+  const auto started = std::chrono::steady_clock::now();
+  SendServeEvent(&connection, "started", request.id, [&](aurora::io::JsonBuffer* out) {
+    out->Raw(",\"queued_s\":").Number(std::chrono::duration<double>(started - received).count());
+  });
+  int exit_code = 1;
+  try {
+    exit_code = request.command == "render" ? RenderLoadedScores(scores, render_options, started, streams)
+                                            : RunAnalyzeCommand(analyze_options, started, streams);
+  } catch (const std::exception& e) {
+    job_err << "Internal error: " << e.what() << "\n";
+  }
+  finish(exit_code, started);
+  queue->Finish(memory);
+}
+
+// Binds and listens on a Unix domain socket at `path`, replacing a stale socket file left by an earlier server.
+int ListenUnixSocket(const std::filesystem::path& path, std::string* error) {
+#if defined(_WIN32)
+  (void)path;
+  *error = "aurora serve needs Unix domain sockets, which this platform build does not support.";
+  return -1;
+#else
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  const std::string native = path.string();
+  if (native.size() >= sizeof(address.sun_path)) {
+    *error = "Socket path is too long: " + native;
+    return -1;
+  }
+  std::copy(native.begin(), native.end(), address.sun_path);
+  std::error_code ec;
+  if (std::filesystem::is_socket(path, ec)) {
+    std::filesystem::remove(path, ec);
+  }
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    *error = "Failed to create socket.";
+    return -1;
+  }
+  if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 64) != 0) {
+    ::close(fd);
+    *error = "Failed to listen on " + native + " (is the path in use?)";
+    return -1;
+  }
+  return fd;
+#endif
+}
+
+// `aurora serve`: accepts render and analyze jobs on a Unix domain socket and runs them in this process on one shared
+// TaskScheduler, configured by main so that its workers plus the running jobs stay within `options.threads`. Each
+// connection sends one JSON request line and reads NDJSON events back until `done`.
+int RunServeCommand(const ServeCliOptions& options, const std::chrono::steady_clock::time_point& start_time) {
+  std::string error;
+  const int listen_fd = ListenUnixSocket(options.socket_path, &error);
+  if (listen_fd < 0) {
+    std::cerr << "Serve error: " << error << "\n";
+    return 6;
+  }
+  std::cerr << "[aurora +" << FormatElapsed(start_time) << "] Listening on " << options.socket_path.string() << " ("
+            << options.threads << " threads, " << options.jobs << " concurrent jobs"
+            << (options.memory_mb > 0 ? ", " + std::to_string(options.memory_mb) + " MB memory budget" : "")
+            << ")\n";
+  // Connection threads are detached, so the queue lives as long as the process.
+  static ServeJobQueue queue(static_cast<size_t>(options.jobs), options.memory_mb * 1024U * 1024U);
+  static std::atomic<size_t> open_connections{0U};
+#if !defined(_WIN32)
+  while (true) {
+    const int fd = ::accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << "Serve error: accept failed.\n";
+      ::close(listen_fd);
+      return 6;
+    }
+    if (open_connections.load() >= kMaxServeConnections) {
+      ServeConnection connection(fd);
+      SendServeEvent(&connection, "rejected", "", [](aurora::io::JsonBuffer* out) {
+        out->Raw(",\"error\":").String("Too many open connections.");
+      });
+      continue;
+    }
+    open_connections.fetch_add(1U);
+    std::thread([fd]() {
+      ServeJob(fd, &queue);
+      open_connections.fetch_sub(1U);
+    }).detach();
+  }
+#else
+  return 6;
+#endif
+}
+
+int main(int argc, char** argv) {
+  const auto start_time = std::chrono::steady_clock::now();
+
+  if (argc < 2) {
+    PrintUsage();
+    return 2;
+  }
+
+  const std::string command = argv[1];
+  if (command == "analyze") {
+    AnalyzeCliOptions options;
+    std::string cli_error;
+    if (!ParseAnalyzeArgs(argc, argv, &options, &cli_error)) {
+      std::cerr << "Argument error: " << cli_error << "\n";
+      PrintUsage();
+      return 2;
+    }
+    aurora::core::TaskScheduler::Configure(options.threads);
+    return RunAnalyzeCommand(options, start_time, CommandStreams{std::cout, std::cerr});
+  }
+
+  if (command == "watch") {
+    std::filesystem::path au_file;
+    RenderCliOptions options;
+    std::string cli_error;
+    if (!ParseRenderArgs(argc, argv, &au_file, &options, &cli_error)) {
+      std::cerr << "Argument error: " << cli_error << "\n";
+      PrintUsage();
+      return 2;
+    }
+    if (options.analyze || options.dry_run || options.progress_json || !options.seeds.empty() ||
+        !options.extra_files.empty() || !options.only_patches.empty() || !options.only_buses.empty()) {
+      std::cerr << "Argument error: watch renders one whole score and writes stems, master, MIDI and render.json "
+                   "only; analysis, --dry-run, --progress-json, batches and --only need aurora render.\n";
+      return 2;
+    }
+    aurora::core::TaskScheduler::Configure(options.threads);
+    return RunWatchCommand(au_file, options, start_time);
+  }
+
+  if (command == "serve") {
+    ServeCliOptions options;
+    std::string cli_error;
+    if (!ParseServeArgs(argc, argv, &options, &cli_error)) {
+      std::cerr << "Argument error: " << cli_error << "\n";
+      PrintUsage();
+      return 2;
+    }
+    // Each running job's connection thread joins the scheduler as a caller (it runs tasks while it waits), so the
+    // scheduler gets the budget minus the other running jobs and at most one job per budgeted thread may run.
+    options.threads = options.threads > 0 ? options.threads : aurora::core::DefaultThreadCount();
+    options.jobs = std::min(options.jobs, options.threads);
+    aurora::core::TaskScheduler::Configure(options.threads - options.jobs + 1);
+    return RunServeCommand(options, start_time);
+  }
+
+  if (command != "render") {
+    std::cerr << "Unsupported command: " << command << "\n";
+    PrintUsage();
+    return 2;
+  }
+
+  std::filesystem::path au_file;
+  RenderCliOptions options;
+  std::string cli_error;
+  if (!ParseRenderArgs(argc, argv, &au_file, &options, &cli_error)) {
+    std::cerr << "Argument error: " << cli_error << "\n";
+    PrintUsage();
+    return 2;
+  }
+  aurora::core::TaskScheduler::Configure(options.threads);
+
+  return RunRenderCommand(au_file, options, start_time, CommandStreams{std::cout, std::cerr});
+}
@@ -1,19 +1,24 @@
 #include "aurora/core/analyzer.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <complex>
 #include <cstdint>
 #include <ctime>
-#include <atomic>
+#include <future>
 #include <iomanip>
 #include <map>
+#include <mutex>
 #include <numeric>
 #include <sstream>
 #include <string>
-#include <thread>
 #include <vector>
 
+#include "aurora/core/loudness.hpp"
+#include "aurora/core/masking.hpp"
+#include "aurora/core/task_scheduler.hpp"
+
 namespace aurora::core {
 namespace {
 
@@ -55,76 +60,34 @@ std::string NowIso8601Utc() {
   return out.str();
 }
 
-std::vector<float> MixToMono(const AudioStem& stem) {
-  if (stem.channels <= 1) {
-    return stem.samples;
-  }
-  std::vector<float> mono;
-  mono.resize(stem.samples.size() / 2U);
-  for (size_t i = 0, j = 0; i + 1 < stem.samples.size(); i += 2, ++j) {
-    mono[j] = 0.5F * (stem.samples[i] + stem.samples[i + 1]);
-  }
-  return mono;
-}
-
-BasicStats ComputeBasicStats(const std::vector<float>& samples) {
-  BasicStats stats;
-  if (samples.empty()) {
-    return stats;
-  }
+// Peak and energy of a signal fed in sample order; matches a sequential rescan bit for bit.
+struct PeakEnergyAccumulator {
+  double peak = 0.0;
   double sum_sq = 0.0;
-  for (float s : samples) {
+  size_t count = 0;
+
+  void Add(float s) {
     const double v = static_cast<double>(s);
-    const double av = std::fabs(v);
-    stats.peak = std::max(stats.peak, av);
+    peak = std::max(peak, std::fabs(v));
     sum_sq += v * v;
+    ++count;
   }
-  stats.rms = std::sqrt(sum_sq / static_cast<double>(samples.size()));
-  return stats;
-}
-
-void FftInPlace(std::vector<std::complex<double>>* values) {
-  auto& a = *values;
-  const size_t n = a.size();
-  size_t j = 0;
-  for (size_t i = 1; i < n; ++i) {
-    size_t bit = n >> 1;
-    while (j & bit) {
-      j ^= bit;
-      bit >>= 1;
-    }
-    j ^= bit;
-    if (i < j) {
-      std::swap(a[i], a[j]);
-    }
-  }
-
-  for (size_t len = 2; len <= n; len <<= 1) {
-    const double angle = -2.0 * kPi / static_cast<double>(len);
-    const std::complex<double> w_len(std::cos(angle), std::sin(angle));
-    for (size_t i = 0; i < n; i += len) {
-      std::complex<double> w(1.0, 0.0);
-      for (size_t j2 = 0; j2 < len / 2; ++j2) {
-        const std::complex<double> u = a[i + j2];
-        const std::complex<double> v = a[i + j2 + len / 2] * w;
-        a[i + j2] = u + v;
-        a[i + j2 + len / 2] = u - v;
-        w *= w_len;
-      }
-    }
-  }
-}
 
-std::vector<double> BuildHann(int size) {
-  std::vector<double> w(static_cast<size_t>(size), 0.0);
-  if (size <= 1) {
-    return w;
+  void Merge(const PeakEnergyAccumulator& other) {
+    peak = std::max(peak, other.peak);
+    sum_sq += other.sum_sq;
+    count += other.count;
   }
-  for (int i = 0; i < size; ++i) {
-    w[static_cast<size_t>(i)] = 0.5 - 0.5 * std::cos(2.0 * kPi * static_cast<double>(i) / static_cast<double>(size - 1));
+
+  BasicStats Stats() const {
+    BasicStats stats;
+    if (count > 0) {
+      stats.peak = peak;
+      stats.rms = std::sqrt(sum_sq / static_cast<double>(count));
+    }
+    return stats;
   }
-  return w;
-}
+};
 
 size_t BandIndex(double hz) {
   if (hz < 60.0) {
@@ -182,18 +145,37 @@ void AccumulateBand(SpectralRatios* ratios, size_t band, double value) {
   }
 }
 
-FftFrameSummary AnalyzeFftFrame(const std::vector<float>& mono, const std::vector<float>& side, size_t start, int fft_size,
-                                int sample_rate, const std::vector<double>& window, bool have_side) {
+void AddRatios(SpectralRatios* into, const SpectralRatios& from) {
+  into->sub += from.sub;
+  into->low += from.low;
+  into->low_mid += from.low_mid;
+  into->mid += from.mid;
+  into->presence += from.presence;
+  into->high += from.high;
+  into->air += from.air;
+  into->ultra += from.ultra;
+}
+
+struct FftScratch {
+  std::vector<std::complex<double>> bins;
+  std::vector<std::complex<double>> side_bins;
+  std::vector<double> cumulative;
+};
+
+// `mono` and `side` point at fft_size contiguous samples of one STFT frame.
+FftFrameSummary AnalyzeFftFrame(const float* mono, const float* side, int fft_size, int sample_rate,
+                                const std::vector<double>& window, bool have_side, FftScratch* scratch) {
   FftFrameSummary out;
-  std::vector<std::complex<double>> bins(static_cast<size_t>(fft_size));
-  std::vector<std::complex<double>> side_bins(static_cast<size_t>(fft_size));
+  auto& bins = scratch->bins;
+  auto& side_bins = scratch->side_bins;
+  bins.resize(static_cast<size_t>(fft_size));
+  side_bins.resize(static_cast<size_t>(fft_size));
   for (int i = 0; i < fft_size; ++i) {
-    const size_t idx = start + static_cast<size_t>(i);
+    const size_t idx = static_cast<size_t>(i);
     const double sample = static_cast<double>(mono[idx]);
-    bins[static_cast<size_t>(i)] = std::complex<double>(sample * window[static_cast<size_t>(i)], 0.0);
+    bins[idx] = std::complex<double>(sample * window[idx], 0.0);
     if (have_side) {
-      side_bins[static_cast<size_t>(i)] = std::complex<double>(static_cast<double>(side[idx]) * window[static_cast<size_t>(i)],
-                                                               0.0);
+      side_bins[idx] = std::complex<double>(static_cast<double>(side[idx]) * window[idx], 0.0);
     }
   }
   FftInPlace(&bins);
@@ -202,7 +184,8 @@ FftFrameSummary AnalyzeFftFrame(const std::vector<float>& mono, const std::vecto
   }
 
   const size_t half = static_cast<size_t>(fft_size / 2);
-  std::vector<double> cumulative(half, 0.0);
+  auto& cumulative = scratch->cumulative;
+  cumulative.assign(half, 0.0);
   double total_mag = 0.0;
   double weighted_sum = 0.0;
   double geometric_sum = 0.0;
@@ -244,56 +227,99 @@ FftFrameSummary AnalyzeFftFrame(const std::vector<float>& mono, const std::vecto
   return out;
 }
 
-std::vector<double> ComputeShortTermLoudness(const std::vector<float>& mono, int sample_rate) {
-  std::vector<double> values;
-  const size_t win = static_cast<size_t>(std::max(1, sample_rate * 3));
-  const size_t hop = static_cast<size_t>(std::max(1, sample_rate));
-  if (mono.size() < win) {
-    const BasicStats stats = ComputeBasicStats(mono);
-    values.push_back(ToDb(stats.rms) - 0.691);
-    return values;
+// Appends the magnitudes of bins [0, fft_size / 2] of the windowed `mono` frame to `out`, in the same form the
+// spectrogram rasterizer computes them (non-finite samples read as silence). `scratch->bins` is reused when it
+// already holds this frame's transform.
+void AppendFrameMagnitudes(const float* mono, int fft_size, const std::vector<double>& window, bool bins_ready,
+                           FftScratch* scratch, std::vector<float>* out) {
+  const size_t n = static_cast<size_t>(fft_size);
+  bool finite = true;
+  for (size_t i = 0; i < n && finite; ++i) {
+    finite = std::isfinite(mono[i]);
   }
-  for (size_t start = 0; start + win <= mono.size(); start += hop) {
-    double sum_sq = 0.0;
-    for (size_t i = 0; i < win; ++i) {
-      const double v = static_cast<double>(mono[start + i]);
-      sum_sq += v * v;
+  if (!bins_ready || !finite) {
+    auto& bins = scratch->bins;
+    bins.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      const double sample = std::isfinite(mono[i]) ? static_cast<double>(mono[i]) : 0.0;
+      bins[i] = std::complex<double>(sample * window[i], 0.0);
     }
-    const double rms = std::sqrt(sum_sq / static_cast<double>(win));
-    values.push_back(ToDb(rms) - 0.691);
+    FftInPlace(&bins);
   }
-  if (values.empty()) {
-    values.push_back(-120.0);
+  for (size_t k = 0; k <= n / 2U; ++k) {
+    out->push_back(static_cast<float>(std::abs(scratch->bins[k])));
   }
-  return values;
 }
 
-TransientMetrics ComputeTransientMetrics(const std::vector<float>& mono, int sample_rate, double silence_threshold_db) {
-  TransientMetrics out;
-  if (mono.empty() || sample_rate <= 0) {
-    return out;
+// Sums of squares over fixed windows starting every `hop` samples. An instance owns windows [first, end) and is fed
+// consecutive samples by absolute position; each window's sum runs in sample order, so a window gives the same value
+// whichever segment owns it.
+class WindowedEnergy {
+ public:
+  WindowedEnergy(size_t window, size_t hop, size_t first, size_t end)
+      : window_(window), hop_(hop), first_open_(first), next_open_(first), end_(std::max(first, end)) {
+    open_.assign(window_ / hop_ + 2U, 0.0);
+    sums_.reserve(end_ - first_open_);
+  }
+
+  // Number of windows that fit in `total` samples.
+  static size_t WindowCount(size_t window, size_t hop, size_t total) {
+    return (window > 0 && hop > 0 && total >= window) ? (total - window) / hop + 1U : 0U;
   }
-  const size_t frame = 1024;
-  const size_t hop = 512;
-  std::vector<double> energies;
-  energies.reserve(mono.size() / hop + 1U);
-  for (size_t start = 0; start + frame <= mono.size(); start += hop) {
-    double e = 0.0;
-    for (size_t i = 0; i < frame; ++i) {
-      const double v = static_cast<double>(mono[start + i]);
-      e += v * v;
+
+  void Add(const float* samples, size_t count, size_t position) {
+    for (size_t i = 0; i < count && first_open_ < end_; ++i, ++position) {
+      if (next_open_ < end_ && position == next_open_ * hop_) {
+        open_[next_open_ % open_.size()] = 0.0;
+        ++next_open_;
+      }
+      if (first_open_ == next_open_) {
+        continue;
+      }
+      const double v = static_cast<double>(samples[i]);
+      const double v2 = v * v;
+      for (size_t k = first_open_; k < next_open_; ++k) {
+        open_[k % open_.size()] += v2;
+      }
+      if (position + 1U == first_open_ * hop_ + window_) {
+        sums_.push_back(open_[first_open_ % open_.size()]);
+        ++first_open_;
+      }
     }
-    energies.push_back(e / static_cast<double>(frame));
   }
-  if (energies.empty()) {
+
+  std::vector<double>& sums() { return sums_; }
+
+ private:
+  size_t window_ = 0;
+  size_t hop_ = 1;
+  size_t first_open_ = 0;
+  size_t next_open_ = 0;
+  size_t end_ = 0;
+  std::vector<double> open_;
+  std::vector<double> sums_;
+};
+
+// Onset strength of each transient window (the rise in mean energy over the previous one) and the hit threshold,
+// one standard deviation above the mean strength.
+struct OnsetDetection {
+  std::vector<double> strength;
+  double threshold = 0.0;
+};
+
+OnsetDetection DetectOnsets(const std::vector<double>& frame_energy_sums, size_t frame_size) {
+  OnsetDetection out;
+  if (frame_energy_sums.empty()) {
     return out;
   }
-
-  std::vector<double> onset_strength;
-  onset_strength.reserve(energies.size());
+  std::vector<double>& onset_strength = out.strength;
+  onset_strength.reserve(frame_energy_sums.size());
   onset_strength.push_back(0.0);
-  for (size_t i = 1; i < energies.size(); ++i) {
-    onset_strength.push_back(std::max(0.0, energies[i] - energies[i - 1]));
+  double previous = frame_energy_sums[0] / static_cast<double>(frame_size);
+  for (size_t i = 1; i < frame_energy_sums.size(); ++i) {
+    const double energy = frame_energy_sums[i] / static_cast<double>(frame_size);
+    onset_strength.push_back(std::max(0.0, energy - previous));
+    previous = energy;
   }
   const double mean = std::accumulate(onset_strength.begin(), onset_strength.end(), 0.0) /
                       static_cast<double>(onset_strength.size());
@@ -303,7 +329,18 @@ TransientMetrics ComputeTransientMetrics(const std::vector<float>& mono, int sam
     variance += d * d;
   }
   variance /= static_cast<double>(onset_strength.size());
-  const double threshold = mean + std::sqrt(variance);
+  out.threshold = mean + std::sqrt(variance);
+  return out;
+}
+
+TransientMetrics FinishTransientMetrics(const OnsetDetection& onsets, size_t sample_count, size_t silent_count,
+                                        int sample_rate) {
+  TransientMetrics out;
+  if (onsets.strength.empty()) {
+    return out;
+  }
+  const std::vector<double>& onset_strength = onsets.strength;
+  const double threshold = onsets.threshold;
 
   std::vector<double> hits;
   hits.reserve(onset_strength.size());
@@ -322,62 +359,149 @@ TransientMetrics ComputeTransientMetrics(const std::vector<float>& mono, int sam
     out.variance = var / static_cast<double>(hits.size());
   }
 
-  const double duration_minutes = static_cast<double>(mono.size()) / static_cast<double>(sample_rate) / 60.0;
+  const double duration_minutes = static_cast<double>(sample_count) / static_cast<double>(sample_rate) / 60.0;
   if (duration_minutes > 0.0) {
     out.transients_per_minute = static_cast<double>(hits.size()) / duration_minutes;
   }
-
-  const double silence_threshold = std::pow(10.0, silence_threshold_db / 20.0);
-  size_t silent = 0;
-  for (float s : mono) {
-    if (std::fabs(static_cast<double>(s)) < silence_threshold) {
-      ++silent;
-    }
-  }
-  out.silence_percentage = 100.0 * static_cast<double>(silent) / static_cast<double>(mono.size());
-
+  out.silence_percentage = 100.0 * static_cast<double>(silent_count) / static_cast<double>(sample_count);
   return out;
 }
 
-std::vector<float> LowPass(const std::vector<float>& in, int sample_rate, double cutoff_hz) {
-  std::vector<float> out(in.size(), 0.0F);
-  if (in.empty() || sample_rate <= 0 || cutoff_hz <= 0.0) {
-    return out;
-  }
-  const double alpha = std::exp(-2.0 * kPi * cutoff_hz / static_cast<double>(sample_rate));
+// One-pole low-pass y = (1 - alpha) * x + alpha * y, streamed one sample at a time.
+struct OnePoleLowPass {
+  double alpha = 0.0;
   double y = 0.0;
-  for (size_t i = 0; i < in.size(); ++i) {
-    y = (1.0 - alpha) * static_cast<double>(in[i]) + alpha * y;
-    out[i] = static_cast<float>(y);
+
+  OnePoleLowPass(int sample_rate, double cutoff_hz)
+      : alpha(std::exp(-2.0 * kPi * cutoff_hz / static_cast<double>(sample_rate))) {}
+
+  float Process(float x) {
+    y = (1.0 - alpha) * static_cast<double>(x) + alpha * y;
+    return static_cast<float>(y);
   }
-  return out;
-}
+};
+
+// Pearson correlation fed chunk by chunk. Each chunk is reduced with a two-pass mean/co-moment while it is cache
+// resident, then merged into the running totals with the pairwise update of Chan et al., which stays stable without
+// a second walk over the signal.
+struct CorrelationAccumulator {
+  double n = 0.0;
+  double mean_a = 0.0;
+  double mean_b = 0.0;
+  double m2_a = 0.0;
+  double m2_b = 0.0;
+  double c_ab = 0.0;
 
-double Correlation(const std::vector<float>& a, const std::vector<float>& b) {
-  if (a.size() != b.size() || a.empty()) {
-    return 0.0;
+  void AddChunk(const float* a, const float* b, size_t count) {
+    if (count == 0) {
+      return;
+    }
+    CorrelationAccumulator chunk;
+    chunk.n = static_cast<double>(count);
+    double sum_a = 0.0;
+    double sum_b = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+      sum_a += static_cast<double>(a[i]);
+      sum_b += static_cast<double>(b[i]);
+    }
+    chunk.mean_a = sum_a / chunk.n;
+    chunk.mean_b = sum_b / chunk.n;
+    for (size_t i = 0; i < count; ++i) {
+      const double va = static_cast<double>(a[i]) - chunk.mean_a;
+      const double vb = static_cast<double>(b[i]) - chunk.mean_b;
+      chunk.c_ab += va * vb;
+      chunk.m2_a += va * va;
+      chunk.m2_b += vb * vb;
+    }
+    Merge(chunk);
   }
-  double sum_a = 0.0;
-  double sum_b = 0.0;
-  for (size_t i = 0; i < a.size(); ++i) {
-    sum_a += static_cast<double>(a[i]);
-    sum_b += static_cast<double>(b[i]);
+
+  void Merge(const CorrelationAccumulator& other) {
+    if (other.n == 0.0) {
+      return;
+    }
+    if (n == 0.0) {
+      *this = other;
+      return;
+    }
+    const double total = n + other.n;
+    const double da = other.mean_a - mean_a;
+    const double db = other.mean_b - mean_b;
+    const double weight = n * other.n / total;
+    m2_a += other.m2_a + da * da * weight;
+    m2_b += other.m2_b + db * db * weight;
+    c_ab += other.c_ab + da * db * weight;
+    mean_a += da * other.n / total;
+    mean_b += db * other.n / total;
+    n = total;
   }
-  const double mean_a = sum_a / static_cast<double>(a.size());
-  const double mean_b = sum_b / static_cast<double>(b.size());
-  double num = 0.0;
-  double da = 0.0;
-  double db = 0.0;
-  for (size_t i = 0; i < a.size(); ++i) {
-    const double va = static_cast<double>(a[i]) - mean_a;
-    const double vb = static_cast<double>(b[i]) - mean_b;
-    num += va * vb;
-    da += va * va;
-    db += vb * vb;
+
+  double Value() const {
+    if (n == 0.0) {
+      return 0.0;
+    }
+    const double den = std::sqrt(std::max(m2_a * m2_b, kEpsilon));
+    return Clamp(c_ab / den, -1.0, 1.0);
   }
-  const double den = std::sqrt(std::max(da * db, kEpsilon));
-  return Clamp(num / den, -1.0, 1.0);
-}
+};
+
+// Assembles overlapping STFT frames from chunked input and hands each complete frame to `on_frame`.
+class StftFrameAssembler {
+ public:
+  // Frames are emitted after `skip` leading samples, at most `max_frames` of them.
+  StftFrameAssembler(size_t fft_size, size_t hop, bool have_side, size_t skip, size_t max_frames)
+      : fft_size_(fft_size),
+        hop_(hop),
+        have_side_(have_side),
+        skip_(skip),
+        remaining_(max_frames),
+        mono_(fft_size, 0.0F),
+        side_(have_side ? fft_size : 0U, 0.0F) {}
+
+  template <typename OnFrame>
+  void Add(const float* mono, const float* side, size_t count, OnFrame&& on_frame) {
+    size_t i = 0;
+    while (i < count && remaining_ > 0) {
+      if (skip_ > 0) {
+        const size_t n = std::min(skip_, count - i);
+        skip_ -= n;
+        i += n;
+        continue;
+      }
+      const size_t n = std::min(fft_size_ - filled_, count - i);
+      std::copy(mono + i, mono + i + n, mono_.begin() + static_cast<std::ptrdiff_t>(filled_));
+      if (have_side_) {
+        std::copy(side + i, side + i + n, side_.begin() + static_cast<std::ptrdiff_t>(filled_));
+      }
+      filled_ += n;
+      i += n;
+      if (filled_ == fft_size_) {
+        on_frame(mono_.data(), have_side_ ? side_.data() : nullptr);
+        --remaining_;
+        if (hop_ < fft_size_) {
+          std::copy(mono_.begin() + static_cast<std::ptrdiff_t>(hop_), mono_.end(), mono_.begin());
+          if (have_side_) {
+            std::copy(side_.begin() + static_cast<std::ptrdiff_t>(hop_), side_.end(), side_.begin());
+          }
+          filled_ = fft_size_ - hop_;
+        } else {
+          filled_ = 0;
+          skip_ = hop_ - fft_size_;
+        }
+      }
+    }
+  }
+
+ private:
+  size_t fft_size_ = 0;
+  size_t hop_ = 0;
+  bool have_side_ = false;
+  size_t filled_ = 0;
+  size_t skip_ = 0;
+  size_t remaining_ = 0;
+  std::vector<float> mono_;
+  std::vector<float> side_;
+};
 
 std::string DominanceProfile(const SpectralRatios& ratios) {
   std::vector<std::pair<std::string, double>> bands = {
@@ -433,99 +557,606 @@ IntentEvaluation EvaluateIntent(const FileAnalysis& mix, const std::string& inte
   return out;
 }
 
-}  // namespace
+// Fixed time segmentation used for intra-file parallelism. Segment boundaries depend only on the stem length, never
+// on the worker count, so serial and parallel runs merge the same partial states in the same order.
+constexpr size_t kSegmentFrames = size_t{1} << 20;
+constexpr size_t kChunkFrames = 2048;
+constexpr size_t kTransientFrame = 1024;
+constexpr size_t kTransientHop = 512;
+// One-pole filters restart this far before a segment; 2 s takes a 60 Hz pole's start-up error below 1e-300, so the
+// filter state has converged to the serial one by the time the segment's own samples arrive.
+constexpr int kFilterWarmupSeconds = 2;
 
-FileAnalysis AnalyzeStem(const AudioStem& stem, int sample_rate, const AnalysisOptions& options) {
-  FileAnalysis out;
-  out.name = stem.name;
+const std::vector<std::string>& FeatureColumnNames() {
+  static const std::vector<std::string> names = {"centroid_hz",     "rolloff_85_hz", "flatness",       "energy",
+                                                 "energy_sub",      "energy_low",    "energy_low_mid", "energy_mid",
+                                                 "energy_presence", "energy_high",   "energy_air",     "energy_ultra"};
+  return names;
+}
 
-  if (sample_rate <= 0 || stem.channels <= 0 || stem.samples.empty()) {
-    return out;
+// Running sums of one timeline cell, the span between two consecutive window or section edges. A window's metrics
+// merge the cells it covers, so overlapping fixed and section windows share one pass over the audio.
+struct TimelineCell {
+  SpectralRatios energy;
+  double total_energy = 0.0;
+  double centroid_sum = 0.0;
+  size_t frames = 0;
+  CorrelationAccumulator correlation;
+
+  void Merge(const TimelineCell& other) {
+    AddRatios(&energy, other.energy);
+    total_energy += other.total_energy;
+    centroid_sum += other.centroid_sum;
+    frames += other.frames;
+    correlation.Merge(other.correlation);
   }
+};
 
-  const size_t frame_count = stem.samples.size() / static_cast<size_t>(stem.channels);
-  out.duration_seconds = static_cast<double>(frame_count) / static_cast<double>(sample_rate);
+struct StemAnalysisPlan {
+  bool stereo = false;
+  size_t mono_count = 0;
+  size_t segment_count = 0;
+  int fft_size = 0;
+  int hop = 0;
+  // The STFT runs every `stft_hop` samples; every `metric_stride`-th frame feeds the spectral metrics and `wanted`
+  // flags the frames kept as spectrogram magnitudes.
+  int stft_hop = 0;
+  size_t metric_stride = 1;
+  size_t stft_frames = 0;
+  bool capture = false;
+  std::vector<uint8_t> wanted;
+  // BS.1770 loudness is assembled from 100 ms blocks of K-weighted energy.
+  size_t loudness_block = 0;
+  size_t loudness_blocks = 0;
+  size_t transient_windows = 0;
+  size_t filter_warmup = 0;
+  double silence_threshold = 0.0;
+  std::vector<double> window;
+  // Sorted frame positions where a timeline window or section starts or ends, from 0 to mono_count; empty when the
+  // timeline is off. Cell c spans [timeline_edges[c], timeline_edges[c + 1]).
+  size_t timeline_window = 0;
+  std::vector<size_t> timeline_edges;
+};
+
+// One analysis target: resident samples or a source pulled through StreamedAudio::read.
+struct AnalysisTarget {
+  std::string name;
+  int channels = 0;
+  size_t sample_count = 0;  // interleaved samples
+  const AudioStem* stem = nullptr;
+  const StreamedAudio* stream = nullptr;
+};
 
-  std::vector<float> mono = MixToMono(stem);
-  std::vector<float> left;
-  std::vector<float> right;
-  std::vector<float> side;
-  if (stem.channels == 2) {
-    left.resize(frame_count);
-    right.resize(frame_count);
-    side.resize(frame_count);
-    for (size_t i = 0; i < frame_count; ++i) {
-      const float l = stem.samples[i * 2U];
-      const float r = stem.samples[i * 2U + 1U];
-      left[i] = l;
-      right[i] = r;
-      side[i] = 0.5F * (l - r);
+AnalysisTarget ResidentTarget(const AudioStem& stem) {
+  AnalysisTarget target;
+  target.name = stem.name;
+  target.channels = stem.channels;
+  target.sample_count = stem.samples.size();
+  target.stem = &stem;
+  return target;
+}
+
+AnalysisTarget StreamedTarget(const StreamedAudio& stream) {
+  AnalysisTarget target;
+  target.name = stream.name;
+  target.channels = stream.channels;
+  target.sample_count = stream.frame_count * static_cast<size_t>(std::max(stream.channels, 0));
+  target.stream = &stream;
+  return target;
+}
+
+// Resident targets exposed through the streamed-source interface, for passes that read every target in lockstep.
+StreamedAudio TargetSource(const AnalysisTarget& target) {
+  if (target.stream != nullptr) {
+    return *target.stream;
+  }
+  StreamedAudio source;
+  source.name = target.name;
+  source.channels = target.channels;
+  source.frame_count = target.sample_count / static_cast<size_t>(std::max(target.channels, 1));
+  const AudioStem* stem = target.stem;
+  source.read = [stem](size_t first_frame, size_t frame_count, float* out, std::string*) {
+    const size_t channels = static_cast<size_t>(std::max(stem->channels, 1));
+    std::copy_n(stem->samples.begin() + static_cast<std::ptrdiff_t>(first_frame * channels), frame_count * channels, out);
+    return true;
+  };
+  return source;
+}
+
+StemAnalysisPlan PlanStemAnalysis(const AnalysisTarget& target, int sample_rate, const AnalysisOptions& options) {
+  StemAnalysisPlan plan;
+  plan.stereo = target.channels == 2;
+  // Analysis works on the mono fold; non-stereo stems are analyzed as one channel.
+  plan.mono_count = plan.stereo ? target.sample_count / 2U : target.sample_count;
+  plan.segment_count = std::max<size_t>(1U, (plan.mono_count + kSegmentFrames - 1U) / kSegmentFrames);
+  plan.fft_size = std::max(256, options.fft_size);
+  plan.hop = std::max(64, options.fft_hop);
+  plan.stft_hop = plan.hop;
+  const int shared_hop = options.spectrogram_hop;
+  if (!options.spectrogram_widths.empty() && options.spectrogram_window == plan.fft_size &&
+      options.spectrogram_nfft == plan.fft_size && shared_hop > 0 && plan.hop % shared_hop == 0 &&
+      plan.mono_count >= static_cast<size_t>(plan.fft_size)) {
+    plan.capture = true;
+    plan.stft_hop = shared_hop;
+    plan.metric_stride = static_cast<size_t>(plan.hop / shared_hop);
+  }
+  plan.stft_frames = WindowedEnergy::WindowCount(static_cast<size_t>(plan.fft_size), static_cast<size_t>(plan.stft_hop),
+                                                 plan.mono_count);
+  if (plan.capture) {
+    for (const int width : options.spectrogram_widths) {
+      MarkSpectrogramFrames(plan.stft_frames, width, &plan.wanted);
+    }
+  }
+  plan.loudness_block = LoudnessBlockFrames(sample_rate);
+  plan.loudness_blocks = WindowedEnergy::WindowCount(plan.loudness_block, plan.loudness_block, plan.mono_count);
+  plan.transient_windows = WindowedEnergy::WindowCount(kTransientFrame, kTransientHop, plan.mono_count);
+  plan.filter_warmup = static_cast<size_t>(sample_rate) * static_cast<size_t>(kFilterWarmupSeconds);
+  plan.silence_threshold = std::pow(10.0, options.silence_threshold_db / 20.0);
+  plan.window = BuildHann(plan.fft_size);
+  if (options.timeline_window_seconds > 0.0) {
+    plan.timeline_window = std::max<size_t>(
+        1U, static_cast<size_t>(std::llround(options.timeline_window_seconds * static_cast<double>(sample_rate))));
+    for (size_t edge = 0; edge < plan.mono_count; edge += plan.timeline_window) {
+      plan.timeline_edges.push_back(edge);
     }
+    for (const RenderSection& section : options.timeline_sections) {
+      plan.timeline_edges.push_back(std::min<size_t>(plan.mono_count, static_cast<size_t>(section.start_sample)));
+      plan.timeline_edges.push_back(std::min<size_t>(plan.mono_count, static_cast<size_t>(section.end_sample)));
+    }
+    plan.timeline_edges.push_back(plan.mono_count);
+    std::sort(plan.timeline_edges.begin(), plan.timeline_edges.end());
+    plan.timeline_edges.erase(std::unique(plan.timeline_edges.begin(), plan.timeline_edges.end()),
+                              plan.timeline_edges.end());
   }
+  return plan;
+}
 
-  const BasicStats mono_stats = ComputeBasicStats(mono);
+// Timeline cell containing frame `position`.
+size_t TimelineCellAt(const StemAnalysisPlan& plan, size_t position) {
+  const auto it = std::upper_bound(plan.timeline_edges.begin(), plan.timeline_edges.end(), position);
+  return static_cast<size_t>(std::distance(plan.timeline_edges.begin(), it)) - 1U;
+}
+
+// Index range [first, end) of hop-spaced windows (out of `count`) whose start falls in [begin, end_pos).
+std::pair<size_t, size_t> OwnedWindows(size_t begin, size_t end_pos, size_t hop, size_t count) {
+  const size_t first = std::min(count, (begin + hop - 1U) / hop);
+  const size_t last = std::min(count, (end_pos + hop - 1U) / hop);
+  return {first, last};
+}
+
+// Mergeable partial analysis of one time segment. Scalars merge by sum/max; per-window and per-frame series merge by
+// concatenation, so merging segments in order reproduces the serial sequence of values.
+struct StemAnalysisState {
+  PeakEnergyAccumulator mono_energy;
+  PeakEnergyAccumulator sub_energy;
+  PeakEnergyAccumulator low_energy;
+  PeakEnergyAccumulator side_energy;
+  size_t silent = 0;
+  std::vector<double> loudness_blocks;
+  double true_peak = 0.0;
+  std::vector<double> transient_sums;
+  CorrelationAccumulator correlation;
+  CorrelationAccumulator low_correlation;
+  SpectralRatios energy_sum;
+  double total_spectral_energy = 0.0;
+  double high_side_energy = 0.0;
+  double high_total_energy = 0.0;
+  double rolloff_sum = 0.0;
+  double flatness_sum = 0.0;
+  std::vector<double> centroids;
+  std::vector<std::vector<float>> series;
+  std::vector<size_t> spectrum_frames;
+  std::vector<float> spectrum_magnitudes;
+  // Cells [timeline_first, timeline_first + timeline.size()); a cell cut by a segment boundary appears in both
+  // segments and merges.
+  size_t timeline_first = 0;
+  std::vector<TimelineCell> timeline;
+  std::string error;
+
+  void Merge(StemAnalysisState&& later) {
+    if (error.empty()) {
+      error = std::move(later.error);
+    }
+    mono_energy.Merge(later.mono_energy);
+    sub_energy.Merge(later.sub_energy);
+    low_energy.Merge(later.low_energy);
+    side_energy.Merge(later.side_energy);
+    silent += later.silent;
+    loudness_blocks.insert(loudness_blocks.end(), later.loudness_blocks.begin(), later.loudness_blocks.end());
+    true_peak = std::max(true_peak, later.true_peak);
+    transient_sums.insert(transient_sums.end(), later.transient_sums.begin(), later.transient_sums.end());
+    correlation.Merge(later.correlation);
+    low_correlation.Merge(later.low_correlation);
+    AddRatios(&energy_sum, later.energy_sum);
+    total_spectral_energy += later.total_spectral_energy;
+    high_side_energy += later.high_side_energy;
+    high_total_energy += later.high_total_energy;
+    rolloff_sum += later.rolloff_sum;
+    flatness_sum += later.flatness_sum;
+    centroids.insert(centroids.end(), later.centroids.begin(), later.centroids.end());
+    spectrum_frames.insert(spectrum_frames.end(), later.spectrum_frames.begin(), later.spectrum_frames.end());
+    spectrum_magnitudes.insert(spectrum_magnitudes.end(), later.spectrum_magnitudes.begin(),
+                               later.spectrum_magnitudes.end());
+    if (timeline.empty()) {
+      timeline_first = later.timeline_first;
+      timeline = std::move(later.timeline);
+    } else {
+      for (size_t i = 0; i < later.timeline.size(); ++i) {
+        const size_t slot = later.timeline_first + i - timeline_first;
+        if (slot < timeline.size()) {
+          timeline[slot].Merge(later.timeline[i]);
+        } else {
+          timeline.push_back(later.timeline[i]);
+        }
+      }
+    }
+    if (series.size() < later.series.size()) {
+      series.resize(later.series.size());
+    }
+    for (size_t c = 0; c < later.series.size(); ++c) {
+      series[c].insert(series[c].end(), later.series[c].begin(), later.series[c].end());
+    }
+  }
+};
+
+// Walks one segment of the stem once in cache-sized chunks and feeds every accumulator. Sample statistics cover
+// the segment itself; windows and STFT frames that start inside it read past its end; filters warm up before it.
+StemAnalysisState AnalyzeStemSegment(const AnalysisTarget& target, int sample_rate, const AnalysisOptions& options,
+                                     const StemAnalysisPlan& plan, size_t segment) {
+  StemAnalysisState state;
+  const bool stereo = plan.stereo;
+  const size_t seg_begin = std::min(plan.mono_count, segment * kSegmentFrames);
+  const size_t seg_end = std::min(plan.mono_count, seg_begin + kSegmentFrames);
+
+  const size_t stft_hop = static_cast<size_t>(plan.stft_hop);
+  const auto [stft_first, stft_end] = OwnedWindows(seg_begin, seg_end, stft_hop, plan.stft_frames);
+  const auto [loud_first, loud_end] = OwnedWindows(seg_begin, seg_end, plan.loudness_block, plan.loudness_blocks);
+  const auto [trans_first, trans_end] = OwnedWindows(seg_begin, seg_end, kTransientHop, plan.transient_windows);
+  // K-weighted energy per channel; the two channels of a stereo target are summed per block at the end.
+  WindowedEnergy loudness_energy(plan.loudness_block, plan.loudness_block, loud_first, loud_end);
+  WindowedEnergy right_loudness_energy(plan.loudness_block, plan.loudness_block, loud_first, loud_end);
+  WindowedEnergy transient_energy(kTransientFrame, kTransientHop, trans_first, trans_end);
+
+  size_t read_end = seg_end;
+  if (stft_end > stft_first) {
+    read_end = std::max(read_end, (stft_end - 1U) * stft_hop + static_cast<size_t>(plan.fft_size));
+  }
+  if (loud_end > loud_first) {
+    read_end = std::max(read_end, loud_end * plan.loudness_block);
+  }
+  if (trans_end > trans_first) {
+    read_end = std::max(read_end, (trans_end - 1U) * kTransientHop + kTransientFrame);
+  }
+  const size_t read_begin = seg_begin > plan.filter_warmup ? seg_begin - plan.filter_warmup : 0U;
+
+  OnePoleLowPass lp60(sample_rate, 60.0);
+  OnePoleLowPass lp200(sample_rate, 200.0);
+  OnePoleLowPass left_lp200(sample_rate, 200.0);
+  OnePoleLowPass right_lp200(sample_rate, 200.0);
+  KWeightingFilter weighting(sample_rate);
+  KWeightingFilter right_weighting(sample_rate);
+  TruePeakDetector true_peak(sample_rate);
+  TruePeakDetector right_true_peak(sample_rate);
+
+  std::vector<std::vector<float>>* series = nullptr;
+  if (options.keep_feature_series) {
+    state.series.resize(FeatureColumnNames().size());
+    for (auto& column : state.series) {
+      column.reserve((stft_end - stft_first) / plan.metric_stride + 1U);
+    }
+    series = &state.series;
+  }
+  state.centroids.reserve((stft_end - stft_first) / plan.metric_stride + 1U);
+  const bool keep_timeline = !plan.timeline_edges.empty() && seg_end > seg_begin;
+  if (keep_timeline) {
+    state.timeline_first = TimelineCellAt(plan, seg_begin);
+    state.timeline.resize(TimelineCellAt(plan, seg_end - 1U) - state.timeline_first + 1U);
+  }
+  // Cells of the latest STFT frame and sample; both only move forward.
+  size_t frame_cell = state.timeline_first;
+  size_t sample_cell = state.timeline_first;
+
+  FftScratch fft_scratch;
+  StftFrameAssembler stft(static_cast<size_t>(plan.fft_size), stft_hop, stereo, stft_first * stft_hop - seg_begin,
+                          stft_end - stft_first);
+  size_t frame_index = stft_first;
+  const auto on_stft_frame = [&](const float* frame_mono, const float* frame_side) {
+    const size_t index = frame_index++;
+    const bool metric = index % plan.metric_stride == 0;
+    const bool keep = plan.capture && plan.wanted[index] != 0U;
+    if (keep) {
+      state.spectrum_frames.push_back(index);
+    }
+    if (!metric) {
+      if (keep) {
+        AppendFrameMagnitudes(frame_mono, plan.fft_size, plan.window, false, &fft_scratch, &state.spectrum_magnitudes);
+      }
+      return;
+    }
+    const FftFrameSummary frame =
+        AnalyzeFftFrame(frame_mono, frame_side, plan.fft_size, sample_rate, plan.window, stereo, &fft_scratch);
+    if (series != nullptr) {
+      const double values[] = {frame.centroid_hz,      frame.rolloff_85_hz, frame.flatness,     frame.total_energy,
+                               frame.ratios.sub,       frame.ratios.low,    frame.ratios.low_mid, frame.ratios.mid,
+                               frame.ratios.presence,  frame.ratios.high,   frame.ratios.air,   frame.ratios.ultra};
+      for (size_t c = 0; c < series->size(); ++c) {
+        (*series)[c].push_back(static_cast<float>(values[c]));
+      }
+    }
+    AccumulateBand(&state.energy_sum, 0, frame.ratios.sub);
+    AccumulateBand(&state.energy_sum, 1, frame.ratios.low);
+    AccumulateBand(&state.energy_sum, 2, frame.ratios.low_mid);
+    AccumulateBand(&state.energy_sum, 3, frame.ratios.mid);
+    AccumulateBand(&state.energy_sum, 4, frame.ratios.presence);
+    AccumulateBand(&state.energy_sum, 5, frame.ratios.high);
+    AccumulateBand(&state.energy_sum, 6, frame.ratios.air);
+    AccumulateBand(&state.energy_sum, 7, frame.ratios.ultra);
+    state.total_spectral_energy += frame.total_energy;
+    state.centroids.push_back(frame.centroid_hz);
+    state.rolloff_sum += frame.rolloff_85_hz;
+    state.flatness_sum += frame.flatness;
+    state.high_side_energy += frame.high_side_energy;
+    state.high_total_energy += frame.high_total_energy;
+    if (keep_timeline) {
+      while (plan.timeline_edges[frame_cell + 1U] <= index * stft_hop) {
+        ++frame_cell;
+      }
+      TimelineCell& cell = state.timeline[frame_cell - state.timeline_first];
+      AddRatios(&cell.energy, frame.ratios);
+      cell.total_energy += frame.total_energy;
+      cell.centroid_sum += frame.centroid_hz;
+      ++cell.frames;
+    }
+    if (keep) {
+      AppendFrameMagnitudes(frame_mono, plan.fft_size, plan.window, true, &fft_scratch, &state.spectrum_magnitudes);
+    }
+  };
+
+  std::vector<float> mono(kChunkFrames);
+  std::vector<float> side(stereo ? kChunkFrames : 0U);
+  std::vector<float> left(stereo ? kChunkFrames : 0U);
+  std::vector<float> right(stereo ? kChunkFrames : 0U);
+  std::vector<float> left_low(stereo ? kChunkFrames : 0U);
+  std::vector<float> right_low(stereo ? kChunkFrames : 0U);
+  std::vector<float> weighted(kChunkFrames);
+  std::vector<float> right_weighted(stereo ? kChunkFrames : 0U);
+  // Streamed targets are pulled chunk by chunk at the same boundaries resident ones are walked at.
+  std::vector<float> staging(target.stream != nullptr ? kChunkFrames * static_cast<size_t>(target.channels) : 0U);
+  for (size_t begin = read_begin; begin < read_end; begin += kChunkFrames) {
+    const size_t count = std::min(kChunkFrames, read_end - begin);
+    const float* src = nullptr;
+    if (target.stream != nullptr) {
+      if (!target.stream->read(begin, count, staging.data(), &state.error)) {
+        if (state.error.empty()) {
+          state.error = "Failed to read audio for '" + target.name + "'.";
+        }
+        return state;
+      }
+      src = staging.data();
+    } else {
+      src = target.stem->samples.data() + begin * (stereo ? 2U : 1U);
+    }
+    // Part of this chunk that belongs to the segment itself (the rest is filter warm-up or window overlap).
+    const size_t own_begin = std::clamp(seg_begin, begin, begin + count) - begin;
+    const size_t own_end = std::clamp(seg_end, begin, begin + count) - begin;
+    const size_t filter_end = own_end;
+    if (stereo) {
+      for (size_t i = 0; i < count; ++i) {
+        const float l = src[i * 2U];
+        const float r = src[i * 2U + 1U];
+        left[i] = l;
+        right[i] = r;
+        mono[i] = 0.5F * (l + r);
+        side[i] = 0.5F * (l - r);
+      }
+      for (size_t i = 0; i < filter_end; ++i) {
+        left_low[i] = left_lp200.Process(left[i]);
+        right_low[i] = right_lp200.Process(right[i]);
+      }
+      for (size_t i = own_begin; i < own_end; ++i) {
+        state.side_energy.Add(side[i]);
+      }
+      state.correlation.AddChunk(left.data() + own_begin, right.data() + own_begin, own_end - own_begin);
+      state.low_correlation.AddChunk(left_low.data() + own_begin, right_low.data() + own_begin, own_end - own_begin);
+      for (size_t from = own_begin; keep_timeline && from < own_end;) {
+        while (plan.timeline_edges[sample_cell + 1U] <= begin + from) {
+          ++sample_cell;
+        }
+        const size_t to = std::min(own_end, plan.timeline_edges[sample_cell + 1U] - begin);
+        state.timeline[sample_cell - state.timeline_first].correlation.AddChunk(left.data() + from, right.data() + from,
+                                                                                 to - from);
+        from = to;
+      }
+    } else {
+      std::copy_n(src, count, mono.begin());
+    }
+    // Loudness and true peak follow the channels themselves (the mono fold for non-stereo targets). Both run over
+    // the whole chunk: K-weighting state must reach the blocks that end past the segment, and the detectors are
+    // primed by the warm-up so only owned samples are measured.
+    const float* loud_src = stereo ? left.data() : mono.data();
+    weighting.Process(loud_src, count, 1U, weighted.data());
+    true_peak.Process(loud_src, own_begin, 1U, false);
+    true_peak.Process(loud_src + own_begin, own_end - own_begin, 1U, true);
+    if (stereo) {
+      right_weighting.Process(right.data(), count, 1U, right_weighted.data());
+      right_true_peak.Process(right.data(), own_begin, 1U, false);
+      right_true_peak.Process(right.data() + own_begin, own_end - own_begin, 1U, true);
+    }
+
+    for (size_t i = 0; i < filter_end; ++i) {
+      const float m = mono[i];
+      const float sub = lp60.Process(m);
+      const float low = lp200.Process(m);
+      if (i >= own_begin) {
+        state.mono_energy.Add(m);
+        if (std::fabs(static_cast<double>(m)) < plan.silence_threshold) {
+          ++state.silent;
+        }
+        state.sub_energy.Add(sub);
+        state.low_energy.Add(low - sub);
+      }
+    }
+    if (begin + count > seg_begin) {
+      const size_t from = own_begin;
+      loudness_energy.Add(weighted.data() + from, count - from, begin + from);
+      if (stereo) {
+        right_loudness_energy.Add(right_weighted.data() + from, count - from, begin + from);
+      }
+      transient_energy.Add(mono.data() + from, count - from, begin + from);
+      stft.Add(mono.data() + from, stereo ? side.data() + from : nullptr, count - from, on_stft_frame);
+    }
+  }
+
+  state.loudness_blocks = std::move(loudness_energy.sums());
+  if (stereo) {
+    const std::vector<double>& right_blocks = right_loudness_energy.sums();
+    for (size_t i = 0; i < state.loudness_blocks.size() && i < right_blocks.size(); ++i) {
+      state.loudness_blocks[i] += right_blocks[i];
+    }
+  }
+  state.true_peak = std::max(true_peak.peak(), right_true_peak.peak());
+  state.transient_sums = std::move(transient_energy.sums());
+  if (options.frames_processed != nullptr) {
+    options.frames_processed->fetch_add(stft_end - stft_first, std::memory_order_relaxed);
+  }
+  return state;
+}
+
+SpectralRatios NormalizeRatios(const SpectralRatios& energy, double total) {
+  SpectralRatios out;
+  if (total > 0.0) {
+    out.sub = energy.sub / total;
+    out.low = energy.low / total;
+    out.low_mid = energy.low_mid / total;
+    out.mid = energy.mid / total;
+    out.presence = energy.presence / total;
+    out.high = energy.high / total;
+    out.air = energy.air / total;
+    out.ultra = energy.ultra / total;
+  }
+  return out;
+}
+
+// Frames [begin, end) of a target as one timeline window. Spectral and stereo figures merge the cells it covers,
+// loudness summarizes the 100 ms blocks that start inside it, and transient density counts the onset windows that do.
+TimelineWindow SummarizeTimelineWindow(const StemAnalysisPlan& plan, const StemAnalysisState& state,
+                                       const OnsetDetection& onsets, int sample_rate, size_t begin, size_t end) {
+  TimelineWindow out;
+  const double rate = static_cast<double>(sample_rate);
+  out.start_seconds = static_cast<double>(begin) / rate;
+  out.end_seconds = static_cast<double>(end) / rate;
+
+  const auto edge_index = [&plan](size_t position) {
+    return static_cast<size_t>(std::distance(
+        plan.timeline_edges.begin(), std::lower_bound(plan.timeline_edges.begin(), plan.timeline_edges.end(), position)));
+  };
+  TimelineCell merged;
+  for (size_t c = edge_index(begin); c < edge_index(end); ++c) {
+    if (c >= state.timeline_first && c - state.timeline_first < state.timeline.size()) {
+      merged.Merge(state.timeline[c - state.timeline_first]);
+    }
+  }
+  out.ratios = NormalizeRatios(merged.energy, merged.total_energy);
+  if (merged.frames > 0) {
+    out.centroid_hz = merged.centroid_sum / static_cast<double>(merged.frames);
+  }
+  if (plan.stereo) {
+    out.correlation = merged.correlation.Value();
+  }
+
+  const auto [block_first, block_end] = OwnedWindows(begin, end, plan.loudness_block, state.loudness_blocks.size());
+  const std::vector<double> blocks(state.loudness_blocks.begin() + static_cast<std::ptrdiff_t>(block_first),
+                                   state.loudness_blocks.begin() + static_cast<std::ptrdiff_t>(block_end));
+  const LoudnessSummary loudness = SummarizeLoudness(blocks, plan.loudness_block);
+  out.integrated_lufs = loudness.integrated_lufs;
+  out.short_term_max_lufs = loudness.short_term_max_lufs;
+
+  const auto [onset_first, onset_end] = OwnedWindows(begin, end, kTransientHop, onsets.strength.size());
+  size_t hits = 0;
+  for (size_t i = onset_first; i < onset_end; ++i) {
+    if (onsets.strength[i] > onsets.threshold) {
+      ++hits;
+    }
+  }
+  const double minutes = static_cast<double>(end - begin) / rate / 60.0;
+  if (minutes > 0.0) {
+    out.transients_per_minute = static_cast<double>(hits) / minutes;
+  }
+  return out;
+}
+
+AnalysisTimeline FinishTimeline(const StemAnalysisPlan& plan, const StemAnalysisState& state,
+                                const OnsetDetection& onsets, int sample_rate, const AnalysisOptions& options) {
+  AnalysisTimeline out;
+  if (plan.timeline_edges.empty()) {
+    return out;
+  }
+  out.present = true;
+  out.window_seconds = options.timeline_window_seconds;
+  for (size_t begin = 0; begin < plan.mono_count; begin += plan.timeline_window) {
+    out.windows.push_back(SummarizeTimelineWindow(plan, state, onsets, sample_rate, begin,
+                                                  std::min(plan.mono_count, begin + plan.timeline_window)));
+  }
+  for (const RenderSection& section : options.timeline_sections) {
+    const size_t begin = std::min<size_t>(plan.mono_count, static_cast<size_t>(section.start_sample));
+    const size_t end = std::min<size_t>(plan.mono_count, static_cast<size_t>(section.end_sample));
+    if (end <= begin) {
+      continue;
+    }
+    out.sections.push_back(SummarizeTimelineWindow(plan, state, onsets, sample_rate, begin, end));
+    out.sections.back().section = section.name;
+  }
+  return out;
+}
+
+FileAnalysis FinishStemAnalysis(const AnalysisTarget& target, int sample_rate, const AnalysisOptions& options,
+                                const StemAnalysisPlan& plan, StemAnalysisState&& state) {
+  FileAnalysis out;
+  out.name = target.name;
+  out.duration_seconds = static_cast<double>(target.sample_count / static_cast<size_t>(target.channels)) /
+                         static_cast<double>(sample_rate);
+
+  BasicStats mono_stats = state.mono_energy.Stats();
+  if (target.stem != nullptr && target.stem->stats.valid) {
+    mono_stats.peak = target.stem->stats.mono_peak;
+    mono_stats.rms = target.stem->stats.mono_rms();
+  }
   out.peak_db = ToDb(mono_stats.peak);
   out.rms_db = ToDb(mono_stats.rms);
 
   out.loudness.rms_db = out.rms_db;
-  out.loudness.true_peak_dbtp = out.peak_db;
-  out.loudness.integrated_lufs = out.rms_db - 0.691;
-  const std::vector<double> short_term = ComputeShortTermLoudness(mono, sample_rate);
+  out.loudness.true_peak_dbtp = ToDb(state.true_peak);
+  const LoudnessSummary loudness = SummarizeLoudness(state.loudness_blocks, plan.loudness_block);
+  // Signals shorter than one 400 ms gating block fall back to their unweighted level.
+  out.loudness.integrated_lufs = loudness.gated ? loudness.integrated_lufs : out.rms_db - 0.691;
+  out.loudness.momentary_max_lufs = loudness.gated ? loudness.momentary_max_lufs : out.loudness.integrated_lufs;
+  out.loudness.short_term_max_lufs = loudness.gated ? loudness.short_term_max_lufs : out.loudness.integrated_lufs;
+  out.loudness.lra = loudness.lra;
+  std::vector<double> short_term = loudness.short_term_lufs;
+  if (short_term.empty()) {
+    short_term.push_back(out.loudness.short_term_max_lufs);
+  }
   out.loudness.short_term_lufs =
       std::accumulate(short_term.begin(), short_term.end(), 0.0) / static_cast<double>(short_term.size());
-  std::vector<double> sorted_st = short_term;
-  std::sort(sorted_st.begin(), sorted_st.end());
-  const size_t p10 = static_cast<size_t>(0.1 * static_cast<double>(sorted_st.size() - 1));
-  const size_t p95 = static_cast<size_t>(0.95 * static_cast<double>(sorted_st.size() - 1));
-  out.loudness.lra = sorted_st[p95] - sorted_st[p10];
+  if (options.keep_feature_series) {
+    out.series.hop = plan.hop;
+    out.series.fft_size = plan.fft_size;
+    out.series.column_names = FeatureColumnNames();
+    out.series.columns = std::move(state.series);
+    out.series.columns.resize(out.series.column_names.size());
+    out.series.loudness_window = static_cast<int>(plan.loudness_block * 30U);
+    out.series.loudness_hop = static_cast<int>(plan.loudness_block * 10U);
+    out.series.short_term_lufs.assign(short_term.begin(), short_term.end());
+  }
   out.loudness.crest_factor_db = out.peak_db - out.rms_db;
 
-  out.transient = ComputeTransientMetrics(mono, sample_rate, options.silence_threshold_db);
-
-  const int fft_size = std::max(256, options.fft_size);
-  const int hop = std::max(64, options.fft_hop);
-  const std::vector<double> window = BuildHann(fft_size);
-  std::vector<double> centroids;
-  double rolloff_sum = 0.0;
-  double flatness_sum = 0.0;
-  size_t frames = 0;
-  SpectralRatios energy_sum;
-  double total_spectral_energy = 0.0;
-  double high_side_energy = 0.0;
-  double high_total_energy = 0.0;
+  const OnsetDetection onsets = DetectOnsets(state.transient_sums, kTransientFrame);
+  out.transient = FinishTransientMetrics(onsets, plan.mono_count, state.silent, sample_rate);
+  out.timeline = FinishTimeline(plan, state, onsets, sample_rate, options);
 
-  if (mono.size() >= static_cast<size_t>(fft_size)) {
-    for (size_t start = 0; start + static_cast<size_t>(fft_size) <= mono.size(); start += static_cast<size_t>(hop)) {
-      const FftFrameSummary frame = AnalyzeFftFrame(mono, side, start, fft_size, sample_rate, window, stem.channels == 2);
-      AccumulateBand(&energy_sum, 0, frame.ratios.sub);
-      AccumulateBand(&energy_sum, 1, frame.ratios.low);
-      AccumulateBand(&energy_sum, 2, frame.ratios.low_mid);
-      AccumulateBand(&energy_sum, 3, frame.ratios.mid);
-      AccumulateBand(&energy_sum, 4, frame.ratios.presence);
-      AccumulateBand(&energy_sum, 5, frame.ratios.high);
-      AccumulateBand(&energy_sum, 6, frame.ratios.air);
-      AccumulateBand(&energy_sum, 7, frame.ratios.ultra);
-      total_spectral_energy += frame.total_energy;
-      centroids.push_back(frame.centroid_hz);
-      rolloff_sum += frame.rolloff_85_hz;
-      flatness_sum += frame.flatness;
-      high_side_energy += frame.high_side_energy;
-      high_total_energy += frame.high_total_energy;
-      ++frames;
-    }
-  }
-
-  if (total_spectral_energy > 0.0) {
-    out.spectral.ratios.sub = energy_sum.sub / total_spectral_energy;
-    out.spectral.ratios.low = energy_sum.low / total_spectral_energy;
-    out.spectral.ratios.low_mid = energy_sum.low_mid / total_spectral_energy;
-    out.spectral.ratios.mid = energy_sum.mid / total_spectral_energy;
-    out.spectral.ratios.presence = energy_sum.presence / total_spectral_energy;
-    out.spectral.ratios.high = energy_sum.high / total_spectral_energy;
-    out.spectral.ratios.air = energy_sum.air / total_spectral_energy;
-    out.spectral.ratios.ultra = energy_sum.ultra / total_spectral_energy;
-  }
+  out.spectral.ratios = NormalizeRatios(state.energy_sum, state.total_spectral_energy);
 
+  const std::vector<double>& centroids = state.centroids;
   if (!centroids.empty()) {
     const double centroid_mean = std::accumulate(centroids.begin(), centroids.end(), 0.0) / static_cast<double>(centroids.size());
     double centroid_var = 0.0;
@@ -536,118 +1167,298 @@ FileAnalysis AnalyzeStem(const AudioStem& stem, int sample_rate, const AnalysisO
     centroid_var /= static_cast<double>(centroids.size());
     out.spectral.centroid_mean_hz = centroid_mean;
     out.spectral.centroid_variance = centroid_var;
-  }
-  if (frames > 0) {
-    out.spectral.rolloff_85_hz = rolloff_sum / static_cast<double>(frames);
-    out.spectral.flatness = flatness_sum / static_cast<double>(frames);
+    out.spectral.rolloff_85_hz = state.rolloff_sum / static_cast<double>(centroids.size());
+    out.spectral.flatness = state.flatness_sum / static_cast<double>(centroids.size());
   }
 
-  const std::vector<float> lp60 = LowPass(mono, sample_rate, 60.0);
-  const std::vector<float> lp200 = LowPass(mono, sample_rate, 200.0);
-  std::vector<float> band60_200(mono.size(), 0.0F);
-  for (size_t i = 0; i < mono.size(); ++i) {
-    band60_200[i] = lp200[i] - lp60[i];
-  }
-  const BasicStats sub_stats = ComputeBasicStats(lp60);
-  const BasicStats low_stats = ComputeBasicStats(band60_200);
+  const BasicStats sub_stats = state.sub_energy.Stats();
+  const BasicStats low_stats = state.low_energy.Stats();
   out.sub.sub_rms_db = ToDb(sub_stats.rms);
   out.sub.sub_crest_factor_db = ToDb(sub_stats.peak) - ToDb(sub_stats.rms);
   out.sub.sub_to_total_ratio = Clamp(out.spectral.ratios.sub, 0.0, 1.0);
   out.sub.low_to_sub_ratio = low_stats.rms / std::max(sub_stats.rms, kEpsilon);
 
-  if (stem.channels == 2) {
+  if (plan.stereo) {
     out.stereo.available = true;
-    std::vector<float> mid(frame_count, 0.0F);
-    for (size_t i = 0; i < frame_count; ++i) {
-      mid[i] = 0.5F * (left[i] + right[i]);
-    }
-    const BasicStats mid_stats = ComputeBasicStats(mid);
-    const BasicStats side_stats = ComputeBasicStats(side);
-    out.stereo.mid_energy = mid_stats.rms * mid_stats.rms;
+    // The mid signal is the mono fold, so its energy is the mono energy.
+    const BasicStats side_stats = state.side_energy.Stats();
+    out.stereo.mid_energy = mono_stats.rms * mono_stats.rms;
     out.stereo.side_energy = side_stats.rms * side_stats.rms;
     out.stereo.mid_side_ratio = out.stereo.mid_energy / std::max(out.stereo.side_energy, kEpsilon);
-    out.stereo.correlation = Correlation(left, right);
-    const std::vector<float> l_low = LowPass(left, sample_rate, 200.0);
-    const std::vector<float> r_low = LowPass(right, sample_rate, 200.0);
-    out.stereo.low_frequency_correlation = Correlation(l_low, r_low);
-    out.stereo.high_band_side_ratio = high_side_energy / std::max(high_total_energy, kEpsilon);
+    out.stereo.correlation = state.correlation.Value();
+    out.stereo.low_frequency_correlation = state.low_correlation.Value();
+    out.stereo.high_band_side_ratio = state.high_side_energy / std::max(state.high_total_energy, kEpsilon);
     out.sub.low_frequency_phase_coherence = std::fabs(out.stereo.low_frequency_correlation);
   }
 
+  if (plan.capture) {
+    out.spectrum.window = plan.fft_size;
+    out.spectrum.hop = plan.stft_hop;
+    out.spectrum.nfft = plan.fft_size;
+    out.spectrum.bins = plan.fft_size / 2 + 1;
+    out.spectrum.frame_count = plan.stft_frames;
+    out.spectrum.slots.assign(plan.stft_frames, -1);
+    for (size_t row = 0; row < state.spectrum_frames.size(); ++row) {
+      out.spectrum.slots[state.spectrum_frames[row]] = static_cast<int32_t>(row);
+    }
+    out.spectrum.magnitudes = std::move(state.spectrum_magnitudes);
+  }
+
   out.frequency_dominance_profile = DominanceProfile(out.spectral.ratios);
   return out;
 }
 
-AnalysisReport AnalyzeFiles(const std::vector<AudioStem>& stems, const AudioStem& mix, int sample_rate,
-                            const std::string& mode, const AnalysisOptions& options) {
-  AnalysisReport report;
-  report.timestamp = NowIso8601Utc();
-  report.sample_rate = sample_rate;
-  report.mode = mode;
-  const size_t total_jobs = stems.size() + 1U;  // mix + stems
-  std::vector<FileAnalysis> analyzed_stems(stems.size());
-
-  size_t workers = 0;
-  if (options.max_parallel_jobs > 0) {
-    workers = static_cast<size_t>(options.max_parallel_jobs);
-  } else {
-    const unsigned int hw = std::thread::hardware_concurrency();
-    workers = hw == 0U ? 1U : static_cast<size_t>(hw);
+bool CanAnalyze(const AnalysisTarget& target, int sample_rate) {
+  return sample_rate > 0 && target.channels > 0 && target.sample_count > 0;
+}
+
+}  // namespace
+
+FileAnalysis AnalyzeStem(const AudioStem& stem, int sample_rate, const AnalysisOptions& options) {
+  const AnalysisTarget target = ResidentTarget(stem);
+  if (!CanAnalyze(target, sample_rate)) {
+    FileAnalysis out;
+    out.name = stem.name;
+    return out;
+  }
+  const StemAnalysisPlan plan = PlanStemAnalysis(target, sample_rate, options);
+  StemAnalysisState state = AnalyzeStemSegment(target, sample_rate, options, plan, 0);
+  for (size_t segment = 1; segment < plan.segment_count; ++segment) {
+    state.Merge(AnalyzeStemSegment(target, sample_rate, options, plan, segment));
   }
-  workers = std::max<size_t>(1U, std::min(workers, total_jobs));
+  return FinishStemAnalysis(target, sample_rate, options, plan, std::move(state));
+}
+
+namespace {
 
-  if (workers == 1U) {
-    report.mix = AnalyzeStem(mix, sample_rate, options);
-    for (size_t i = 0; i < stems.size(); ++i) {
-      analyzed_stems[i] = AnalyzeStem(stems[i], sample_rate, options);
+// Completes a report from per-target analyses (index 0 is the mix): stem ratios relative to the mix, masking and the
+// intent check.
+bool FinishReport(const std::vector<AnalysisTarget>& targets, std::vector<FileAnalysis> analyzed, int sample_rate,
+                  const AnalysisOptions& options, AnalysisReport* report, std::string* error) {
+  report->mix = std::move(analyzed[0]);
+  const double mix_rms_linear = std::pow(10.0, report->mix.rms_db / 20.0);
+  const double mix_sub_ratio = report->mix.sub.sub_to_total_ratio;
+
+  report->stems.reserve(analyzed.size() - 1U);
+  for (size_t t = 1; t < analyzed.size(); ++t) {
+    FileAnalysis& stem_analysis = analyzed[t];
+    const double stem_rms_linear = std::pow(10.0, stem_analysis.rms_db / 20.0);
+    stem_analysis.relative_loudness_lufs = stem_analysis.loudness.integrated_lufs - report->mix.loudness.integrated_lufs;
+    stem_analysis.energy_contribution_ratio = stem_rms_linear / std::max(mix_rms_linear, kEpsilon);
+    stem_analysis.sub_contribution_ratio = stem_analysis.sub.sub_to_total_ratio / std::max(mix_sub_ratio, kEpsilon);
+    report->stems.push_back(std::move(stem_analysis));
+  }
+
+  if (options.masking_window_seconds > 0.0 && targets.size() > 1U) {
+    std::vector<StreamedAudio> stem_sources;
+    stem_sources.reserve(targets.size() - 1U);
+    for (size_t t = 1; t < targets.size(); ++t) {
+      stem_sources.push_back(TargetSource(targets[t]));
     }
-  } else {
-    std::atomic<size_t> next_job{0U};
-    std::vector<std::thread> pool;
-    pool.reserve(workers);
-    for (size_t t = 0; t < workers; ++t) {
-      pool.emplace_back([&]() {
-        while (true) {
-          const size_t job = next_job.fetch_add(1U);
-          if (job >= total_jobs) {
-            break;
-          }
-          if (job == 0U) {
-            report.mix = AnalyzeStem(mix, sample_rate, options);
-          } else {
-            const size_t stem_index = job - 1U;
-            analyzed_stems[stem_index] = AnalyzeStem(stems[stem_index], sample_rate, options);
-          }
-        }
-      });
+    if (!AnalyzeMasking(stem_sources, TargetSource(targets[0]), sample_rate, options, &report->masking, error)) {
+      return false;
     }
-    for (auto& worker : pool) {
-      worker.join();
+  }
+
+  report->intent_evaluation = EvaluateIntent(report->mix, options.intent);
+  return true;
+}
+
+// Analyzes one resident target with its segments spread over the scheduler; the result equals AnalyzeStem's.
+FileAnalysis AnalyzeTargetSegments(const AnalysisTarget& target, int sample_rate, const AnalysisOptions& options) {
+  if (!CanAnalyze(target, sample_rate)) {
+    FileAnalysis out;
+    out.name = target.name;
+    return out;
+  }
+  const StemAnalysisPlan plan = PlanStemAnalysis(target, sample_rate, options);
+  std::vector<StemAnalysisState> states(plan.segment_count);
+  TaskScheduler::Global().ParallelFor(
+      plan.segment_count, static_cast<size_t>(std::max(options.max_parallel_jobs, 0)),
+      [&](size_t segment) { states[segment] = AnalyzeStemSegment(target, sample_rate, options, plan, segment); });
+  StemAnalysisState merged = std::move(states[0]);
+  for (size_t segment = 1; segment < states.size(); ++segment) {
+    merged.Merge(std::move(states[segment]));
+  }
+  return FinishStemAnalysis(target, sample_rate, options, plan, std::move(merged));
+}
+
+AnalysisOptions RenderAnalysisOptions(const RenderMetadata& metadata, const AnalysisOptions& options) {
+  AnalysisOptions render_options = options;
+  if (render_options.timeline_window_seconds > 0.0 && render_options.timeline_sections.empty()) {
+    render_options.timeline_sections = metadata.sections;
+  }
+  return render_options;
+}
+
+// Analyzes every target (target 0 is the mix) with one job per (target, time segment), so a single long file spreads
+// across all workers. Segment states are merged in segment order once all jobs finish, which keeps results
+// independent of the worker count. Fails only when a streamed target cannot be read.
+bool AnalyzeTargets(const std::vector<AnalysisTarget>& targets, int sample_rate, const std::string& mode,
+                    const AnalysisOptions& options, AnalysisReport* report, std::string* error) {
+  report->timestamp = NowIso8601Utc();
+  report->sample_rate = sample_rate;
+  report->mode = mode;
+
+  struct SegmentJob {
+    size_t target = 0;
+    size_t segment = 0;
+  };
+  std::vector<StemAnalysisPlan> plans(targets.size());
+  std::vector<std::vector<StemAnalysisState>> states(targets.size());
+  std::vector<SegmentJob> jobs;
+  for (size_t t = 0; t < targets.size(); ++t) {
+    if (!CanAnalyze(targets[t], sample_rate)) {
+      continue;
+    }
+    plans[t] = PlanStemAnalysis(targets[t], sample_rate, options);
+    states[t].resize(plans[t].segment_count);
+    for (size_t segment = 0; segment < plans[t].segment_count; ++segment) {
+      jobs.push_back(SegmentJob{t, segment});
     }
   }
 
-  const double mix_rms_linear = std::pow(10.0, report.mix.rms_db / 20.0);
-  const double mix_sub_ratio = report.mix.sub.sub_to_total_ratio;
+  const auto run_job = [&](size_t job) {
+    const SegmentJob& segment = jobs[job];
+    states[segment.target][segment.segment] =
+        AnalyzeStemSegment(targets[segment.target], sample_rate, options, plans[segment.target], segment.segment);
+  };
+  TaskScheduler::Global().ParallelFor(jobs.size(), static_cast<size_t>(std::max(options.max_parallel_jobs, 0)),
+                                      run_job);
 
-  report.stems.reserve(analyzed_stems.size());
-  for (auto& analyzed : analyzed_stems) {
-    const double stem_rms_linear = std::pow(10.0, analyzed.rms_db / 20.0);
-    analyzed.relative_loudness_lufs = analyzed.loudness.integrated_lufs - report.mix.loudness.integrated_lufs;
-    analyzed.energy_contribution_ratio = stem_rms_linear / std::max(mix_rms_linear, kEpsilon);
-    analyzed.sub_contribution_ratio = analyzed.sub.sub_to_total_ratio / std::max(mix_sub_ratio, kEpsilon);
-    report.stems.push_back(std::move(analyzed));
+  std::vector<FileAnalysis> analyzed(targets.size());
+  for (size_t t = 0; t < targets.size(); ++t) {
+    if (states[t].empty()) {
+      analyzed[t].name = targets[t].name;
+      continue;
+    }
+    StemAnalysisState merged = std::move(states[t][0]);
+    for (size_t segment = 1; segment < states[t].size(); ++segment) {
+      merged.Merge(std::move(states[t][segment]));
+    }
+    states[t].clear();
+    if (!merged.error.empty()) {
+      if (error != nullptr) {
+        *error = merged.error;
+      }
+      return false;
+    }
+    analyzed[t] = FinishStemAnalysis(targets[t], sample_rate, options, plans[t], std::move(merged));
   }
 
-  report.intent_evaluation = EvaluateIntent(report.mix, options.intent);
+  return FinishReport(targets, std::move(analyzed), sample_rate, options, report, error);
+}
+
+}  // namespace
+
+AnalysisReport AnalyzeFiles(const std::vector<AudioStem>& stems, const AudioStem& mix, int sample_rate,
+                            const std::string& mode, const AnalysisOptions& options) {
+  std::vector<AnalysisTarget> targets;
+  targets.reserve(stems.size() + 1U);
+  targets.push_back(ResidentTarget(mix));
+  for (const auto& stem : stems) {
+    targets.push_back(ResidentTarget(stem));
+  }
+  AnalysisReport report;
+  AnalyzeTargets(targets, sample_rate, mode, options, &report, nullptr);
   return report;
 }
 
 AnalysisReport AnalyzeRender(const RenderResult& render, const AnalysisOptions& options) {
-  std::vector<AudioStem> stems;
-  stems.reserve(render.patch_stems.size() + render.bus_stems.size());
-  stems.insert(stems.end(), render.patch_stems.begin(), render.patch_stems.end());
-  stems.insert(stems.end(), render.bus_stems.begin(), render.bus_stems.end());
-  return AnalyzeFiles(stems, render.master, render.metadata.sample_rate, "render_analysis", options);
+  std::vector<AnalysisTarget> targets;
+  targets.reserve(render.patch_stems.size() + render.bus_stems.size() + 1U);
+  targets.push_back(ResidentTarget(render.master));
+  for (const auto& stem : render.patch_stems) {
+    targets.push_back(ResidentTarget(stem));
+  }
+  for (const auto& stem : render.bus_stems) {
+    targets.push_back(ResidentTarget(stem));
+  }
+  AnalysisReport report;
+  AnalyzeTargets(targets, render.metadata.sample_rate, "render_analysis", RenderAnalysisOptions(render.metadata, options),
+                 &report, nullptr);
+  return report;
+}
+
+RenderAnalysisSession::RenderAnalysisSession(const RenderMetadata& metadata, size_t stem_count,
+                                             const AnalysisOptions& options)
+    : sample_rate_(metadata.sample_rate),
+      options_(RenderAnalysisOptions(metadata, options)),
+      stems_(stem_count),
+      pending_(stem_count) {}
+
+RenderAnalysisSession::~RenderAnalysisSession() {
+  for (auto& pending : pending_) {
+    if (pending.valid()) {
+      TaskScheduler::Global().Wait(pending);
+    }
+  }
+}
+
+void RenderAnalysisSession::AddStem(size_t index, const AudioStem& stem) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index >= pending_.size() || pending_[index].valid()) {
+    return;
+  }
+  pending_[index] = TaskScheduler::Global().Submit([this, index, &stem]() {
+    stems_[index] = AnalyzeTargetSegments(ResidentTarget(stem), sample_rate_, options_);
+  });
+}
+
+AnalysisReport RenderAnalysisSession::Finish(const RenderResult& render) {
+  std::vector<AnalysisTarget> targets;
+  targets.reserve(render.patch_stems.size() + render.bus_stems.size() + 1U);
+  targets.push_back(ResidentTarget(render.master));
+  for (const auto& stem : render.patch_stems) {
+    targets.push_back(ResidentTarget(stem));
+  }
+  for (const auto& stem : render.bus_stems) {
+    targets.push_back(ResidentTarget(stem));
+  }
+
+  std::vector<FileAnalysis> analyzed(targets.size());
+  analyzed[0] = AnalyzeTargetSegments(targets[0], sample_rate_, options_);
+  for (size_t t = 1; t < targets.size(); ++t) {
+    const size_t index = t - 1U;
+    std::future<void> pending;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (index < pending_.size()) {
+        pending = std::move(pending_[index]);
+      }
+    }
+    if (pending.valid()) {
+      TaskScheduler::Global().Wait(pending);
+      analyzed[t] = std::move(stems_[index]);
+    } else {
+      analyzed[t] = AnalyzeTargetSegments(targets[t], sample_rate_, options_);
+    }
+  }
+
+  AnalysisReport report;
+  report.timestamp = NowIso8601Utc();
+  report.sample_rate = sample_rate_;
+  report.mode = "render_analysis";
+  FinishReport(targets, std::move(analyzed), sample_rate_, options_, &report, nullptr);
+  return report;
+}
+
+bool AnalyzeStreamedFiles(const std::vector<StreamedAudio>& stems, const StreamedAudio& mix, int sample_rate,
+                          const std::string& mode, const AnalysisOptions& options, AnalysisReport* report,
+                          std::string* error) {
+  if (report == nullptr) {
+    if (error != nullptr) {
+      *error = "Internal error: null analysis report.";
+    }
+    return false;
+  }
+  std::vector<AnalysisTarget> targets;
+  targets.reserve(stems.size() + 1U);
+  targets.push_back(StreamedTarget(mix));
+  for (const auto& stem : stems) {
+    targets.push_back(StreamedTarget(stem));
+  }
+  return AnalyzeTargets(targets, sample_rate, mode, options, report, error);
 }
 
 }  // namespace aurora::core
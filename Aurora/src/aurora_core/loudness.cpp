@@ -0,0 +1,319 @@
+#include "aurora/core/loudness.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace aurora::core {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+// Mean squares below this read as silence (-200 LUFS) instead of -inf.
+constexpr double kEnergyFloor = 1e-20;
+constexpr size_t kMomentaryBlocks = 4;
+constexpr size_t kShortTermBlocks = 30;
+constexpr size_t kShortTermSeriesHop = 10;
+constexpr size_t kTruePeakTapsPerPhase = 12;
+constexpr size_t kProcessChunk = 4096;
+
+double ToLufs(double mean_square) { return -0.691 + 10.0 * std::log10(std::max(mean_square, kEnergyFloor)); }
+
+// Mean square whose loudness equals `lufs`; gates compare energies so blocks need no logarithm.
+double FromLufs(double lufs) { return std::pow(10.0, (lufs + 0.691) / 10.0); }
+
+// Transposed direct form II biquad step with normalized a[0].
+double Biquad(const double* b, const double* a, double* z, double x) {
+  const double y = b[0] * x + z[0];
+  z[0] = b[1] * x - a[1] * y + z[1];
+  z[1] = b[2] * x - a[2] * y;
+  return y;
+}
+
+// Loudness range of short-term values after the EBU Tech 3342 gates.
+double LoudnessRange(const std::vector<double>& short_term_energy) {
+  const double absolute_gate = FromLufs(-70.0);
+  double sum = 0.0;
+  size_t count = 0;
+  for (const double energy : short_term_energy) {
+    if (energy > absolute_gate) {
+      sum += energy;
+      ++count;
+    }
+  }
+  if (count == 0) {
+    return 0.0;
+  }
+  const double relative_gate = FromLufs(ToLufs(sum / static_cast<double>(count)) - 20.0);
+  std::vector<double> gated;
+  gated.reserve(count);
+  for (const double energy : short_term_energy) {
+    if (energy > absolute_gate && energy > relative_gate) {
+      gated.push_back(energy);
+    }
+  }
+  if (gated.empty()) {
+    return 0.0;
+  }
+  std::sort(gated.begin(), gated.end());
+  const double last = static_cast<double>(gated.size() - 1U);
+  const size_t low = static_cast<size_t>(last * 0.10 + 0.5);
+  const size_t high = static_cast<size_t>(last * 0.95 + 0.5);
+  return ToLufs(gated[high]) - ToLufs(gated[low]);
+}
+
+}  // namespace
+
+KWeightingFilter::KWeightingFilter(int sample_rate) {
+  const double rate = static_cast<double>(std::max(sample_rate, 1));
+  // Stage 1: high shelf, +4 dB above ~1.7 kHz.
+  {
+    const double f0 = 1681.974450955533;
+    const double gain_db = 3.999843853973347;
+    const double q = 0.7071752369554196;
+    const double k = std::tan(kPi * f0 / rate);
+    const double vh = std::pow(10.0, gain_db / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    const double a0 = 1.0 + k / q + k * k;
+    shelf_b_[0] = (vh + vb * k / q + k * k) / a0;
+    shelf_b_[1] = 2.0 * (k * k - vh) / a0;
+    shelf_b_[2] = (vh - vb * k / q + k * k) / a0;
+    shelf_a_[0] = 1.0;
+    shelf_a_[1] = 2.0 * (k * k - 1.0) / a0;
+    shelf_a_[2] = (1.0 - k / q + k * k) / a0;
+  }
+  // Stage 2: RLB high-pass at ~38 Hz.
+  {
+    const double f0 = 38.13547087602444;
+    const double q = 0.5003270373238773;
+    const double k = std::tan(kPi * f0 / rate);
+    const double a0 = 1.0 + k / q + k * k;
+    highpass_b_[0] = 1.0;
+    highpass_b_[1] = -2.0;
+    highpass_b_[2] = 1.0;
+    highpass_a_[0] = 1.0;
+    highpass_a_[1] = 2.0 * (k * k - 1.0) / a0;
+    highpass_a_[2] = (1.0 - k / q + k * k) / a0;
+  }
+}
+
+void KWeightingFilter::Process(const float* in, size_t count, size_t stride, float* out) {
+  for (size_t i = 0; i < count; ++i) {
+    const double x = static_cast<double>(in[i * stride]);
+    const double shelved = Biquad(shelf_b_, shelf_a_, shelf_z_, x);
+    out[i] = static_cast<float>(Biquad(highpass_b_, highpass_a_, highpass_z_, shelved));
+  }
+}
+
+TruePeakDetector::TruePeakDetector(int sample_rate)
+    : factor_(sample_rate < 96000 ? 4U : (sample_rate < 192000 ? 2U : 1U)),
+      taps_(factor_ > 1U ? kTruePeakTapsPerPhase : 1U) {
+  phases_.assign(factor_ * taps_, 0.0F);
+  if (factor_ == 1U) {
+    phases_[0] = 1.0F;
+  } else {
+    // Blackman-windowed sinc with its cutoff at the input Nyquist, split into `factor_` phases that each interpolate
+    // at a different fraction of the sample interval. Every phase is normalized to unity DC gain.
+    const size_t length = factor_ * taps_;
+    const double center = static_cast<double>(length - 1U) / 2.0;
+    std::vector<double> prototype(length);
+    for (size_t n = 0; n < length; ++n) {
+      const double t = (static_cast<double>(n) - center) / static_cast<double>(factor_);
+      const double sinc = std::fabs(t) < 1e-12 ? 1.0 : std::sin(kPi * t) / (kPi * t);
+      const double phase = 2.0 * kPi * static_cast<double>(n) / static_cast<double>(length - 1U);
+      prototype[n] = sinc * (0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase));
+    }
+    for (size_t p = 0; p < factor_; ++p) {
+      double sum = 0.0;
+      for (size_t k = 0; k < taps_; ++k) {
+        sum += prototype[k * factor_ + p];
+      }
+      for (size_t k = 0; k < taps_; ++k) {
+        phases_[p * taps_ + (taps_ - 1U - k)] = static_cast<float>(prototype[k * factor_ + p] / sum);
+      }
+    }
+  }
+  history_.assign(taps_ - 1U, 0.0F);
+}
+
+void TruePeakDetector::Process(const float* in, size_t count, size_t stride, bool measure) {
+  const size_t keep = taps_ - 1U;
+  for (size_t done = 0; done < count;) {
+    const size_t n = std::min(kProcessChunk, count - done);
+    history_.resize(keep + n);
+    for (size_t i = 0; i < n; ++i) {
+      history_[keep + i] = in[(done + i) * stride];
+    }
+    if (measure) {
+      float chunk_peak = 0.0F;
+      for (size_t i = 0; i < n; ++i) {
+        chunk_peak = std::max(chunk_peak, std::fabs(history_[keep + i]));
+      }
+      phase_out_.resize(n);
+      for (size_t p = 0; factor_ > 1U && p < factor_; ++p) {
+        const float* taps = phases_.data() + p * taps_;
+        std::fill(phase_out_.begin(), phase_out_.end(), 0.0F);
+        for (size_t m = 0; m < taps_; ++m) {
+          const float tap = taps[m];
+          const float* src = history_.data() + m;
+          float* dst = phase_out_.data();
+          for (size_t i = 0; i < n; ++i) {
+            dst[i] += tap * src[i];
+          }
+        }
+        for (size_t i = 0; i < n; ++i) {
+          chunk_peak = std::max(chunk_peak, std::fabs(phase_out_[i]));
+        }
+      }
+      peak_ = std::max(peak_, static_cast<double>(chunk_peak));
+    }
+    std::copy(history_.end() - static_cast<std::ptrdiff_t>(keep), history_.end(), history_.begin());
+    done += n;
+  }
+}
+
+size_t LoudnessBlockFrames(int sample_rate) {
+  return std::max<size_t>(1U, static_cast<size_t>(std::lround(static_cast<double>(sample_rate) / 10.0)));
+}
+
+LoudnessSummary SummarizeLoudness(const std::vector<double>& block_energy, size_t block_frames) {
+  LoudnessSummary out;
+  const size_t blocks = block_energy.size();
+  const double frames = static_cast<double>(std::max<size_t>(block_frames, 1U));
+  if (blocks < kMomentaryBlocks) {
+    double total = 0.0;
+    for (const double energy : block_energy) {
+      total += energy;
+    }
+    out.integrated_lufs = blocks == 0 ? ToLufs(0.0) : ToLufs(total / (frames * static_cast<double>(blocks)));
+    out.momentary_max_lufs = out.integrated_lufs;
+    out.short_term_max_lufs = out.integrated_lufs;
+    return out;
+  }
+  out.gated = true;
+
+  // 400 ms gating blocks every 100 ms; they are also the momentary loudness.
+  std::vector<double> momentary(blocks - kMomentaryBlocks + 1U);
+  double window = 0.0;
+  for (size_t i = 0; i < kMomentaryBlocks; ++i) {
+    window += block_energy[i];
+  }
+  double momentary_max = 0.0;
+  for (size_t j = 0; j < momentary.size(); ++j) {
+    if (j > 0) {
+      window += block_energy[j + kMomentaryBlocks - 1U] - block_energy[j - 1U];
+    }
+    momentary[j] = std::max(window, 0.0) / (frames * static_cast<double>(kMomentaryBlocks));
+    momentary_max = std::max(momentary_max, momentary[j]);
+  }
+  out.momentary_max_lufs = ToLufs(momentary_max);
+
+  const double absolute_gate = FromLufs(-70.0);
+  double sum = 0.0;
+  size_t count = 0;
+  for (const double energy : momentary) {
+    if (energy > absolute_gate) {
+      sum += energy;
+      ++count;
+    }
+  }
+  if (count == 0) {
+    // Nothing above the absolute gate: report the ungated level instead of -inf.
+    for (const double energy : momentary) {
+      sum += energy;
+    }
+    out.integrated_lufs = ToLufs(sum / static_cast<double>(momentary.size()));
+  } else {
+    const double relative_gate = FromLufs(ToLufs(sum / static_cast<double>(count)) - 10.0);
+    double gated_sum = 0.0;
+    size_t gated_count = 0;
+    for (const double energy : momentary) {
+      if (energy > absolute_gate && energy > relative_gate) {
+        gated_sum += energy;
+        ++gated_count;
+      }
+    }
+    out.integrated_lufs = ToLufs(gated_sum / static_cast<double>(gated_count));
+  }
+
+  // 3 s short-term windows every 100 ms feed LRA; every tenth one is the 1 s series.
+  if (blocks < kShortTermBlocks) {
+    double total = 0.0;
+    for (const double energy : block_energy) {
+      total += energy;
+    }
+    out.short_term_max_lufs = ToLufs(total / (frames * static_cast<double>(blocks)));
+    return out;
+  }
+  std::vector<double> short_term(blocks - kShortTermBlocks + 1U);
+  window = 0.0;
+  for (size_t i = 0; i < kShortTermBlocks; ++i) {
+    window += block_energy[i];
+  }
+  double short_term_max = 0.0;
+  out.short_term_lufs.reserve(short_term.size() / kShortTermSeriesHop + 1U);
+  for (size_t j = 0; j < short_term.size(); ++j) {
+    if (j > 0) {
+      window += block_energy[j + kShortTermBlocks - 1U] - block_energy[j - 1U];
+    }
+    short_term[j] = std::max(window, 0.0) / (frames * static_cast<double>(kShortTermBlocks));
+    short_term_max = std::max(short_term_max, short_term[j]);
+    if (j % kShortTermSeriesHop == 0) {
+      out.short_term_lufs.push_back(ToLufs(short_term[j]));
+    }
+  }
+  out.short_term_max_lufs = ToLufs(short_term_max);
+  out.lra = LoudnessRange(short_term);
+  return out;
+}
+
+LoudnessMeter::LoudnessMeter(int sample_rate, int channels)
+    : channels_(std::max(channels, 1)), block_frames_(LoudnessBlockFrames(sample_rate)) {
+  for (int c = 0; c < channels_; ++c) {
+    weighting_.emplace_back(sample_rate);
+    true_peak_.emplace_back(sample_rate);
+  }
+}
+
+void LoudnessMeter::Add(const float* interleaved, size_t frames) {
+  const size_t channels = static_cast<size_t>(channels_);
+  for (size_t done = 0; done < frames;) {
+    const size_t n = std::min(kProcessChunk, frames - done);
+    const float* chunk = interleaved + done * channels;
+    weighted_.resize(n * channels);
+    for (size_t c = 0; c < channels; ++c) {
+      weighting_[c].Process(chunk + c, n, channels, weighted_.data() + c * n);
+      true_peak_[c].Process(chunk + c, n, channels, true);
+    }
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t c = 0; c < channels; ++c) {
+        const double v = static_cast<double>(weighted_[c * n + i]);
+        block_sum_ += v * v;
+      }
+      if (++block_filled_ == block_frames_) {
+        blocks_.push_back(block_sum_);
+        block_sum_ = 0.0;
+        block_filled_ = 0;
+      }
+    }
+    done += n;
+  }
+}
+
+LoudnessReading LoudnessMeter::Finish() const {
+  const LoudnessSummary summary = SummarizeLoudness(blocks_, block_frames_);
+  LoudnessReading out;
+  out.measured = true;
+  out.integrated_lufs = summary.integrated_lufs;
+  out.lra = summary.lra;
+  out.momentary_max_lufs = summary.momentary_max_lufs;
+  out.short_term_max_lufs = summary.short_term_max_lufs;
+  double peak = 0.0;
+  for (const auto& detector : true_peak_) {
+    peak = std::max(peak, detector.peak());
+  }
+  out.true_peak_dbtp = 20.0 * std::log10(std::max(peak, 1e-12));
+  return out;
+}
+
+}  // namespace aurora::core
@@ -0,0 +1,419 @@
+#include "aurora/core/masking.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "aurora/core/stft.hpp"
+#include "aurora/core/task_scheduler.hpp"
+
+namespace aurora::core {
+namespace {
+
+constexpr size_t kBandCount = 8;
+// Frames transformed per read; a block spans (kFrameBlock - 1) * hop + fft_size samples of every target.
+constexpr size_t kFrameBlock = 16;
+// Rows compared per tile: a tile pair reads at most 2 * kRowTile rows of one band while scoring kRowTile^2 pairs.
+constexpr size_t kRowTile = 8;
+// Independent partial sums per bin loop, so the float reductions vectorize without reassociation.
+constexpr size_t kLanes = 8;
+constexpr double kLevelFloor = 1e-12;
+// Cells this far below a pair's loudest window and band are ignored when picking its peaks (-30 dB).
+constexpr double kPeakFloor = 1e-3;
+// Spectrum components below this are rounding residue of the packed transform and are stored as zero, keeping the
+// float products in the pair kernel out of the denormal range.
+constexpr double kSpectrumFloor = 1e-15;
+
+const char* const kBandNames[kBandCount] = {"sub", "low", "low_mid", "mid", "presence", "high", "air", "ultra"};
+// Upper edges of the analyzer's spectral-ratio bands.
+constexpr double kBandUpperHz[kBandCount - 1] = {60.0, 200.0, 500.0, 2000.0, 5000.0, 10000.0, 16000.0};
+
+double& BandValue(SpectralRatios* ratios, size_t band) {
+  switch (band) {
+    case 0:
+      return ratios->sub;
+    case 1:
+      return ratios->low;
+    case 2:
+      return ratios->low_mid;
+    case 3:
+      return ratios->mid;
+    case 4:
+      return ratios->presence;
+    case 5:
+      return ratios->high;
+    case 6:
+      return ratios->air;
+    default:
+      return ratios->ultra;
+  }
+}
+
+struct BinRange {
+  size_t begin = 0;
+  size_t end = 0;
+};
+
+// Bins [1, fft_size / 2) grouped by band, matching the analyzer's band energies.
+std::vector<BinRange> BandBins(int fft_size, int sample_rate) {
+  std::vector<BinRange> bands(kBandCount);
+  const size_t half = static_cast<size_t>(fft_size / 2);
+  size_t band = 0;
+  bands[0].begin = 1U;
+  for (size_t k = 1; k < half; ++k) {
+    const double hz = static_cast<double>(sample_rate) * static_cast<double>(k) / static_cast<double>(fft_size);
+    while (band + 1U < kBandCount && hz >= kBandUpperHz[band]) {
+      bands[band].end = k;
+      bands[++band].begin = k;
+    }
+  }
+  bands[band].end = std::max(bands[band].begin, half);
+  for (size_t b = band + 1U; b < kBandCount; ++b) {
+    bands[b].begin = bands[b].end = std::max(bands[band].end, bands[b].begin);
+  }
+  return bands;
+}
+
+float SpectrumComponent(double value) {
+  return std::abs(value) < kSpectrumFloor ? 0.0F : static_cast<float>(value);
+}
+
+size_t PairIndex(size_t i, size_t j, size_t rows) { return i * rows - i * (i + 1U) / 2U + (j - i - 1U); }
+
+float SumLanes(const float* values, size_t n) {
+  float lanes[kLanes] = {};
+  size_t k = 0;
+  for (; k + kLanes <= n; k += kLanes) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      lanes[l] += values[k + l];
+    }
+  }
+  float sum = 0.0F;
+  for (; k < n; ++k) {
+    sum += values[k];
+  }
+  for (const float lane : lanes) {
+    sum += lane;
+  }
+  return sum;
+}
+
+// Sum over n bins of min(|A|^2, |B|^2) and of Re(A conj(B)).
+void PairBandSums(const float* power_a, const float* power_b, const float* re_a, const float* re_b, const float* im_a,
+                  const float* im_b, size_t n, double* min_sum, double* cross_sum) {
+  float mins[kLanes] = {};
+  float cross[kLanes] = {};
+  size_t k = 0;
+  for (; k + kLanes <= n; k += kLanes) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      mins[l] += std::min(power_a[k + l], power_b[k + l]);
+      cross[l] += re_a[k + l] * re_b[k + l] + im_a[k + l] * im_b[k + l];
+    }
+  }
+  float min_tail = 0.0F;
+  float cross_tail = 0.0F;
+  for (; k < n; ++k) {
+    min_tail += std::min(power_a[k], power_b[k]);
+    cross_tail += re_a[k] * re_b[k] + im_a[k] * im_b[k];
+  }
+  for (size_t l = 0; l < kLanes; ++l) {
+    min_tail += mins[l];
+    cross_tail += cross[l];
+  }
+  *min_sum += static_cast<double>(min_tail);
+  *cross_sum += static_cast<double>(cross_tail);
+}
+
+// Spectra of one block of frames for every row: element (frame * rows + row) * bins + k.
+struct BlockSpectra {
+  size_t rows = 0;
+  size_t bins = 0;
+  std::vector<float> re;
+  std::vector<float> im;
+  std::vector<float> power;
+};
+
+// Adds one frame to a window's sums: per-row band power, then every pair's min and cross sums. Bands are outermost so
+// each pass touches only that band's bins; rows are tiled so a tile pair's rows are reused across all its pairs.
+void AccumulateFrame(const BlockSpectra& spectra, size_t frame, const std::vector<BinRange>& bands, double* row_power,
+                     double* pair_min, double* pair_cross) {
+  const size_t rows = spectra.rows;
+  const size_t base = frame * rows * spectra.bins;
+  const float* re = spectra.re.data() + base;
+  const float* im = spectra.im.data() + base;
+  const float* power = spectra.power.data() + base;
+  for (size_t b = 0; b < kBandCount; ++b) {
+    const size_t k0 = bands[b].begin;
+    const size_t n = bands[b].end - k0;
+    if (n == 0) {
+      continue;
+    }
+    for (size_t r = 0; r < rows; ++r) {
+      row_power[r * kBandCount + b] += static_cast<double>(SumLanes(power + r * spectra.bins + k0, n));
+    }
+    for (size_t i0 = 0; i0 < rows; i0 += kRowTile) {
+      const size_t i_end = std::min(rows, i0 + kRowTile);
+      for (size_t j0 = i0; j0 < rows; j0 += kRowTile) {
+        const size_t j_end = std::min(rows, j0 + kRowTile);
+        for (size_t i = i0; i < i_end; ++i) {
+          const size_t a = i * spectra.bins + k0;
+          for (size_t j = std::max(j0, i + 1U); j < j_end; ++j) {
+            const size_t c = j * spectra.bins + k0;
+            const size_t slot = PairIndex(i, j, rows) * kBandCount + b;
+            PairBandSums(power + a, power + c, re + a, re + c, im + a, im + c, n, &pair_min[slot], &pair_cross[slot]);
+          }
+        }
+      }
+    }
+  }
+}
+
+// Mono fold of frames [first, first + count) of `source`, zero past its end; non-finite samples read as silence.
+bool ReadMono(const StreamedAudio& source, size_t first, size_t count, std::vector<float>* staging, float* mono,
+              std::string* error) {
+  const size_t channels = static_cast<size_t>(std::max(source.channels, 1));
+  const size_t available = first < source.frame_count ? std::min(count, source.frame_count - first) : 0U;
+  if (available > 0) {
+    staging->resize(available * channels);
+    if (!source.read(first, available, staging->data(), error)) {
+      if (error != nullptr && error->empty()) {
+        *error = "Failed to read audio for '" + source.name + "'.";
+      }
+      return false;
+    }
+  }
+  const float scale = 1.0F / static_cast<float>(channels);
+  for (size_t i = 0; i < available; ++i) {
+    float sum = 0.0F;
+    for (size_t c = 0; c < channels; ++c) {
+      const float s = (*staging)[i * channels + c];
+      sum += std::isfinite(s) ? s : 0.0F;
+    }
+    mono[i] = sum * scale;
+  }
+  std::fill(mono + available, mono + count, 0.0F);
+  return true;
+}
+
+struct MaskingPlan {
+  size_t rows = 0;
+  size_t pairs = 0;
+  size_t fft_size = 0;
+  size_t hop = 0;
+  size_t frames = 0;
+  size_t window_frames = 0;
+  size_t windows = 0;
+  std::vector<BinRange> bands;
+  std::vector<double> hann;
+};
+
+// Transforms the frames that start in window `w` for every source and adds them to that window's sums.
+bool AnalyzeMaskingWindow(const std::vector<const StreamedAudio*>& sources, const MaskingPlan& plan, size_t w,
+                          double* row_power, double* pair_min, double* pair_cross, std::string* error) {
+  const size_t window_begin = w * plan.window_frames;
+  const size_t frame_first = (window_begin + plan.hop - 1U) / plan.hop;
+  const size_t frame_end = std::min(plan.frames, (window_begin + plan.window_frames + plan.hop - 1U) / plan.hop);
+  const size_t bins = plan.fft_size / 2U;
+
+  BlockSpectra spectra;
+  spectra.rows = plan.rows;
+  spectra.bins = bins;
+  spectra.re.resize(kFrameBlock * plan.rows * bins);
+  spectra.im.resize(spectra.re.size());
+  spectra.power.resize(spectra.re.size());
+  std::vector<float> staging;
+  const size_t span_max = (kFrameBlock - 1U) * plan.hop + plan.fft_size;
+  std::vector<float> mono_a(span_max);
+  std::vector<float> mono_b(span_max);
+  std::vector<std::complex<double>> frame(plan.fft_size);
+
+  for (size_t block = frame_first; block < frame_end; block += kFrameBlock) {
+    const size_t count = std::min(kFrameBlock, frame_end - block);
+    const size_t span = (count - 1U) * plan.hop + plan.fft_size;
+    // Two real rows share one complex transform: row r as the real part, row r + 1 as the imaginary part.
+    for (size_t r = 0; r < plan.rows; r += 2U) {
+      const bool paired = r + 1U < plan.rows;
+      if (!ReadMono(*sources[r], block * plan.hop, span, &staging, mono_a.data(), error) ||
+          (paired && !ReadMono(*sources[r + 1U], block * plan.hop, span, &staging, mono_b.data(), error))) {
+        return false;
+      }
+      if (!paired) {
+        std::fill(mono_b.begin(), mono_b.begin() + static_cast<std::ptrdiff_t>(span), 0.0F);
+      }
+      for (size_t f = 0; f < count; ++f) {
+        const float* samples_a = mono_a.data() + f * plan.hop;
+        const float* samples_b = mono_b.data() + f * plan.hop;
+        for (size_t i = 0; i < plan.fft_size; ++i) {
+          frame[i] = std::complex<double>(static_cast<double>(samples_a[i]) * plan.hann[i],
+                                          static_cast<double>(samples_b[i]) * plan.hann[i]);
+        }
+        FftInPlace(&frame);
+        const size_t base_a = (f * plan.rows + r) * bins;
+        const size_t base_b = base_a + bins;
+        for (size_t k = 0; k < bins; ++k) {
+          // A[k] = (Z[k] + conj(Z[N - k])) / 2, B[k] = (Z[k] - conj(Z[N - k])) / 2i.
+          const std::complex<double> z = frame[k];
+          const std::complex<double> mirror = std::conj(frame[(plan.fft_size - k) & (plan.fft_size - 1U)]);
+          const float re_a = SpectrumComponent(0.5 * (z.real() + mirror.real()));
+          const float im_a = SpectrumComponent(0.5 * (z.imag() + mirror.imag()));
+          spectra.re[base_a + k] = re_a;
+          spectra.im[base_a + k] = im_a;
+          spectra.power[base_a + k] = re_a * re_a + im_a * im_a;
+          if (paired) {
+            const float re_b = SpectrumComponent(0.5 * (z.imag() - mirror.imag()));
+            const float im_b = SpectrumComponent(-0.5 * (z.real() - mirror.real()));
+            spectra.re[base_b + k] = re_b;
+            spectra.im[base_b + k] = im_b;
+            spectra.power[base_b + k] = re_b * re_b + im_b * im_b;
+          }
+        }
+      }
+    }
+    for (size_t f = 0; f < count; ++f) {
+      AccumulateFrame(spectra, f, plan.bands, row_power, pair_min, pair_cross);
+    }
+  }
+  return true;
+}
+
+double SummingDb(double combined, double separate) {
+  return 10.0 * std::log10(std::max(combined / separate, kLevelFloor));
+}
+
+}  // namespace
+
+bool AnalyzeMasking(const std::vector<StreamedAudio>& stems, const StreamedAudio& mix, int sample_rate,
+                    const AnalysisOptions& options, MaskingReport* report, std::string* error) {
+  *report = MaskingReport{};
+  if (stems.empty() || sample_rate <= 0 || options.masking_window_seconds <= 0.0) {
+    return true;
+  }
+  // Rows are the stems in order followed by the mix.
+  std::vector<const StreamedAudio*> sources;
+  sources.reserve(stems.size() + 1U);
+  for (const auto& stem : stems) {
+    sources.push_back(&stem);
+  }
+  sources.push_back(&mix);
+
+  MaskingPlan plan;
+  plan.rows = sources.size();
+  plan.pairs = plan.rows * (plan.rows - 1U) / 2U;
+  plan.fft_size = static_cast<size_t>(std::max(256, options.fft_size));
+  plan.hop = static_cast<size_t>(std::max(64, options.fft_hop));
+  size_t length = 0;
+  for (const StreamedAudio* source : sources) {
+    length = std::max(length, source->frame_count);
+  }
+  plan.frames = length >= plan.fft_size ? (length - plan.fft_size) / plan.hop + 1U : 0U;
+  plan.window_frames = std::max<size_t>(
+      1U, static_cast<size_t>(std::llround(options.masking_window_seconds * static_cast<double>(sample_rate))));
+  plan.windows = std::max<size_t>(1U, (length + plan.window_frames - 1U) / plan.window_frames);
+  plan.bands = BandBins(static_cast<int>(plan.fft_size), sample_rate);
+  plan.hann = BuildHann(static_cast<int>(plan.fft_size));
+
+  std::vector<double> row_power(plan.windows * plan.rows * kBandCount, 0.0);
+  std::vector<double> pair_min(plan.windows * plan.pairs * kBandCount, 0.0);
+  std::vector<double> pair_cross(pair_min.size(), 0.0);
+  std::vector<std::string> errors(plan.windows);
+  const auto run_window = [&](size_t w) {
+    AnalyzeMaskingWindow(sources, plan, w, row_power.data() + w * plan.rows * kBandCount,
+                         pair_min.data() + w * plan.pairs * kBandCount, pair_cross.data() + w * plan.pairs * kBandCount,
+                         &errors[w]);
+  };
+  TaskScheduler::Global().ParallelFor(plan.windows, static_cast<size_t>(std::max(options.max_parallel_jobs, 0)),
+                                      run_window);
+  for (const std::string& window_error : errors) {
+    if (!window_error.empty()) {
+      if (error != nullptr) {
+        *error = window_error;
+      }
+      return false;
+    }
+  }
+
+  report->present = true;
+  report->window_seconds = options.masking_window_seconds;
+  report->fft_size = static_cast<int>(plan.fft_size);
+  report->hop = static_cast<int>(plan.hop);
+  report->windows = plan.windows;
+  const size_t mix_row = plan.rows - 1U;
+  for (size_t b = 0; b < kBandCount; ++b) {
+    double mix_power = 0.0;
+    double stem_power = 0.0;
+    for (size_t w = 0; w < plan.windows; ++w) {
+      const double* powers = row_power.data() + w * plan.rows * kBandCount;
+      mix_power += powers[mix_row * kBandCount + b];
+      for (size_t r = 0; r < mix_row; ++r) {
+        stem_power += powers[r * kBandCount + b];
+      }
+    }
+    if (mix_power > kLevelFloor && stem_power > kLevelFloor) {
+      BandValue(&report->mix_summing_db, b) = SummingDb(mix_power, stem_power);
+    }
+  }
+
+  report->pairs.reserve(plan.pairs);
+  for (size_t i = 0; i < plan.rows; ++i) {
+    for (size_t j = i + 1U; j < plan.rows; ++j) {
+      MaskingPair pair;
+      pair.a = sources[i]->name;
+      pair.b = sources[j]->name;
+      pair.with_mix = j == mix_row;
+      pair.window_overlap.resize(plan.windows);
+      pair.window_cancellation_db.resize(plan.windows);
+      const size_t p = PairIndex(i, j, plan.rows);
+      double loudest = 0.0;
+      for (size_t w = 0; w < plan.windows; ++w) {
+        const double* powers = row_power.data() + w * plan.rows * kBandCount;
+        for (size_t b = 0; b < kBandCount; ++b) {
+          loudest = std::max(loudest, powers[i * kBandCount + b] + powers[j * kBandCount + b]);
+        }
+      }
+      bool have_peak = false;
+      double totals[kBandCount][3] = {};
+      for (size_t w = 0; w < plan.windows; ++w) {
+        const double* powers = row_power.data() + w * plan.rows * kBandCount;
+        const double start_seconds =
+            static_cast<double>(w * plan.window_frames) / static_cast<double>(sample_rate);
+        for (size_t b = 0; b < kBandCount; ++b) {
+          const double separate = powers[i * kBandCount + b] + powers[j * kBandCount + b];
+          const size_t slot = (w * plan.pairs + p) * kBandCount + b;
+          totals[b][0] += separate;
+          totals[b][1] += pair_min[slot];
+          totals[b][2] += pair_cross[slot];
+          if (separate <= kLevelFloor) {
+            continue;
+          }
+          const double overlap = 2.0 * pair_min[slot] / separate;
+          const double cancellation = SummingDb(separate + 2.0 * pair_cross[slot], separate);
+          BandValue(&pair.window_overlap[w], b) = overlap;
+          BandValue(&pair.window_cancellation_db[w], b) = cancellation;
+          if (separate < loudest * kPeakFloor) {
+            continue;
+          }
+          if (!have_peak || overlap > pair.peak_overlap.value) {
+            pair.peak_overlap = MaskingPeak{start_seconds, kBandNames[b], overlap};
+          }
+          if (!have_peak || cancellation < pair.peak_cancellation.value) {
+            pair.peak_cancellation = MaskingPeak{start_seconds, kBandNames[b], cancellation};
+          }
+          have_peak = true;
+        }
+      }
+      for (size_t b = 0; b < kBandCount; ++b) {
+        if (totals[b][0] > kLevelFloor) {
+          BandValue(&pair.overlap, b) = 2.0 * totals[b][1] / totals[b][0];
+          BandValue(&pair.cancellation_db, b) = SummingDb(totals[b][0] + 2.0 * totals[b][2], totals[b][0]);
+        }
+      }
+      report->pairs.push_back(std::move(pair));
+    }
+  }
+  return true;
+}
+
+}  // namespace aurora::core
@@ -2,22 +2,29 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <deque>
 #include <functional>
 #include <future>
 #include <limits>
 #include <map>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "aurora/core/loudness.hpp"
 #include "aurora/core/rng.hpp"
+#include "aurora/core/task_scheduler.hpp"
 #include "aurora/core/timebase.hpp"
 
 namespace aurora::core {
@@ -339,6 +346,7 @@ SectionConstraintState ResolveSectionConstraints(const aurora::lang::SectionDefi
 struct ExpansionResult {
   std::vector<PlayOccurrence> plays;
   std::map<std::string, std::map<std::string, AutomationLane>> automation;
+  std::vector<RenderSection> sections;
   uint64_t timeline_end = 0;
 };
 
@@ -554,6 +562,7 @@ ExpansionResult ExpandScore(const aurora::lang::AuroraFile& file, const TempoMap
     const uint64_t xfade_out_samples =
         static_cast<uint64_t>(std::llround(xfade_out_s * static_cast<double>(sample_rate)));
     out.timeline_end = std::max(out.timeline_end, section_start + section_dur);
+    out.sections.push_back(RenderSection{section.name, section_start, section_end});
     std::map<std::string, std::map<std::string, aurora::lang::ParamValue>> section_set_params_by_patch;
 
     for (const auto& event : section.events) {
@@ -1587,14 +1596,135 @@ struct Smoother1p {
   }
 };
 
+// Live counters of one render. Voices add their samples in chunks from worker threads, and whichever thread moves the
+// counters past the report interval builds a snapshot and calls RenderOptions::progress_callback under a lock.
+// Kernel choices of a draft render (RenderOptions::draft); the default is the final-quality render.
+struct DraftKernels {
+  bool enabled = false;
+  bool mono = false;
+  // Rate the output is upsampled to; bus reverb delays are sized for it so the draft keeps the final decay times.
+  int output_sample_rate = 0;
+};
+
+class RenderTelemetry {
+ public:
+  static constexpr uint64_t kFlushSamples = 4096;
+
+  RenderTelemetry(const RenderPlan& plan, const RenderOptions& options)
+      : plan_(plan),
+        callback_(options.progress_callback),
+        start_(std::chrono::steady_clock::now()),
+        patch_samples_(plan.patches.size()),
+        patch_done_(plan.patches.size()),
+        bus_done_(plan.buses.size()) {}
+
+  // `slot` indexes RenderPlan::patches.
+  void AddSamples(size_t slot, uint64_t samples) {
+    patch_samples_[slot].fetch_add(samples, std::memory_order_relaxed);
+    Report(false);
+  }
+  void VoiceStarted() { voices_in_flight_.fetch_add(1U, std::memory_order_relaxed); }
+  void VoiceFinished() { voices_in_flight_.fetch_sub(1U, std::memory_order_relaxed); }
+  void PatchFinished(size_t slot) {
+    patch_done_[slot].store(true);
+    Report(false);
+  }
+  // `slot` indexes RenderPlan::buses.
+  void BusFinished(size_t slot) {
+    bus_done_[slot].store(true);
+    Report(false);
+  }
+  void Finish() {
+    finished_.store(true);
+    Report(true);
+  }
+
+  void Report(bool force) {
+    if (!callback_) {
+      return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_).count();
+    if (!force && now_ns < next_report_ns_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+    if (force) {
+      lock.lock();
+    } else if (!lock.try_lock() || now_ns < next_report_ns_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    next_report_ns_.store(now_ns + kReportIntervalNs, std::memory_order_relaxed);
+    callback_(Snapshot(static_cast<double>(now_ns) * 1e-9));
+  }
+
+ private:
+  static constexpr int64_t kReportIntervalNs = 250'000'000;
+
+  RenderProgress Snapshot(double elapsed_seconds) const {
+    const bool finished = finished_.load();
+    RenderProgress progress;
+    progress.elapsed_seconds = elapsed_seconds;
+    progress.voices_in_flight = voices_in_flight_.load(std::memory_order_relaxed);
+    progress.buses_total = plan_.buses.size();
+    double done_seconds = 0.0;
+    progress.patches.reserve(plan_.patches.size());
+    for (size_t slot = 0; slot < plan_.patches.size(); ++slot) {
+      const RenderCostEstimate& estimate = plan_.patches[slot];
+      RenderPatchProgress patch;
+      patch.name = estimate.name;
+      patch.samples_rendered = patch_samples_[slot].load(std::memory_order_relaxed);
+      patch.samples_predicted = estimate.samples;
+      patch.done = finished || patch_done_[slot].load();
+      const double fraction =
+          patch.done ? 1.0
+                     : std::min(1.0, static_cast<double>(patch.samples_rendered) /
+                                         static_cast<double>(std::max<uint64_t>(estimate.samples, 1U)));
+      done_seconds += estimate.seconds * fraction;
+      progress.samples_rendered += patch.samples_rendered;
+      progress.samples_predicted += patch.samples_predicted;
+      progress.patches.push_back(std::move(patch));
+    }
+    for (size_t slot = 0; slot < plan_.buses.size(); ++slot) {
+      if (finished || bus_done_[slot].load()) {
+        done_seconds += plan_.buses[slot].seconds;
+        ++progress.buses_done;
+      }
+    }
+    const double fraction = finished ? 1.0 : std::min(1.0, done_seconds / std::max(plan_.work_seconds, 1e-9));
+    progress.percent = 100.0 * fraction;
+    if (elapsed_seconds > 0.0) {
+      progress.realtime_factor = fraction * plan_.metadata.duration_seconds / elapsed_seconds;
+    }
+    if (fraction > 0.0) {
+      progress.remaining_seconds = elapsed_seconds * (1.0 - fraction) / fraction;
+    }
+    return progress;
+  }
+
+  const RenderPlan& plan_;
+  const std::function<void(const RenderProgress&)>& callback_;
+  const std::chrono::steady_clock::time_point start_;
+  std::vector<std::atomic<uint64_t>> patch_samples_;
+  std::vector<std::atomic<bool>> patch_done_;
+  std::vector<std::atomic<bool>> bus_done_;
+  std::atomic<size_t> voices_in_flight_{0U};
+  std::atomic<bool> finished_{false};
+  std::atomic<int64_t> next_report_ns_{0};
+  std::mutex mutex_;
+};
+
 void RenderPlayToStem(aurora::core::AudioStem* stem, const PlayOccurrence& play, const PatchProgram& program,
                       const std::map<std::string, AutomationLane>& automation, int sample_rate, int block_size,
-                      uint64_t seed) {
+                      uint64_t seed, uint64_t stem_origin = 0, bool block_rate_modulation = false,
+                      RenderTelemetry* telemetry = nullptr, size_t telemetry_slot = 0) {
   if (stem == nullptr || stem->channels < 1 || stem->samples.empty()) {
     return;
   }
-  const size_t stem_frames = stem->samples.size() / static_cast<size_t>(stem->channels);
-  if (play.start_sample >= stem_frames) {
+  // Frame 0 of the stem is timeline sample `stem_origin`; a voice starting earlier runs from its start but only
+  // writes from there on.
+  const uint64_t stem_end = stem_origin + stem->samples.size() / static_cast<size_t>(stem->channels);
+  if (play.start_sample >= stem_end) {
     return;
   }
   const double base_gain = DbToLinear(program.gain_db) * play.velocity;
@@ -1860,7 +1990,7 @@ void RenderPlayToStem(aurora::core::AudioStem* stem, const PlayOccurrence& play,
     const uint64_t block = static_cast<uint64_t>(std::max(1, block_size));
     for (const size_t route_index : *route_indices) {
       const auto& route = program.mod_routes[route_index];
-      const bool audio_rate = route.rate == "audio";
+      const bool audio_rate = route.rate == "audio" && !block_rate_modulation;
       const bool should_update =
           audio_rate || !route_last_value_valid[route_index] || ((abs_sample % block) == 0ULL);
       if (should_update) {
@@ -2018,7 +2148,7 @@ void RenderPlayToStem(aurora::core::AudioStem* stem, const PlayOccurrence& play,
         continue;
       }
       const auto& route = program.mod_routes[route_index];
-      if (route.rate == "audio") {
+      if (route.rate == "audio" && !block_rate_modulation) {
         has_audio = true;
       } else {
         has_control = true;
@@ -2177,13 +2307,21 @@ void RenderPlayToStem(aurora::core::AudioStem* stem, const PlayOccurrence& play,
       return static_cast<double>(line[i0]) * (1.0 - frac) + static_cast<double>(line[i1]) * frac;
     };
 
+    if (telemetry != nullptr) {
+      telemetry->VoiceStarted();
+    }
+    uint64_t published_samples = 0;
     for (uint64_t i = 0; i < render_samples; ++i) {
+      if (telemetry != nullptr && i - published_samples >= RenderTelemetry::kFlushSamples) {
+        telemetry->AddSamples(telemetry_slot, i - published_samples);
+        published_samples = i;
+      }
       if (i < spread_delay_samples) {
         continue;
       }
       const uint64_t voice_i = i - spread_delay_samples;
       const uint64_t abs_sample = play.start_sample + i;
-      if (abs_sample >= stem_frames) {
+      if (abs_sample >= stem_end) {
         break;
       }
       const double t = static_cast<double>(voice_i) / sample_rate;
@@ -2610,7 +2748,10 @@ void RenderPlayToStem(aurora::core::AudioStem* stem, const PlayOccurrence& play,
       }
       const float out_left = static_cast<float>(sample_left * env * gain);
       const float out_right = static_cast<float>(sample_right * env * gain);
-      const size_t frame_index = static_cast<size_t>(abs_sample);
+      if (abs_sample < stem_origin) {
+        continue;
+      }
+      const size_t frame_index = static_cast<size_t>(abs_sample - stem_origin);
       if (stem->channels == 1) {
         stem->samples[frame_index] += 0.5f * (out_left + out_right);
       } else {
@@ -2621,6 +2762,11 @@ void RenderPlayToStem(aurora::core::AudioStem* stem, const PlayOccurrence& play,
         }
       }
     }
+    if (telemetry != nullptr) {
+      telemetry->AddSamples(telemetry_slot,
+                            std::min<uint64_t>(render_samples, stem_end - play.start_sample) - published_samples);
+      telemetry->VoiceFinished();
+    }
   }
 }
 
@@ -2738,7 +2884,68 @@ double ReadDelayTap(const std::vector<float>& line, size_t write_idx, double del
   return static_cast<double>(line[i0]) * (1.0 - frac) + static_cast<double>(line[i1]) * frac;
 }
 
-void ProcessBusStem(aurora::core::AudioStem* stem, const BusProgram& program, int sample_rate) {
+// Adds `source` into `bus` from bus frame `bus_first_frame` on at `send_gain`, folding or spreading channels to the
+// bus layout.
+void AddSendToBus(const AudioStem& source, float send_gain, AudioStem* bus, size_t bus_first_frame = 0) {
+  const int src_channels = source.channels;
+  const int bus_channels = bus->channels;
+  const size_t bus_frames = bus->samples.size() / static_cast<size_t>(std::max(bus_channels, 1));
+  if (bus_first_frame >= bus_frames) {
+    return;
+  }
+  const size_t frames = std::min(source.samples.size() / static_cast<size_t>(std::max(src_channels, 1)),
+                                 bus_frames - bus_first_frame);
+  float* const bus_samples = bus->samples.data() + bus_first_frame * static_cast<size_t>(bus_channels);
+  for (size_t frame = 0; frame < frames; ++frame) {
+    float src_l = 0.0f;
+    float src_r = 0.0f;
+    if (src_channels == 1) {
+      src_l = source.samples[frame];
+      src_r = src_l;
+    } else {
+      const size_t base = frame * 2U;
+      src_l = source.samples[base];
+      src_r = source.samples[base + 1U];
+    }
+    if (bus_channels == 1) {
+      bus_samples[frame] += 0.5f * (src_l + src_r) * send_gain;
+    } else {
+      const size_t base = frame * 2U;
+      bus_samples[base] += src_l * send_gain;
+      bus_samples[base + 1U] += src_r * send_gain;
+    }
+  }
+}
+
+constexpr std::array<int, 4> kReverbCombLengths{1116, 1188, 1277, 1356};
+constexpr double kMaxBusPrerollSeconds = 30.0;
+
+double ReverbCombFeedback(const BusProgram& program, int sample_rate) {
+  return Clamp(1.0 - std::exp(-3.0 / (program.reverb_decay * static_cast<double>(sample_rate))), 0.2, 0.97);
+}
+
+// How long the bus keeps sounding after its input stops, until its delay and reverb have fallen by 60 dB, capped at
+// kMaxBusPrerollSeconds. A range render starts the bus this long before the range so its tails are in place there.
+double BusTailSeconds(const BusProgram& program, int sample_rate) {
+  const double kDecayRatio = std::log(1e-3);
+  double tail = 0.0;
+  if (program.has_delay && program.delay_fb > 0.0) {
+    const double period = program.delay_time_seconds + std::max(0.0, program.delay_mod_depth_seconds);
+    tail += period * (1.0 + kDecayRatio / std::log(program.delay_fb));
+  } else if (program.has_delay) {
+    tail += program.delay_time_seconds;
+  }
+  if (program.has_reverb) {
+    const double comb_seconds = Clamp(program.reverb_size, 0.1, 1.0) * kReverbCombLengths.back() /
+                                static_cast<double>(sample_rate);
+    tail += program.reverb_predelay_seconds +
+            comb_seconds * kDecayRatio / std::log(ReverbCombFeedback(program, sample_rate));
+  }
+  return std::min(tail, kMaxBusPrerollSeconds);
+}
+
+void ProcessBusStem(aurora::core::AudioStem* stem, const BusProgram& program, int sample_rate,
+                    const DraftKernels& draft = DraftKernels{}) {
   if (stem == nullptr || stem->samples.empty()) {
     return;
   }
@@ -2800,16 +3007,22 @@ void ProcessBusStem(aurora::core::AudioStem* stem, const BusProgram& program, in
     std::vector<float> pred_l(static_cast<size_t>(predelay_samples), 0.0f);
     std::vector<float> pred_r(static_cast<size_t>(predelay_samples), 0.0f);
     size_t pred_idx = 0;
-    const double size_scale = Clamp(program.reverb_size, 0.1, 1.0);
-    const std::array<int, 4> comb_base{1116, 1188, 1277, 1356};
-    std::vector<std::vector<float>> comb_l(4), comb_r(4);
+    // Comb lengths are in samples of the output rate; a draft scales them to its own rate and runs two of the four.
+    const int comb_rate = draft.enabled ? draft.output_sample_rate : sample_rate;
+    const double rate_scale = static_cast<double>(sample_rate) / static_cast<double>(comb_rate);
+    const double size_scale = Clamp(program.reverb_size, 0.1, 1.0) * rate_scale;
+    const size_t comb_count = draft.enabled ? 2U : kReverbCombLengths.size();
+    const std::array<int, 4>& comb_base = kReverbCombLengths;
+    std::vector<std::vector<float>> comb_l(comb_count), comb_r(comb_count);
     std::array<size_t, 4> comb_idx{0, 0, 0, 0};
-    for (size_t i = 0; i < 4; ++i) {
+    const int stereo_offset = channels == 2 ? static_cast<int>(std::llround(23.0 * rate_scale)) : 0;
+    for (size_t i = 0; i < comb_count; ++i) {
       const int len = std::max(8, static_cast<int>(std::llround(comb_base[i] * size_scale)));
       comb_l[i].assign(static_cast<size_t>(len), 0.0f);
-      comb_r[i].assign(static_cast<size_t>(len + (channels == 2 ? 23 : 0)), 0.0f);
+      comb_r[i].assign(static_cast<size_t>(len + stereo_offset), 0.0f);
     }
-    const double fb = Clamp(1.0 - std::exp(-3.0 / (program.reverb_decay * static_cast<double>(sample_rate))), 0.2, 0.97);
+    const double fb = ReverbCombFeedback(program, comb_rate);
+    const double comb_norm = 1.0 / static_cast<double>(comb_count);
     double lp_l = 0.0, lp_r = 0.0;
     double hp_lp_l = 0.0, hp_lp_r = 0.0;
     for (size_t f = 0; f < frames; ++f) {
@@ -2822,7 +3035,7 @@ void ProcessBusStem(aurora::core::AudioStem* stem, const BusProgram& program, in
       pred_r[pred_idx] = static_cast<float>(dry_r);
       pred_idx = (pred_idx + 1U) % pred_l.size();
       double wet_l = 0.0, wet_r = 0.0;
-      for (size_t i = 0; i < 4; ++i) {
+      for (size_t i = 0; i < comb_count; ++i) {
         auto& cl = comb_l[i];
         auto& cr = comb_r[i];
         const size_t il = comb_idx[i] % cl.size();
@@ -2835,8 +3048,8 @@ void ProcessBusStem(aurora::core::AudioStem* stem, const BusProgram& program, in
         wet_l += yl;
         wet_r += yr;
       }
-      wet_l *= 0.25;
-      wet_r *= 0.25;
+      wet_l *= comb_norm;
+      wet_r *= comb_norm;
       wet_l = OnePoleLP(wet_l, program.reverb_hicut_hz, sample_rate, &lp_l);
       wet_r = OnePoleLP(wet_r, program.reverb_hicut_hz, sample_rate, &lp_r);
       wet_l = OnePoleHP(wet_l, program.reverb_locut_hz, sample_rate, &hp_lp_l);
@@ -2856,6 +3069,159 @@ void ProcessBusStem(aurora::core::AudioStem* stem, const BusProgram& program, in
   stem->samples.swap(work);
 }
 
+// Stem channel count of a patch: stereo as soon as any stage places or widens the voice.
+int PatchChannels(const aurora::lang::PatchDefinition& patch, const PatchProgram& program) {
+  bool has_spatial_node = false;
+  for (const auto& node : patch.graph.nodes) {
+    if (node.type == "pan" || node.type == "stereo_width" || node.type == "depth" || node.type == "decorrelate") {
+      has_spatial_node = true;
+    }
+  }
+  return (program.binaural.enabled || program.pan.enabled || program.stereo_width.enabled || program.depth.enabled ||
+          program.decorrelate.enabled || has_spatial_node || patch.voice_spread.pan > 0.0)
+             ? 2
+             : 1;
+}
+
+// Per-sample cost of the voice stages relative to one oscillator. Only the ratios matter: the calibration below
+// turns units into seconds on the running machine.
+constexpr double kVoiceBaseUnits = 1.5;  // envelope, gain, click fades and the stem write
+constexpr double kOscillatorUnits = 1.0;
+constexpr double kNoiseUnits = 0.4;
+constexpr double kFilterUnitsPer12Db = 0.8;
+constexpr double kModulatorUnits = 0.5;  // each LFO, mod route and CV node
+constexpr double kShaperUnits = 0.6;     // ring mod, softclip, audio mix, comb
+constexpr double kSpatialUnits = 0.5;    // binaural, pan, width, depth, decorrelate
+constexpr double kStereoVoiceFactor = 1.3;
+// Samples the calibration renders per run; long enough to dwarf timer resolution, short enough to go unnoticed.
+constexpr uint64_t kCalibrationSamples = 16384;
+constexpr int kCalibrationRuns = 3;
+
+double VoiceUnitsPerSample(const PatchProgram& program, int channels) {
+  double units = kVoiceBaseUnits + kOscillatorUnits * static_cast<double>(program.oscillators.size());
+  if (program.noise_white || program.sample_player) {
+    units += kNoiseUnits;
+  }
+  if (program.filter.enabled) {
+    units += kFilterUnitsPer12Db * static_cast<double>(std::max(1, program.filter.slope_db / 12));
+  }
+  units += kModulatorUnits *
+           static_cast<double>(program.lfos.size() + program.mod_routes.size() + program.cv_nodes.size());
+  for (const bool shaper : {program.ring_mod.enabled, program.softclip.enabled, program.audio_mix.enabled,
+                            program.comb.enabled}) {
+    units += shaper ? kShaperUnits : 0.0;
+  }
+  for (const bool spatial : {program.binaural.enabled, program.pan.enabled, program.stereo_width.enabled,
+                             program.depth.enabled, program.decorrelate.enabled}) {
+    units += spatial ? kSpatialUnits : 0.0;
+  }
+  return channels == 2 ? units * kStereoVoiceFactor : units;
+}
+
+// Samples one voice of `play` renders: the note plus its envelope tail, clipped to the stem.
+uint64_t VoiceSamples(const PlayOccurrence& play, const PatchProgram& program, int sample_rate, uint64_t total_samples) {
+  if (play.start_sample >= total_samples) {
+    return 0;
+  }
+  uint64_t samples = play.dur_samples;
+  if (program.env.enabled) {
+    if (program.env.mode == PatchProgram::Env::Mode::kAd) {
+      samples = std::max<uint64_t>(samples, static_cast<uint64_t>(std::llround(
+                                                (std::max(0.0001, program.env.a) + std::max(0.0001, program.env.d)) *
+                                                static_cast<double>(sample_rate))));
+    } else {
+      samples += static_cast<uint64_t>(std::llround(std::max(0.0001, program.env.r) * static_cast<double>(sample_rate)));
+    }
+  }
+  return std::min(samples, total_samples - play.start_sample);
+}
+
+double BusUnitsPerSample(const BusProgram& program) {
+  return (program.has_delay ? 1.0 : 0.0) + (program.has_reverb ? 1.0 : 0.0);
+}
+
+struct CostCalibration {
+  double seconds_per_voice_unit = 0.0;
+  double seconds_per_delay_frame = 0.0;
+  double seconds_per_reverb_frame = 0.0;
+};
+
+template <typename Body>
+double FastestRunSeconds(const Body& body) {
+  double best = 0.0;
+  for (int run = 0; run < kCalibrationRuns; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    best = run == 0 ? seconds : std::min(best, seconds);
+  }
+  return best;
+}
+
+// Times a reference voice (one saw, 12 dB filter, ADSR) and a stereo delay and reverb bus through the real render
+// code. Runs once per process.
+CostCalibration MeasureCostCalibration() {
+  constexpr int kSampleRate = 48000;
+  CostCalibration calibration;
+
+  PatchProgram voice;
+  PatchProgram::Osc osc;
+  osc.type = "osc_saw_blep";
+  voice.oscillators.push_back(osc);
+  voice.env.enabled = true;
+  voice.env.r = 0.0001;
+  voice.filter.enabled = true;
+  PlayOccurrence play;
+  play.patch = "calibration";
+  play.dur_samples = kCalibrationSamples;
+  play.pitches.push_back(ResolvedPitch{});
+  AudioStem stem;
+  stem.channels = 1;
+  const std::map<std::string, AutomationLane> no_automation;
+  const uint64_t voice_samples = VoiceSamples(play, voice, kSampleRate, kCalibrationSamples * 2U);
+  const double voice_seconds = FastestRunSeconds([&]() {
+    stem.samples.assign(static_cast<size_t>(kCalibrationSamples * 2U), 0.0f);
+    RenderPlayToStem(&stem, play, voice, no_automation, kSampleRate, 256, 0);
+  });
+  calibration.seconds_per_voice_unit =
+      voice_seconds / (static_cast<double>(voice_samples) * VoiceUnitsPerSample(voice, stem.channels));
+
+  AudioStem bus;
+  bus.channels = 2;
+  const auto time_bus = [&](const BusProgram& program) {
+    return FastestRunSeconds([&]() {
+             bus.samples.assign(static_cast<size_t>(kCalibrationSamples) * 2U, 0.25f);
+             ProcessBusStem(&bus, program, kSampleRate);
+           }) /
+           static_cast<double>(kCalibrationSamples);
+  };
+  BusProgram delay;
+  delay.channels = 2;
+  delay.has_delay = true;
+  calibration.seconds_per_delay_frame = time_bus(delay);
+  BusProgram reverb;
+  reverb.channels = 2;
+  reverb.has_reverb = true;
+  calibration.seconds_per_reverb_frame = time_bus(reverb);
+  return calibration;
+}
+
+const CostCalibration& GetCostCalibration() {
+  static const CostCalibration calibration = MeasureCostCalibration();
+  return calibration;
+}
+
+bool LongerFirst(const RenderCostEstimate& a, const RenderCostEstimate& b) { return a.seconds > b.seconds; }
+
+// Makespan of assigning each estimate, longest first, to the least loaded of `threads`.
+double ListScheduleSeconds(const std::vector<RenderCostEstimate>& longest_first, size_t threads) {
+  std::vector<double> load(std::max<size_t>(threads, 1U), 0.0);
+  for (const RenderCostEstimate& estimate : longest_first) {
+    *std::min_element(load.begin(), load.end()) += estimate.seconds;
+  }
+  return *std::max_element(load.begin(), load.end());
+}
+
 int ParamToCC(const std::string& key) {
   if (EndsWith(key, ".cutoff")) {
     return 74;
@@ -2879,18 +3245,107 @@ uint8_t ParamValueToCC(const std::string& key, double value) {
   return static_cast<uint8_t>(std::llround(Clamp(value, 0.0, 1.0) * 127.0));
 }
 
-}  // namespace
+// The expanded score and everything derived from it before any audio is rendered.
+struct PreparedScore {
+  RenderMetadata metadata;
+  ExpansionResult expanded;
+  std::map<std::string, PatchProgram> patch_programs;
+  // Timeline sample the render stops at: the end of the range, or metadata.total_samples for a whole render.
+  uint64_t render_end = 0;
+  // Samples buses run before metadata.start_sample, and the patches sending to them render before it as well.
+  uint64_t bus_preroll = 0;
+  std::string range_error;
+  // Patches and buses left out by RenderOptions::only_patches / only_buses.
+  std::set<std::string> excluded_patches;
+  std::set<std::string> excluded_buses;
+};
 
-RenderResult Renderer::Render(const aurora::lang::AuroraFile& file, const RenderOptions& options) const {
-  RenderResult result;
-  result.metadata.sample_rate = options.sample_rate_override > 0 ? options.sample_rate_override : file.globals.sr;
-  result.metadata.block_size = file.globals.block;
+// Patches and buses a selection renders: the selected ones and every patch sending to a selected bus. Unknown names
+// fail when `error` is given and are skipped otherwise.
+bool SelectionClosure(const aurora::lang::AuroraFile& file, const RenderOptions& options,
+                      std::set<std::string>* patches, std::set<std::string>* buses, std::string* error) {
+  const auto select = [&](const std::set<std::string>& names, const auto& defined, const char* kind,
+                          std::set<std::string>* selected) {
+    for (const std::string& name : names) {
+      if (std::any_of(defined.begin(), defined.end(), [&](const auto& item) { return item.name == name; })) {
+        selected->insert(name);
+      } else if (error != nullptr) {
+        *error = "Unknown " + std::string(kind) + " '" + name + "' in stem selection.";
+        return false;
+      }
+    }
+    return true;
+  };
+  if (!select(options.only_patches, file.patches, "patch", patches) ||
+      !select(options.only_buses, file.buses, "bus", buses)) {
+    return false;
+  }
+  for (const auto& patch : file.patches) {
+    if (patch.send.has_value() && buses->count(patch.send->bus) != 0U) {
+      patches->insert(patch.name);
+    }
+  }
+  return true;
+}
+
+// Resolves one range bound to a timeline sample; a section bounds the range with its start or, for `is_end`, its end.
+bool ResolveTimeRef(const RenderTimeRef& ref, bool is_end, const RenderMetadata& metadata, const TempoMap& tempo_map,
+                    uint64_t* sample, std::string* error) {
+  if (!ref.section.empty()) {
+    for (const RenderSection& section : metadata.sections) {
+      if (section.name == ref.section) {
+        *sample = is_end ? section.end_sample : section.start_sample;
+        return true;
+      }
+    }
+    *error = "Unknown section '" + ref.section + "' in render range.";
+    return false;
+  }
+  if (ref.time.value < 0.0) {
+    *error = "Render range bounds must not be negative.";
+    return false;
+  }
+  try {
+    *sample = ToSamples(ref.time, tempo_map, metadata.sample_rate);
+  } catch (const std::exception& ex) {
+    *error = ex.what();
+    return false;
+  }
+  return true;
+}
+
+bool ResolveRenderRange(const RenderOptions& options, const RenderMetadata& metadata, const TempoMap& tempo_map,
+                        uint64_t* start_sample, uint64_t* end_sample, std::string* error) {
+  *start_sample = 0;
+  *end_sample = metadata.total_samples;
+  if (options.range_from.has_value() &&
+      !ResolveTimeRef(*options.range_from, false, metadata, tempo_map, start_sample, error)) {
+    return false;
+  }
+  if (options.range_to.has_value() && !ResolveTimeRef(*options.range_to, true, metadata, tempo_map, end_sample, error)) {
+    return false;
+  }
+  *end_sample = std::min(*end_sample, metadata.total_samples);
+  if (*start_sample >= *end_sample) {
+    *error = "Render range is empty: it must start before it ends and before the end of the timeline (" +
+             std::to_string(metadata.total_samples) + " samples).";
+    return false;
+  }
+  return true;
+}
+
+PreparedScore PrepareScore(const aurora::lang::AuroraFile& file, const RenderOptions& options) {
+  PreparedScore prepared;
+  RenderMetadata& metadata = prepared.metadata;
+  metadata.sample_rate = options.sample_rate_override > 0 ? options.sample_rate_override : file.globals.sr;
+  metadata.block_size = file.globals.block;
 
   const TempoMap tempo_map = BuildTempoMap(file.globals);
-  ExpansionResult expanded = ExpandScore(file, tempo_map, result.metadata.sample_rate, options.seed);
+  prepared.expanded = ExpandScore(file, tempo_map, metadata.sample_rate, options.seed);
+  ExpansionResult& expanded = prepared.expanded;
   ApplyMonoPolicies(file, &expanded.plays);
 
-  std::map<std::string, PatchProgram> patch_programs;
+  std::map<std::string, PatchProgram>& patch_programs = prepared.patch_programs;
   for (const auto& patch : file.patches) {
     patch_programs[patch.name] = BuildPatchProgram(patch);
   }
@@ -2906,239 +3361,695 @@ RenderResult Renderer::Render(const aurora::lang::AuroraFile& file, const Render
     if (env.enabled) {
       if (env.mode == PatchProgram::Env::Mode::kAd) {
         const uint64_t ad =
-            static_cast<uint64_t>(std::llround((std::max(0.0001, env.a) + std::max(0.0001, env.d)) * result.metadata.sample_rate));
+            static_cast<uint64_t>(std::llround((std::max(0.0001, env.a) + std::max(0.0001, env.d)) * metadata.sample_rate));
         const uint64_t note = play.dur_samples;
         extra = (ad > note) ? (ad - note) : 0;
       } else {
-        extra = static_cast<uint64_t>(std::llround(std::max(0.0001, env.r) * result.metadata.sample_rate));
+        extra = static_cast<uint64_t>(std::llround(std::max(0.0001, env.r) * metadata.sample_rate));
       }
     }
     timeline_with_env_tails = std::max<uint64_t>(timeline_with_env_tails, play.start_sample + play.dur_samples + extra);
   }
 
   const uint64_t tail_samples = static_cast<uint64_t>(
-      std::llround(file.globals.tail_policy.fixed_seconds * static_cast<double>(result.metadata.sample_rate)));
+      std::llround(file.globals.tail_policy.fixed_seconds * static_cast<double>(metadata.sample_rate)));
   const uint64_t total_samples =
-      RoundUpToBlock(std::max<uint64_t>(timeline_with_env_tails, 1) + tail_samples, result.metadata.block_size);
-  result.metadata.total_samples = total_samples;
-  result.metadata.duration_seconds = static_cast<double>(total_samples) / static_cast<double>(result.metadata.sample_rate);
+      RoundUpToBlock(std::max<uint64_t>(timeline_with_env_tails, 1) + tail_samples, metadata.block_size);
+  metadata.total_samples = total_samples;
+  metadata.duration_seconds = static_cast<double>(total_samples) / static_cast<double>(metadata.sample_rate);
+  metadata.sections = expanded.sections;
+  prepared.render_end = total_samples;
+  // A selection drops the plays of the patches it leaves out once the timeline length is fixed, so the stems it
+  // renders line up with those of a whole render.
+  if (!options.only_patches.empty() || !options.only_buses.empty()) {
+    std::set<std::string> patches;
+    std::set<std::string> buses;
+    SelectionClosure(file, options, &patches, &buses, nullptr);
+    for (const auto& patch : file.patches) {
+      if (patches.count(patch.name) == 0U) {
+        prepared.excluded_patches.insert(patch.name);
+      }
+    }
+    for (const auto& bus : file.buses) {
+      if (buses.count(bus.name) == 0U) {
+        prepared.excluded_buses.insert(bus.name);
+      }
+    }
+    std::erase_if(expanded.plays,
+                  [&](const PlayOccurrence& play) { return prepared.excluded_patches.count(play.patch) != 0U; });
+  }
+  if (!options.range_from.has_value() && !options.range_to.has_value()) {
+    return prepared;
+  }
+  uint64_t range_start = 0;
+  uint64_t range_end = total_samples;
+  if (!ResolveRenderRange(options, metadata, tempo_map, &range_start, &range_end, &prepared.range_error)) {
+    return prepared;
+  }
 
-  std::map<std::string, AudioStem> patch_buffers;
-  for (const auto& patch : file.patches) {
-    const auto program_it = patch_programs.find(patch.name);
-    if (program_it == patch_programs.end()) {
-      continue;
+  std::set<std::string> fed_buses;
+  for (const auto& [name, program] : patch_programs) {
+    if (program.send.has_value() && prepared.excluded_patches.count(name) == 0U &&
+        prepared.excluded_buses.count(program.send->bus) == 0U) {
+      fed_buses.insert(program.send->bus);
     }
-    const PatchProgram& program = program_it->second;
-    bool has_pan_node = false;
-    bool has_stereo_width_node = false;
-    bool has_depth_node = false;
-    bool has_decorrelate_node = false;
-    for (const auto& node : patch.graph.nodes) {
-      if (node.type == "pan") {
-        has_pan_node = true;
-      } else if (node.type == "stereo_width") {
-        has_stereo_width_node = true;
-      } else if (node.type == "depth") {
-        has_depth_node = true;
-      } else if (node.type == "decorrelate") {
-        has_decorrelate_node = true;
-      }
-    }
-    AudioStem buffer;
-    buffer.name = patch.name;
-    buffer.channels =
-        (program.binaural.enabled || program.pan.enabled || program.stereo_width.enabled || program.depth.enabled ||
-         program.decorrelate.enabled || has_pan_node || has_stereo_width_node || has_depth_node || has_decorrelate_node ||
-         patch.voice_spread.pan > 0.0)
-            ? 2
-            : 1;
-    buffer.samples.assign(static_cast<size_t>(total_samples) * static_cast<size_t>(buffer.channels), 0.0f);
-    patch_buffers[patch.name] = std::move(buffer);
-  }
-
-  const uint64_t progress_total_units =
-      std::max<uint64_t>(1, static_cast<uint64_t>(expanded.plays.size()) + static_cast<uint64_t>(file.buses.size()) + 1U);
-  uint64_t progress_done_units = 0;
-  double last_progress_reported = -1.0;
-  auto last_progress_time = std::chrono::steady_clock::now();
-  auto report_progress = [&](bool force) {
-    if (!options.progress_callback) {
-      return;
+  }
+  double preroll_seconds = 0.0;
+  for (const auto& bus : file.buses) {
+    if (fed_buses.count(bus.name) != 0U) {
+      preroll_seconds = std::max(preroll_seconds, BusTailSeconds(BuildBusProgram(bus), metadata.sample_rate));
     }
-    const double pct = 100.0 * static_cast<double>(progress_done_units) / static_cast<double>(progress_total_units);
-    const auto now = std::chrono::steady_clock::now();
-    const bool time_due = (now - last_progress_time) >= std::chrono::milliseconds(500);
-    const bool step_due = (pct - last_progress_reported) >= 0.5;
-    if (!force && !time_due && !step_due) {
-      return;
+  }
+  prepared.bus_preroll = std::min<uint64_t>(
+      range_start, static_cast<uint64_t>(std::ceil(preroll_seconds * static_cast<double>(metadata.sample_rate))));
+  // A play is kept when its voice, release tail included, sounds anywhere its patch's stem covers.
+  expanded.plays.erase(
+      std::remove_if(expanded.plays.begin(), expanded.plays.end(),
+                     [&](const PlayOccurrence& play) {
+                       const auto program_it = patch_programs.find(play.patch);
+                       if (program_it == patch_programs.end()) {
+                         return false;
+                       }
+                       const uint64_t first =
+                           range_start - (program_it->second.send.has_value() ? prepared.bus_preroll : 0U);
+                       const PatchProgram& program = program_it->second;
+                       const uint64_t spread_delay =
+                           program.voice_spread.enabled
+                               ? static_cast<uint64_t>(std::ceil(std::max(0.0, program.voice_spread.delay_seconds) *
+                                                                 static_cast<double>(metadata.sample_rate)))
+                               : 0U;
+                       const uint64_t voice_end = play.start_sample + spread_delay +
+                                                  VoiceSamples(play, program, metadata.sample_rate, range_end);
+                       return play.start_sample >= range_end || voice_end <= first;
+                     }),
+      expanded.plays.end());
+
+  std::vector<RenderSection> sections;
+  for (const RenderSection& section : metadata.sections) {
+    if (section.end_sample > range_start && section.start_sample < range_end) {
+      sections.push_back(RenderSection{section.name, std::max(section.start_sample, range_start) - range_start,
+                                       std::min(section.end_sample, range_end) - range_start});
     }
-    options.progress_callback(pct);
-    last_progress_reported = pct;
-    last_progress_time = now;
-  };
-  report_progress(true);
+  }
+  metadata.sections = std::move(sections);
+  metadata.start_sample = range_start;
+  metadata.total_samples = range_end - range_start;
+  metadata.duration_seconds =
+      static_cast<double>(metadata.total_samples) / static_cast<double>(metadata.sample_rate);
+  prepared.render_end = range_end;
+  return prepared;
+}
 
-  std::map<std::string, std::vector<const PlayOccurrence*>> plays_by_patch;
-  for (const auto& play : expanded.plays) {
-    const auto patch_it = patch_programs.find(play.patch);
-    const auto stem_it = patch_buffers.find(play.patch);
-    if (patch_it == patch_programs.end() || stem_it == patch_buffers.end()) {
-      result.warnings.push_back("Event references unknown patch '" + play.patch + "'.");
-      continue;
+RenderPlan BuildRenderPlan(const aurora::lang::AuroraFile& file, const PreparedScore& prepared) {
+  const CostCalibration& calibration = GetCostCalibration();
+  RenderPlan plan;
+  plan.metadata = prepared.metadata;
+  plan.threads = TaskScheduler::Global().concurrency();
+  const uint64_t total_samples = plan.metadata.total_samples;
+
+  std::map<std::string, uint64_t> voice_samples;
+  for (const auto& play : prepared.expanded.plays) {
+    const auto program_it = prepared.patch_programs.find(play.patch);
+    if (program_it != prepared.patch_programs.end()) {
+      voice_samples[play.patch] +=
+          VoiceSamples(play, program_it->second, plan.metadata.sample_rate, prepared.render_end) * play.pitches.size();
     }
-    plays_by_patch[play.patch].push_back(&play);
   }
-
-  struct PatchFuture {
-    std::string patch_name;
-    std::future<size_t> future;
-  };
-  std::vector<PatchFuture> patch_futures;
   for (const auto& patch : file.patches) {
-    const std::string patch_name = patch.name;
-    const auto plays_it = plays_by_patch.find(patch_name);
-    if (plays_it == plays_by_patch.end() || plays_it->second.empty()) {
+    const auto samples_it = voice_samples.find(patch.name);
+    const auto program_it = prepared.patch_programs.find(patch.name);
+    if (samples_it == voice_samples.end() || program_it == prepared.patch_programs.end()) {
       continue;
     }
-    const std::vector<const PlayOccurrence*> play_list = plays_it->second;
-    const int sample_rate = result.metadata.sample_rate;
-    const int block_size = result.metadata.block_size;
-    patch_futures.push_back(PatchFuture{
-        patch_name,
-        std::async(std::launch::async, [&patch_programs, &patch_buffers, &expanded, play_list, patch_name, &options, sample_rate,
-                                        block_size]() {
-          size_t rendered_count = 0;
-          const auto patch_it = patch_programs.find(patch_name);
-          const auto stem_it = patch_buffers.find(patch_name);
-          if (patch_it == patch_programs.end() || stem_it == patch_buffers.end()) {
-            return rendered_count;
-          }
-          const auto auto_it = expanded.automation.find(patch_name);
-          const std::map<std::string, AutomationLane> empty_auto;
-          const auto& automation = (auto_it != expanded.automation.end()) ? auto_it->second : empty_auto;
-          for (const PlayOccurrence* play_ptr : play_list) {
-            if (play_ptr == nullptr) {
-              continue;
-            }
-            RenderPlayToStem(&stem_it->second, *play_ptr, patch_it->second, automation, sample_rate, block_size,
-                             options.seed);
-            ++rendered_count;
-          }
-          return rendered_count;
-        })});
-  }
-  for (auto& task : patch_futures) {
-    progress_done_units += static_cast<uint64_t>(task.future.get());
-    report_progress(false);
+    RenderCostEstimate estimate;
+    estimate.name = patch.name;
+    estimate.samples = samples_it->second;
+    estimate.units_per_sample = VoiceUnitsPerSample(program_it->second, PatchChannels(patch, program_it->second));
+    estimate.seconds =
+        static_cast<double>(estimate.samples) * estimate.units_per_sample * calibration.seconds_per_voice_unit;
+    plan.patches.push_back(std::move(estimate));
   }
-
-  std::map<std::string, AudioStem> bus_buffers;
-  std::map<std::string, BusProgram> bus_programs;
   for (const auto& bus : file.buses) {
+    if (prepared.excluded_buses.count(bus.name) != 0U) {
+      continue;
+    }
     const BusProgram program = BuildBusProgram(bus);
-    AudioStem buffer;
-    buffer.name = bus.name;
-    buffer.channels = program.channels;
-    buffer.samples.assign(static_cast<size_t>(total_samples) * static_cast<size_t>(buffer.channels), 0.0f);
-    bus_buffers[bus.name] = std::move(buffer);
-    bus_programs[bus.name] = program;
+    RenderCostEstimate estimate;
+    estimate.name = bus.name;
+    estimate.samples = total_samples + prepared.bus_preroll;
+    estimate.units_per_sample = BusUnitsPerSample(program);
+    // The bus effects run both channels of their state even for a mono bus, so the stereo calibration applies as is.
+    estimate.seconds = static_cast<double>(estimate.samples) *
+                       ((program.has_delay ? calibration.seconds_per_delay_frame : 0.0) +
+                        (program.has_reverb ? calibration.seconds_per_reverb_frame : 0.0));
+    plan.buses.push_back(std::move(estimate));
+  }
+  std::stable_sort(plan.patches.begin(), plan.patches.end(), LongerFirst);
+  std::stable_sort(plan.buses.begin(), plan.buses.end(), LongerFirst);
+  for (const auto* estimates : {&plan.patches, &plan.buses}) {
+    for (const RenderCostEstimate& estimate : *estimates) {
+      plan.work_seconds += estimate.seconds;
+    }
   }
+  plan.predicted_seconds =
+      ListScheduleSeconds(plan.patches, plan.threads) + ListScheduleSeconds(plan.buses, plan.threads);
+  return plan;
+}
 
+// One track per patch with the notes and per-block automation CCs of the rendered window.
+std::vector<MidiTrackData> BuildMidiTracks(const aurora::lang::AuroraFile& file, const PreparedScore& prepared,
+                                           const RenderOptions& options) {
+  const uint64_t range_start = prepared.metadata.start_sample;
+  const uint64_t total_samples = prepared.metadata.total_samples;
+  std::map<std::string, MidiTrackData> midi_by_patch;
   for (const auto& patch : file.patches) {
-    const auto program_it = patch_programs.find(patch.name);
-    if (program_it == patch_programs.end()) {
+    MidiTrackData track;
+    track.name = patch.name;
+    midi_by_patch[patch.name] = std::move(track);
+  }
+  for (const auto& play : prepared.expanded.plays) {
+    auto it = midi_by_patch.find(play.patch);
+    if (it == midi_by_patch.end()) {
       continue;
     }
-    const auto& program = program_it->second;
-    if (!program.send.has_value() || program.send->bus.empty()) {
+    // A range render keeps plays whose release reaches into the range, but their notes ended before it.
+    if (range_start > 0U && play.start_sample + play.dur_samples <= range_start) {
       continue;
     }
-    const auto bus_it = bus_buffers.find(program.send->bus);
-    const auto source_it = patch_buffers.find(patch.name);
-    if (bus_it == bus_buffers.end() || source_it == patch_buffers.end()) {
+    const int channel = static_cast<int>(std::distance(midi_by_patch.begin(), it)) % 16;
+    for (const auto& pitch : play.pitches) {
+      MidiNote note;
+      note.channel = channel;
+      note.note = std::clamp(pitch.midi, 0, 127);
+      note.velocity = static_cast<uint8_t>(std::llround(Clamp(play.velocity, 0.0, 1.0) * 127.0));
+      note.start_sample = std::min(std::max(play.start_sample, range_start) - range_start, total_samples);
+      note.end_sample = std::min(play.start_sample + play.dur_samples - range_start, total_samples);
+      if (note.end_sample <= note.start_sample) {
+        note.end_sample = note.start_sample + 1;
+      }
+      it->second.notes.push_back(note);
+    }
+  }
+
+  const int cc_tolerance = std::clamp(options.midi_cc_tolerance, 0, 127);
+  for (const auto& [patch_name, lanes] : prepared.expanded.automation) {
+    auto it = midi_by_patch.find(patch_name);
+    if (it == midi_by_patch.end()) {
       continue;
     }
-    AudioStem& bus_stem = bus_it->second;
-    const AudioStem& src_stem = source_it->second;
-    const float send_gain = static_cast<float>(DbToLinear(program.send->amount_db));
-    const int src_channels = src_stem.channels;
-    const int bus_channels = bus_stem.channels;
-    for (size_t frame = 0; frame < static_cast<size_t>(total_samples); ++frame) {
-      float src_l = 0.0f;
-      float src_r = 0.0f;
-      if (src_channels == 1) {
-        src_l = src_stem.samples[frame];
-        src_r = src_l;
-      } else {
-        const size_t base = frame * 2U;
-        src_l = src_stem.samples[base];
-        src_r = src_stem.samples[base + 1U];
+    const int channel = static_cast<int>(std::distance(midi_by_patch.begin(), it)) % 16;
+    for (const auto& [key, lane] : lanes) {
+      const int cc = ParamToCC(key);
+      // Lanes are sampled once per block, but a point is only emitted when the 7-bit value moves by more than the
+      // tolerance from the last emitted value; receivers hold CC values, so tolerance 0 is lossless.
+      const uint64_t block = static_cast<uint64_t>(std::max(1, prepared.metadata.block_size));
+      const uint64_t last_block_sample = total_samples == 0 ? 0 : ((total_samples - 1U) / block) * block;
+      bool emitted_any = false;
+      int last_emitted = 0;
+      for (uint64_t sample = 0; sample < total_samples; sample += block) {
+        const uint8_t value = ParamValueToCC(key, EvaluateLane(lane, range_start + sample));
+        const int delta = std::abs(static_cast<int>(value) - last_emitted);
+        const bool settle = sample == last_block_sample && delta != 0;
+        if (emitted_any && delta <= cc_tolerance && !settle) {
+          continue;
+        }
+        MidiCCPoint point;
+        point.channel = channel;
+        point.cc = cc;
+        point.sample = sample;
+        point.value = value;
+        it->second.ccs.push_back(point);
+        emitted_any = true;
+        last_emitted = static_cast<int>(value);
       }
-      if (bus_channels == 1) {
-        bus_stem.samples[frame] += 0.5f * (src_l + src_r) * send_gain;
-      } else {
-        const size_t base = frame * 2U;
-        bus_stem.samples[base] += src_l * send_gain;
-        bus_stem.samples[base + 1U] += src_r * send_gain;
+    }
+  }
+
+  std::vector<MidiTrackData> tracks;
+  for (auto& [_, track] : midi_by_patch) {
+    std::sort(track.notes.begin(), track.notes.end(), [](const MidiNote& a, const MidiNote& b) {
+      if (a.start_sample == b.start_sample) {
+        return a.note < b.note;
       }
+      return a.start_sample < b.start_sample;
+    });
+    if (prepared.excluded_patches.count(track.name) == 0U) {
+      tracks.push_back(std::move(track));
     }
   }
+  return tracks;
+}
 
-  struct BusFuture {
-    std::string bus_name;
-    std::future<void> future;
-  };
-  std::vector<BusFuture> bus_futures;
-  for (const auto& bus : file.buses) {
-    const std::string bus_name = bus.name;
-    auto buffer_it = bus_buffers.find(bus_name);
-    auto program_it = bus_programs.find(bus_name);
-    if (buffer_it == bus_buffers.end() || program_it == bus_programs.end()) {
-      continue;
+// 64-bit fingerprint of render inputs. Strings are length-prefixed and values are tagged by kind, so adjacent fields
+// cannot run into each other.
+class Fingerprint {
+ public:
+  Fingerprint& Int(uint64_t value) {
+    hash_ = Hash64Combine(hash_, value);
+    return *this;
+  }
+  Fingerprint& Real(double value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return Int(bits);
+  }
+  Fingerprint& Text(std::string_view text) {
+    Int(text.size());
+    hash_ = Hash64(text, hash_);
+    return *this;
+  }
+  Fingerprint& Value(const aurora::lang::ParamValue& value) {
+    Int(static_cast<uint64_t>(value.kind));
+    Int(value.bool_value ? 1U : 0U).Real(value.number_value);
+    Real(value.unit_number_value.value).Text(value.unit_number_value.unit).Text(value.string_value);
+    Int(value.list_values.size());
+    for (const auto& item : value.list_values) {
+      Value(item);
+    }
+    return Params(value.object_values);
+  }
+  Fingerprint& Params(const std::map<std::string, aurora::lang::ParamValue>& params) {
+    Int(params.size());
+    for (const auto& [key, value] : params) {
+      Text(key).Value(value);
+    }
+    return *this;
+  }
+  Fingerprint& Graph(const aurora::lang::GraphDefinition& graph) {
+    Int(graph.nodes.size());
+    for (const auto& node : graph.nodes) {
+      Text(node.id).Text(node.type).Params(node.params);
+    }
+    Int(graph.connections.size());
+    for (const auto& connection : graph.connections) {
+      Text(connection.from).Text(connection.to).Text(connection.rate).Params(connection.map);
+    }
+    return Text(graph.out);
+  }
+  uint64_t value() const { return hash_; }
+
+ private:
+  uint64_t hash_ = 1469598103934665603ULL;
+};
+
+// Whether a patch's voices draw on the render seed (RenderPlayToStem's noise, decorrelation and voice spread RNGs).
+// The seed also picks `seq` steps, but those arrive as plays, which PatchFingerprint covers on their own.
+bool UsesSeed(const PatchProgram& program) {
+  return program.noise_white || program.sample_player ||
+         (program.decorrelate.enabled && !program.decorrelate.node_id.empty()) || program.voice_spread.enabled;
+}
+
+// Fingerprint of the render settings every stem depends on, and of a stem's layout within them. The seed is left out:
+// only patches that use it add it (see UsesSeed), so their stems and those of the buses they feed change with it.
+Fingerprint StemFingerprint(const RenderMetadata& metadata, const DraftKernels& draft, const AudioStem& stem,
+                            uint64_t stem_origin) {
+  Fingerprint fingerprint;
+  fingerprint.Int(static_cast<uint64_t>(metadata.sample_rate)).Int(static_cast<uint64_t>(metadata.block_size));
+  fingerprint.Int(stem_origin).Int(static_cast<uint64_t>(stem.channels)).Int(stem.samples.size());
+  fingerprint.Int(draft.enabled ? 1U : 0U).Int(draft.mono ? 1U : 0U);
+  return fingerprint.Int(static_cast<uint64_t>(draft.output_sample_rate));
+}
+
+uint64_t PatchFingerprint(Fingerprint fingerprint, const aurora::lang::PatchDefinition& patch,
+                          const std::vector<const PlayOccurrence*>& plays,
+                          const std::map<std::string, AutomationLane>* automation) {
+  fingerprint.Text(patch.name).Int(static_cast<uint64_t>(patch.poly)).Text(patch.voice_steal).Text(patch.retrig);
+  fingerprint.Int(patch.mono ? 1U : 0U).Int(patch.legato ? 1U : 0U);
+  fingerprint.Int(patch.binaural.enabled ? 1U : 0U).Real(patch.binaural.shift_hz).Real(patch.binaural.mix);
+  fingerprint.Int(patch.voice_spread.enabled ? 1U : 0U).Real(patch.voice_spread.pan);
+  fingerprint.Real(patch.voice_spread.detune_semitones).Real(patch.voice_spread.delay_seconds);
+  fingerprint.Int(patch.stage_position.enabled ? 1U : 0U).Real(patch.stage_position.pan);
+  fingerprint.Real(patch.stage_position.depth).Int(patch.send.has_value() ? 1U : 0U);
+  if (patch.send.has_value()) {
+    fingerprint.Text(patch.send->bus).Real(patch.send->amount_db);
+  }
+  fingerprint.Graph(patch.graph).Int(plays.size());
+  for (const PlayOccurrence* play : plays) {
+    fingerprint.Int(play->start_sample).Int(play->dur_samples).Real(play->velocity).Int(play->pitches.size());
+    for (const ResolvedPitch& pitch : play->pitches) {
+      fingerprint.Real(pitch.frequency).Int(static_cast<uint64_t>(pitch.midi));
     }
-    AudioStem* buffer_ptr = &buffer_it->second;
-    const BusProgram* program_ptr = &program_it->second;
-    bus_futures.push_back(BusFuture{
-        bus_name, std::async(std::launch::async, [buffer_ptr, program_ptr, sample_rate = result.metadata.sample_rate]() {
-          ProcessBusStem(buffer_ptr, *program_ptr, sample_rate);
-        })});
+    fingerprint.Params(play->params).Int(play->section_start_sample).Int(play->section_end_sample);
+    fingerprint.Int(play->xfade_in_samples).Int(play->xfade_out_samples);
+  }
+  fingerprint.Int(automation == nullptr ? 0U : automation->size());
+  if (automation != nullptr) {
+    for (const auto& [key, lane] : *automation) {
+      fingerprint.Text(key).Text(lane.curve).Int(lane.points.size());
+      for (const auto& [sample, value] : lane.points) {
+        fingerprint.Int(sample).Real(value);
+      }
+    }
+  }
+  return fingerprint.value();
+}
+
+}  // namespace
+
+bool RenderCache::Lookup(const std::string& key, uint64_t fingerprint, AudioStem* stem) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  touched_.insert(key);
+  const auto it = entries_.find(key);
+  if (it == entries_.end() || it->second.fingerprint != fingerprint) {
+    return false;
   }
-  for (auto& task : bus_futures) {
-    task.future.get();
-    ++progress_done_units;
-    report_progress(false);
+  stem->channels = it->second.channels;
+  stem->samples = it->second.samples;
+  return true;
+}
+
+void RenderCache::Store(const std::string& key, uint64_t fingerprint, const AudioStem& stem) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  touched_.insert(key);
+  Entry& entry = entries_[key];
+  entry.fingerprint = fingerprint;
+  entry.channels = stem.channels;
+  entry.samples = stem.samples;
+}
+
+void RenderCache::Sweep() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::erase_if(entries_, [this](const auto& entry) { return !touched_.contains(entry.first); });
+  touched_.clear();
+}
+
+size_t RenderCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+AudioStemStats ComputeAudioStemStats(const AudioStem& stem) {
+  AudioStemStatsAccumulator stats;
+  if (stem.channels == 2) {
+    for (size_t i = 0; i + 1U < stem.samples.size(); i += 2U) {
+      stats.AddStereo(stem.samples[i], stem.samples[i + 1U]);
+    }
+  } else if (stem.channels == 1) {
+    for (const float sample : stem.samples) {
+      stats.AddMono(sample);
+    }
   }
+  return stats.Finish();
+}
+
+namespace {
 
+RenderResult RenderScore(const aurora::lang::AuroraFile& file, const RenderOptions& options,
+                         const DraftKernels& draft) {
+  const PreparedScore prepared = PrepareScore(file, options);
+  RenderResult result;
+  result.metadata = prepared.metadata;
+  const ExpansionResult& expanded = prepared.expanded;
+  const std::map<std::string, PatchProgram>& patch_programs = prepared.patch_programs;
+  const uint64_t total_samples = result.metadata.total_samples;
+  // A range render writes timeline samples [range_start, range_start + total_samples); buses and the patches feeding
+  // them start `preroll` samples earlier and drop that head once processed.
+  const uint64_t range_start = result.metadata.start_sample;
+  const uint64_t preroll = prepared.bus_preroll;
+  if (!prepared.range_error.empty()) {
+    result.warnings.push_back(prepared.range_error + " Rendering the whole timeline.");
+  }
+  const RenderPlan plan = BuildRenderPlan(file, prepared);
+  if (options.plan_callback) {
+    options.plan_callback(plan);
+  }
+
+  // Stems are built in place and never move, so a stem handed to options.stem_callback is the one in the result. Stems
+  // a selection excludes stay empty and are kept aside; patch_stems / bus_stems reach every stem in declaration order.
+  std::vector<AudioStem*> patch_stems;
+  std::vector<AudioStem*> bus_stems;
+  std::vector<AudioStem> excluded_stems;
+  excluded_stems.reserve(prepared.excluded_patches.size() + prepared.excluded_buses.size());
+  std::map<std::string, size_t> patch_index;
   result.patch_stems.reserve(file.patches.size());
   for (const auto& patch : file.patches) {
+    const auto program_it = patch_programs.find(patch.name);
     AudioStem stem;
-    stem.channels = patch_buffers[patch.name].channels;
     stem.name = patch.out_stem.empty() ? patch.name : patch.out_stem;
-    stem.samples = patch_buffers[patch.name].samples;
-    result.patch_stems.push_back(std::move(stem));
+    if (program_it != patch_programs.end()) {
+      stem.channels = draft.mono ? 1 : PatchChannels(patch, program_it->second);
+      if (prepared.excluded_patches.count(patch.name) == 0U) {
+        stem.samples.assign(static_cast<size_t>(total_samples) * static_cast<size_t>(stem.channels), 0.0f);
+      }
+    }
+    patch_index[patch.name] = patch_stems.size();
+    if (prepared.excluded_patches.count(patch.name) != 0U) {
+      patch_stems.push_back(&excluded_stems.emplace_back(std::move(stem)));
+    } else {
+      patch_stems.push_back(&result.patch_stems.emplace_back(std::move(stem)));
+    }
   }
 
+  // A bus runs as soon as every patch sending to it has rendered; sends are still summed in patch order.
+  struct BusInputs {
+    std::vector<size_t> senders;
+    std::atomic<size_t> pending{0U};
+    std::promise<void> done;
+  };
+  std::map<std::string, size_t> bus_index;
+  std::vector<BusProgram> bus_programs;
+  std::vector<BusInputs> bus_inputs(file.buses.size());
   result.bus_stems.reserve(file.buses.size());
   for (const auto& bus : file.buses) {
+    bus_programs.push_back(BuildBusProgram(bus));
     AudioStem stem;
-    stem.channels = bus_buffers[bus.name].channels;
     stem.name = bus.out_stem.empty() ? bus.name : bus.out_stem;
-    stem.samples = bus_buffers[bus.name].samples;
-    result.bus_stems.push_back(std::move(stem));
+    stem.channels = draft.mono ? 1 : bus_programs.back().channels;
+    if (prepared.excluded_buses.count(bus.name) == 0U) {
+      stem.samples.assign(static_cast<size_t>(total_samples + preroll) * static_cast<size_t>(stem.channels), 0.0f);
+    }
+    bus_index[bus.name] = bus_stems.size();
+    if (prepared.excluded_buses.count(bus.name) != 0U) {
+      bus_stems.push_back(&excluded_stems.emplace_back(std::move(stem)));
+    } else {
+      bus_stems.push_back(&result.bus_stems.emplace_back(std::move(stem)));
+    }
+  }
+  // stem_callback index of each stem: its position in the result, counting patch stems and then bus stems.
+  std::vector<size_t> patch_output(file.patches.size(), 0U);
+  std::vector<size_t> bus_output(file.buses.size(), 0U);
+  for (size_t p = 0, output = 0; p < file.patches.size(); ++p) {
+    patch_output[p] = output;
+    output += prepared.excluded_patches.count(file.patches[p].name) == 0U ? 1U : 0U;
+  }
+  for (size_t b = 0, output = result.patch_stems.size(); b < file.buses.size(); ++b) {
+    bus_output[b] = output;
+    output += prepared.excluded_buses.count(file.buses[b].name) == 0U ? 1U : 0U;
+  }
+  std::vector<std::optional<size_t>> patch_send_bus(file.patches.size());
+  for (size_t p = 0; p < file.patches.size(); ++p) {
+    const auto program_it = patch_programs.find(file.patches[p].name);
+    if (program_it == patch_programs.end() || !program_it->second.send.has_value()) {
+      continue;
+    }
+    const auto bus_it = bus_index.find(program_it->second.send->bus);
+    if (bus_it != bus_index.end() && !patch_stems[p]->samples.empty() &&
+        !bus_stems[bus_it->second]->samples.empty()) {
+      patch_send_bus[p] = bus_it->second;
+      bus_inputs[bus_it->second].senders.push_back(p);
+      AudioStem& stem = *patch_stems[p];
+      stem.samples.resize(static_cast<size_t>(total_samples + preroll) * static_cast<size_t>(stem.channels), 0.0f);
+    }
+  }
+  // Moves the pre-roll head of a sending patch's stem aside for its bus, leaving the stem on the range.
+  std::vector<AudioStem> send_preroll(file.patches.size());
+  const auto split_preroll = [&](size_t p) {
+    if (preroll == 0U || !patch_send_bus[p].has_value()) {
+      return;
+    }
+    AudioStem& stem = *patch_stems[p];
+    const auto head_end = stem.samples.begin() + static_cast<std::ptrdiff_t>(preroll * static_cast<uint64_t>(stem.channels));
+    send_preroll[p].channels = stem.channels;
+    send_preroll[p].samples.assign(stem.samples.begin(), head_end);
+    stem.samples.erase(stem.samples.begin(), head_end);
+  };
+
+  RenderTelemetry telemetry(plan, options);
+  telemetry.Report(true);
+
+  std::map<std::string, std::vector<const PlayOccurrence*>> plays_by_patch;
+  for (const auto& play : expanded.plays) {
+    const auto patch_it = patch_programs.find(play.patch);
+    const auto index_it = patch_index.find(play.patch);
+    if (patch_it == patch_programs.end() || index_it == patch_index.end()) {
+      result.warnings.push_back("Event references unknown patch '" + play.patch + "'.");
+      continue;
+    }
+    plays_by_patch[play.patch].push_back(&play);
+  }
+
+  // With a cache, a patch or bus whose fingerprint is unchanged takes its stored stem instead of rendering.
+  std::vector<uint64_t> patch_fingerprints(file.patches.size(), 0U);
+  std::vector<bool> patch_reused(file.patches.size(), false);
+  std::vector<uint64_t> bus_fingerprints(file.buses.size(), 0U);
+  std::vector<bool> bus_reused(file.buses.size(), false);
+  if (options.cache != nullptr) {
+    const std::vector<const PlayOccurrence*> no_plays;
+    for (size_t p = 0; p < file.patches.size(); ++p) {
+      const auto& patch = file.patches[p];
+      const auto plays_it = plays_by_patch.find(patch.name);
+      const auto auto_it = expanded.automation.find(patch.name);
+      const uint64_t stem_origin = range_start - (patch_send_bus[p].has_value() ? preroll : 0U);
+      AudioStem& stem = *patch_stems[p];
+      Fingerprint fingerprint = StemFingerprint(result.metadata, draft, stem, stem_origin);
+      if (UsesSeed(patch_programs.at(patch.name))) {
+        fingerprint.Int(options.seed);
+      }
+      patch_fingerprints[p] =
+          PatchFingerprint(fingerprint, patch,
+                           plays_it != plays_by_patch.end() ? plays_it->second : no_plays,
+                           auto_it != expanded.automation.end() ? &auto_it->second : nullptr);
+      if (plays_it != plays_by_patch.end() && !stem.samples.empty()) {
+        patch_reused[p] = options.cache->Lookup("patch:" + patch.name, patch_fingerprints[p], &stem);
+      }
+    }
+    for (size_t b = 0; b < file.buses.size(); ++b) {
+      const auto& bus = file.buses[b];
+      Fingerprint fingerprint =
+          StemFingerprint(result.metadata, draft, *bus_stems[b], range_start - preroll);
+      fingerprint.Text(bus.name).Int(static_cast<uint64_t>(bus.channels)).Graph(bus.graph);
+      fingerprint.Int(bus_inputs[b].senders.size());
+      for (const size_t p : bus_inputs[b].senders) {
+        fingerprint.Int(patch_fingerprints[p]);
+      }
+      bus_fingerprints[b] = fingerprint.value();
+      bus_reused[b] = !bus_stems[b]->samples.empty() &&
+                      options.cache->Lookup("bus:" + bus.name, bus_fingerprints[b], bus_stems[b]);
+    }
+  }
+
+  TaskScheduler& scheduler = TaskScheduler::Global();
+  const int sample_rate = result.metadata.sample_rate;
+  const int block_size = result.metadata.block_size;
+  std::vector<size_t> bus_slot(file.buses.size(), 0U);
+  for (size_t slot = 0; slot < plan.buses.size(); ++slot) {
+    bus_slot[bus_index.at(plan.buses[slot].name)] = slot;
+  }
+  const auto run_bus = [&](size_t b) {
+    try {
+      AudioStem& bus_stem = *bus_stems[b];
+      if (!bus_reused[b]) {
+        for (const size_t p : bus_inputs[b].senders) {
+          const PatchProgram& program = patch_programs.at(file.patches[p].name);
+          const float send_gain = static_cast<float>(DbToLinear(program.send->amount_db));
+          AddSendToBus(send_preroll[p], send_gain, &bus_stem);
+          AddSendToBus(*patch_stems[p], send_gain, &bus_stem, static_cast<size_t>(preroll));
+        }
+        ProcessBusStem(&bus_stem, bus_programs[b], sample_rate, draft);
+        bus_stem.samples.erase(bus_stem.samples.begin(),
+                               bus_stem.samples.begin() +
+                                   static_cast<std::ptrdiff_t>(preroll * static_cast<uint64_t>(bus_stem.channels)));
+        if (options.cache != nullptr) {
+          options.cache->Store("bus:" + file.buses[b].name, bus_fingerprints[b], bus_stem);
+        }
+      }
+      bus_stem.stats = ComputeAudioStemStats(bus_stem);
+      telemetry.BusFinished(bus_slot[b]);
+      if (options.stem_callback) {
+        options.stem_callback(bus_output[b], bus_stem);
+      }
+      bus_inputs[b].done.set_value();
+    } catch (...) {
+      bus_inputs[b].done.set_exception(std::current_exception());
+    }
+  };
+  const auto launch_bus = [&](size_t b) { scheduler.Submit([&run_bus, b]() { run_bus(b); }); };
+
+  std::vector<std::future<void>> patch_futures(file.patches.size());
+  std::vector<bool> dispatched(file.patches.size(), false);
+  for (const RenderCostEstimate& estimate : plan.patches) {
+    const auto plays_it = plays_by_patch.find(estimate.name);
+    if (plays_it == plays_by_patch.end() || plays_it->second.empty()) {
+      continue;
+    }
+    const size_t p = patch_index.at(estimate.name);
+    if (patch_reused[p]) {
+      continue;
+    }
+    dispatched[p] = true;
+    if (patch_send_bus[p].has_value()) {
+      bus_inputs[*patch_send_bus[p]].pending.fetch_add(1U);
+    }
+  }
+  // Buses no rendered patch feeds are decided before any patch can finish and launch a bus itself.
+  std::vector<size_t> idle_buses;
+  for (const RenderCostEstimate& estimate : plan.buses) {
+    const size_t b = bus_index.at(estimate.name);
+    if (bus_inputs[b].pending.load() == 0U) {
+      idle_buses.push_back(b);
+    }
+  }
+  for (size_t p = 0; p < file.patches.size(); ++p) {
+    if (dispatched[p] || prepared.excluded_patches.count(file.patches[p].name) != 0U) {
+      continue;
+    }
+    split_preroll(p);
+    patch_stems[p]->stats = ComputeAudioStemStats(*patch_stems[p]);
+    if (options.stem_callback) {
+      options.stem_callback(patch_output[p], *patch_stems[p]);
+    }
+  }
+  for (size_t slot = 0; slot < plan.patches.size(); ++slot) {
+    const size_t p = patch_index.at(plan.patches[slot].name);
+    if (!dispatched[p]) {
+      if (patch_reused[p]) {
+        telemetry.PatchFinished(slot);
+      }
+      continue;
+    }
+    const std::string patch_name = plan.patches[slot].name;
+    const std::vector<const PlayOccurrence*>* play_list = &plays_by_patch.at(patch_name);
+    const uint64_t stem_origin = range_start - (patch_send_bus[p].has_value() ? preroll : 0U);
+    patch_futures[p] = scheduler.Submit([&patch_stems, &patch_programs, &expanded, &options, &patch_send_bus,
+                                         &bus_inputs, &launch_bus, &telemetry, &split_preroll, play_list, patch_name,
+                                         p, slot, stem_origin, sample_rate, block_size, &draft, &patch_fingerprints,
+                                         &patch_output]() {
+      const PatchProgram& program = patch_programs.at(patch_name);
+      const auto auto_it = expanded.automation.find(patch_name);
+      const std::map<std::string, AutomationLane> empty_auto;
+      const auto& automation = (auto_it != expanded.automation.end()) ? auto_it->second : empty_auto;
+      AudioStem& stem = *patch_stems[p];
+      for (const PlayOccurrence* play_ptr : *play_list) {
+        if (play_ptr == nullptr) {
+          continue;
+        }
+        RenderPlayToStem(&stem, *play_ptr, program, automation, sample_rate, block_size, options.seed, stem_origin,
+                         draft.enabled, &telemetry, slot);
+      }
+      if (options.cache != nullptr) {
+        options.cache->Store("patch:" + patch_name, patch_fingerprints[p], stem);
+      }
+      split_preroll(p);
+      stem.stats = ComputeAudioStemStats(stem);
+      telemetry.PatchFinished(slot);
+      if (options.stem_callback) {
+        options.stem_callback(patch_output[p], stem);
+      }
+      if (patch_send_bus[p].has_value() && bus_inputs[*patch_send_bus[p]].pending.fetch_sub(1U) == 1U) {
+        launch_bus(*patch_send_bus[p]);
+      }
+    });
+  }
+  std::vector<std::future<void>> bus_futures;
+  bus_futures.reserve(bus_inputs.size());
+  for (auto& inputs : bus_inputs) {
+    bus_futures.push_back(inputs.done.get_future());
+  }
+  for (const size_t b : idle_buses) {
+    launch_bus(b);
   }
 
   result.master.name = "master";
   bool any_stereo = false;
-  for (const auto& stem : result.patch_stems) {
-    if (stem.channels == 2) {
+  for (const AudioStem* stem : patch_stems) {
+    if (stem->channels == 2) {
       any_stereo = true;
       break;
     }
   }
   if (!any_stereo) {
-    for (const auto& stem : result.bus_stems) {
-      if (stem.channels == 2) {
+    for (const AudioStem* stem : bus_stems) {
+      if (stem->channels == 2) {
         any_stereo = true;
         break;
       }
@@ -3147,105 +4058,299 @@ RenderResult Renderer::Render(const aurora::lang::AuroraFile& file, const Render
   result.master.channels = any_stereo ? 2 : 1;
   result.master.samples.assign(static_cast<size_t>(total_samples) * static_cast<size_t>(result.master.channels), 0.0f);
 
+  // Stem statistics were gathered by the task that finished each stem, before handing it to options.stem_callback,
+  // so the mix only reads the stems.
+  const size_t frame_total = static_cast<size_t>(total_samples);
   const auto mix_stem_into_master = [&](const AudioStem& stem) {
+    float* master = result.master.samples.data();
+    const float* src = stem.samples.data();
     if (stem.channels == 1 && result.master.channels == 1) {
-      for (size_t i = 0; i < static_cast<size_t>(total_samples); ++i) {
-        result.master.samples[i] += stem.samples[i];
+      for (size_t i = 0; i < frame_total; ++i) {
+        master[i] += src[i];
       }
-      return;
-    }
-    if (stem.channels == 2 && result.master.channels == 2) {
-      for (size_t i = 0; i < static_cast<size_t>(total_samples) * 2U; ++i) {
-        result.master.samples[i] += stem.samples[i];
+    } else if (stem.channels == 2 && result.master.channels == 2) {
+      for (size_t i = 0; i < frame_total * 2U; ++i) {
+        master[i] += src[i];
       }
-      return;
-    }
-    if (stem.channels == 1 && result.master.channels == 2) {
-      for (size_t frame = 0; frame < static_cast<size_t>(total_samples); ++frame) {
-        const float s = stem.samples[frame];
-        const size_t base = frame * 2U;
-        result.master.samples[base] += s;
-        result.master.samples[base + 1U] += s;
+    } else if (stem.channels == 1 && result.master.channels == 2) {
+      for (size_t frame = 0; frame < frame_total; ++frame) {
+        const float s = src[frame];
+        master[frame * 2U] += s;
+        master[frame * 2U + 1U] += s;
       }
-      return;
-    }
-    if (stem.channels == 2 && result.master.channels == 1) {
-      for (size_t frame = 0; frame < static_cast<size_t>(total_samples); ++frame) {
-        const size_t base = frame * 2U;
-        result.master.samples[frame] += 0.5f * (stem.samples[base] + stem.samples[base + 1U]);
+    } else if (stem.channels == 2 && result.master.channels == 1) {
+      for (size_t frame = 0; frame < frame_total; ++frame) {
+        master[frame] += 0.5f * (src[frame * 2U] + src[frame * 2U + 1U]);
       }
     }
   };
 
-  for (const auto& stem : result.patch_stems) {
-    mix_stem_into_master(stem);
+  // Stems are mixed in declaration order as each one becomes ready, which keeps the sum identical to a phased mix
+  // while later patches and buses are still rendering on other threads.
+  for (size_t p = 0; p < file.patches.size(); ++p) {
+    if (patch_futures[p].valid()) {
+      scheduler.Wait(patch_futures[p]);
+    }
+    if (prepared.excluded_patches.count(file.patches[p].name) == 0U) {
+      mix_stem_into_master(*patch_stems[p]);
+    }
   }
-  for (const auto& stem : result.bus_stems) {
-    mix_stem_into_master(stem);
+  for (size_t b = 0; b < file.buses.size(); ++b) {
+    if (prepared.excluded_buses.count(file.buses[b].name) == 0U) {
+      scheduler.Wait(bus_futures[b]);
+      mix_stem_into_master(*bus_stems[b]);
+    }
   }
-  for (float& sample : result.master.samples) {
-    sample = static_cast<float>(std::tanh(sample));
+  {
+    // The limiter runs in chunks so the loudness meter reads each chunk while it is still in cache.
+    constexpr size_t kMeterChunkFrames = 4096;
+    AudioStemStatsAccumulator stats;
+    std::optional<LoudnessMeter> meter;
+    if (options.meter_master_loudness) {
+      meter.emplace(result.metadata.sample_rate, result.master.channels);
+    }
+    float* master = result.master.samples.data();
+    const size_t channels = static_cast<size_t>(result.master.channels);
+    for (size_t first = 0; first < frame_total; first += kMeterChunkFrames) {
+      const size_t last = std::min(frame_total, first + kMeterChunkFrames);
+      if (channels == 2) {
+        for (size_t frame = first; frame < last; ++frame) {
+          const size_t base = frame * 2U;
+          master[base] = static_cast<float>(std::tanh(master[base]));
+          master[base + 1U] = static_cast<float>(std::tanh(master[base + 1U]));
+          stats.AddStereo(master[base], master[base + 1U]);
+        }
+      } else {
+        for (size_t i = first; i < last; ++i) {
+          master[i] = static_cast<float>(std::tanh(master[i]));
+          stats.AddMono(master[i]);
+        }
+      }
+      if (meter) {
+        meter->Add(master + first * channels, last - first);
+      }
+    }
+    result.master.stats = stats.Finish();
+    if (meter) {
+      result.master_loudness = meter->Finish();
+    }
   }
 
-  std::map<std::string, MidiTrackData> midi_by_patch;
-  for (const auto& patch : file.patches) {
-    MidiTrackData track;
-    track.name = patch.name;
-    midi_by_patch[patch.name] = std::move(track);
+  result.midi_tracks = BuildMidiTracks(file, prepared, options);
+  result.stems_reused = patch_reused;
+  result.stems_reused.insert(result.stems_reused.end(), bus_reused.begin(), bus_reused.end());
+  if (options.cache != nullptr) {
+    options.cache->Sweep();
   }
-  for (const auto& play : expanded.plays) {
-    auto it = midi_by_patch.find(play.patch);
-    if (it == midi_by_patch.end()) {
-      continue;
+  if (!excluded_stems.empty()) {
+    std::vector<bool> reused;
+    for (size_t p = 0; p < file.patches.size(); ++p) {
+      if (prepared.excluded_patches.count(file.patches[p].name) == 0U) {
+        reused.push_back(patch_reused[p]);
+      }
     }
-    const int channel = static_cast<int>(std::distance(midi_by_patch.begin(), it)) % 16;
-    for (const auto& pitch : play.pitches) {
-      MidiNote note;
-      note.channel = channel;
-      note.note = std::clamp(pitch.midi, 0, 127);
-      note.velocity = static_cast<uint8_t>(std::llround(Clamp(play.velocity, 0.0, 1.0) * 127.0));
-      note.start_sample = std::min(play.start_sample, total_samples);
-      note.end_sample = std::min(play.start_sample + play.dur_samples, total_samples);
-      if (note.end_sample <= note.start_sample) {
-        note.end_sample = note.start_sample + 1;
+    for (size_t b = 0; b < file.buses.size(); ++b) {
+      if (prepared.excluded_buses.count(file.buses[b].name) == 0U) {
+        reused.push_back(bus_reused[b]);
       }
-      it->second.notes.push_back(note);
     }
+    result.stems_reused = std::move(reused);
   }
 
-  for (const auto& [patch_name, lanes] : expanded.automation) {
-    auto it = midi_by_patch.find(patch_name);
-    if (it == midi_by_patch.end()) {
-      continue;
+  telemetry.Finish();
+
+  return result;
+}
+
+int DraftSampleRate(const aurora::lang::AuroraFile& file, const RenderOptions& options) {
+  const int output_rate = options.sample_rate_override > 0 ? options.sample_rate_override : file.globals.sr;
+  return std::clamp(options.draft.sample_rate, 1, std::max(1, output_rate));
+}
+
+// Resamples `source` onto the frames already allocated in `target` by linear interpolation, duplicating a mono source
+// into both channels or folding a stereo one to mono, and fills target->stats.
+void UpsampleStem(const AudioStem& source, AudioStem* target) {
+  const size_t target_channels = static_cast<size_t>(std::clamp(target->channels, 1, 2));
+  const size_t target_frames = target->samples.size() / target_channels;
+  const size_t source_channels = static_cast<size_t>(std::clamp(source.channels, 1, 2));
+  const size_t source_frames = source.samples.size() / source_channels;
+  AudioStemStatsAccumulator stats;
+  if (target_frames == 0U || source_frames == 0U) {
+    std::fill(target->samples.begin(), target->samples.end(), 0.0f);
+    target->stats = ComputeAudioStemStats(*target);
+    return;
+  }
+  const double step = static_cast<double>(source_frames) / static_cast<double>(target_frames);
+  const auto read = [&](size_t frame, size_t channel) {
+    if (frame >= source_frames) {
+      return 0.0;
     }
-    const int channel = static_cast<int>(std::distance(midi_by_patch.begin(), it)) % 16;
-    for (const auto& [key, lane] : lanes) {
-      const int cc = ParamToCC(key);
-      for (uint64_t sample = 0; sample < total_samples; sample += static_cast<uint64_t>(result.metadata.block_size)) {
-        MidiCCPoint point;
-        point.channel = channel;
-        point.cc = cc;
-        point.sample = sample;
-        point.value = ParamValueToCC(key, EvaluateLane(lane, sample));
-        it->second.ccs.push_back(point);
-      }
+    const size_t base = frame * source_channels;
+    if (source_channels == 1U) {
+      return static_cast<double>(source.samples[base]);
+    }
+    if (target_channels == 1U) {
+      return 0.5 * (static_cast<double>(source.samples[base]) + static_cast<double>(source.samples[base + 1U]));
+    }
+    return static_cast<double>(source.samples[base + channel]);
+  };
+  for (size_t frame = 0; frame < target_frames; ++frame) {
+    const double position = static_cast<double>(frame) * step;
+    const size_t first = static_cast<size_t>(position);
+    const double frac = position - static_cast<double>(first);
+    for (size_t c = 0; c < target_channels; ++c) {
+      const double a = read(first, c);
+      target->samples[frame * target_channels + c] = static_cast<float>(a + (read(first + 1U, c) - a) * frac);
+    }
+    if (target_channels == 2U) {
+      stats.AddStereo(target->samples[frame * 2U], target->samples[frame * 2U + 1U]);
+    } else {
+      stats.AddMono(target->samples[frame]);
     }
   }
+  target->stats = stats.Finish();
+}
 
-  for (auto& [_, track] : midi_by_patch) {
-    std::sort(track.notes.begin(), track.notes.end(), [](const MidiNote& a, const MidiNote& b) {
-      if (a.start_sample == b.start_sample) {
-        return a.note < b.note;
-      }
-      return a.start_sample < b.start_sample;
-    });
-    result.midi_tracks.push_back(std::move(track));
+// Renders the score at the draft rate with the draft kernels, then upsamples every stem and the master onto the
+// output-rate timeline. Metadata, stem layouts and MIDI come from the output-rate expansion, so they are those of the
+// final render.
+RenderResult RenderDraft(const aurora::lang::AuroraFile& file, const RenderOptions& options) {
+  const PreparedScore prepared = PrepareScore(file, options);
+  RenderResult result;
+  result.metadata = prepared.metadata;
+  result.metadata.draft_sample_rate = DraftSampleRate(file, options);
+  result.metadata.draft_mono = options.draft.mono;
+  const size_t total_samples = static_cast<size_t>(prepared.metadata.total_samples);
+
+  for (const auto& patch : file.patches) {
+    const auto program_it = prepared.patch_programs.find(patch.name);
+    if (prepared.excluded_patches.count(patch.name) != 0U) {
+      continue;
+    }
+    AudioStem stem;
+    stem.name = patch.out_stem.empty() ? patch.name : patch.out_stem;
+    if (program_it != prepared.patch_programs.end()) {
+      stem.channels = PatchChannels(patch, program_it->second);
+      stem.samples.assign(total_samples * static_cast<size_t>(stem.channels), 0.0f);
+    }
+    result.patch_stems.push_back(std::move(stem));
+  }
+  for (const auto& bus : file.buses) {
+    if (prepared.excluded_buses.count(bus.name) != 0U) {
+      continue;
+    }
+    AudioStem stem;
+    stem.name = bus.out_stem.empty() ? bus.name : bus.out_stem;
+    stem.channels = BuildBusProgram(bus).channels;
+    stem.samples.assign(total_samples * static_cast<size_t>(stem.channels), 0.0f);
+    result.bus_stems.push_back(std::move(stem));
   }
 
-  progress_done_units = progress_total_units;
-  report_progress(true);
+  RenderOptions draft_options = options;
+  draft_options.sample_rate_override = DraftSampleRate(file, options);
+  draft_options.meter_master_loudness = false;
+  if (options.plan_callback) {
+    draft_options.plan_callback = [&](const RenderPlan& plan) {
+      RenderPlan shown = plan;
+      shown.metadata = result.metadata;
+      options.plan_callback(shown);
+    };
+  }
+  draft_options.stem_callback = [&](size_t index, const AudioStem& stem) {
+    const size_t patch_count = result.patch_stems.size();
+    AudioStem& target = index < patch_count ? result.patch_stems[index] : result.bus_stems[index - patch_count];
+    UpsampleStem(stem, &target);
+    if (options.stem_callback) {
+      options.stem_callback(index, target);
+    }
+  };
+  DraftKernels draft;
+  draft.enabled = true;
+  draft.mono = options.draft.mono;
+  draft.output_sample_rate = result.metadata.sample_rate;
+  RenderResult drafted = RenderScore(file, draft_options, draft);
+  result.warnings = std::move(drafted.warnings);
+  result.stems_reused = std::move(drafted.stems_reused);
 
+  bool any_stereo = false;
+  for (const auto* stems : {&result.patch_stems, &result.bus_stems}) {
+    for (const AudioStem& stem : *stems) {
+      any_stereo = any_stereo || stem.channels == 2;
+    }
+  }
+  result.master.name = "master";
+  result.master.channels = any_stereo ? 2 : 1;
+  result.master.samples.assign(total_samples * static_cast<size_t>(result.master.channels), 0.0f);
+  UpsampleStem(drafted.master, &result.master);
+  if (options.meter_master_loudness) {
+    LoudnessMeter meter(result.metadata.sample_rate, result.master.channels);
+    meter.Add(result.master.samples.data(), total_samples);
+    result.master_loudness = meter.Finish();
+  }
+  result.midi_tracks = BuildMidiTracks(file, prepared, options);
   return result;
 }
 
+}  // namespace
+
+RenderResult Renderer::Render(const aurora::lang::AuroraFile& file, const RenderOptions& options) const {
+  if (options.draft.enabled) {
+    return RenderDraft(file, options);
+  }
+  return RenderScore(file, options, DraftKernels{});
+}
+
+RenderPlan Renderer::Plan(const aurora::lang::AuroraFile& file, const RenderOptions& options) const {
+  if (!options.draft.enabled) {
+    return BuildRenderPlan(file, PrepareScore(file, options));
+  }
+  RenderOptions draft_options = options;
+  draft_options.sample_rate_override = DraftSampleRate(file, options);
+  RenderPlan plan = BuildRenderPlan(file, PrepareScore(file, draft_options));
+  plan.metadata = PrepareScore(file, options).metadata;
+  return plan;
+}
+
+bool Renderer::ResolveSelection(const aurora::lang::AuroraFile& file, const RenderOptions& options,
+                                std::vector<std::string>* patches, std::vector<std::string>* buses,
+                                std::string* error) const {
+  std::set<std::string> selected_patches;
+  std::set<std::string> selected_buses;
+  std::string selection_error;
+  if (!SelectionClosure(file, options, &selected_patches, &selected_buses, &selection_error)) {
+    if (error != nullptr) {
+      *error = selection_error;
+    }
+    return false;
+  }
+  for (const auto& patch : file.patches) {
+    if (selected_patches.count(patch.name) != 0U) {
+      patches->push_back(patch.name);
+    }
+  }
+  for (const auto& bus : file.buses) {
+    if (selected_buses.count(bus.name) != 0U) {
+      buses->push_back(bus.name);
+    }
+  }
+  return true;
+}
+
+bool Renderer::ResolveRange(const aurora::lang::AuroraFile& file, const RenderOptions& options, uint64_t* start_sample,
+                            uint64_t* end_sample, std::string* error) const {
+  RenderOptions whole = options;
+  whole.range_from.reset();
+  whole.range_to.reset();
+  const PreparedScore prepared = PrepareScore(file, whole);
+  std::string range_error;
+  if (!ResolveRenderRange(options, prepared.metadata, BuildTempoMap(file.globals), start_sample, end_sample,
+                          &range_error)) {
+    if (error != nullptr) {
+      *error = range_error;
+    }
+    return false;
+  }
+  return true;
+}
+
 }  // namespace aurora::core
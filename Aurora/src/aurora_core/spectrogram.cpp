@@ -1,17 +1,20 @@
 #include "aurora/core/spectrogram.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
-#include <complex>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <string>
 #include <vector>
 
+#include "aurora/core/task_scheduler.hpp"
+
 namespace aurora::core {
 namespace {
 
-constexpr double kPi = 3.14159265358979323846;
 constexpr double kEps = 1e-12;
 
 struct Rgb {
@@ -24,49 +27,6 @@ double Clamp(double value, double lo, double hi) { return std::max(lo, std::min(
 
 bool IsPowerOfTwo(int value) { return value > 0 && (value & (value - 1)) == 0; }
 
-void FftInPlace(std::vector<std::complex<double>>* values) {
-  auto& a = *values;
-  const size_t n = a.size();
-  size_t j = 0;
-  for (size_t i = 1; i < n; ++i) {
-    size_t bit = n >> 1;
-    while (j & bit) {
-      j ^= bit;
-      bit >>= 1;
-    }
-    j ^= bit;
-    if (i < j) {
-      std::swap(a[i], a[j]);
-    }
-  }
-
-  for (size_t len = 2; len <= n; len <<= 1) {
-    const double angle = -2.0 * kPi / static_cast<double>(len);
-    const std::complex<double> w_len(std::cos(angle), std::sin(angle));
-    for (size_t i = 0; i < n; i += len) {
-      std::complex<double> w(1.0, 0.0);
-      for (size_t j2 = 0; j2 < len / 2; ++j2) {
-        const std::complex<double> u = a[i + j2];
-        const std::complex<double> v = a[i + j2 + len / 2] * w;
-        a[i + j2] = u + v;
-        a[i + j2 + len / 2] = u - v;
-        w *= w_len;
-      }
-    }
-  }
-}
-
-std::vector<double> BuildHann(int size) {
-  std::vector<double> w(static_cast<size_t>(size), 0.0);
-  if (size <= 1) {
-    return w;
-  }
-  for (int i = 0; i < size; ++i) {
-    w[static_cast<size_t>(i)] = 0.5 - 0.5 * std::cos(2.0 * kPi * static_cast<double>(i) / static_cast<double>(size - 1));
-  }
-  return w;
-}
-
 Rgb LerpRgb(const Rgb& a, const Rgb& b, double t) {
   const double tt = Clamp(t, 0.0, 1.0);
   const int r = static_cast<int>(std::lround((1.0 - tt) * static_cast<double>(a.r) + tt * static_cast<double>(b.r)));
@@ -137,26 +97,150 @@ const std::vector<Rgb>& GetColorLut(const std::string& name) {
   return magma;
 }
 
-float SampleFrameMag(const std::vector<float>& mags, int bins, int frame, double kf) {
+// Linear interpolation between two neighbouring bins, precomputed per image row.
+struct BinTap {
+  int k0 = 0;
+  int k1 = 0;
+  double frac = 0.0;
+};
+
+BinTap MakeBinTap(int bins, double kf) {
+  BinTap tap;
   const double bounded = Clamp(kf, 0.0, static_cast<double>(bins - 1));
-  const int k0 = static_cast<int>(std::floor(bounded));
-  const int k1 = std::min(k0 + 1, bins - 1);
-  const double frac = bounded - static_cast<double>(k0);
-  const float a = mags[static_cast<size_t>(frame * bins + k0)];
-  const float b = mags[static_cast<size_t>(frame * bins + k1)];
-  return static_cast<float>((1.0 - frac) * static_cast<double>(a) + frac * static_cast<double>(b));
+  tap.k0 = static_cast<int>(std::floor(bounded));
+  tap.k1 = std::min(tap.k0 + 1, bins - 1);
+  tap.frac = bounded - static_cast<double>(tap.k0);
+  return tap;
 }
 
-}  // namespace
+float SampleFrameMag(const float* mags, const BinTap& tap) {
+  const float a = mags[tap.k0];
+  const float b = mags[tap.k1];
+  return static_cast<float>((1.0 - tap.frac) * static_cast<double>(a) + tap.frac * static_cast<double>(b));
+}
 
-bool RenderSpectrogramRgb(const std::vector<float>& mono, int sample_rate, const SpectrogramConfig& config,
-                          std::vector<uint8_t>* rgb, std::string* error) {
-  if (rgb == nullptr) {
-    if (error != nullptr) {
-      *error = "Internal error: null spectrogram output buffer.";
+// Bin taps of every image row, bottom row first.
+std::vector<BinTap> BuildRowTaps(int bins, int sample_rate, const SpectrogramConfig& config) {
+  const int height = config.height_px;
+  std::vector<BinTap> row_taps(static_cast<size_t>(height));
+  for (int y = 0; y < height; ++y) {
+    const double alpha = static_cast<double>(y) / static_cast<double>(height - 1);
+    double kf = 0.0;
+    if (config.freq_scale == "linear") {
+      kf = alpha * static_cast<double>(bins - 1);
+    } else {
+      const double ratio = config.max_hz / config.min_hz;
+      const double fy = config.min_hz * std::pow(ratio, alpha);
+      kf = fy * static_cast<double>(config.nfft) / static_cast<double>(sample_rate);
     }
-    return false;
+    row_taps[static_cast<size_t>(y)] = MakeBinTap(bins, kf);
+  }
+  return row_taps;
+}
+
+// dB window and gamma mapping of one magnitude to [0, 1].
+double NormalizeMagnitude(double mag, const SpectrogramConfig& config) {
+  double db = 20.0 * std::log10(mag + kEps);
+  db = Clamp(db, config.db_min, config.db_max);
+  double norm = (db - config.db_min) / std::max(config.db_max - config.db_min, 1e-9);
+  norm = Clamp(norm, 0.0, 1.0);
+  if (config.gamma != 1.0) {
+    norm = std::pow(norm, 1.0 / config.gamma);
+  }
+  return norm;
+}
+
+uint8_t QuantizeNorm(double norm) {
+  return static_cast<uint8_t>(std::clamp(static_cast<int>(std::lround(Clamp(norm, 0.0, 1.0) * 255.0)), 0, 255));
+}
+
+// Magnitude -> palette index as 255 ascending thresholds: the index of a magnitude is the number of thresholds at or
+// below it. Each threshold is the smallest double whose NormalizeMagnitude/QuantizeNorm index reaches that level,
+// found by bisection over the ordered bit patterns of non-negative doubles, so the table reproduces the per-pixel
+// formula exactly while replacing log10/pow with eight comparisons.
+class MagnitudeIndexLut {
+ public:
+  explicit MagnitudeIndexLut(const SpectrogramConfig& config) {
+    const auto level = [&config](uint64_t bits) {
+      double mag = 0.0;
+      std::memcpy(&mag, &bits, sizeof(mag));
+      return QuantizeNorm(NormalizeMagnitude(mag, config));
+    };
+    const double max_value = std::numeric_limits<double>::max();
+    uint64_t max_bits = 0;
+    std::memcpy(&max_bits, &max_value, sizeof(max_bits));
+    for (int k = 1; k < 256; ++k) {
+      uint64_t lo = 0;
+      uint64_t hi = max_bits;
+      if (level(hi) < k) {
+        thresholds_[static_cast<size_t>(k - 1)] = std::numeric_limits<double>::infinity();
+        continue;
+      }
+      while (lo < hi) {
+        const uint64_t mid = lo + (hi - lo) / 2U;
+        if (level(mid) >= k) {
+          hi = mid;
+        } else {
+          lo = mid + 1U;
+        }
+      }
+      std::memcpy(&thresholds_[static_cast<size_t>(k - 1)], &lo, sizeof(double));
+    }
+  }
+
+  uint8_t Index(double mag) const {
+    if (std::isnan(mag)) {
+      mag = 0.0;
+    }
+    // Fixed-step bisection over the 2^8 - 1 thresholds; the steps compile to conditional moves instead of branches.
+    size_t index = 0;
+    for (size_t step = 128; step > 0; step >>= 1U) {
+      index += thresholds_[index + step - 1U] <= mag ? step : 0U;
+    }
+    return static_cast<uint8_t>(index);
   }
+
+ private:
+  std::array<double, 255> thresholds_{};
+};
+
+// Replaces `count` floats spaced `stride` apart with the mean of their neighbours within `radius` (the window is
+// clipped at both ends). A running sum keeps the cost independent of the radius; `pending` holds the originals the
+// window still has to subtract after they were overwritten, so only radius + 1 values are buffered.
+void BoxFilterInPlace(float* values, size_t count, size_t stride, int radius, std::vector<float>* pending) {
+  if (count < 2 || radius <= 0) {
+    return;
+  }
+  const size_t r = std::min(static_cast<size_t>(radius), count - 1U);
+  pending->resize(r + 1U);
+  double sum = 0.0;
+  for (size_t i = 0; i <= r; ++i) {
+    sum += static_cast<double>(values[i * stride]);
+  }
+  for (size_t i = 0; i < count; ++i) {
+    const size_t first = i >= r ? i - r : 0U;
+    const size_t last = std::min(i + r, count - 1U);
+    float& value = values[i * stride];
+    (*pending)[i % (r + 1U)] = value;
+    value = static_cast<float>(sum / static_cast<double>(last - first + 1U));
+    if (i + r + 1U < count) {
+      sum += static_cast<double>(values[(i + r + 1U) * stride]);
+    }
+    if (i >= r) {
+      sum -= static_cast<double>((*pending)[(i - r) % (r + 1U)]);
+    }
+  }
+}
+
+// Runs `body(block)` for every block in [0, block_count) on up to `workers` scheduler threads claiming blocks in turn.
+template <typename Body>
+void RunBlocks(int workers, int block_count, const Body& body) {
+  TaskScheduler::Global().ParallelFor(static_cast<size_t>(std::max(block_count, 0)),
+                                      static_cast<size_t>(std::max(workers, 1)),
+                                      [&body](size_t block) { body(static_cast<int>(block)); });
+}
+
+bool ValidateSpectrogramConfig(int sample_rate, const SpectrogramConfig& config, std::string* error) {
   if (sample_rate <= 0) {
     if (error != nullptr) {
       *error = "Invalid sample rate for spectrogram.";
@@ -164,113 +248,274 @@ bool RenderSpectrogramRgb(const std::vector<float>& mono, int sample_rate, const
     return false;
   }
   if (config.window < 2 || config.hop < 1 || config.nfft < config.window || !IsPowerOfTwo(config.nfft) ||
-      config.width_px < 2 || config.height_px < 2 || config.gamma <= 0.0 || config.max_hz <= config.min_hz) {
+      config.width_px < 2 || config.height_px < 2 || config.gamma <= 0.0 || config.max_hz <= config.min_hz ||
+      config.smoothing_bins < 0 || config.smoothing_columns < 0) {
     if (error != nullptr) {
       *error = "Invalid spectrogram configuration.";
     }
     return false;
   }
+  return true;
+}
 
-  const int width = config.width_px;
-  const int height = config.height_px;
-  const int fft_size = config.nfft;
-  const int bins = fft_size / 2 + 1;
-  const size_t sample_count = mono.size();
-  const size_t window = static_cast<size_t>(config.window);
-  const size_t hop = static_cast<size_t>(config.hop);
-  const size_t num_frames = sample_count >= window ? (1U + (sample_count - window) / hop) : 1U;
-
-  std::vector<float> mags(num_frames * static_cast<size_t>(bins), 0.0F);
-  const std::vector<double> hann = BuildHann(config.window);
-  std::vector<std::complex<double>> frame(static_cast<size_t>(fft_size), std::complex<double>(0.0, 0.0));
-
-  for (size_t t = 0; t < num_frames; ++t) {
-    std::fill(frame.begin(), frame.end(), std::complex<double>(0.0, 0.0));
-    const size_t start = t * hop;
-    for (int i = 0; i < config.window; ++i) {
-      const size_t idx = start + static_cast<size_t>(i);
-      double sample = 0.0;
-      if (idx < sample_count) {
-        sample = static_cast<double>(mono[idx]);
-        if (!std::isfinite(sample)) {
-          sample = 0.0;
-        }
-      }
-      frame[static_cast<size_t>(i)] = std::complex<double>(sample * hann[static_cast<size_t>(i)], 0.0);
-    }
-    FftInPlace(&frame);
-    for (int k = 0; k < bins; ++k) {
-      mags[t * static_cast<size_t>(bins) + static_cast<size_t>(k)] = static_cast<float>(std::abs(frame[static_cast<size_t>(k)]));
-    }
+}  // namespace
+
+bool RenderSpectrogramIndexed(const std::vector<float>& mono, int sample_rate, const SpectrogramConfig& config,
+                              std::vector<uint8_t>* indices, std::vector<uint8_t>* rgb, std::string* error) {
+  if (!ValidateSpectrogramConfig(sample_rate, config, error)) {
+    return false;
   }
+  std::vector<uint8_t> wanted;
+  MarkSpectrogramFrames(StftFrameCount(mono.size(), config.window, config.hop), config.width_px, &wanted);
+  MagnitudeFrames frames;
+  if (!ComputeMagnitudeFrames(mono, config.window, config.hop, config.nfft, wanted, &frames, error)) {
+    return false;
+  }
+  return RenderSpectrogramIndexedFromFrames(frames, sample_rate, config, indices, rgb, error);
+}
 
-  std::vector<double> freq_bins(static_cast<size_t>(height), 0.0);
-  for (int y = 0; y < height; ++y) {
-    const double alpha = static_cast<double>(y) / static_cast<double>(height - 1);
-    if (config.freq_scale == "linear") {
-      freq_bins[static_cast<size_t>(y)] = alpha * static_cast<double>(bins - 1);
-    } else {
-      const double ratio = config.max_hz / config.min_hz;
-      const double fy = config.min_hz * std::pow(ratio, alpha);
-      freq_bins[static_cast<size_t>(y)] = fy * static_cast<double>(fft_size) / static_cast<double>(sample_rate);
+bool RenderSpectrogramIndexedFromFrames(const MagnitudeFrames& frames, int sample_rate, const SpectrogramConfig& config,
+                                        std::vector<uint8_t>* indices, std::vector<uint8_t>* rgb, std::string* error) {
+  if (indices == nullptr) {
+    if (error != nullptr) {
+      *error = "Internal error: null spectrogram output buffer.";
     }
+    return false;
+  }
+  if (!ValidateSpectrogramConfig(sample_rate, config, error)) {
+    return false;
+  }
+  if (!frames.Matches(config.window, config.hop, config.nfft)) {
+    if (error != nullptr) {
+      *error = "Spectrogram frames do not match the configured STFT.";
+    }
+    return false;
   }
 
-  std::vector<double> u(static_cast<size_t>(width * height), 0.0);
+  const int width = config.width_px;
+  const int height = config.height_px;
+  const size_t num_frames = frames.frame_count;
+
+  const std::vector<BinTap> row_taps = BuildRowTaps(frames.bins, sample_rate, config);
+
+  struct ColumnTap {
+    const float* frame0 = nullptr;
+    const float* frame1 = nullptr;
+    double frac = 0.0;
+  };
+  std::vector<ColumnTap> column_taps(static_cast<size_t>(width));
   for (int x = 0; x < width; ++x) {
     const double tf = static_cast<double>(x) * static_cast<double>(num_frames - 1) / static_cast<double>(width - 1);
     const int t0 = static_cast<int>(std::floor(tf));
     const int t1 = std::min(t0 + 1, static_cast<int>(num_frames - 1));
-    const double time_frac = tf - static_cast<double>(t0);
-    for (int y = 0; y < height; ++y) {
-      const float m0 = SampleFrameMag(mags, bins, t0, freq_bins[static_cast<size_t>(y)]);
-      const float m1 = SampleFrameMag(mags, bins, t1, freq_bins[static_cast<size_t>(y)]);
-      const double mag = (1.0 - time_frac) * static_cast<double>(m0) + time_frac * static_cast<double>(m1);
-      double db = 20.0 * std::log10(mag + kEps);
-      db = Clamp(db, config.db_min, config.db_max);
-      double norm = (db - config.db_min) / std::max(config.db_max - config.db_min, 1e-9);
-      norm = Clamp(norm, 0.0, 1.0);
-      if (config.gamma != 1.0) {
-        norm = std::pow(norm, 1.0 / config.gamma);
+    if (!frames.Has(static_cast<size_t>(t0)) || !frames.Has(static_cast<size_t>(t1))) {
+      if (error != nullptr) {
+        *error = "Spectrogram frames are missing a column the rasterizer needs.";
       }
-      const int yy = (height - 1) - y;
-      u[static_cast<size_t>(yy * width + x)] = norm;
+      return false;
     }
+    ColumnTap& tap = column_taps[static_cast<size_t>(x)];
+    tap.frame0 = frames.Frame(static_cast<size_t>(t0));
+    tap.frame1 = frames.Frame(static_cast<size_t>(t1));
+    tap.frac = tf - static_cast<double>(t0);
   }
 
-  if (config.smoothing_bins > 0) {
-    const int radius = config.smoothing_bins;
-    std::vector<double> smoothed = u;
-    for (int y = 0; y < height; ++y) {
-      const int y0 = std::max(0, y - radius);
-      const int y1 = std::min(height - 1, y + radius);
-      for (int x = 0; x < width; ++x) {
-        double sum = 0.0;
-        int count = 0;
-        for (int yy = y0; yy <= y1; ++yy) {
-          sum += u[static_cast<size_t>(yy * width + x)];
-          ++count;
+  // Without smoothing, magnitudes go straight to palette indices. Smoothing averages normalized values, so that path
+  // keeps a float image of them: the frequency-axis pass runs per column as it is rasterized, the time-axis pass per
+  // row once every column is done.
+  const bool smoothing = config.smoothing_bins > 0 || config.smoothing_columns > 0;
+  const MagnitudeIndexLut index_lut(config);
+  indices->assign(static_cast<size_t>(width) * static_cast<size_t>(height), 0U);
+  std::vector<float> norms(smoothing ? indices->size() : 0U);
+  const size_t stride = static_cast<size_t>(width);
+  const auto render_columns = [&](int x_begin, int x_end) {
+    std::vector<float> pending;
+    for (int x = x_begin; x < x_end; ++x) {
+      const ColumnTap& column = column_taps[static_cast<size_t>(x)];
+      for (int y = 0; y < height; ++y) {
+        const BinTap& row = row_taps[static_cast<size_t>(y)];
+        const float m0 = SampleFrameMag(column.frame0, row);
+        const float m1 = SampleFrameMag(column.frame1, row);
+        const double mag = (1.0 - column.frac) * static_cast<double>(m0) + column.frac * static_cast<double>(m1);
+        const size_t pixel = static_cast<size_t>((height - 1) - y) * stride + static_cast<size_t>(x);
+        if (smoothing) {
+          norms[pixel] = static_cast<float>(NormalizeMagnitude(mag, config));
+        } else {
+          (*indices)[pixel] = index_lut.Index(mag);
         }
-        smoothed[static_cast<size_t>(y * width + x)] = sum / static_cast<double>(std::max(count, 1));
+      }
+      if (smoothing) {
+        BoxFilterInPlace(norms.data() + x, static_cast<size_t>(height), stride, config.smoothing_bins, &pending);
       }
     }
-    u = std::move(smoothed);
+  };
+
+  // Columns are independent; workers claim fixed blocks so each writes whole cache lines of every output row.
+  constexpr int kColumnBlock = 64;
+  const int workers = std::max(config.render_threads, 1);
+  RunBlocks(workers, (width + kColumnBlock - 1) / kColumnBlock, [&](int block) {
+    render_columns(block * kColumnBlock, std::min(width, (block + 1) * kColumnBlock));
+  });
+
+  if (smoothing) {
+    constexpr int kRowBlock = 16;
+    RunBlocks(workers, (height + kRowBlock - 1) / kRowBlock, [&](int block) {
+      std::vector<float> pending;
+      for (int y = block * kRowBlock; y < std::min(height, (block + 1) * kRowBlock); ++y) {
+        float* row = norms.data() + static_cast<size_t>(y) * stride;
+        BoxFilterInPlace(row, stride, 1U, config.smoothing_columns, &pending);
+        for (size_t x = 0; x < stride; ++x) {
+          (*indices)[static_cast<size_t>(y) * stride + x] = QuantizeNorm(static_cast<double>(row[x]));
+        }
+      }
+    });
   }
 
-  const std::vector<Rgb>& lut = GetColorLut(config.colormap);
-  rgb->assign(static_cast<size_t>(width * height * 3), 0U);
-  for (int y = 0; y < height; ++y) {
-    for (int x = 0; x < width; ++x) {
-      const double norm = Clamp(u[static_cast<size_t>(y * width + x)], 0.0, 1.0);
-      const int lut_idx = std::clamp(static_cast<int>(std::lround(norm * 255.0)), 0, 255);
-      const Rgb c = lut[static_cast<size_t>(lut_idx)];
-      const size_t out = static_cast<size_t>((y * width + x) * 3);
-      (*rgb)[out] = c.r;
-      (*rgb)[out + 1] = c.g;
-      (*rgb)[out + 2] = c.b;
+  if (rgb != nullptr) {
+    const std::vector<Rgb>& lut = GetColorLut(config.colormap);
+    rgb->assign(indices->size() * 3U, 0U);
+    for (size_t i = 0; i < indices->size(); ++i) {
+      const Rgb c = lut[(*indices)[i]];
+      (*rgb)[i * 3U] = c.r;
+      (*rgb)[i * 3U + 1U] = c.g;
+      (*rgb)[i * 3U + 2U] = c.b;
+    }
+  }
+
+  return true;
+}
+
+bool RenderSpectrogramRgb(const std::vector<float>& mono, int sample_rate, const SpectrogramConfig& config,
+                          std::vector<uint8_t>* rgb, std::string* error) {
+  if (rgb == nullptr) {
+    if (error != nullptr) {
+      *error = "Internal error: null spectrogram output buffer.";
+    }
+    return false;
+  }
+  std::vector<uint8_t> indices;
+  return RenderSpectrogramIndexed(mono, sample_rate, config, &indices, rgb, error);
+}
+
+bool RenderSpectrogramPyramid(const MonoSampleReader& read, size_t sample_count, int sample_rate,
+                              const SpectrogramConfig& config, const SpectrogramTileConfig& tiles,
+                              const SpectrogramTileSink& sink, SpectrogramPyramid* pyramid, std::string* error) {
+  if (!ValidateSpectrogramConfig(sample_rate, config, error)) {
+    return false;
+  }
+  if (!sink || tiles.tile_width_px < 2 || (tiles.pooling != "max" && tiles.pooling != "mean")) {
+    if (error != nullptr) {
+      *error = "Invalid spectrogram tile configuration.";
     }
+    return false;
+  }
+
+  const size_t frame_count = StftFrameCount(sample_count, config.window, config.hop);
+  const size_t tile_width = static_cast<size_t>(tiles.tile_width_px);
+  const size_t height = static_cast<size_t>(config.height_px);
+  // The finest level has one column per frame; each coarser level halves the column count (rounding up) until one
+  // tile holds the whole signal.
+  int finest = 0;
+  while (((frame_count - 1U) >> finest) + 1U > tile_width) {
+    ++finest;
+  }
+  SpectrogramPyramid layout;
+  layout.frame_count = frame_count;
+  layout.tile_width_px = tiles.tile_width_px;
+  layout.tile_height_px = config.height_px;
+  for (int level = 0; level <= finest; ++level) {
+    SpectrogramPyramidLevel info;
+    info.frames_per_column = size_t{1} << (finest - level);
+    info.columns = ((frame_count - 1U) >> (finest - level)) + 1U;
+    info.tiles = (info.columns + tile_width - 1U) / tile_width;
+    layout.levels.push_back(info);
+  }
+  if (pyramid != nullptr) {
+    *pyramid = layout;
   }
 
+  // Per level: the tile being filled (column-major magnitudes) and a finer column waiting for its pooling partner.
+  struct LevelState {
+    std::vector<float> tile;
+    size_t filled = 0;
+    size_t next_index = 0;
+    std::vector<float> carry;
+    bool has_carry = false;
+  };
+  std::vector<LevelState> levels(static_cast<size_t>(finest) + 1U);
+  for (auto& level : levels) {
+    level.tile.assign(tile_width * height, 0.0F);
+    level.carry.assign(height, 0.0F);
+  }
+  const MagnitudeIndexLut index_lut(config);
+  const bool mean_pooling = tiles.pooling == "mean";
+  SpectrogramTile out;
+  out.height = config.height_px;
+
+  const auto emit = [&](int z, std::string* emit_error) {
+    LevelState& level = levels[static_cast<size_t>(z)];
+    out.level = z;
+    out.index = level.next_index++;
+    out.width = static_cast<int>(level.filled);
+    out.indices.resize(level.filled * height);
+    for (size_t x = 0; x < level.filled; ++x) {
+      const float* column = level.tile.data() + x * height;
+      for (size_t y = 0; y < height; ++y) {
+        out.indices[(height - 1U - y) * level.filled + x] = index_lut.Index(static_cast<double>(column[y]));
+      }
+    }
+    level.filled = 0;
+    return sink(out, emit_error);
+  };
+  // Appends a column to level `z`; every second column of a level pools with its partner into the next coarser one.
+  const auto push = [&](int z, const float* column, std::string* push_error) {
+    while (true) {
+      LevelState& level = levels[static_cast<size_t>(z)];
+      std::copy_n(column, height, level.tile.data() + level.filled * height);
+      if (++level.filled == tile_width && !emit(z, push_error)) {
+        return false;
+      }
+      if (z == 0) {
+        return true;
+      }
+      if (!level.has_carry) {
+        std::copy_n(column, height, level.carry.data());
+        level.has_carry = true;
+        return true;
+      }
+      for (size_t y = 0; y < height; ++y) {
+        level.carry[y] = mean_pooling ? 0.5F * (level.carry[y] + column[y]) : std::max(level.carry[y], column[y]);
+      }
+      level.has_carry = false;
+      column = level.carry.data();
+      --z;
+    }
+  };
+
+  const std::vector<BinTap> row_taps = BuildRowTaps(config.nfft / 2 + 1, sample_rate, config);
+  std::vector<float> column(height, 0.0F);
+  const MagnitudeFrameVisitor visit = [&](size_t, const float* magnitudes, std::string* visit_error) {
+    for (size_t y = 0; y < height; ++y) {
+      column[y] = SampleFrameMag(magnitudes, row_taps[y]);
+    }
+    return push(finest, column.data(), visit_error);
+  };
+  if (!ForEachMagnitudeFrame(read, sample_count, config.window, config.hop, config.nfft, visit, error)) {
+    return false;
+  }
+  // An odd trailing column has no partner and passes to the coarser level as is.
+  for (int z = finest; z >= 0; --z) {
+    LevelState& level = levels[static_cast<size_t>(z)];
+    if (z > 0 && level.has_carry) {
+      level.has_carry = false;
+      if (!push(z - 1, level.carry.data(), error)) {
+        return false;
+      }
+    }
+    if (level.filled > 0 && !emit(z, error)) {
+      return false;
+    }
+  }
   return true;
 }
 
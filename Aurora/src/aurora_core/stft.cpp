@@ -0,0 +1,200 @@
+#include "aurora/core/stft.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace aurora::core {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+bool ValidStft(int window, int hop, int nfft) {
+  return window >= 2 && hop >= 1 && nfft >= window && (nfft & (nfft - 1)) == 0;
+}
+
+}  // namespace
+
+void FftInPlace(std::vector<std::complex<double>>* values) {
+  auto& a = *values;
+  const size_t n = a.size();
+  size_t j = 0;
+  for (size_t i = 1; i < n; ++i) {
+    size_t bit = n >> 1;
+    while (j & bit) {
+      j ^= bit;
+      bit >>= 1;
+    }
+    j ^= bit;
+    if (i < j) {
+      std::swap(a[i], a[j]);
+    }
+  }
+
+  for (size_t len = 2; len <= n; len <<= 1) {
+    const double angle = -2.0 * kPi / static_cast<double>(len);
+    const std::complex<double> w_len(std::cos(angle), std::sin(angle));
+    for (size_t i = 0; i < n; i += len) {
+      std::complex<double> w(1.0, 0.0);
+      for (size_t j2 = 0; j2 < len / 2; ++j2) {
+        const std::complex<double> u = a[i + j2];
+        const std::complex<double> v = a[i + j2 + len / 2] * w;
+        a[i + j2] = u + v;
+        a[i + j2 + len / 2] = u - v;
+        w *= w_len;
+      }
+    }
+  }
+}
+
+std::vector<double> BuildHann(int size) {
+  std::vector<double> w(static_cast<size_t>(size), 0.0);
+  if (size <= 1) {
+    return w;
+  }
+  for (int i = 0; i < size; ++i) {
+    w[static_cast<size_t>(i)] = 0.5 - 0.5 * std::cos(2.0 * kPi * static_cast<double>(i) / static_cast<double>(size - 1));
+  }
+  return w;
+}
+
+size_t StftFrameCount(size_t sample_count, int window, int hop) {
+  const size_t w = static_cast<size_t>(std::max(window, 1));
+  const size_t h = static_cast<size_t>(std::max(hop, 1));
+  return sample_count >= w ? (1U + (sample_count - w) / h) : 1U;
+}
+
+void MarkSpectrogramFrames(size_t frame_count, int width_px, std::vector<uint8_t>* wanted) {
+  wanted->resize(frame_count, 0U);
+  if (frame_count == 0 || width_px < 2) {
+    return;
+  }
+  // Mirrors the column -> frame mapping of the rasterizer: column x reads frames floor(tf) and floor(tf) + 1.
+  for (int x = 0; x < width_px; ++x) {
+    const double tf = static_cast<double>(x) * static_cast<double>(frame_count - 1) / static_cast<double>(width_px - 1);
+    const size_t t0 = static_cast<size_t>(std::floor(tf));
+    const size_t t1 = std::min(t0 + 1U, frame_count - 1U);
+    (*wanted)[std::min(t0, frame_count - 1U)] = 1U;
+    (*wanted)[t1] = 1U;
+  }
+}
+
+namespace {
+
+// Hann-windowed, zero-padded FFT of one frame to `nfft / 2 + 1` magnitudes; non-finite samples count as silence.
+class FrameTransform {
+ public:
+  FrameTransform(int window, int nfft)
+      : hann_(BuildHann(window)), frame_(static_cast<size_t>(nfft), std::complex<double>(0.0, 0.0)) {}
+
+  void Run(const float* samples, float* magnitudes) {
+    std::fill(frame_.begin(), frame_.end(), std::complex<double>(0.0, 0.0));
+    for (size_t i = 0; i < hann_.size(); ++i) {
+      double sample = static_cast<double>(samples[i]);
+      if (!std::isfinite(sample)) {
+        sample = 0.0;
+      }
+      frame_[i] = std::complex<double>(sample * hann_[i], 0.0);
+    }
+    FftInPlace(&frame_);
+    const size_t bins = frame_.size() / 2U + 1U;
+    for (size_t k = 0; k < bins; ++k) {
+      magnitudes[k] = static_cast<float>(std::abs(frame_[k]));
+    }
+  }
+
+ private:
+  std::vector<double> hann_;
+  std::vector<std::complex<double>> frame_;
+};
+
+}  // namespace
+
+bool ComputeMagnitudeFrames(const std::vector<float>& mono, int window, int hop, int nfft,
+                            const std::vector<uint8_t>& wanted, MagnitudeFrames* out, std::string* error) {
+  const MonoSampleReader read = [&mono](size_t first, size_t count, float* dst, std::string*) {
+    std::copy_n(mono.begin() + static_cast<std::ptrdiff_t>(first), count, dst);
+    return true;
+  };
+  return ComputeMagnitudeFrames(read, mono.size(), window, hop, nfft, wanted, out, error);
+}
+
+bool ComputeMagnitudeFrames(const MonoSampleReader& read, size_t sample_count, int window, int hop, int nfft,
+                            const std::vector<uint8_t>& wanted, MagnitudeFrames* out, std::string* error) {
+  if (out == nullptr || !ValidStft(window, hop, nfft)) {
+    if (error != nullptr) {
+      *error = "Invalid STFT configuration.";
+    }
+    return false;
+  }
+  out->window = window;
+  out->hop = hop;
+  out->nfft = nfft;
+  out->bins = nfft / 2 + 1;
+  out->frame_count = StftFrameCount(sample_count, window, hop);
+  out->slots.assign(out->frame_count, -1);
+  out->magnitudes.clear();
+
+  const size_t bins = static_cast<size_t>(out->bins);
+  FrameTransform transform(window, nfft);
+  std::vector<float> samples(static_cast<size_t>(window), 0.0F);
+  for (size_t t = 0; t < out->frame_count; ++t) {
+    if (t >= wanted.size() || wanted[t] == 0U) {
+      continue;
+    }
+    const size_t start = t * static_cast<size_t>(hop);
+    const size_t available = start < sample_count ? std::min(samples.size(), sample_count - start) : 0U;
+    if (available > 0 && !read(start, available, samples.data(), error)) {
+      return false;
+    }
+    std::fill(samples.begin() + static_cast<std::ptrdiff_t>(available), samples.end(), 0.0F);
+    out->slots[t] = static_cast<int32_t>(out->magnitudes.size() / bins);
+    out->magnitudes.resize(out->magnitudes.size() + bins);
+    transform.Run(samples.data(), out->magnitudes.data() + out->magnitudes.size() - bins);
+  }
+  return true;
+}
+
+bool ForEachMagnitudeFrame(const MonoSampleReader& read, size_t sample_count, int window, int hop, int nfft,
+                           const MagnitudeFrameVisitor& visit, std::string* error) {
+  if (!ValidStft(window, hop, nfft)) {
+    if (error != nullptr) {
+      *error = "Invalid STFT configuration.";
+    }
+    return false;
+  }
+  const size_t frame_count = StftFrameCount(sample_count, window, hop);
+  const size_t w = static_cast<size_t>(window);
+  const size_t h = static_cast<size_t>(hop);
+  FrameTransform transform(window, nfft);
+  std::vector<float> samples(w, 0.0F);
+  std::vector<float> magnitudes(static_cast<size_t>(nfft / 2 + 1), 0.0F);
+  // `samples` always holds [start, start + window) of the signal, zero past its end. With overlapping frames only the
+  // last `hop` samples are new, so each sample is read once.
+  for (size_t t = 0; t < frame_count; ++t) {
+    const size_t start = t * h;
+    size_t keep = 0;
+    if (t > 0 && h < w) {
+      keep = w - h;
+      std::copy(samples.begin() + static_cast<std::ptrdiff_t>(h), samples.end(), samples.begin());
+    }
+    const size_t read_begin = start + keep;
+    const size_t read_end = std::min(start + w, sample_count);
+    if (read_end > read_begin && !read(read_begin, read_end - read_begin, samples.data() + keep, error)) {
+      return false;
+    }
+    const size_t valid = read_end > start ? read_end - start : 0U;
+    std::fill(samples.begin() + static_cast<std::ptrdiff_t>(std::max(valid, keep)), samples.end(), 0.0F);
+    transform.Run(samples.data(), magnitudes.data());
+    if (!visit(t, magnitudes.data(), error)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace aurora::core
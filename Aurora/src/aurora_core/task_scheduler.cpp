@@ -0,0 +1,277 @@
+#include "aurora/core/task_scheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace aurora::core {
+namespace {
+
+constexpr size_t kNoWorker = std::numeric_limits<size_t>::max();
+
+// Whole CPUs granted by a quota of `quota` per `period`, or 0 when either is missing or unlimited.
+int QuotaCpus(long long quota, long long period) {
+  if (quota <= 0 || period <= 0) {
+    return 0;
+  }
+  return static_cast<int>(std::max(1LL, (quota + period - 1LL) / period));
+}
+
+int CgroupCpuLimit() {
+  {
+    std::ifstream in("/sys/fs/cgroup/cpu.max");
+    std::string quota;
+    long long period = 0;
+    if (in >> quota >> period) {
+      if (quota == "max") {
+        return 0;
+      }
+      try {
+        return QuotaCpus(std::stoll(quota), period);
+      } catch (const std::exception&) {
+        return 0;
+      }
+    }
+  }
+  for (const char* dir : {"/sys/fs/cgroup/cpu/", "/sys/fs/cgroup/cpu,cpuacct/"}) {
+    std::ifstream quota_in(std::string(dir) + "cpu.cfs_quota_us");
+    std::ifstream period_in(std::string(dir) + "cpu.cfs_period_us");
+    long long quota = 0;
+    long long period = 0;
+    if (quota_in >> quota && period_in >> period) {
+      return QuotaCpus(quota, period);
+    }
+  }
+  return 0;
+}
+
+struct TaskQueue {
+  std::mutex mutex;
+  std::deque<std::function<void()>> tasks;
+};
+
+struct ParallelForState {
+  const std::function<void(size_t)>* body = nullptr;  // only dereferenced after a successful claim
+  size_t count = 0;
+  std::atomic<size_t> next{0U};
+  std::mutex mutex;
+  std::condition_variable finished_cv;
+  size_t finished = 0;
+  std::exception_ptr failure;
+};
+
+// Claims and runs indices until none are left. The body is reached only through a claimed index, and the caller does
+// not return before every claimed index has finished, so a helper that starts late never touches a dead body.
+void RunClaims(ParallelForState* state) {
+  for (size_t i = state->next.fetch_add(1U); i < state->count; i = state->next.fetch_add(1U)) {
+    std::exception_ptr failure;
+    try {
+      (*state->body)(i);
+    } catch (...) {
+      failure = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (failure && !state->failure) {
+      state->failure = failure;
+    }
+    if (++state->finished == state->count) {
+      state->finished_cv.notify_all();
+    }
+  }
+}
+
+std::mutex g_global_mutex;
+std::unique_ptr<TaskScheduler> g_global;
+
+}  // namespace
+
+struct TaskScheduler::State {
+  std::vector<std::unique_ptr<TaskQueue>> local;  // one per worker
+  TaskQueue injected;                             // tasks submitted from outside the pool
+  std::atomic<size_t> queued{0U};
+  std::mutex sleep_mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+  std::vector<std::thread> workers;
+
+  // Pops the caller's own newest task, else the oldest injected task, else steals the oldest task of another worker.
+  bool Take(size_t self, std::function<void()>* task) {
+    const auto pop = [&](TaskQueue& queue, bool newest) {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (queue.tasks.empty()) {
+        return false;
+      }
+      if (newest) {
+        *task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      } else {
+        *task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+      queued.fetch_sub(1U);
+      return true;
+    };
+    if (self != kNoWorker && pop(*local[self], true)) {
+      return true;
+    }
+    if (pop(injected, false)) {
+      return true;
+    }
+    const size_t workers_count = local.size();
+    for (size_t offset = 1; offset <= workers_count; ++offset) {
+      const size_t victim = self == kNoWorker ? offset - 1U : (self + offset) % workers_count;
+      if (victim != self && pop(*local[victim], false)) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+namespace {
+
+// The scheduler and worker index of the current thread, when it is a pool worker.
+thread_local const void* t_owner = nullptr;
+thread_local size_t t_worker = kNoWorker;
+
+}  // namespace
+
+int DefaultThreadCount() {
+  int cpus = static_cast<int>(std::thread::hardware_concurrency());
+#if defined(__linux__)
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+    cpus = CPU_COUNT(&mask);
+  }
+#endif
+  cpus = std::max(cpus, 1);
+  const int quota = CgroupCpuLimit();
+  return quota > 0 ? std::min(cpus, quota) : cpus;
+}
+
+TaskScheduler& TaskScheduler::Global() {
+  std::lock_guard<std::mutex> lock(g_global_mutex);
+  if (!g_global) {
+    g_global = std::make_unique<TaskScheduler>(static_cast<size_t>(DefaultThreadCount()));
+  }
+  return *g_global;
+}
+
+void TaskScheduler::Configure(int threads) {
+  const size_t budget = static_cast<size_t>(threads > 0 ? threads : DefaultThreadCount());
+  std::lock_guard<std::mutex> lock(g_global_mutex);
+  g_global.reset();
+  g_global = std::make_unique<TaskScheduler>(budget);
+}
+
+TaskScheduler::TaskScheduler(size_t threads) : state_(std::make_unique<State>()) {
+  const size_t workers = std::max<size_t>(threads, 1U) - 1U;
+  state_->local.reserve(workers);
+  for (size_t w = 0; w < workers; ++w) {
+    state_->local.push_back(std::make_unique<TaskQueue>());
+  }
+  state_->workers.reserve(workers);
+  for (size_t w = 0; w < workers; ++w) {
+    state_->workers.emplace_back([state = state_.get(), w]() {
+      t_owner = state;
+      t_worker = w;
+      std::function<void()> task;
+      while (true) {
+        if (state->Take(w, &task)) {
+          task();
+          task = nullptr;
+          continue;
+        }
+        std::unique_lock<std::mutex> lock(state->sleep_mutex);
+        state->wake.wait(lock, [state]() { return state->stopping || state->queued.load() > 0U; });
+        if (state->stopping && state->queued.load() == 0U) {
+          return;
+        }
+      }
+    });
+  }
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(state_->sleep_mutex);
+    state_->stopping = true;
+  }
+  state_->wake.notify_all();
+  for (auto& worker : state_->workers) {
+    worker.join();
+  }
+  // Without workers, tasks nobody waited for still run, so their futures are satisfied.
+  std::function<void()> task;
+  while (state_->Take(kNoWorker, &task)) {
+    task();
+  }
+}
+
+size_t TaskScheduler::concurrency() const { return state_->workers.size() + 1U; }
+
+void TaskScheduler::Push(std::function<void()> task) {
+  if (t_owner == state_.get()) {
+    std::lock_guard<std::mutex> lock(state_->local[t_worker]->mutex);
+    state_->local[t_worker]->tasks.push_back(std::move(task));
+  } else {
+    std::lock_guard<std::mutex> lock(state_->injected.mutex);
+    state_->injected.tasks.push_back(std::move(task));
+  }
+  state_->queued.fetch_add(1U);
+  {
+    // Pairs with the predicate check in the worker loop so a worker about to sleep sees the new task.
+    std::lock_guard<std::mutex> lock(state_->sleep_mutex);
+  }
+  state_->wake.notify_one();
+}
+
+bool TaskScheduler::RunOne() {
+  std::function<void()> task;
+  if (!state_->Take(t_owner == state_.get() ? t_worker : kNoWorker, &task)) {
+    return false;
+  }
+  task();
+  return true;
+}
+
+void TaskScheduler::ParallelFor(size_t count, size_t max_parallelism, const std::function<void(size_t)>& body) {
+  if (count == 0) {
+    return;
+  }
+  size_t parallelism = max_parallelism == 0 ? concurrency() : std::min(max_parallelism, concurrency());
+  parallelism = std::min(parallelism, count);
+  if (parallelism <= 1U) {
+    for (size_t i = 0; i < count; ++i) {
+      body(i);
+    }
+    return;
+  }
+  auto state = std::make_shared<ParallelForState>();
+  state->body = &body;
+  state->count = count;
+  for (size_t helper = 1; helper < parallelism; ++helper) {
+    Push([state]() { RunClaims(state.get()); });
+  }
+  RunClaims(state.get());
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->finished_cv.wait(lock, [&state]() { return state->finished == state->count; });
+  if (state->failure) {
+    std::rethrow_exception(state->failure);
+  }
+}
+
+}  // namespace aurora::core
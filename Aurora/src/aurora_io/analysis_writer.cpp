@@ -2,180 +2,276 @@
 
 #include <filesystem>
 #include <fstream>
-#include <iomanip>
-#include <sstream>
 #include <string>
+#include <vector>
+
+#include "aurora/io/json_buffer.hpp"
 
 namespace aurora::io {
 namespace {
 
-std::string EscapeJson(const std::string& in) {
-  std::ostringstream out;
-  for (const char ch : in) {
-    switch (ch) {
-      case '"':
-        out << "\\\"";
-        break;
-      case '\\':
-        out << "\\\\";
-        break;
-      case '\n':
-        out << "\\n";
-        break;
-      case '\r':
-        out << "\\r";
-        break;
-      case '\t':
-        out << "\\t";
-        break;
-      default:
-        out << ch;
-        break;
-    }
-  }
-  return out.str();
+void WriteSpectralRatios(JsonBuffer* out, const aurora::core::SpectralRatios& r, int indent) {
+  out->Indent(indent).Raw("\"sub\": ").Number(r.sub).Raw(",\n");
+  out->Indent(indent).Raw("\"low\": ").Number(r.low).Raw(",\n");
+  out->Indent(indent).Raw("\"low_mid\": ").Number(r.low_mid).Raw(",\n");
+  out->Indent(indent).Raw("\"mid\": ").Number(r.mid).Raw(",\n");
+  out->Indent(indent).Raw("\"presence\": ").Number(r.presence).Raw(",\n");
+  out->Indent(indent).Raw("\"high\": ").Number(r.high).Raw(",\n");
+  out->Indent(indent).Raw("\"air\": ").Number(r.air).Raw(",\n");
+  out->Indent(indent).Raw("\"ultra\": ").Number(r.ultra).Raw("\n");
 }
 
-void WriteSpectralRatios(std::ofstream& out, const aurora::core::SpectralRatios& r, int indent) {
-  const std::string pad(static_cast<size_t>(indent), ' ');
-  out << pad << "\"sub\": " << r.sub << ",\n";
-  out << pad << "\"low\": " << r.low << ",\n";
-  out << pad << "\"low_mid\": " << r.low_mid << ",\n";
-  out << pad << "\"mid\": " << r.mid << ",\n";
-  out << pad << "\"presence\": " << r.presence << ",\n";
-  out << pad << "\"high\": " << r.high << ",\n";
-  out << pad << "\"air\": " << r.air << ",\n";
-  out << pad << "\"ultra\": " << r.ultra << "\n";
-}
-
-void WriteSpectrogram(std::ofstream& out, const aurora::core::SpectrogramArtifact& spec, int indent) {
-  const std::string pad(static_cast<size_t>(indent), ' ');
-  out << pad << "\"enabled\": " << (spec.enabled ? "true" : "false");
+void WriteSpectrogram(JsonBuffer* out, const aurora::core::SpectrogramArtifact& spec, int indent) {
+  out->Indent(indent).Raw("\"enabled\": ").Bool(spec.enabled);
   if (!spec.path.empty()) {
-    out << ",\n" << pad << "\"path\": \"" << EscapeJson(spec.path) << "\"";
+    out->Raw(",\n").Indent(indent).Raw("\"path\": ").String(spec.path);
   }
   if (!spec.paths.empty()) {
-    out << ",\n" << pad << "\"paths\": [\n";
+    out->Raw(",\n").Indent(indent).Raw("\"paths\": [\n");
     for (size_t i = 0; i < spec.paths.size(); ++i) {
-      out << pad << "  \"" << EscapeJson(spec.paths[i]) << "\"";
+      out->Indent(indent + 2).String(spec.paths[i]);
       if (i + 1 < spec.paths.size()) {
-        out << ",";
+        out->Raw(",");
       }
-      out << "\n";
+      out->Raw("\n");
     }
-    out << pad << "]";
+    out->Indent(indent).Raw("]");
+  }
+  if (!spec.tiles_manifest.empty()) {
+    out->Raw(",\n").Indent(indent).Raw("\"tiles_manifest\": ").String(spec.tiles_manifest);
   }
   if (!spec.error.empty()) {
-    out << ",\n" << pad << "\"error\": \"" << EscapeJson(spec.error) << "\"";
+    out->Raw(",\n").Indent(indent).Raw("\"error\": ").String(spec.error);
   }
   if (spec.enabled) {
-    out << ",\n" << pad << "\"mode\": \"" << EscapeJson(spec.mode) << "\"";
-    out << ",\n" << pad << "\"sr\": " << spec.sr;
-    out << ",\n" << pad << "\"window\": " << spec.window;
-    out << ",\n" << pad << "\"hop\": " << spec.hop;
-    out << ",\n" << pad << "\"nfft\": " << spec.nfft;
-    out << ",\n" << pad << "\"freq_scale\": \"" << EscapeJson(spec.freq_scale) << "\"";
-    out << ",\n" << pad << "\"min_hz\": " << spec.min_hz;
-    out << ",\n" << pad << "\"max_hz\": " << spec.max_hz;
-    out << ",\n" << pad << "\"db_min\": " << spec.db_min;
-    out << ",\n" << pad << "\"db_max\": " << spec.db_max;
-    out << ",\n" << pad << "\"colormap\": \"" << EscapeJson(spec.colormap) << "\"";
-    out << ",\n" << pad << "\"width_px\": " << spec.width_px;
-    out << ",\n" << pad << "\"height_px\": " << spec.height_px;
-    out << ",\n" << pad << "\"gamma\": " << spec.gamma;
-    out << ",\n" << pad << "\"smoothing_bins\": " << spec.smoothing_bins;
-  }
-  out << "\n";
+    out->Raw(",\n").Indent(indent).Raw("\"mode\": ").String(spec.mode);
+    out->Raw(",\n").Indent(indent).Raw("\"sr\": ").Int(spec.sr);
+    out->Raw(",\n").Indent(indent).Raw("\"window\": ").Int(spec.window);
+    out->Raw(",\n").Indent(indent).Raw("\"hop\": ").Int(spec.hop);
+    out->Raw(",\n").Indent(indent).Raw("\"nfft\": ").Int(spec.nfft);
+    out->Raw(",\n").Indent(indent).Raw("\"freq_scale\": ").String(spec.freq_scale);
+    out->Raw(",\n").Indent(indent).Raw("\"min_hz\": ").Number(spec.min_hz);
+    out->Raw(",\n").Indent(indent).Raw("\"max_hz\": ").Number(spec.max_hz);
+    out->Raw(",\n").Indent(indent).Raw("\"db_min\": ").Number(spec.db_min);
+    out->Raw(",\n").Indent(indent).Raw("\"db_max\": ").Number(spec.db_max);
+    out->Raw(",\n").Indent(indent).Raw("\"colormap\": ").String(spec.colormap);
+    out->Raw(",\n").Indent(indent).Raw("\"width_px\": ").Int(spec.width_px);
+    out->Raw(",\n").Indent(indent).Raw("\"height_px\": ").Int(spec.height_px);
+    out->Raw(",\n").Indent(indent).Raw("\"gamma\": ").Number(spec.gamma);
+    out->Raw(",\n").Indent(indent).Raw("\"smoothing_bins\": ").Int(spec.smoothing_bins);
+    if (spec.smoothing_columns > 0) {
+      out->Raw(",\n").Indent(indent).Raw("\"smoothing_columns\": ").Int(spec.smoothing_columns);
+    }
+  }
+  out->Raw("\n");
+}
+
+void WriteFeatureExport(JsonBuffer* out, const aurora::core::FeatureExportArtifact& features, int indent) {
+  out->Indent(indent).Raw("\"format\": ").String(features.format);
+  if (!features.error.empty()) {
+    out->Raw(",\n").Indent(indent).Raw("\"error\": ").String(features.error).Raw("\n");
+    return;
+  }
+  out->Raw(",\n").Indent(indent).Raw("\"path\": ").String(features.path);
+  out->Raw(",\n").Indent(indent).Raw("\"frames\": ").Int(features.frames);
+  out->Raw(",\n").Indent(indent).Raw("\"hop\": ").Int(features.hop);
+  out->Raw(",\n").Indent(indent).Raw("\"fft_size\": ").Int(features.fft_size);
+  out->Raw(",\n").Indent(indent).Raw("\"columns\": [");
+  for (size_t i = 0; i < features.columns.size(); ++i) {
+    out->Raw(i == 0 ? "" : ", ").String(features.columns[i]);
+  }
+  out->Raw("]");
+  out->Raw(",\n").Indent(indent).Raw("\"loudness_path\": ").String(features.loudness_path);
+  out->Raw(",\n").Indent(indent).Raw("\"loudness_frames\": ").Int(features.loudness_frames);
+  out->Raw(",\n").Indent(indent).Raw("\"loudness_window\": ").Int(features.loudness_window);
+  out->Raw(",\n").Indent(indent).Raw("\"loudness_hop\": ").Int(features.loudness_hop);
+  out->Raw("\n");
 }
 
-void WriteFileAnalysis(std::ofstream& out, const aurora::core::FileAnalysis& item, int indent) {
-  const std::string pad(static_cast<size_t>(indent), ' ');
-  out << pad << "\"name\": \"" << EscapeJson(item.name) << "\",\n";
-  out << pad << "\"duration_seconds\": " << item.duration_seconds << ",\n";
-  out << pad << "\"rms\": " << item.rms_db << ",\n";
-  out << pad << "\"peak_db\": " << item.peak_db << ",\n";
-  out << pad << "\"loudness\": {\n";
-  out << pad << "  \"integrated_lufs\": " << item.loudness.integrated_lufs << ",\n";
-  out << pad << "  \"short_term_lufs\": " << item.loudness.short_term_lufs << ",\n";
-  out << pad << "  \"true_peak_db\": " << item.loudness.true_peak_dbtp << ",\n";
-  out << pad << "  \"rms_db\": " << item.loudness.rms_db << ",\n";
-  out << pad << "  \"crest_factor\": " << item.loudness.crest_factor_db << ",\n";
-  out << pad << "  \"lra\": " << item.loudness.lra << "\n";
-  out << pad << "},\n";
-  out << pad << "\"spectral_ratios\": {\n";
-  WriteSpectralRatios(out, item.spectral.ratios, indent + 2);
-  out << pad << "},\n";
-  out << pad << "\"spectral\": {\n";
-  out << pad << "  \"centroid_mean_hz\": " << item.spectral.centroid_mean_hz << ",\n";
-  out << pad << "  \"centroid_variance\": " << item.spectral.centroid_variance << ",\n";
-  out << pad << "  \"rolloff_85_hz\": " << item.spectral.rolloff_85_hz << ",\n";
-  out << pad << "  \"flatness\": " << item.spectral.flatness << "\n";
-  out << pad << "},\n";
-  out << pad << "\"transient\": {\n";
-  out << pad << "  \"transients_per_minute\": " << item.transient.transients_per_minute << ",\n";
-  out << pad << "  \"average_strength\": " << item.transient.average_strength << ",\n";
-  out << pad << "  \"variance\": " << item.transient.variance << ",\n";
-  out << pad << "  \"silence_percentage\": " << item.transient.silence_percentage << "\n";
-  out << pad << "},\n";
-  out << pad << "\"stereo\": {\n";
-  out << pad << "  \"available\": " << (item.stereo.available ? "true" : "false") << ",\n";
-  out << pad << "  \"mid_energy\": " << item.stereo.mid_energy << ",\n";
-  out << pad << "  \"side_energy\": " << item.stereo.side_energy << ",\n";
-  out << pad << "  \"mid_side_ratio\": " << item.stereo.mid_side_ratio << ",\n";
-  out << pad << "  \"correlation\": " << item.stereo.correlation << ",\n";
-  out << pad << "  \"low_frequency_correlation\": " << item.stereo.low_frequency_correlation << ",\n";
-  out << pad << "  \"high_band_side_ratio\": " << item.stereo.high_band_side_ratio << "\n";
-  out << pad << "},\n";
-  out << pad << "\"sub\": {\n";
-  out << pad << "  \"sub_rms_db\": " << item.sub.sub_rms_db << ",\n";
-  out << pad << "  \"sub_crest_factor\": " << item.sub.sub_crest_factor_db << ",\n";
-  out << pad << "  \"sub_to_total_ratio\": " << item.sub.sub_to_total_ratio << ",\n";
-  out << pad << "  \"low_to_sub_ratio\": " << item.sub.low_to_sub_ratio << ",\n";
-  out << pad << "  \"low_frequency_phase_coherence\": " << item.sub.low_frequency_phase_coherence << "\n";
-  out << pad << "},\n";
-  out << pad << "\"relative_loudness_lufs\": " << item.relative_loudness_lufs << ",\n";
-  out << pad << "\"energy_contribution_ratio\": " << item.energy_contribution_ratio << ",\n";
-  out << pad << "\"sub_contribution_ratio\": " << item.sub_contribution_ratio << ",\n";
-  out << pad << "\"frequency_dominance_profile\": \"" << EscapeJson(item.frequency_dominance_profile) << "\"";
+void WriteTimelineWindows(JsonBuffer* out, const std::vector<aurora::core::TimelineWindow>& windows, bool stereo,
+                          int indent) {
+  const int inner = indent + 2;
+  for (size_t i = 0; i < windows.size(); ++i) {
+    const aurora::core::TimelineWindow& window = windows[i];
+    out->Indent(indent).Raw("{\n");
+    if (!window.section.empty()) {
+      out->Indent(inner).Raw("\"section\": ").String(window.section).Raw(",\n");
+    }
+    out->Indent(inner).Raw("\"start_seconds\": ").Number(window.start_seconds).Raw(",\n");
+    out->Indent(inner).Raw("\"end_seconds\": ").Number(window.end_seconds).Raw(",\n");
+    out->Indent(inner).Raw("\"integrated_lufs\": ").Number(window.integrated_lufs).Raw(",\n");
+    out->Indent(inner).Raw("\"short_term_max_lufs\": ").Number(window.short_term_max_lufs).Raw(",\n");
+    out->Indent(inner).Raw("\"spectral_ratios\": {\n");
+    WriteSpectralRatios(out, window.ratios, inner + 2);
+    out->Indent(inner).Raw("},\n");
+    out->Indent(inner).Raw("\"centroid_hz\": ").Number(window.centroid_hz).Raw(",\n");
+    if (stereo) {
+      out->Indent(inner).Raw("\"correlation\": ").Number(window.correlation).Raw(",\n");
+    }
+    out->Indent(inner).Raw("\"transients_per_minute\": ").Number(window.transients_per_minute).Raw("\n");
+    out->Indent(indent).Raw(i + 1 < windows.size() ? "},\n" : "}\n");
+  }
+}
+
+void WriteTimeline(JsonBuffer* out, const aurora::core::AnalysisTimeline& timeline, bool stereo, int indent) {
+  out->Indent(indent).Raw("\"window_seconds\": ").Number(timeline.window_seconds).Raw(",\n");
+  out->Indent(indent).Raw("\"windows\": [\n");
+  WriteTimelineWindows(out, timeline.windows, stereo, indent + 2);
+  out->Indent(indent).Raw("],\n");
+  out->Indent(indent).Raw("\"sections\": [\n");
+  WriteTimelineWindows(out, timeline.sections, stereo, indent + 2);
+  out->Indent(indent).Raw("]\n");
+}
+
+void WriteFileAnalysis(JsonBuffer* out, const aurora::core::FileAnalysis& item, int indent) {
+  const int inner = indent + 2;
+  out->Indent(indent).Raw("\"name\": ").String(item.name).Raw(",\n");
+  out->Indent(indent).Raw("\"duration_seconds\": ").Number(item.duration_seconds).Raw(",\n");
+  out->Indent(indent).Raw("\"rms\": ").Number(item.rms_db).Raw(",\n");
+  out->Indent(indent).Raw("\"peak_db\": ").Number(item.peak_db).Raw(",\n");
+  out->Indent(indent).Raw("\"loudness\": {\n");
+  out->Indent(inner).Raw("\"integrated_lufs\": ").Number(item.loudness.integrated_lufs).Raw(",\n");
+  out->Indent(inner).Raw("\"short_term_lufs\": ").Number(item.loudness.short_term_lufs).Raw(",\n");
+  out->Indent(inner).Raw("\"momentary_max_lufs\": ").Number(item.loudness.momentary_max_lufs).Raw(",\n");
+  out->Indent(inner).Raw("\"short_term_max_lufs\": ").Number(item.loudness.short_term_max_lufs).Raw(",\n");
+  out->Indent(inner).Raw("\"true_peak_db\": ").Number(item.loudness.true_peak_dbtp).Raw(",\n");
+  out->Indent(inner).Raw("\"rms_db\": ").Number(item.loudness.rms_db).Raw(",\n");
+  out->Indent(inner).Raw("\"crest_factor\": ").Number(item.loudness.crest_factor_db).Raw(",\n");
+  out->Indent(inner).Raw("\"lra\": ").Number(item.loudness.lra).Raw("\n");
+  out->Indent(indent).Raw("},\n");
+  out->Indent(indent).Raw("\"spectral_ratios\": {\n");
+  WriteSpectralRatios(out, item.spectral.ratios, inner);
+  out->Indent(indent).Raw("},\n");
+  out->Indent(indent).Raw("\"spectral\": {\n");
+  out->Indent(inner).Raw("\"centroid_mean_hz\": ").Number(item.spectral.centroid_mean_hz).Raw(",\n");
+  out->Indent(inner).Raw("\"centroid_variance\": ").Number(item.spectral.centroid_variance).Raw(",\n");
+  out->Indent(inner).Raw("\"rolloff_85_hz\": ").Number(item.spectral.rolloff_85_hz).Raw(",\n");
+  out->Indent(inner).Raw("\"flatness\": ").Number(item.spectral.flatness).Raw("\n");
+  out->Indent(indent).Raw("},\n");
+  out->Indent(indent).Raw("\"transient\": {\n");
+  out->Indent(inner).Raw("\"transients_per_minute\": ").Number(item.transient.transients_per_minute).Raw(",\n");
+  out->Indent(inner).Raw("\"average_strength\": ").Number(item.transient.average_strength).Raw(",\n");
+  out->Indent(inner).Raw("\"variance\": ").Number(item.transient.variance).Raw(",\n");
+  out->Indent(inner).Raw("\"silence_percentage\": ").Number(item.transient.silence_percentage).Raw("\n");
+  out->Indent(indent).Raw("},\n");
+  out->Indent(indent).Raw("\"stereo\": {\n");
+  out->Indent(inner).Raw("\"available\": ").Bool(item.stereo.available).Raw(",\n");
+  out->Indent(inner).Raw("\"mid_energy\": ").Number(item.stereo.mid_energy).Raw(",\n");
+  out->Indent(inner).Raw("\"side_energy\": ").Number(item.stereo.side_energy).Raw(",\n");
+  out->Indent(inner).Raw("\"mid_side_ratio\": ").Number(item.stereo.mid_side_ratio).Raw(",\n");
+  out->Indent(inner).Raw("\"correlation\": ").Number(item.stereo.correlation).Raw(",\n");
+  out->Indent(inner).Raw("\"low_frequency_correlation\": ").Number(item.stereo.low_frequency_correlation).Raw(",\n");
+  out->Indent(inner).Raw("\"high_band_side_ratio\": ").Number(item.stereo.high_band_side_ratio).Raw("\n");
+  out->Indent(indent).Raw("},\n");
+  out->Indent(indent).Raw("\"sub\": {\n");
+  out->Indent(inner).Raw("\"sub_rms_db\": ").Number(item.sub.sub_rms_db).Raw(",\n");
+  out->Indent(inner).Raw("\"sub_crest_factor\": ").Number(item.sub.sub_crest_factor_db).Raw(",\n");
+  out->Indent(inner).Raw("\"sub_to_total_ratio\": ").Number(item.sub.sub_to_total_ratio).Raw(",\n");
+  out->Indent(inner).Raw("\"low_to_sub_ratio\": ").Number(item.sub.low_to_sub_ratio).Raw(",\n");
+  out->Indent(inner)
+      .Raw("\"low_frequency_phase_coherence\": ")
+      .Number(item.sub.low_frequency_phase_coherence)
+      .Raw("\n");
+  out->Indent(indent).Raw("},\n");
+  out->Indent(indent).Raw("\"relative_loudness_lufs\": ").Number(item.relative_loudness_lufs).Raw(",\n");
+  out->Indent(indent).Raw("\"energy_contribution_ratio\": ").Number(item.energy_contribution_ratio).Raw(",\n");
+  out->Indent(indent).Raw("\"sub_contribution_ratio\": ").Number(item.sub_contribution_ratio).Raw(",\n");
+  out->Indent(indent).Raw("\"frequency_dominance_profile\": ").String(item.frequency_dominance_profile);
   if (item.spectrogram.present) {
-    out << ",\n";
-    out << pad << "\"spectrogram\": {\n";
-    WriteSpectrogram(out, item.spectrogram, indent + 2);
-    out << pad << "}\n";
-  } else {
-    out << "\n";
+    out->Raw(",\n");
+    out->Indent(indent).Raw("\"spectrogram\": {\n");
+    WriteSpectrogram(out, item.spectrogram, inner);
+    out->Indent(indent).Raw("}");
+  }
+  if (item.features.present) {
+    out->Raw(",\n");
+    out->Indent(indent).Raw("\"features\": {\n");
+    WriteFeatureExport(out, item.features, inner);
+    out->Indent(indent).Raw("}");
+  }
+  if (item.timeline.present) {
+    out->Raw(",\n");
+    out->Indent(indent).Raw("\"timeline\": {\n");
+    WriteTimeline(out, item.timeline, item.stereo.available, inner);
+    out->Indent(indent).Raw("}");
   }
+  out->Raw("\n");
 }
 
-void WriteCompositeSpectrogram(std::ofstream& out, const aurora::core::CompositeSpectrogramReport& composite, int indent) {
-  const std::string pad(static_cast<size_t>(indent), ' ');
-  out << pad << "\"enabled\": " << (composite.enabled ? "true" : "false") << ",\n";
-  out << pad << "\"mode\": \"" << EscapeJson(composite.mode) << "\",\n";
-  out << pad << "\"profile\": \"" << EscapeJson(composite.profile) << "\",\n";
+void WriteMaskingPeak(JsonBuffer* out, const aurora::core::MaskingPeak& peak) {
+  out->Raw("{\"start_seconds\": ").Number(peak.start_seconds);
+  out->Raw(", \"band\": ").String(peak.band);
+  out->Raw(", \"value\": ").Number(peak.value).Raw("}");
+}
+
+void WriteMasking(JsonBuffer* out, const aurora::core::MaskingReport& masking, int indent) {
+  const int inner = indent + 2;
+  out->Indent(indent).Raw("\"window_seconds\": ").Number(masking.window_seconds).Raw(",\n");
+  out->Indent(indent).Raw("\"fft_size\": ").Int(masking.fft_size).Raw(",\n");
+  out->Indent(indent).Raw("\"hop\": ").Int(masking.hop).Raw(",\n");
+  out->Indent(indent).Raw("\"windows\": ").UInt(masking.windows).Raw(",\n");
+  if (!masking.error.empty()) {
+    out->Indent(indent).Raw("\"error\": ").String(masking.error).Raw(",\n");
+  }
+  if (!masking.overlap_path.empty()) {
+    out->Indent(indent).Raw("\"overlap_path\": ").String(masking.overlap_path).Raw(",\n");
+    out->Indent(indent).Raw("\"cancellation_path\": ").String(masking.cancellation_path).Raw(",\n");
+  }
+  out->Indent(indent).Raw("\"mix_summing_db\": {\n");
+  WriteSpectralRatios(out, masking.mix_summing_db, inner);
+  out->Indent(indent).Raw("},\n");
+  out->Indent(indent).Raw("\"pairs\": [\n");
+  for (size_t i = 0; i < masking.pairs.size(); ++i) {
+    const aurora::core::MaskingPair& pair = masking.pairs[i];
+    out->Indent(inner).Raw("{\n");
+    out->Indent(inner + 2).Raw("\"a\": ").String(pair.a).Raw(",\n");
+    out->Indent(inner + 2).Raw("\"b\": ").String(pair.b).Raw(",\n");
+    out->Indent(inner + 2).Raw("\"with_mix\": ").Bool(pair.with_mix).Raw(",\n");
+    out->Indent(inner + 2).Raw("\"overlap\": {\n");
+    WriteSpectralRatios(out, pair.overlap, inner + 4);
+    out->Indent(inner + 2).Raw("},\n");
+    out->Indent(inner + 2).Raw("\"cancellation_db\": {\n");
+    WriteSpectralRatios(out, pair.cancellation_db, inner + 4);
+    out->Indent(inner + 2).Raw("},\n");
+    out->Indent(inner + 2).Raw("\"peak_overlap\": ");
+    WriteMaskingPeak(out, pair.peak_overlap);
+    out->Raw(",\n");
+    out->Indent(inner + 2).Raw("\"peak_cancellation\": ");
+    WriteMaskingPeak(out, pair.peak_cancellation);
+    out->Raw("\n");
+    out->Indent(inner).Raw(i + 1 < masking.pairs.size() ? "},\n" : "}\n");
+  }
+  out->Indent(indent).Raw("]\n");
+}
+
+void WriteCompositeSpectrogram(JsonBuffer* out, const aurora::core::CompositeSpectrogramReport& composite, int indent) {
+  out->Indent(indent).Raw("\"enabled\": ").Bool(composite.enabled).Raw(",\n");
+  out->Indent(indent).Raw("\"mode\": ").String(composite.mode).Raw(",\n");
+  out->Indent(indent).Raw("\"profile\": ").String(composite.profile).Raw(",\n");
   if (!composite.path.empty()) {
-    out << pad << "\"path\": \"" << EscapeJson(composite.path) << "\",\n";
+    out->Indent(indent).Raw("\"path\": ").String(composite.path).Raw(",\n");
   }
-  out << pad << "\"targets\": [\n";
+  out->Indent(indent).Raw("\"targets\": [\n");
   for (size_t i = 0; i < composite.targets.size(); ++i) {
-    out << pad << "  {\"kind\":\"" << EscapeJson(composite.targets[i].kind) << "\",\"name\":\""
-        << EscapeJson(composite.targets[i].name) << "\"}";
+    out->Indent(indent + 2).Raw("{\"kind\":").String(composite.targets[i].kind);
+    out->Raw(",\"name\":").String(composite.targets[i].name).Raw("}");
     if (i + 1 < composite.targets.size()) {
-      out << ",";
+      out->Raw(",");
     }
-    out << "\n";
-  }
-  out << pad << "],\n";
-  out << pad << "\"row_height_px\": " << composite.row_height_px << ",\n";
-  out << pad << "\"header_height_px\": " << composite.header_height_px << ",\n";
-  out << pad << "\"width_px\": " << composite.width_px << ",\n";
-  out << pad << "\"format\": \"" << EscapeJson(composite.format) << "\",\n";
-  out << pad << "\"indexed_palette\": " << (composite.indexed_palette ? "true" : "false") << ",\n";
-  out << pad << "\"freq_scale\": \"" << EscapeJson(composite.freq_scale) << "\",\n";
-  out << pad << "\"colormap\": \"" << EscapeJson(composite.colormap) << "\",\n";
+    out->Raw("\n");
+  }
+  out->Indent(indent).Raw("],\n");
+  out->Indent(indent).Raw("\"row_height_px\": ").Int(composite.row_height_px).Raw(",\n");
+  out->Indent(indent).Raw("\"header_height_px\": ").Int(composite.header_height_px).Raw(",\n");
+  out->Indent(indent).Raw("\"width_px\": ").Int(composite.width_px).Raw(",\n");
+  out->Indent(indent).Raw("\"format\": ").String(composite.format).Raw(",\n");
+  out->Indent(indent).Raw("\"indexed_palette\": ").Bool(composite.indexed_palette).Raw(",\n");
+  out->Indent(indent).Raw("\"freq_scale\": ").String(composite.freq_scale).Raw(",\n");
+  out->Indent(indent).Raw("\"colormap\": ").String(composite.colormap).Raw(",\n");
   if (composite.error.empty()) {
-    out << pad << "\"error\": null\n";
+    out->Indent(indent).Raw("\"error\": null\n");
   } else {
-    out << pad << "\"error\": \"" << EscapeJson(composite.error) << "\"\n";
+    out->Indent(indent).Raw("\"error\": ").String(composite.error).Raw("\n");
   }
 }
 
@@ -191,46 +287,52 @@ bool WriteAnalysisJson(const std::filesystem::path& path, const aurora::core::An
     return false;
   }
 
-  out << std::setprecision(9);
-  out << "{\n";
-  out << "  \"aurora_version\": \"" << EscapeJson(report.aurora_version) << "\",\n";
-  out << "  \"analysis_version\": \"" << EscapeJson(report.analysis_version) << "\",\n";
-  out << "  \"timestamp\": \"" << EscapeJson(report.timestamp) << "\",\n";
-  out << "  \"sample_rate\": " << report.sample_rate << ",\n";
-  out << "  \"mode\": \"" << EscapeJson(report.mode) << "\",\n";
-  out << "  \"mix\": {\n";
-  WriteFileAnalysis(out, report.mix, 4);
-  out << "  },\n";
-  out << "  \"stems\": [\n";
+  JsonBuffer json;
+  json.Raw("{\n");
+  json.Raw("  \"aurora_version\": ").String(report.aurora_version).Raw(",\n");
+  json.Raw("  \"analysis_version\": ").String(report.analysis_version).Raw(",\n");
+  json.Raw("  \"timestamp\": ").String(report.timestamp).Raw(",\n");
+  json.Raw("  \"sample_rate\": ").Int(report.sample_rate).Raw(",\n");
+  json.Raw("  \"mode\": ").String(report.mode).Raw(",\n");
+  json.Raw("  \"mix\": {\n");
+  WriteFileAnalysis(&json, report.mix, 4);
+  json.Raw("  },\n");
+  json.Raw("  \"stems\": [\n");
   for (size_t i = 0; i < report.stems.size(); ++i) {
-    out << "    {\n";
-    WriteFileAnalysis(out, report.stems[i], 6);
-    out << "    }";
+    json.Raw("    {\n");
+    WriteFileAnalysis(&json, report.stems[i], 6);
+    json.Raw("    }");
     if (i + 1 < report.stems.size()) {
-      out << ",";
+      json.Raw(",");
     }
-    out << "\n";
+    json.Raw("\n");
   }
-  out << "  ],\n";
+  json.Raw("  ],\n");
   if (report.composite_spectrogram.present) {
-    out << "  \"composite_spectrogram\": {\n";
-    WriteCompositeSpectrogram(out, report.composite_spectrogram, 4);
-    out << "  },\n";
+    json.Raw("  \"composite_spectrogram\": {\n");
+    WriteCompositeSpectrogram(&json, report.composite_spectrogram, 4);
+    json.Raw("  },\n");
+  }
+  if (report.masking.present) {
+    json.Raw("  \"masking\": {\n");
+    WriteMasking(&json, report.masking, 4);
+    json.Raw("  },\n");
   }
-  out << "  \"intent_evaluation\": {\n";
-  out << "    \"status\": \"" << EscapeJson(report.intent_evaluation.status) << "\",\n";
-  out << "    \"notes\": [\n";
+  json.Raw("  \"intent_evaluation\": {\n");
+  json.Raw("    \"status\": ").String(report.intent_evaluation.status).Raw(",\n");
+  json.Raw("    \"notes\": [\n");
   for (size_t i = 0; i < report.intent_evaluation.notes.size(); ++i) {
-    out << "      \"" << EscapeJson(report.intent_evaluation.notes[i]) << "\"";
+    json.Raw("      ").String(report.intent_evaluation.notes[i]);
     if (i + 1 < report.intent_evaluation.notes.size()) {
-      out << ",";
+      json.Raw(",");
     }
-    out << "\n";
+    json.Raw("\n");
   }
-  out << "    ]\n";
-  out << "  }\n";
-  out << "}\n";
+  json.Raw("    ]\n");
+  json.Raw("  }\n");
+  json.Raw("}\n");
 
+  out.write(json.str().data(), static_cast<std::streamsize>(json.str().size()));
   if (!out.good()) {
     if (error != nullptr) {
       *error = "Failed while writing analysis JSON: " + path.string();
@@ -240,4 +342,63 @@ bool WriteAnalysisJson(const std::filesystem::path& path, const aurora::core::An
   return true;
 }
 
+bool WriteSpectrogramTileManifest(const std::filesystem::path& path, const std::string& target, int sample_rate,
+                                  const aurora::core::SpectrogramConfig& config,
+                                  const aurora::core::SpectrogramTileConfig& tiles,
+                                  const aurora::core::SpectrogramPyramid& pyramid, std::string* error) {
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream out(path);
+  if (!out.is_open()) {
+    if (error != nullptr) {
+      *error = "Failed to open tile manifest for writing: " + path.string();
+    }
+    return false;
+  }
+
+  JsonBuffer json;
+  json.Raw("{\n");
+  json.Raw("  \"format\": ").String("aurora-spectrogram-tiles").Raw(",\n");
+  json.Raw("  \"version\": ").Int(1).Raw(",\n");
+  json.Raw("  \"target\": ").String(target).Raw(",\n");
+  json.Raw("  \"tile_path\": ").String("{level}/{index}.png").Raw(",\n");
+  json.Raw("  \"tile_width_px\": ").Int(pyramid.tile_width_px).Raw(",\n");
+  json.Raw("  \"tile_height_px\": ").Int(pyramid.tile_height_px).Raw(",\n");
+  json.Raw("  \"pooling\": ").String(tiles.pooling).Raw(",\n");
+  json.Raw("  \"sr\": ").Int(sample_rate).Raw(",\n");
+  json.Raw("  \"window\": ").Int(config.window).Raw(",\n");
+  json.Raw("  \"hop\": ").Int(config.hop).Raw(",\n");
+  json.Raw("  \"nfft\": ").Int(config.nfft).Raw(",\n");
+  json.Raw("  \"frame_count\": ").UInt(pyramid.frame_count).Raw(",\n");
+  json.Raw("  \"freq_scale\": ").String(config.freq_scale).Raw(",\n");
+  json.Raw("  \"min_hz\": ").Number(config.min_hz).Raw(",\n");
+  json.Raw("  \"max_hz\": ").Number(config.max_hz).Raw(",\n");
+  json.Raw("  \"db_min\": ").Number(config.db_min).Raw(",\n");
+  json.Raw("  \"db_max\": ").Number(config.db_max).Raw(",\n");
+  json.Raw("  \"gamma\": ").Number(config.gamma).Raw(",\n");
+  json.Raw("  \"colormap\": ").String(config.colormap).Raw(",\n");
+  json.Raw("  \"levels\": [\n");
+  for (size_t z = 0; z < pyramid.levels.size(); ++z) {
+    const aurora::core::SpectrogramPyramidLevel& level = pyramid.levels[z];
+    const double seconds_per_column =
+        static_cast<double>(level.frames_per_column) * static_cast<double>(config.hop) / static_cast<double>(sample_rate);
+    json.Raw("    {\"level\": ").UInt(z);
+    json.Raw(", \"columns\": ").UInt(level.columns);
+    json.Raw(", \"tiles\": ").UInt(level.tiles);
+    json.Raw(", \"frames_per_column\": ").UInt(level.frames_per_column);
+    json.Raw(", \"seconds_per_column\": ").Number(seconds_per_column).Raw("}");
+    json.Raw(z + 1 < pyramid.levels.size() ? ",\n" : "\n");
+  }
+  json.Raw("  ]\n");
+  json.Raw("}\n");
+
+  out.write(json.str().data(), static_cast<std::streamsize>(json.str().size()));
+  if (!out.good()) {
+    if (error != nullptr) {
+      *error = "Failed while writing tile manifest: " + path.string();
+    }
+    return false;
+  }
+  return true;
+}
+
 }  // namespace aurora::io
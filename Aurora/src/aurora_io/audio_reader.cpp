@@ -7,6 +7,8 @@
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -34,6 +36,50 @@ bool HasAudioExtension(const std::filesystem::path& path, const std::string& ext
   return e == ext;
 }
 
+bool CheckWavSampleFormat(uint16_t audio_format, uint16_t bits_per_sample, std::string* error) {
+  if (audio_format == 1) {
+    if (bits_per_sample == 16 || bits_per_sample == 24 || bits_per_sample == 32) {
+      return true;
+    }
+    if (error != nullptr) {
+      *error = "Unsupported PCM bit depth in WAV: " + std::to_string(bits_per_sample);
+    }
+    return false;
+  }
+  if (audio_format == 3) {
+    if (bits_per_sample == 32) {
+      return true;
+    }
+    if (error != nullptr) {
+      *error = "Unsupported float WAV bit depth: " + std::to_string(bits_per_sample);
+    }
+    return false;
+  }
+  if (error != nullptr) {
+    *error = "Unsupported WAV format code: " + std::to_string(audio_format);
+  }
+  return false;
+}
+
+// Decodes one sample of a format accepted by CheckWavSampleFormat.
+float DecodeWavSample(const uint8_t* p, uint16_t audio_format, uint16_t bits_per_sample) {
+  if (audio_format == 3) {
+    float s = 0.0F;
+    std::memcpy(&s, p, sizeof(float));
+    return s;
+  }
+  if (bits_per_sample == 16) {
+    const int16_t s = static_cast<int16_t>(ReadU16Le(p));
+    return static_cast<float>(static_cast<double>(s) / 32768.0);
+  }
+  if (bits_per_sample == 24) {
+    const int32_t s = ReadS24Le(p);
+    return static_cast<float>(static_cast<double>(s) / 8388608.0);
+  }
+  const int32_t s = static_cast<int32_t>(ReadU32Le(p));
+  return static_cast<float>(static_cast<double>(s) / 2147483648.0);
+}
+
 bool ReadWavPcmOrFloat(const std::filesystem::path& path, aurora::core::AudioStem* stem, int* sample_rate, std::string* error) {
   std::ifstream in(path, std::ios::binary);
   if (!in.is_open()) {
@@ -115,49 +161,27 @@ bool ReadWavPcmOrFloat(const std::filesystem::path& path, aurora::core::AudioSte
   }
 
   const size_t sample_count = static_cast<size_t>(data_size / bytes_per_sample);
+  if (sample_count > 0 && !CheckWavSampleFormat(audio_format, bits_per_sample, error)) {
+    return false;
+  }
   stem->samples.assign(sample_count, 0.0F);
   stem->channels = static_cast<int>(channels);
   stem->name = path.stem().string();
   *sample_rate = static_cast<int>(sr);
 
+  // Stem statistics are gathered while decoding so the analyzer does not rescan the buffer.
+  aurora::core::AudioStemStatsAccumulator stats;
   for (size_t i = 0; i < sample_count; ++i) {
-    const uint8_t* p = data_ptr + i * bytes_per_sample;
-    float value = 0.0F;
-    if (audio_format == 1) {
-      if (bits_per_sample == 16) {
-        const int16_t s = static_cast<int16_t>(ReadU16Le(p));
-        value = static_cast<float>(static_cast<double>(s) / 32768.0);
-      } else if (bits_per_sample == 24) {
-        const int32_t s = ReadS24Le(p);
-        value = static_cast<float>(static_cast<double>(s) / 8388608.0);
-      } else if (bits_per_sample == 32) {
-        const int32_t s = static_cast<int32_t>(ReadU32Le(p));
-        value = static_cast<float>(static_cast<double>(s) / 2147483648.0);
-      } else {
-        if (error != nullptr) {
-          *error = "Unsupported PCM bit depth in WAV: " + std::to_string(bits_per_sample);
-        }
-        return false;
-      }
-    } else if (audio_format == 3) {
-      if (bits_per_sample != 32) {
-        if (error != nullptr) {
-          *error = "Unsupported float WAV bit depth: " + std::to_string(bits_per_sample);
-        }
-        return false;
-      }
-      float s = 0.0F;
-      std::memcpy(&s, p, sizeof(float));
-      value = s;
-    } else {
-      if (error != nullptr) {
-        *error = "Unsupported WAV format code: " + std::to_string(audio_format);
-      }
-      return false;
-    }
+    const float value = DecodeWavSample(data_ptr + i * bytes_per_sample, audio_format, bits_per_sample);
     stem->samples[i] = value;
+    if (channels == 1) {
+      stats.AddMono(value);
+    } else if ((i & 1U) != 0U) {
+      stats.AddStereo(stem->samples[i - 1U], value);
+    }
   }
 
+  stem->stats = stats.Finish();
   return true;
 }
 
@@ -174,12 +198,11 @@ std::string EscapeSingleQuotes(const std::string& value) {
   return out;
 }
 
-bool ReadFlacViaFfmpeg(const std::filesystem::path& path, aurora::core::AudioStem* stem, int* sample_rate, std::string* error) {
-  const std::filesystem::path tmp_wav = std::filesystem::temp_directory_path() /
-                                        ("aurora_flac_decode_" + std::to_string(std::rand()) + ".wav");
+bool DecodeViaFfmpeg(const std::filesystem::path& path, std::filesystem::path* tmp_wav, std::string* error) {
+  *tmp_wav = std::filesystem::temp_directory_path() / ("aurora_flac_decode_" + std::to_string(std::rand()) + ".wav");
 
   const std::string input_escaped = EscapeSingleQuotes(path.string());
-  const std::string tmp_escaped = EscapeSingleQuotes(tmp_wav.string());
+  const std::string tmp_escaped = EscapeSingleQuotes(tmp_wav->string());
   const std::string command =
       "ffmpeg -v error -y -i '" + input_escaped + "' -f wav '" + tmp_escaped + "' >/dev/null 2>&1";
   const int code = std::system(command.c_str());
@@ -189,6 +212,19 @@ bool ReadFlacViaFfmpeg(const std::filesystem::path& path, aurora::core::AudioSte
     }
     return false;
   }
+  return true;
+}
+
+bool IsFfmpegDecodedExtension(const std::filesystem::path& path) {
+  return HasAudioExtension(path, ".flac") || HasAudioExtension(path, ".mp3") || HasAudioExtension(path, ".aiff") ||
+         HasAudioExtension(path, ".aif");
+}
+
+bool ReadFlacViaFfmpeg(const std::filesystem::path& path, aurora::core::AudioStem* stem, int* sample_rate, std::string* error) {
+  std::filesystem::path tmp_wav;
+  if (!DecodeViaFfmpeg(path, &tmp_wav, error)) {
+    return false;
+  }
 
   std::string wav_error;
   const bool ok = ReadWavPcmOrFloat(tmp_wav, stem, sample_rate, &wav_error);
@@ -218,8 +254,7 @@ bool ReadAudioFile(const std::filesystem::path& path, aurora::core::AudioStem* s
     return ReadWavPcmOrFloat(path, stem, sample_rate, error);
   }
 
-  if (HasAudioExtension(path, ".flac") || HasAudioExtension(path, ".mp3") || HasAudioExtension(path, ".aiff") ||
-      HasAudioExtension(path, ".aif")) {
+  if (IsFfmpegDecodedExtension(path)) {
     return ReadFlacViaFfmpeg(path, stem, sample_rate, error);
   }
 
@@ -229,4 +264,160 @@ bool ReadAudioFile(const std::filesystem::path& path, aurora::core::AudioStem* s
   return false;
 }
 
+struct AudioStreamReader::State {
+  std::mutex mutex;
+  std::ifstream in;
+  std::string name;
+  std::filesystem::path temp_wav;
+  uint64_t data_offset = 0;
+  uint16_t audio_format = 0;
+  uint16_t bits_per_sample = 0;
+  uint32_t bytes_per_frame = 0;
+  int sample_rate = 0;
+  int channels = 0;
+  size_t frame_count = 0;
+
+  ~State() {
+    if (!temp_wav.empty()) {
+      in.close();
+      std::error_code ec;
+      std::filesystem::remove(temp_wav, ec);
+    }
+  }
+};
+
+AudioStreamReader::AudioStreamReader() = default;
+AudioStreamReader::~AudioStreamReader() = default;
+
+bool AudioStreamReader::Open(const std::filesystem::path& path, std::string* error) {
+  state_ = std::make_unique<State>();
+  State& st = *state_;
+  st.name = path.stem().string();
+  std::filesystem::path wav_path = path;
+  if (IsFfmpegDecodedExtension(path)) {
+    if (!DecodeViaFfmpeg(path, &st.temp_wav, error)) {
+      state_.reset();
+      return false;
+    }
+    wav_path = st.temp_wav;
+  } else if (!HasAudioExtension(path, ".wav")) {
+    if (error != nullptr) {
+      *error = "Unsupported audio file extension: " + path.string();
+    }
+    state_.reset();
+    return false;
+  }
+
+  const auto fail = [&](const std::string& message) {
+    if (error != nullptr) {
+      *error = message;
+    }
+    state_.reset();
+    return false;
+  };
+  st.in.open(wav_path, std::ios::binary);
+  if (!st.in.is_open()) {
+    return fail("Failed to open WAV file: " + path.string());
+  }
+  std::error_code size_ec;
+  const uint64_t file_size = std::filesystem::file_size(wav_path, size_ec);
+  uint8_t header[16] = {};
+  if (size_ec || file_size < 44 || !st.in.read(reinterpret_cast<char*>(header), 12)) {
+    return fail("WAV file too small: " + path.string());
+  }
+  if (std::memcmp(header, "RIFF", 4) != 0 || std::memcmp(header + 8, "WAVE", 4) != 0) {
+    return fail("Not a RIFF/WAVE file: " + path.string());
+  }
+
+  // Walk the chunk list by header only; the data chunk is located but not read.
+  uint16_t channels = 0;
+  uint32_t sr = 0;
+  uint64_t data_size = 0;
+  bool have_data = false;
+  uint64_t cursor = 12;
+  while (cursor + 8 <= file_size) {
+    st.in.seekg(static_cast<std::streamoff>(cursor));
+    uint8_t chunk_header[8] = {};
+    if (!st.in.read(reinterpret_cast<char*>(chunk_header), 8)) {
+      break;
+    }
+    const uint32_t chunk_size = ReadU32Le(chunk_header + 4);
+    const uint64_t chunk_data = cursor + 8;
+    if (chunk_data + chunk_size > file_size) {
+      break;
+    }
+    if (std::memcmp(chunk_header, "fmt ", 4) == 0 && chunk_size >= 16) {
+      if (!st.in.read(reinterpret_cast<char*>(header), 16)) {
+        break;
+      }
+      st.audio_format = ReadU16Le(header);
+      channels = ReadU16Le(header + 2);
+      sr = ReadU32Le(header + 4);
+      st.bits_per_sample = ReadU16Le(header + 14);
+    } else if (std::memcmp(chunk_header, "data", 4) == 0) {
+      st.data_offset = chunk_data;
+      data_size = chunk_size;
+      have_data = true;
+    }
+    cursor = chunk_data + chunk_size + (chunk_size % 2U);
+  }
+  st.in.clear();
+
+  if (!have_data || channels == 0 || sr == 0 || st.bits_per_sample == 0) {
+    return fail("Malformed WAV file: missing required chunks in " + path.string());
+  }
+  if (channels > 2) {
+    return fail("Only mono/stereo WAV files are supported: " + path.string());
+  }
+  const uint32_t bytes_per_sample = st.bits_per_sample / 8U;
+  if (bytes_per_sample == 0) {
+    return fail("Unsupported WAV bit depth in " + path.string());
+  }
+  st.bytes_per_frame = bytes_per_sample * channels;
+  if ((data_size % st.bytes_per_frame) != 0U) {
+    return fail("WAV data is not frame-aligned: " + path.string());
+  }
+  std::string format_error;
+  if (data_size > 0 && !CheckWavSampleFormat(st.audio_format, st.bits_per_sample, &format_error)) {
+    return fail(format_error);
+  }
+  st.channels = static_cast<int>(channels);
+  st.sample_rate = static_cast<int>(sr);
+  st.frame_count = static_cast<size_t>(data_size / st.bytes_per_frame);
+  return true;
+}
+
+bool AudioStreamReader::ReadFrames(size_t first_frame, size_t frame_count, float* out, std::string* error) {
+  if (!state_ || out == nullptr || first_frame + frame_count > state_->frame_count) {
+    if (error != nullptr) {
+      *error = "Audio read outside the stream.";
+    }
+    return false;
+  }
+  State& st = *state_;
+  const size_t bytes_per_sample = st.bits_per_sample / 8U;
+  std::vector<uint8_t> raw(frame_count * st.bytes_per_frame);
+  {
+    std::lock_guard<std::mutex> lock(st.mutex);
+    st.in.seekg(static_cast<std::streamoff>(st.data_offset + first_frame * st.bytes_per_frame));
+    if (!st.in.read(reinterpret_cast<char*>(raw.data()), static_cast<std::streamsize>(raw.size()))) {
+      st.in.clear();
+      if (error != nullptr) {
+        *error = "Failed to read audio data from '" + st.name + "'.";
+      }
+      return false;
+    }
+  }
+  const size_t samples = frame_count * static_cast<size_t>(st.channels);
+  for (size_t i = 0; i < samples; ++i) {
+    out[i] = DecodeWavSample(raw.data() + i * bytes_per_sample, st.audio_format, st.bits_per_sample);
+  }
+  return true;
+}
+
+const std::string& AudioStreamReader::name() const { return state_->name; }
+int AudioStreamReader::sample_rate() const { return state_ ? state_->sample_rate : 0; }
+int AudioStreamReader::channels() const { return state_ ? state_->channels : 0; }
+size_t AudioStreamReader::frame_count() const { return state_ ? state_->frame_count : 0U; }
+
 }  // namespace aurora::io
@@ -0,0 +1,84 @@
+#include "aurora/io/json_buffer.hpp"
+
+#include <charconv>
+#include <cstdio>
+
+namespace aurora::io {
+
+JsonBuffer& JsonBuffer::Raw(std::string_view text) {
+  text_.append(text);
+  return *this;
+}
+
+JsonBuffer& JsonBuffer::Indent(int spaces) {
+  if (spaces > 0) {
+    text_.append(static_cast<size_t>(spaces), ' ');
+  }
+  return *this;
+}
+
+JsonBuffer& JsonBuffer::String(std::string_view text) {
+  text_.push_back('"');
+  size_t run_start = 0;
+  for (size_t i = 0; i < text.size(); ++i) {
+    const char* escaped = nullptr;
+    switch (text[i]) {
+      case '"':
+        escaped = "\\\"";
+        break;
+      case '\\':
+        escaped = "\\\\";
+        break;
+      case '\n':
+        escaped = "\\n";
+        break;
+      case '\r':
+        escaped = "\\r";
+        break;
+      case '\t':
+        escaped = "\\t";
+        break;
+      default:
+        break;
+    }
+    if (escaped != nullptr) {
+      text_.append(text.substr(run_start, i - run_start));
+      text_.append(escaped);
+      run_start = i + 1U;
+    }
+  }
+  text_.append(text.substr(run_start));
+  text_.push_back('"');
+  return *this;
+}
+
+JsonBuffer& JsonBuffer::Number(double value) {
+  // "%.9g" is what `std::ostream << std::setprecision(9)` produces for doubles in the default float field.
+  char buf[32];
+  const int len = std::snprintf(buf, sizeof(buf), "%.9g", value);
+  if (len > 0) {
+    text_.append(buf, static_cast<size_t>(len));
+  }
+  return *this;
+}
+
+JsonBuffer& JsonBuffer::Int(int64_t value) {
+  char buf[24];
+  const auto res = std::to_chars(buf, buf + sizeof(buf), value);
+  text_.append(buf, static_cast<size_t>(res.ptr - buf));
+  return *this;
+}
+
+JsonBuffer& JsonBuffer::UInt(uint64_t value) {
+  char buf[24];
+  const auto res = std::to_chars(buf, buf + sizeof(buf), value);
+  text_.append(buf, static_cast<size_t>(res.ptr - buf));
+  return *this;
+}
+
+JsonBuffer& JsonBuffer::Bool(bool value) {
+  text_.append(value ? "true" : "false");
+  return *this;
+}
+
+}  // namespace aurora::io
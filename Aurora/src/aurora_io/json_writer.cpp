@@ -1,105 +1,80 @@
 #include "aurora/io/json_writer.hpp"
 
-#include <cmath>
 #include <filesystem>
 #include <fstream>
-#include <iomanip>
-#include <sstream>
+#include <string>
 #include <vector>
 
+#include "aurora/io/json_buffer.hpp"
+
 namespace aurora::io {
 namespace {
 
-std::string EscapeJson(const std::string& in) {
-  std::ostringstream out;
-  for (const char ch : in) {
-    switch (ch) {
-      case '\"':
-        out << "\\\"";
-        break;
-      case '\\':
-        out << "\\\\";
-        break;
-      case '\n':
-        out << "\\n";
-        break;
-      case '\r':
-        out << "\\r";
-        break;
-      case '\t':
-        out << "\\t";
-        break;
-      default:
-        out << ch;
-        break;
+void WriteStemDetail(JsonBuffer* out, const aurora::core::AudioStem& stem, int indent) {
+  // Stems produced by the renderer carry their statistics; anything else is rescanned once here.
+  const aurora::core::AudioStemStats stats = stem.stats.valid ? stem.stats : aurora::core::ComputeAudioStemStats(stem);
+  out->Indent(indent).Raw("\"name\": ").String(stem.name).Raw(",\n");
+  out->Indent(indent).Raw("\"channels\": ").Int(stem.channels).Raw(",\n");
+  out->Indent(indent).Raw("\"frame_count\": ").UInt(stats.frame_count).Raw(",\n");
+  out->Indent(indent).Raw("\"sample_count\": ").UInt(stats.sample_count).Raw(",\n");
+  out->Indent(indent).Raw("\"peak\": ").Number(stats.peak).Raw(",\n");
+  out->Indent(indent).Raw("\"rms\": ").Number(stats.rms()).Raw(",\n");
+  out->Indent(indent).Raw("\"dc_offset\": ").Number(stats.dc_offset()).Raw(",\n");
+  out->Indent(indent).Raw("\"audible_start_frame\": ").UInt(stats.first_audible_frame).Raw(",\n");
+  out->Indent(indent).Raw("\"audible_end_frame\": ").UInt(stats.end_audible_frame).Raw(",\n");
+  out->Indent(indent).Raw("\"nan_count\": ").UInt(stats.nan_count).Raw("\n");
+}
+
+void WriteStemDetailArray(JsonBuffer* out, const std::string& key, const std::vector<aurora::core::AudioStem>& stems) {
+  out->Raw("  ").String(key).Raw(": [\n");
+  for (size_t i = 0; i < stems.size(); ++i) {
+    out->Raw("    {\n");
+    WriteStemDetail(out, stems[i], 6);
+    out->Raw("    }");
+    if (i + 1 < stems.size()) {
+      out->Raw(",");
     }
+    out->Raw("\n");
   }
-  return out.str();
+  out->Raw("  ]");
 }
 
-struct StemStats {
-  uint64_t frame_count = 0;
-  uint64_t sample_count = 0;
-  double peak = 0.0;
-  double rms = 0.0;
-};
-
-StemStats ComputeStemStats(const aurora::core::AudioStem& stem) {
-  StemStats stats;
-  stats.sample_count = static_cast<uint64_t>(stem.samples.size());
-  if (stem.channels > 0) {
-    stats.frame_count = static_cast<uint64_t>(stem.samples.size() / static_cast<size_t>(stem.channels));
-  }
-  if (stem.samples.empty()) {
-    return stats;
-  }
+void WriteStemDetailObject(JsonBuffer* out, const std::string& key, const aurora::core::AudioStem& stem) {
+  out->Raw("  ").String(key).Raw(": {\n");
+  WriteStemDetail(out, stem, 4);
+  out->Raw("  }");
+}
 
-  double sum_sq = 0.0;
-  double peak = 0.0;
-  for (const float sample : stem.samples) {
-    const double v = static_cast<double>(sample);
-    const double a = std::fabs(v);
-    if (a > peak) {
-      peak = a;
-    }
-    sum_sq += v * v;
-  }
-  stats.peak = peak;
-  stats.rms = std::sqrt(sum_sq / static_cast<double>(stem.samples.size()));
-  return stats;
+void WriteLoudnessObject(JsonBuffer* out, const std::string& key, const aurora::core::LoudnessReading& loudness) {
+  out->Raw("  ").String(key).Raw(": {\n");
+  out->Raw("    \"integrated_lufs\": ").Number(loudness.integrated_lufs).Raw(",\n");
+  out->Raw("    \"lra\": ").Number(loudness.lra).Raw(",\n");
+  out->Raw("    \"momentary_max_lufs\": ").Number(loudness.momentary_max_lufs).Raw(",\n");
+  out->Raw("    \"short_term_max_lufs\": ").Number(loudness.short_term_max_lufs).Raw(",\n");
+  out->Raw("    \"true_peak_dbtp\": ").Number(loudness.true_peak_dbtp).Raw("\n");
+  out->Raw("  }");
 }
 
-void WriteStemDetailArray(std::ofstream& out, const std::string& key, const std::vector<aurora::core::AudioStem>& stems) {
-  out << "  \"" << key << "\": [\n";
-  for (size_t i = 0; i < stems.size(); ++i) {
-    const auto& stem = stems[i];
-    const StemStats stats = ComputeStemStats(stem);
-    out << "    {\n";
-    out << "      \"name\": \"" << EscapeJson(stem.name) << "\",\n";
-    out << "      \"channels\": " << stem.channels << ",\n";
-    out << "      \"frame_count\": " << stats.frame_count << ",\n";
-    out << "      \"sample_count\": " << stats.sample_count << ",\n";
-    out << "      \"peak\": " << stats.peak << ",\n";
-    out << "      \"rms\": " << stats.rms << "\n";
-    out << "    }";
-    if (i + 1 < stems.size()) {
-      out << ",";
+void WriteNameArray(JsonBuffer* out, const std::string& key, const std::vector<std::string>& names) {
+  out->Raw("  ").String(key).Raw(": [\n");
+  for (size_t i = 0; i < names.size(); ++i) {
+    out->Raw("    ").String(names[i]);
+    if (i + 1 < names.size()) {
+      out->Raw(",");
     }
-    out << "\n";
+    out->Raw("\n");
   }
-  out << "  ]";
+  out->Raw("  ]");
 }
 
-void WriteStemDetailObject(std::ofstream& out, const std::string& key, const aurora::core::AudioStem& stem) {
-  const StemStats stats = ComputeStemStats(stem);
-  out << "  \"" << key << "\": {\n";
-  out << "    \"name\": \"" << EscapeJson(stem.name) << "\",\n";
-  out << "    \"channels\": " << stem.channels << ",\n";
-  out << "    \"frame_count\": " << stats.frame_count << ",\n";
-  out << "    \"sample_count\": " << stats.sample_count << ",\n";
-  out << "    \"peak\": " << stats.peak << ",\n";
-  out << "    \"rms\": " << stats.rms << "\n";
-  out << "  }";
+template <typename T>
+std::vector<std::string> NamesOf(const std::vector<T>& items) {
+  std::vector<std::string> names;
+  names.reserve(items.size());
+  for (const auto& item : items) {
+    names.push_back(item.name);
+  }
+  return names;
 }
 
 }  // namespace
@@ -114,56 +89,41 @@ bool WriteRenderJson(const std::filesystem::path& path, const aurora::core::Rend
     return false;
   }
 
-  out << "{\n";
-  out << std::setprecision(9);
-  out << "  \"sample_rate\": " << result.metadata.sample_rate << ",\n";
-  out << "  \"block_size\": " << result.metadata.block_size << ",\n";
-  out << "  \"total_samples\": " << result.metadata.total_samples << ",\n";
-  out << "  \"duration_seconds\": " << result.metadata.duration_seconds << ",\n";
-  out << "  \"patch_stems\": [\n";
-  for (size_t i = 0; i < result.patch_stems.size(); ++i) {
-    out << "    \"" << EscapeJson(result.patch_stems[i].name) << "\"";
-    if (i + 1 < result.patch_stems.size()) {
-      out << ",";
-    }
-    out << "\n";
+  JsonBuffer json;
+  json.Raw("{\n");
+  json.Raw("  \"sample_rate\": ").Int(result.metadata.sample_rate).Raw(",\n");
+  json.Raw("  \"block_size\": ").Int(result.metadata.block_size).Raw(",\n");
+  if (result.metadata.start_sample > 0U) {
+    json.Raw("  \"start_sample\": ").UInt(result.metadata.start_sample).Raw(",\n");
   }
-  out << "  ],\n";
-  out << "  \"bus_stems\": [\n";
-  for (size_t i = 0; i < result.bus_stems.size(); ++i) {
-    out << "    \"" << EscapeJson(result.bus_stems[i].name) << "\"";
-    if (i + 1 < result.bus_stems.size()) {
-      out << ",";
-    }
-    out << "\n";
-  }
-  out << "  ],\n";
-  out << "  \"midi_tracks\": [\n";
-  for (size_t i = 0; i < result.midi_tracks.size(); ++i) {
-    out << "    \"" << EscapeJson(result.midi_tracks[i].name) << "\"";
-    if (i + 1 < result.midi_tracks.size()) {
-      out << ",";
-    }
-    out << "\n";
+  if (result.metadata.draft_sample_rate > 0) {
+    json.Raw("  \"draft\": {\n");
+    json.Raw("    \"sample_rate\": ").Int(result.metadata.draft_sample_rate).Raw(",\n");
+    json.Raw("    \"mono\": ").Bool(result.metadata.draft_mono).Raw("\n");
+    json.Raw("  },\n");
   }
-  out << "  ],\n";
-  WriteStemDetailArray(out, "patch_stem_details", result.patch_stems);
-  out << ",\n";
-  WriteStemDetailArray(out, "bus_stem_details", result.bus_stems);
-  out << ",\n";
-  WriteStemDetailObject(out, "master_stem", result.master);
-  out << ",\n";
-  out << "  \"warnings\": [\n";
-  for (size_t i = 0; i < result.warnings.size(); ++i) {
-    out << "    \"" << EscapeJson(result.warnings[i]) << "\"";
-    if (i + 1 < result.warnings.size()) {
-      out << ",";
-    }
-    out << "\n";
+  json.Raw("  \"total_samples\": ").UInt(result.metadata.total_samples).Raw(",\n");
+  json.Raw("  \"duration_seconds\": ").Number(result.metadata.duration_seconds).Raw(",\n");
+  WriteNameArray(&json, "patch_stems", NamesOf(result.patch_stems));
+  json.Raw(",\n");
+  WriteNameArray(&json, "bus_stems", NamesOf(result.bus_stems));
+  json.Raw(",\n");
+  WriteNameArray(&json, "midi_tracks", NamesOf(result.midi_tracks));
+  json.Raw(",\n");
+  WriteStemDetailArray(&json, "patch_stem_details", result.patch_stems);
+  json.Raw(",\n");
+  WriteStemDetailArray(&json, "bus_stem_details", result.bus_stems);
+  json.Raw(",\n");
+  WriteStemDetailObject(&json, "master_stem", result.master);
+  json.Raw(",\n");
+  if (result.master_loudness.measured) {
+    WriteLoudnessObject(&json, "master_loudness", result.master_loudness);
+    json.Raw(",\n");
   }
-  out << "  ]\n";
-  out << "}\n";
+  WriteNameArray(&json, "warnings", result.warnings);
+  json.Raw("\n}\n");
 
+  out.write(json.str().data(), static_cast<std::streamsize>(json.str().size()));
   if (!out.good()) {
     if (error != nullptr) {
       *error = "Failed while writing JSON metadata: " + path.string();
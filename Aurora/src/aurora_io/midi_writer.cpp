@@ -5,6 +5,7 @@
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <initializer_list>
 #include <limits>
 #include <string>
 #include <vector>
@@ -14,16 +15,16 @@ namespace {
 
 constexpr uint16_t kPpq = 480;
 
-void WriteU16BE(std::ofstream& out, uint16_t v) {
-  out.put(static_cast<char>((v >> 8) & 0xFF));
-  out.put(static_cast<char>(v & 0xFF));
+void AppendU16BE(std::vector<uint8_t>* out, uint16_t v) {
+  out->push_back(static_cast<uint8_t>((v >> 8) & 0xFF));
+  out->push_back(static_cast<uint8_t>(v & 0xFF));
 }
 
-void WriteU32BE(std::ofstream& out, uint32_t v) {
-  out.put(static_cast<char>((v >> 24) & 0xFF));
-  out.put(static_cast<char>((v >> 16) & 0xFF));
-  out.put(static_cast<char>((v >> 8) & 0xFF));
-  out.put(static_cast<char>(v & 0xFF));
+void AppendU32BE(std::vector<uint8_t>* out, uint32_t v) {
+  out->push_back(static_cast<uint8_t>((v >> 24) & 0xFF));
+  out->push_back(static_cast<uint8_t>((v >> 16) & 0xFF));
+  out->push_back(static_cast<uint8_t>((v >> 8) & 0xFF));
+  out->push_back(static_cast<uint8_t>(v & 0xFF));
 }
 
 void WriteVarLen(std::vector<uint8_t>* data, uint32_t value) {
@@ -38,25 +39,42 @@ void WriteVarLen(std::vector<uint8_t>* data, uint32_t value) {
   }
 }
 
-double SecondsToTicks(double seconds, const aurora::core::TempoMap& tempo_map) {
-  double ticks = 0.0;
-  for (size_t i = 0; i < tempo_map.points.size(); ++i) {
-    const double start = tempo_map.points[i].at_seconds;
-    const double bpm = tempo_map.points[i].bpm;
-    const double end =
-        (i + 1 < tempo_map.points.size()) ? tempo_map.points[i + 1].at_seconds : std::numeric_limits<double>::infinity();
-    if (seconds <= start) {
-      break;
+// Cumulative tick position at the start of every tempo segment, so each conversion is a binary search plus one
+// multiply instead of a walk over the whole tempo map.
+class TempoTickIndex {
+ public:
+  explicit TempoTickIndex(const aurora::core::TempoMap& tempo_map) {
+    const auto& points = tempo_map.points;
+    starts_.reserve(points.size());
+    beats_per_second_.reserve(points.size());
+    cumulative_ticks_.reserve(points.size());
+    double ticks = 0.0;
+    for (size_t i = 0; i < points.size(); ++i) {
+      const double bps = points[i].bpm / 60.0;
+      starts_.push_back(points[i].at_seconds);
+      beats_per_second_.push_back(bps);
+      cumulative_ticks_.push_back(ticks);
+      if (i + 1 < points.size()) {
+        ticks += std::max(0.0, points[i + 1].at_seconds - points[i].at_seconds) * bps * static_cast<double>(kPpq);
+      }
     }
-    const double segment_end = std::min(seconds, end);
-    const double seg_seconds = std::max(0.0, segment_end - start);
-    ticks += seg_seconds * (bpm / 60.0) * static_cast<double>(kPpq);
-    if (seconds <= end) {
-      break;
+  }
+
+  double SecondsToTicks(double seconds) const {
+    // Last segment whose start lies strictly before `seconds`.
+    const auto it = std::lower_bound(starts_.begin(), starts_.end(), seconds);
+    if (it == starts_.begin()) {
+      return 0.0;
     }
+    const size_t seg = static_cast<size_t>(std::distance(starts_.begin(), it)) - 1U;
+    return cumulative_ticks_[seg] + std::max(0.0, seconds - starts_[seg]) * beats_per_second_[seg] * static_cast<double>(kPpq);
   }
-  return ticks;
-}
+
+ private:
+  std::vector<double> starts_;
+  std::vector<double> beats_per_second_;
+  std::vector<double> cumulative_ticks_;
+};
 
 bool TickDoubleToU32(double ticks, const char* context, uint32_t* out, std::string* error) {
   if (!std::isfinite(ticks) || ticks < 0.0 || ticks > static_cast<double>(std::numeric_limits<uint32_t>::max())) {
@@ -69,19 +87,56 @@ bool TickDoubleToU32(double ticks, const char* context, uint32_t* out, std::stri
   return true;
 }
 
-bool SampleToTick(uint64_t sample, int sample_rate, const aurora::core::TempoMap& tempo_map, uint32_t* out, std::string* error) {
+bool SampleToTick(uint64_t sample, int sample_rate, const TempoTickIndex& tempo_index, uint32_t* out, std::string* error) {
   const double seconds = static_cast<double>(sample) / static_cast<double>(sample_rate);
-  return TickDoubleToU32(SecondsToTicks(seconds, tempo_map), "note/cc event", out, error);
+  return TickDoubleToU32(tempo_index.SecondsToTicks(seconds), "note/cc event", out, error);
 }
 
 struct MidiEvent {
   uint32_t tick = 0;
-  std::vector<uint8_t> bytes;
+  uint32_t offset = 0;
+  uint16_t size = 0;
   int order = 0;
 };
 
-std::vector<uint8_t> EncodeTrack(std::vector<MidiEvent> events, uint32_t end_tick) {
-  events.push_back(MidiEvent{end_tick, {0xFF, 0x2F, 0x00}, 9999});
+// Per-track event list whose message bytes live in one contiguous arena instead of one heap block per event.
+struct MidiEventBuffer {
+  std::vector<MidiEvent> events;
+  std::vector<uint8_t> arena;
+
+  void Reserve(size_t event_count) {
+    events.reserve(event_count);
+    arena.reserve(event_count * 3U);
+  }
+
+  void Add(uint32_t tick, int order, std::initializer_list<uint8_t> bytes) {
+    MidiEvent event;
+    event.tick = tick;
+    event.order = order;
+    event.offset = static_cast<uint32_t>(arena.size());
+    event.size = static_cast<uint16_t>(bytes.size());
+    arena.insert(arena.end(), bytes.begin(), bytes.end());
+    events.push_back(event);
+  }
+
+  void AddMeta(uint32_t tick, int order, uint8_t type, const std::string& text) {
+    const size_t len = std::min<size_t>(255, text.size());
+    MidiEvent event;
+    event.tick = tick;
+    event.order = order;
+    event.offset = static_cast<uint32_t>(arena.size());
+    event.size = static_cast<uint16_t>(3U + len);
+    arena.push_back(0xFF);
+    arena.push_back(type);
+    arena.push_back(static_cast<uint8_t>(len));
+    arena.insert(arena.end(), text.begin(), text.begin() + static_cast<std::ptrdiff_t>(len));
+    events.push_back(event);
+  }
+};
+
+std::vector<uint8_t> EncodeTrack(MidiEventBuffer* buffer, uint32_t end_tick) {
+  buffer->Add(end_tick, 9999, {0xFF, 0x2F, 0x00});
+  auto& events = buffer->events;
   std::stable_sort(events.begin(), events.end(), [](const MidiEvent& a, const MidiEvent& b) {
     if (a.tick == b.tick) {
       return a.order < b.order;
@@ -90,25 +145,24 @@ std::vector<uint8_t> EncodeTrack(std::vector<MidiEvent> events, uint32_t end_tic
   });
 
   std::vector<uint8_t> data;
+  data.reserve(buffer->arena.size() + events.size() * 2U);
   uint32_t prev_tick = 0;
   for (const auto& ev : events) {
     const uint32_t delta = ev.tick - prev_tick;
     WriteVarLen(&data, delta);
-    data.insert(data.end(), ev.bytes.begin(), ev.bytes.end());
+    const auto begin = buffer->arena.begin() + static_cast<std::ptrdiff_t>(ev.offset);
+    data.insert(data.end(), begin, begin + static_cast<std::ptrdiff_t>(ev.size));
     prev_tick = ev.tick;
   }
   return data;
 }
 
-MidiEvent MakeTempoEvent(uint32_t tick, double bpm) {
+void AddTempoEvent(MidiEventBuffer* buffer, uint32_t tick, double bpm) {
   const double safe_bpm = std::max(1.0, bpm);
   const uint32_t us_per_quarter = static_cast<uint32_t>(std::llround(60000000.0 / safe_bpm));
-  MidiEvent event;
-  event.tick = tick;
-  event.order = 0;
-  event.bytes = {0xFF, 0x51, 0x03, static_cast<uint8_t>((us_per_quarter >> 16) & 0xFF),
-                 static_cast<uint8_t>((us_per_quarter >> 8) & 0xFF), static_cast<uint8_t>(us_per_quarter & 0xFF)};
-  return event;
+  buffer->Add(tick, 0,
+              {0xFF, 0x51, 0x03, static_cast<uint8_t>((us_per_quarter >> 16) & 0xFF),
+               static_cast<uint8_t>((us_per_quarter >> 8) & 0xFF), static_cast<uint8_t>(us_per_quarter & 0xFF)});
 }
 
 }  // namespace
@@ -125,90 +179,82 @@ bool WriteMidiFormat1(const std::filesystem::path& path, const std::vector<auror
     return false;
   }
 
+  const TempoTickIndex tempo_index(tempo_map);
   uint32_t end_tick = 0;
   if (!TickDoubleToU32(
-          std::ceil(SecondsToTicks(static_cast<double>(total_samples) / static_cast<double>(sample_rate), tempo_map)),
+          std::ceil(tempo_index.SecondsToTicks(static_cast<double>(total_samples) / static_cast<double>(sample_rate))),
           "track length", &end_tick, error)) {
     return false;
   }
 
   std::vector<std::vector<uint8_t>> encoded_tracks;
+  encoded_tracks.reserve(tracks.size() + 1U);
 
-  std::vector<MidiEvent> tempo_events;
+  MidiEventBuffer tempo_events;
   for (const auto& point : tempo_map.points) {
     uint32_t tick = 0;
-    if (!TickDoubleToU32(SecondsToTicks(point.at_seconds, tempo_map), "tempo event", &tick, error)) {
+    if (!TickDoubleToU32(tempo_index.SecondsToTicks(point.at_seconds), "tempo event", &tick, error)) {
       return false;
     }
-    tempo_events.push_back(MakeTempoEvent(tick, point.bpm));
+    AddTempoEvent(&tempo_events, tick, point.bpm);
   }
-  if (tempo_events.empty()) {
-    tempo_events.push_back(MakeTempoEvent(0, 60.0));
+  if (tempo_events.events.empty()) {
+    AddTempoEvent(&tempo_events, 0, 60.0);
   }
-  encoded_tracks.push_back(EncodeTrack(std::move(tempo_events), end_tick));
+  encoded_tracks.push_back(EncodeTrack(&tempo_events, end_tick));
 
   for (const auto& track : tracks) {
-    std::vector<MidiEvent> events;
+    MidiEventBuffer events;
+    events.Reserve(track.notes.size() * 2U + track.ccs.size() + 2U);
 
     if (!track.name.empty()) {
-      MidiEvent name;
-      name.tick = 0;
-      name.order = 0;
-      name.bytes = {0xFF, 0x03, static_cast<uint8_t>(std::min<size_t>(255, track.name.size()))};
-      for (size_t i = 0; i < std::min<size_t>(255, track.name.size()); ++i) {
-        name.bytes.push_back(static_cast<uint8_t>(track.name[i]));
-      }
-      events.push_back(std::move(name));
+      events.AddMeta(0, 0, 0x03, track.name);
     }
 
     for (const auto& note : track.notes) {
       uint32_t on_tick = 0;
       uint32_t off_tick = 0;
-      if (!SampleToTick(note.start_sample, sample_rate, tempo_map, &on_tick, error)) {
+      if (!SampleToTick(note.start_sample, sample_rate, tempo_index, &on_tick, error)) {
         return false;
       }
-      if (!SampleToTick(note.end_sample, sample_rate, tempo_map, &off_tick, error)) {
+      if (!SampleToTick(note.end_sample, sample_rate, tempo_index, &off_tick, error)) {
         return false;
       }
-      MidiEvent on;
-      on.tick = on_tick;
-      on.order = 2;
-      on.bytes = {static_cast<uint8_t>(0x90 | (note.channel & 0x0F)), static_cast<uint8_t>(note.note & 0x7F),
-                  static_cast<uint8_t>(note.velocity & 0x7F)};
-      events.push_back(on);
-
-      MidiEvent off;
-      off.tick = std::max(off_tick, on_tick + 1);
-      off.order = 1;
-      off.bytes = {static_cast<uint8_t>(0x80 | (note.channel & 0x0F)), static_cast<uint8_t>(note.note & 0x7F), 0x00};
-      events.push_back(off);
+      events.Add(on_tick, 2,
+                 {static_cast<uint8_t>(0x90 | (note.channel & 0x0F)), static_cast<uint8_t>(note.note & 0x7F),
+                  static_cast<uint8_t>(note.velocity & 0x7F)});
+      events.Add(std::max(off_tick, on_tick + 1), 1,
+                 {static_cast<uint8_t>(0x80 | (note.channel & 0x0F)), static_cast<uint8_t>(note.note & 0x7F), 0x00});
     }
 
     for (const auto& cc : track.ccs) {
       uint32_t cc_tick = 0;
-      if (!SampleToTick(cc.sample, sample_rate, tempo_map, &cc_tick, error)) {
+      if (!SampleToTick(cc.sample, sample_rate, tempo_index, &cc_tick, error)) {
         return false;
       }
-      MidiEvent cce;
-      cce.tick = cc_tick;
-      cce.order = 3;
-      cce.bytes = {static_cast<uint8_t>(0xB0 | (cc.channel & 0x0F)), static_cast<uint8_t>(cc.cc & 0x7F),
-                   static_cast<uint8_t>(cc.value & 0x7F)};
-      events.push_back(cce);
+      events.Add(cc_tick, 3,
+                 {static_cast<uint8_t>(0xB0 | (cc.channel & 0x0F)), static_cast<uint8_t>(cc.cc & 0x7F),
+                  static_cast<uint8_t>(cc.value & 0x7F)});
     }
 
-    encoded_tracks.push_back(EncodeTrack(std::move(events), end_tick));
+    encoded_tracks.push_back(EncodeTrack(&events, end_tick));
   }
 
-  out.write("MThd", 4);
-  WriteU32BE(out, 6);
-  WriteU16BE(out, 1);
-  WriteU16BE(out, static_cast<uint16_t>(encoded_tracks.size()));
-  WriteU16BE(out, kPpq);
+  std::vector<uint8_t> header;
+  header.reserve(14U);
+  header.insert(header.end(), {'M', 'T', 'h', 'd'});
+  AppendU32BE(&header, 6);
+  AppendU16BE(&header, 1);
+  AppendU16BE(&header, static_cast<uint16_t>(encoded_tracks.size()));
+  AppendU16BE(&header, kPpq);
+  out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
 
   for (const auto& track_data : encoded_tracks) {
-    out.write("MTrk", 4);
-    WriteU32BE(out, static_cast<uint32_t>(track_data.size()));
+    std::vector<uint8_t> track_header;
+    track_header.reserve(8U);
+    track_header.insert(track_header.end(), {'M', 'T', 'r', 'k'});
+    AppendU32BE(&track_header, static_cast<uint32_t>(track_data.size()));
+    out.write(reinterpret_cast<const char*>(track_header.data()), static_cast<std::streamsize>(track_header.size()));
     out.write(reinterpret_cast<const char*>(track_data.data()), static_cast<std::streamsize>(track_data.size()));
   }
 
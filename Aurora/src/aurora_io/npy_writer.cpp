@@ -0,0 +1,59 @@
+#include "aurora/io/npy_writer.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace aurora::io {
+
+bool WriteNpyFloat32Columns(const std::filesystem::path& path, const std::vector<std::vector<float>>& columns,
+                            std::string* error) {
+  static_assert(std::endian::native == std::endian::little, "NPY writer emits little-endian float32 data.");
+  const size_t rows = columns.empty() ? 0U : columns.front().size();
+  for (const auto& column : columns) {
+    if (column.size() != rows) {
+      if (error != nullptr) {
+        *error = "NPY columns must have equal length: " + path.string();
+      }
+      return false;
+    }
+  }
+
+  std::string header = "{'descr': '<f4', 'fortran_order': True, 'shape': (" + std::to_string(rows) + ", " +
+                       std::to_string(columns.size()) + "), }";
+  // Magic (6) + version (2) + header length (2) + header must be a multiple of 64, ending in '\n'.
+  const size_t preamble = 10U;
+  const size_t padded = ((preamble + header.size() + 1U + 63U) / 64U) * 64U;
+  header.append(padded - preamble - header.size() - 1U, ' ');
+  header.push_back('\n');
+
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream out(path, std::ios::binary);
+  if (!out.is_open()) {
+    if (error != nullptr) {
+      *error = "Failed to open NPY file for writing: " + path.string();
+    }
+    return false;
+  }
+  const uint16_t header_len = static_cast<uint16_t>(header.size());
+  const char preamble_bytes[10] = {'\x93', 'N', 'U', 'M', 'P', 'Y', '\x01', '\x00', static_cast<char>(header_len & 0xFF),
+                                   static_cast<char>((header_len >> 8) & 0xFF)};
+  out.write(preamble_bytes, sizeof(preamble_bytes));
+  out.write(header.data(), static_cast<std::streamsize>(header.size()));
+  for (const auto& column : columns) {
+    out.write(reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(column.size() * sizeof(float)));
+  }
+
+  if (!out.good()) {
+    if (error != nullptr) {
+      *error = "Failed while writing NPY data: " + path.string();
+    }
+    return false;
+  }
+  return true;
+}
+
+}  // namespace aurora::io
@@ -1,10 +1,12 @@
 #include "aurora/io/png_writer.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -262,4 +264,235 @@ bool WritePngIndexed8(const std::filesystem::path& path, int width, int height,
   return true;
 }
 
+struct PngStreamWriter::State {
+  std::filesystem::path path;
+  std::filesystem::path tmp;
+  std::ofstream out;
+  z_stream zs{};
+  bool zs_ready = false;
+  bool finished = false;
+  int width = 0;
+  int height = 0;
+  int rows_written = 0;
+  bool indexed = false;
+  size_t row_bytes = 0;
+  std::vector<uint8_t> scanline;
+  std::vector<uint8_t> zbuf;
+  std::vector<uint8_t> chunk;
+
+  ~State() {
+    if (zs_ready) {
+      deflateEnd(&zs);
+    }
+    if (!finished && out.is_open()) {
+      out.close();
+      std::error_code ec;
+      std::filesystem::remove(tmp, ec);
+    }
+  }
+
+  bool WriteChunk(const char type[4], const uint8_t* data, size_t size, std::string* error) {
+    chunk.clear();
+    AppendU32Be(&chunk, static_cast<uint32_t>(size));
+    chunk.push_back(static_cast<uint8_t>(type[0]));
+    chunk.push_back(static_cast<uint8_t>(type[1]));
+    chunk.push_back(static_cast<uint8_t>(type[2]));
+    chunk.push_back(static_cast<uint8_t>(type[3]));
+    chunk.insert(chunk.end(), data, data + size);
+    const uint32_t crc = Crc32(chunk.data() + 4U, chunk.size() - 4U);
+    AppendU32Be(&chunk, crc);
+    out.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+    if (!out.good()) {
+      if (error != nullptr) {
+        *error = "Failed while writing PNG bytes: " + tmp.string();
+      }
+      return false;
+    }
+    return true;
+  }
+
+  // Runs deflate over the pending input and emits one IDAT chunk each time the output buffer fills.
+  bool Pump(int flush, std::string* error) {
+    while (true) {
+      if (zs.avail_out == 0U) {
+        if (!WriteChunk("IDAT", zbuf.data(), zbuf.size(), error)) {
+          return false;
+        }
+        zs.next_out = zbuf.data();
+        zs.avail_out = static_cast<uInt>(zbuf.size());
+      }
+      const int rc = deflate(&zs, flush);
+      if (rc == Z_STREAM_ERROR) {
+        if (error != nullptr) {
+          *error = "Failed to deflate PNG payload.";
+        }
+        return false;
+      }
+      if (flush == Z_FINISH) {
+        if (rc == Z_STREAM_END) {
+          return true;
+        }
+        continue;
+      }
+      if (zs.avail_in == 0U && zs.avail_out != 0U) {
+        return true;
+      }
+    }
+  }
+};
+
+PngStreamWriter::PngStreamWriter() = default;
+PngStreamWriter::~PngStreamWriter() = default;
+
+bool PngStreamWriter::Open(const std::filesystem::path& path, int width, int height, const std::vector<uint8_t>* palette_rgb,
+                           int compression_level, std::string* error) {
+  state_.reset();
+  if (width <= 0 || height <= 0) {
+    if (error != nullptr) {
+      *error = "Invalid PNG dimensions.";
+    }
+    return false;
+  }
+  if (palette_rgb != nullptr && palette_rgb->size() != 256U * 3U) {
+    if (error != nullptr) {
+      *error = "Indexed PNG requires 256-color RGB palette.";
+    }
+    return false;
+  }
+  if (compression_level < 0 || compression_level > 9) {
+    if (error != nullptr) {
+      *error = "PNG compression level must be in [0,9].";
+    }
+    return false;
+  }
+
+  auto state = std::make_unique<State>();
+  state->path = path;
+  state->tmp = path.string() + ".tmp";
+  state->width = width;
+  state->height = height;
+  state->indexed = palette_rgb != nullptr;
+  state->row_bytes = static_cast<size_t>(width) * (state->indexed ? 1U : 3U);
+  state->scanline.assign(state->row_bytes + 1U, 0U);
+  state->zbuf.assign(64U * 1024U, 0U);
+
+  std::filesystem::create_directories(path.parent_path());
+  state->out.open(state->tmp, std::ios::binary);
+  if (!state->out.is_open()) {
+    if (error != nullptr) {
+      *error = "Failed to open PNG for writing: " + state->tmp.string();
+    }
+    return false;
+  }
+  if (deflateInit(&state->zs, compression_level) != Z_OK) {
+    if (error != nullptr) {
+      *error = "Failed to initialize PNG deflate stream.";
+    }
+    return false;
+  }
+  state->zs_ready = true;
+  state->zs.next_out = state->zbuf.data();
+  state->zs.avail_out = static_cast<uInt>(state->zbuf.size());
+
+  static constexpr std::array<uint8_t, 8> kSignature = {137U, 80U, 78U, 71U, 13U, 10U, 26U, 10U};
+  state->out.write(reinterpret_cast<const char*>(kSignature.data()), static_cast<std::streamsize>(kSignature.size()));
+  std::vector<uint8_t> ihdr;
+  ihdr.reserve(13U);
+  AppendU32Be(&ihdr, static_cast<uint32_t>(width));
+  AppendU32Be(&ihdr, static_cast<uint32_t>(height));
+  ihdr.push_back(8U);
+  ihdr.push_back(state->indexed ? 3U : 2U);
+  ihdr.push_back(0U);
+  ihdr.push_back(0U);
+  ihdr.push_back(0U);
+  if (!state->WriteChunk("IHDR", ihdr.data(), ihdr.size(), error)) {
+    return false;
+  }
+  if (state->indexed && !state->WriteChunk("PLTE", palette_rgb->data(), palette_rgb->size(), error)) {
+    return false;
+  }
+  state_ = std::move(state);
+  return true;
+}
+
+bool PngStreamWriter::WriteRow(const uint8_t* row, std::string* error) {
+  if (state_ == nullptr || state_->finished || row == nullptr) {
+    if (error != nullptr) {
+      *error = "PNG stream is not open.";
+    }
+    return false;
+  }
+  if (state_->rows_written >= state_->height) {
+    if (error != nullptr) {
+      *error = "PNG stream received more rows than declared height.";
+    }
+    return false;
+  }
+  state_->scanline[0] = 0U;
+  std::copy(row, row + state_->row_bytes, state_->scanline.begin() + 1);
+  state_->zs.next_in = state_->scanline.data();
+  state_->zs.avail_in = static_cast<uInt>(state_->scanline.size());
+  if (!state_->Pump(Z_NO_FLUSH, error)) {
+    return false;
+  }
+  ++state_->rows_written;
+  return true;
+}
+
+bool PngStreamWriter::Finish(std::string* error) {
+  if (state_ == nullptr || state_->finished) {
+    if (error != nullptr) {
+      *error = "PNG stream is not open.";
+    }
+    return false;
+  }
+  if (state_->rows_written != state_->height) {
+    if (error != nullptr) {
+      *error = "PNG stream finished with " + std::to_string(state_->rows_written) + " of " +
+               std::to_string(state_->height) + " rows.";
+    }
+    return false;
+  }
+  state_->zs.next_in = nullptr;
+  state_->zs.avail_in = 0U;
+  if (!state_->Pump(Z_FINISH, error)) {
+    return false;
+  }
+  const size_t pending = state_->zbuf.size() - static_cast<size_t>(state_->zs.avail_out);
+  if (pending > 0U && !state_->WriteChunk("IDAT", state_->zbuf.data(), pending, error)) {
+    return false;
+  }
+  if (!state_->WriteChunk("IEND", nullptr, 0U, error)) {
+    return false;
+  }
+  state_->out.close();
+  if (!state_->out.good()) {
+    if (error != nullptr) {
+      *error = "Failed closing PNG file: " + state_->tmp.string();
+    }
+    return false;
+  }
+  state_->finished = true;
+
+  std::error_code ec;
+  std::filesystem::rename(state_->tmp, state_->path, ec);
+  if (ec) {
+    std::filesystem::remove(state_->path, ec);
+    ec.clear();
+    std::filesystem::rename(state_->tmp, state_->path, ec);
+  }
+  if (ec) {
+    if (error != nullptr) {
+      *error = "Failed to finalize PNG file: " + state_->path.string();
+    }
+    return false;
+  }
+  return true;
+}
+
+int PngStreamWriter::width() const { return state_ == nullptr ? 0 : state_->width; }
+int PngStreamWriter::height() const { return state_ == nullptr ? 0 : state_->height; }
+int PngStreamWriter::rows_written() const { return state_ == nullptr ? 0 : state_->rows_written; }
+bool PngStreamWriter::indexed() const { return state_ != nullptr && state_->indexed; }
+
 }  // namespace aurora::io
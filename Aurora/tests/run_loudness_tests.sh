@@ -0,0 +1,95 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+AURORA_BIN="$ROOT_DIR/build/src/aurora_cli/aurora"
+OUT_ROOT="$ROOT_DIR/out/loudness_test_runs"
+
+if [[ ! -x "$AURORA_BIN" ]]; then
+  echo "error: missing binary at $AURORA_BIN"
+  echo "build first: cmake --build build -j4"
+  exit 1
+fi
+if ! command -v python3 >/dev/null 2>&1; then
+  echo "error: python3 is needed to generate the reference signals"
+  exit 1
+fi
+
+# Writes a 48 kHz stereo 16-bit WAV of a 1 kHz sine, identical in both channels, made of segments given as
+# <dBFS>:<seconds> (EBU Tech 3341 / 3342 test signal style).
+write_sine_steps() {
+  local wav="$1"
+  shift
+  python3 - "$wav" "$@" <<'EOF'
+import math, struct, sys, wave
+
+SR = 48000
+out = bytearray()
+for segment in sys.argv[2:]:
+    dbfs, seconds = (float(x) for x in segment.split(":"))
+    amplitude = 10.0 ** (dbfs / 20.0) * 32767.0
+    # 48 samples are exactly one period of 1 kHz at 48 kHz.
+    cycle = b"".join(struct.pack("<hh", v, v) for v in
+                     (int(round(amplitude * math.sin(2.0 * math.pi * n / 48.0))) for n in range(48)))
+    out += cycle * int(seconds * 1000)
+with wave.open(sys.argv[1], "wb") as w:
+    w.setnchannels(2)
+    w.setsampwidth(2)
+    w.setframerate(SR)
+    w.writeframes(bytes(out))
+EOF
+}
+
+# First value of `key` in a JSON file: in analysis.json that is the mix's loudness reading.
+json_number() {
+  local key="$1"
+  local json="$2"
+  grep -m1 "\"$key\":" "$json" | sed -E 's/.*: *(-?[0-9.eE+-]+),?/\1/'
+}
+
+analyze_ok() {
+  local name="$1"
+  shift
+  echo "[LOUDNESS] $name: $*"
+  write_sine_steps "$OUT_ROOT/$name.wav" "$@"
+  if ! "$AURORA_BIN" analyze "$OUT_ROOT/$name.wav" --out "$OUT_ROOT/$name.json" --nospectrogram \
+      >/tmp/loudness_${name}.log 2>&1; then
+    echo "error: analyze $name failed"
+    cat /tmp/loudness_${name}.log
+    exit 1
+  fi
+}
+
+assert_near() {
+  local name="$1"
+  local key="$2"
+  local expected="$3"
+  local tolerance="$4"
+  local actual
+  actual="$(json_number "$key" "$OUT_ROOT/$name.json")"
+  if ! awk -v a="$actual" -v e="$expected" -v t="$tolerance" 'BEGIN { d = a - e; exit !(d <= t && -d <= t) }'; then
+    echo "error: $name $key = $actual, expected $expected +/- $tolerance"
+    exit 1
+  fi
+}
+
+rm -rf "$OUT_ROOT"
+mkdir -p "$OUT_ROOT"
+
+# EBU Tech 3341 cases 1 and 2: a stereo 1 kHz sine reads its level in dBFS as LUFS, within 0.1 LU.
+analyze_ok "tech3341_1" -23:20
+assert_near "tech3341_1" integrated_lufs -23.0 0.1
+analyze_ok "tech3341_2" -33:20
+assert_near "tech3341_2" integrated_lufs -33.0 0.1
+
+# EBU Tech 3342 cases 1 to 4: level steps give the loudness range, within 1 LU.
+analyze_ok "tech3342_1" -20:20 -30:20
+assert_near "tech3342_1" lra 10 1
+analyze_ok "tech3342_2" -20:20 -15:20
+assert_near "tech3342_2" lra 5 1
+analyze_ok "tech3342_3" -40:20 -20:20
+assert_near "tech3342_3" lra 20 1
+analyze_ok "tech3342_4" -50:20 -35:20 -20:20 -35:20 -50:20
+assert_near "tech3342_4" lra 15 1
+
+echo "[LOUDNESS] all tests passed"
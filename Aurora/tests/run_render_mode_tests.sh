@@ -0,0 +1,309 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+AURORA_BIN="$ROOT_DIR/build/src/aurora_cli/aurora"
+OUT_ROOT="$ROOT_DIR/out/render_mode_test_runs"
+SCORE="tests/render_modes.au"
+SR=48000
+
+if [[ ! -x "$AURORA_BIN" ]]; then
+  echo "error: missing binary at $AURORA_BIN"
+  echo "build first: cmake --build build -j4"
+  exit 1
+fi
+
+wav_channels() {
+  local wav="$1"
+  od -An -j22 -N2 -tu2 "$wav" | tr -d '[:space:]'
+}
+
+# Aurora writes 32-bit float WAV with a 44-byte header.
+wav_frames() {
+  local wav="$1"
+  local size
+  size="$(wc -c <"$wav" | tr -d '[:space:]')"
+  echo $(((size - 44) / ($(wav_channels "$wav") * 4)))
+}
+
+# "<channels>x<frames>"
+wav_layout() {
+  local wav="$1"
+  echo "$(wav_channels "$wav")x$(wav_frames "$wav")"
+}
+
+render_ok() {
+  local name="$1"
+  shift
+  echo "[MODES] render $name${*:+: $*}"
+  if ! "$AURORA_BIN" render "$ROOT_DIR/$SCORE" --out "$OUT_ROOT/$name" "$@" >/tmp/modes_${name}.log 2>&1; then
+    echo "error: render $name failed"
+    cat /tmp/modes_${name}.log
+    exit 1
+  fi
+}
+
+# Asserts that `part` holds exactly `frames` frames of `full` starting at frame `start`, byte for byte.
+assert_same_span() {
+  local full="$1"
+  local part="$2"
+  local start="$3"
+  local frames="$4"
+  local frame_bytes
+  frame_bytes=$(($(wav_channels "$full") * 4))
+  if [[ "$(wav_layout "$part")" != "$(wav_channels "$full")x$frames" ]]; then
+    echo "error: $part should have $frames frames of $(wav_channels "$full") channels"
+    exit 1
+  fi
+  if ! cmp -s -n $((frames * frame_bytes)) "$full" "$part" $((44 + start * frame_bytes)) 44; then
+    echo "error: $part differs from frames $start.. of $full"
+    exit 1
+  fi
+}
+
+rm -rf "$OUT_ROOT"
+mkdir -p "$OUT_ROOT"
+
+render_ok "full"
+FULL="$OUT_ROOT/full"
+FULL_FRAMES="$(wav_frames "$FULL/mix/master.wav")"
+
+# The Space bus pre-roll reaches back to the start of the score from 1.5 s, so every stem, and the master mixed
+# from them, is the exact span of the full render.
+render_ok "range" --from 1.5s --to 4s
+for wav in stems/pad.wav stems/air.wav stems/bass.wav stems/space.wav mix/master.wav; do
+  assert_same_span "$FULL/$wav" "$OUT_ROOT/range/$wav" $((SR * 3 / 2)) $((SR * 5 / 2))
+done
+
+# A section range that starts later: patch voices are computed from their start, so patch stems still match the full
+# render exactly (bus stems only warm up over their pre-roll and are not compared here).
+render_ok "range_section" --from Verse
+for wav in stems/pad.wav stems/air.wav stems/bass.wav; do
+  assert_same_span "$FULL/$wav" "$OUT_ROOT/range_section/$wav" $((SR * 3)) $((FULL_FRAMES - SR * 3))
+done
+if ! grep -q "\"start_sample\": $((SR * 3))," "$OUT_ROOT/range_section/meta/render.json"; then
+  echo "error: range render.json should record start_sample $((SR * 3))"
+  exit 1
+fi
+
+# A draft renders at a lower internal rate, but its stem set, stem layouts and lengths, and MIDI are those of the
+# final render, and render.json says it is a draft.
+render_ok "draft" --draft
+if [[ "$(ls "$OUT_ROOT/draft/stems")" != "$(ls "$FULL/stems")" ]]; then
+  echo "error: draft stem set differs from the full render"
+  exit 1
+fi
+for wav in "$FULL"/stems/*.wav "$FULL/mix/master.wav"; do
+  draft_wav="$OUT_ROOT/draft/${wav#"$FULL/"}"
+  if [[ "$(wav_layout "$draft_wav")" != "$(wav_layout "$wav")" ]]; then
+    echo "error: $draft_wav should have the channels and length of $wav"
+    exit 1
+  fi
+done
+if ! cmp -s "$FULL/midi/arrangement.mid" "$OUT_ROOT/draft/midi/arrangement.mid"; then
+  echo "error: draft arrangement.mid differs from the full render"
+  exit 1
+fi
+if ! grep -q '"draft": {' "$OUT_ROOT/draft/meta/render.json" || grep -q '"draft"' "$FULL/meta/render.json"; then
+  echo "error: only the draft render.json should record draft mode"
+  exit 1
+fi
+
+# A --seeds batch renders Pad and Bass (no noise) once and reuses them for the second seed; every variant must still be
+# byte-identical to a separate --seed render, the shared stems included.
+render_ok "seeds" --seeds 3,9
+if ! grep -q "Reused 2 of 4 stems" /tmp/modes_seeds.log; then
+  echo "error: the second seed should reuse the seed-independent Pad and Bass stems"
+  cat /tmp/modes_seeds.log
+  exit 1
+fi
+for seed in 3 9; do
+  render_ok "seed_$seed" --seed "$seed"
+  if ! diff -r "$OUT_ROOT/seeds/seed-$seed" "$OUT_ROOT/seed_$seed" >/dev/null; then
+    echo "error: --seeds variant seed-$seed differs from a separate --seed $seed render"
+    exit 1
+  fi
+done
+if cmp -s "$OUT_ROOT/seed_3/stems/air.wav" "$OUT_ROOT/seed_9/stems/air.wav"; then
+  echo "error: the noise stem should differ between seeds"
+  exit 1
+fi
+
+# --only bus:Space also renders the patches sending to it (Pad and Air) but not Bass, writes no master, and the stems
+# it writes are byte-identical to the full render's.
+render_ok "only_bus" --only bus:Space
+if [[ "$(ls "$OUT_ROOT/only_bus/stems" | tr '\n' ' ')" != "air.wav pad.wav space.wav " ]]; then
+  echo "error: --only bus:Space should write exactly air, pad and space stems"
+  ls "$OUT_ROOT/only_bus/stems"
+  exit 1
+fi
+if [[ -e "$OUT_ROOT/only_bus/mix/master.wav" ]]; then
+  echo "error: --only without --partial-master should not write a master"
+  exit 1
+fi
+for wav in "$OUT_ROOT"/only_bus/stems/*.wav; do
+  if ! cmp -s "$wav" "$FULL/stems/$(basename "$wav")"; then
+    echo "error: $wav differs from the full render"
+    exit 1
+  fi
+done
+render_ok "only_patch" --only patch:Bass
+if [[ "$(ls "$OUT_ROOT/only_patch/stems" | tr '\n' ' ')" != "bass.wav " ]] ||
+    ! cmp -s "$OUT_ROOT/only_patch/stems/bass.wav" "$FULL/stems/bass.wav"; then
+  echo "error: --only patch:Bass should write exactly the full render's bass stem"
+  exit 1
+fi
+
+# aurora watch re-renders only what an edit touches: after Pad's cutoff changes, Pad and the Space bus it sends to
+# render again while Air and Bass are reused, and every output matches a plain render of the edited score.
+WATCH="$OUT_ROOT/watch"
+mkdir -p "$WATCH"
+cp "$ROOT_DIR/$SCORE" "$WATCH/watch.au"
+echo "[MODES] watch: edit Pad"
+"$AURORA_BIN" watch "$WATCH/watch.au" --out "$WATCH/out" >/tmp/modes_watch.log 2>&1 &
+WATCH_PID=$!
+trap 'kill "$WATCH_PID" 2>/dev/null || true' EXIT
+# Waits until the watch log holds `count` lines matching `pattern`.
+wait_for_watch_log() {
+  local pattern="$1"
+  local count="$2"
+  for _ in $(seq 300); do
+    if [[ "$(grep -c "$pattern" /tmp/modes_watch.log)" -ge "$count" ]]; then
+      return
+    fi
+    sleep 0.1
+  done
+  echo "error: watch did not log \"$pattern\" $count time(s)"
+  cat /tmp/modes_watch.log
+  exit 1
+}
+wait_for_watch_log "Wrote" 1
+sed -i 's/cutoff: 1200Hz/cutoff: 1500Hz/' "$WATCH/watch.au"
+wait_for_watch_log "Rendered .* stems" 2
+wait_for_watch_log "Wrote\|Outputs unchanged" 2
+kill "$WATCH_PID"
+wait "$WATCH_PID" 2>/dev/null || true
+trap - EXIT
+if [[ "$(grep "Rendered .* stems" /tmp/modes_watch.log | tail -1)" != *"Rendered 2 of 4 stems (pad, space)"* ]]; then
+  echo "error: the edit should re-render only the pad and space stems"
+  cat /tmp/modes_watch.log
+  exit 1
+fi
+if ! "$AURORA_BIN" render "$WATCH/watch.au" --out "$WATCH/fresh" >/tmp/modes_watch_fresh.log 2>&1; then
+  echo "error: render of the edited score failed"
+  cat /tmp/modes_watch_fresh.log
+  exit 1
+fi
+for file in stems/pad.wav stems/air.wav stems/bass.wav stems/space.wav mix/master.wav midi/arrangement.mid; do
+  if ! cmp -s "$WATCH/out/$file" "$WATCH/fresh/$file"; then
+    echo "error: watch $file differs from a render of the edited score"
+    exit 1
+  fi
+done
+if cmp -s "$WATCH/out/stems/pad.wav" "$FULL/stems/pad.wav"; then
+  echo "error: watch should have re-rendered the pad stem after the edit"
+  exit 1
+fi
+
+# arrangement.mid of tempo_map_changes.au with the closing cutoff lane ending at 5min, a gain lane and notes around the
+# tempo changes: each CC lane writes a value only when its 7-bit value changes and ends on the lane's final value, and
+# every note-on lands on the tick of a linear walk through the tempo map.
+MIDI="$OUT_ROOT/midi"
+mkdir -p "$MIDI"
+sed -e 's/7min: 700Hz/5min: 700Hz/' \
+    -e 's|^    automate patch.Pulse.filt.cutoff linear.*|&\
+    automate patch.Pulse.amp.gain linear { 0s: -30dB, 5min: -10dB }\
+    play Pulse { at: 45s, dur: 1s, vel: 0.5, pitch: C3 }\
+    play Pulse { at: 89.75s, dur: 1s, vel: 0.5, pitch: D3 }\
+    play Pulse { at: 90s, dur: 1s, vel: 0.5, pitch: E3 }\
+    play Pulse { at: 150.25s, dur: 1s, vel: 0.5, pitch: F3 }\
+    play Pulse { at: 209.5s, dur: 1s, vel: 0.5, pitch: G3 }\
+    play Pulse { at: 212.125s, dur: 1s, vel: 0.5, pitch: A3 }|' \
+    "$ROOT_DIR/tests/tempo_map_changes.au" >"$MIDI/tempo_cc.au"
+echo "[MODES] midi: tempo map and CC lanes"
+if ! "$AURORA_BIN" render "$MIDI/tempo_cc.au" --out "$MIDI/out" >/tmp/modes_midi.log 2>&1; then
+  echo "error: render of the MIDI fixture failed"
+  cat /tmp/modes_midi.log
+  exit 1
+fi
+python3 - "$MIDI/out/midi/arrangement.mid" <<'EOF_PY'
+import math, sys
+
+data = open(sys.argv[1], "rb").read()
+assert data[:4] == b"MThd" and int.from_bytes(data[12:14], "big") == 480, "expected an SMF with 480 PPQ"
+pos = 8 + int.from_bytes(data[4:8], "big")
+note_ons = {}
+lanes = {}
+while pos < len(data):
+    assert data[pos:pos + 4] == b"MTrk", "expected a track chunk"
+    end = pos + 8 + int.from_bytes(data[pos + 4:pos + 8], "big")
+    pos += 8
+    tick = 0
+    status = 0
+    while pos < end:
+        delta = 0
+        while True:
+            byte = data[pos]
+            pos += 1
+            delta = (delta << 7) | (byte & 0x7F)
+            if byte < 0x80:
+                break
+        tick += delta
+        if data[pos] >= 0x80:
+            status = data[pos]
+            pos += 1
+        if status == 0xFF:
+            pos += 2 + data[pos + 1]
+        elif status & 0xF0 in (0xC0, 0xD0):
+            pos += 1
+        else:
+            kind, a, b = status & 0xF0, data[pos], data[pos + 1]
+            pos += 2
+            if kind == 0x90 and b > 0:
+                note_ons.setdefault(a, []).append(tick)
+            elif kind == 0xB0:
+                lanes.setdefault((status & 0x0F, a), []).append(b)
+
+errors = []
+# CC 74 is the cutoff lane (log scale over 20 Hz..20 kHz), CC 7 the gain lane (-60..12 dB).
+final = {74: round(math.log(700 / 20) / math.log(1000) * 127), 7: round((-10 + 60) / 72 * 127)}
+for (channel, cc), values in sorted(lanes.items()):
+    repeats = [v for prev, v in zip(values, values[1:]) if v == prev]
+    if repeats:
+        errors.append(f"CC {cc} on channel {channel} repeats values {repeats[:5]}")
+    if cc in final and values[-1] != final.pop(cc):
+        errors.append(f"CC {cc} on channel {channel} ends on {values[-1]}")
+if final:
+    errors.append(f"missing CC lanes {sorted(final)}")
+
+# The tempo map walked segment by segment, as the MIDI writer did before it kept cumulative ticks.
+TEMPO = [(0.0, 62.0), (90.0, 54.0), (210.0, 48.0)]
+def ticks(seconds):
+    total = 0.0
+    for i, (start, bpm) in enumerate(TEMPO):
+        end = TEMPO[i + 1][0] if i + 1 < len(TEMPO) else math.inf
+        if seconds <= start:
+            break
+        total += max(0.0, min(seconds, end) - start) * (bpm / 60.0) * 480.0
+        if seconds <= end:
+            break
+    return math.floor(total + 0.5)
+
+notes = {36: 0.0, 48: 45.0, 50: 89.75, 52: 90.0, 53: 150.25, 55: 209.5, 57: 212.125}
+for note, seconds in notes.items():
+    expected = ticks(round(seconds * 48000) / 48000)
+    if note_ons.get(note) != [expected]:
+        errors.append(f"note {note} at {seconds} s: note-ons at {note_ons.get(note)}, expected [{expected}]")
+if errors:
+    print("error: " + "\nerror: ".join(errors))
+    sys.exit(1)
+EOF_PY
+for tolerance in -1 128; do
+  if "$AURORA_BIN" render "$MIDI/tempo_cc.au" --out "$MIDI/rejected" --midi-cc-tolerance "$tolerance" \
+      >/tmp/modes_midi_tolerance.log 2>&1 || [[ $? -ne 2 ]]; then
+    echo "error: --midi-cc-tolerance $tolerance should be an argument error"
+    exit 1
+  fi
+done
+
+echo "[MODES] all tests passed"